@@ -189,7 +189,7 @@ class idfxTest:
         print("***************************************************"+bcolors.ENDC)
         raise e
 
-  def run(self, inputFile="", np=2, nowrite=False, restart=-1):
+  def run(self, inputFile="", np=2, nowrite=False, restart=-1, options=[]):
       comm=["./idefix"]
       if inputFile:
           comm.append("-i")
@@ -218,6 +218,8 @@ class idfxTest:
         comm.append("-restart")
         comm.append(str(restart))
 
+      comm.extend(options)
+
       try:
           make=subprocess.run(comm)
           make.check_returncode()
@@ -6,6 +6,9 @@
 // ***********************************************************************************
 
 
+#include <algorithm>
+#include <limits>
+#include <string>
 #include "../idefix.hpp"
 #include "dataBlock.hpp"
 #include "dataBlockHost.hpp"
@@ -23,40 +26,250 @@ void DataBlock::Coarsen() {
   #endif
 }
 
+namespace {
+// Physical width of a cell along one direction
+struct CellWidth {
+  explicit CellWidth(DataBlock *data): dx1(data->dx[IDIR]), dx2(data->dx[JDIR]),
+                                       dx3(data->dx[KDIR]), x1(data->x[IDIR]),
+                                       rt(data->rt), dmu(data->dmu) {}
+
+  KOKKOS_INLINE_FUNCTION real operator()(int dir, int k, int j, int i) const {
+    if(dir == IDIR) return dx1(i);
+    if(dir == JDIR) {
+      #if GEOMETRY == POLAR
+        return dx2(j)*x1(i);
+      #elif GEOMETRY == SPHERICAL
+        return dx2(j)*rt(i);
+      #else
+        return dx2(j);
+      #endif
+    }
+    #if GEOMETRY == SPHERICAL
+      return dx3(k)*rt(i)*dmu(j)/dx2(j);
+    #else
+      return dx3(k);
+    #endif
+  }
+
+  IdefixArray1D<real> dx1, dx2, dx3, x1, rt, dmu;
+};
+
+// Largest signal speed of the gas along one direction (flow speed + fast magnetosonic speed)
+struct SignalSpeed {
+  explicit SignalSpeed(DataBlock *data): Vc(data->hydro->Vc), eos(*(data->hydro->eos.get())) {}
+
+  KOKKOS_INLINE_FUNCTION real operator()(int dir, int k, int j, int i) const {
+    const real rho = Vc(RHO,k,j,i);
+    #if HAVE_ENERGY
+      real c2 = eos.GetGamma(Vc(PRS,k,j,i), rho)*Vc(PRS,k,j,i)/rho;
+    #else
+      const real cs = eos.GetWaveSpeed(k,j,i);
+      real c2 = cs*cs;
+    #endif
+    #if MHD == YES
+      c2 += (EXPAND( Vc(BX1,k,j,i)*Vc(BX1,k,j,i) ,
+                    + Vc(BX2,k,j,i)*Vc(BX2,k,j,i) ,
+                    + Vc(BX3,k,j,i)*Vc(BX3,k,j,i) ))/rho;
+    #endif
+    real v = ZERO_F;
+    if(dir < COMPONENTS) v = FABS(Vc(VX1+dir,k,j,i));
+    return v + std::sqrt(c2);
+  }
+
+  IdefixArray4D<real> Vc;
+  EquationOfState eos;
+};
+}  // namespace
+
 void DataBlock::EnrollGridCoarseningLevels(GridCoarseningFunc func) {
   if(!haveGridCoarsening) {
     IDEFIX_WARNING("DataBlock:EnrollCoarseningLevels was called but grid "
                     "coarsening is not enabled.");
   }
+  if(coarseningCriterion != CoarseningCriterion::userdef) {
+    IDEFIX_WARNING("DataBlock:EnrollCoarseningLevels was called but a coarseningCriterion "
+                   "is set in the input file. The enrolled function will not be used.");
+  }
   this->gridCoarseningFunc = func;
 }
 
+void DataBlock::InitCoarseningCriterion(Input &input) {
+  if(input.CheckEntry("Grid","coarseningCriterion")<0) return;
+  if(!haveGridCoarsening) {
+    IDEFIX_WARNING("Grid:coarseningCriterion is set but grid coarsening is not enabled.");
+    return;
+  }
+  std::string criterion = input.Get<std::string>("Grid","coarseningCriterion",0);
+  if(criterion.compare("cfl")==0) {
+    coarseningCriterion = CoarseningCriterion::cfl;
+  } else if(criterion.compare("aspect")==0) {
+    coarseningCriterion = CoarseningCriterion::aspect;
+  } else {
+    std::stringstream msg;
+    msg << "Grid coarsening criterion can only be cfl or aspect. I got: " << criterion;
+    IDEFIX_ERROR(msg);
+  }
+  coarseningTarget = input.GetOrSet<real>("Grid","coarseningCriterion",1, 1.0);
+  if(coarseningTarget <= 0) {
+    IDEFIX_ERROR("The target ratio of the grid coarsening criterion should be positive.");
+  }
+  if(DIMENSIONS < 2) {
+    IDEFIX_ERROR("The grid coarsening criteria compare several directions, "
+                 "they require DIMENSIONS >= 2.");
+  }
+  // A level of 0 leaves the coarsening only limited by the local grid size
+  const int maxLevel = input.GetOrSet<int>("Grid","coarseningMaxLevel",0, 0);
+
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    if(!coarseningDirection[dir]) continue;
+    // Largest level such that 2^(level-1) divides the local grid size
+    int level = 1;
+    while(np_int[dir] % (1 << level) == 0) level++;
+    if(maxLevel > 0) level = std::min(level, maxLevel);
+
+    const int Xt = (dir == IDIR ? JDIR : IDIR);
+    const int Xb = (dir == KDIR ? JDIR : KDIR);
+    coarseningFactor[dir] = IdefixArray2D<real>("DataBlock_coarseningFactor",
+                                                np_tot[Xb], np_tot[Xt]);
+    #ifdef WITH_MPI
+      // The processes sharing the rows along dir must agree on the levels
+      int remainDims[3] = {false, false, false};
+      remainDims[dir] = true;
+      MPI_SAFE_CALL(MPI_Cart_sub(mygrid->CartComm, remainDims, &coarseningComm[dir]));
+      MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &level, 1, MPI_INT, MPI_MIN,
+                                  coarseningComm[dir]));
+    #endif
+    coarseningMaxLevel[dir] = level;
+  }
+}
+
+void DataBlock::ComputeCoarseningCriterion() {
+  idfx::pushRegion("DataBlock::ComputeCoarseningCriterion");
+  CellWidth width(this);
+  SignalSpeed speed(this);
+  const bool cfl = (coarseningCriterion == CoarseningCriterion::cfl);
+  const real target = coarseningTarget;
+
+  Kokkos::Array<int,3> beg, end;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    beg[dir] = this->beg[dir];
+    end[dir] = this->end[dir];
+  }
+
+  for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+    if(!coarseningDirection[dir]) continue;
+    const int Xt = (dir == IDIR ? JDIR : IDIR);
+    const int Xb = (dir == KDIR ? JDIR : KDIR);
+
+    // Smallest timestep allowed by the directions that are not coarsened here
+    real dtRef = ZERO_F;
+    if(cfl) {
+      dtRef = std::numeric_limits<real>::max();
+      idefix_reduce("CoarseningCriterion_Timestep",
+        beg[KDIR], end[KDIR],
+        beg[JDIR], end[JDIR],
+        beg[IDIR], end[IDIR],
+        KOKKOS_LAMBDA(int k, int j, int i, real &dtMin) {
+          for(int d = 0 ; d < DIMENSIONS ; d++) {
+            if(d == dir) continue;
+            dtMin = FMIN(dtMin, width(d,k,j,i)/speed(d,k,j,i));
+          }
+        },
+        Kokkos::Min<real>(dtRef));
+      #ifdef WITH_MPI
+        MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &dtRef, 1, realMPI, MPI_MIN,
+                                    MPI_COMM_WORLD));
+      #endif
+    }
+
+    // Coarsening factor needed by each row. Rows in the ghost zones copy the closest active row.
+    IdefixArray2D<real> factor = coarseningFactor[dir];
+    idefix_for("CoarseningCriterion_Rows", 0, np_tot[Xb], 0, np_tot[Xt],
+      KOKKOS_LAMBDA(int b, int t) {
+        int idx[3];
+        idx[Xb] = Kokkos::min(Kokkos::max(b, beg[Xb]), end[Xb]-1);
+        idx[Xt] = Kokkos::min(Kokkos::max(t, beg[Xt]), end[Xt]-1);
+        real need = ONE_F;
+        for(int n = beg[dir] ; n < end[dir] ; n++) {
+          idx[dir] = n;
+          const int k = idx[KDIR];
+          const int j = idx[JDIR];
+          const int i = idx[IDIR];
+          const real dl = width(dir,k,j,i);
+          if(cfl) {
+            need = FMAX(need, target*dtRef*speed(dir,k,j,i)/dl);
+          } else {
+            real dlMin = std::numeric_limits<real>::max();
+            for(int d = 0 ; d < DIMENSIONS ; d++) {
+              if(d != dir) dlMin = FMIN(dlMin, width(d,k,j,i));
+            }
+            need = FMAX(need, target*dlMin/dl);
+          }
+        }
+        factor(b,t) = need;
+      });
+
+    #ifdef WITH_MPI
+      if(mygrid->nproc[dir] > 1) {
+        Kokkos::fence();
+        MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, factor.data(), factor.size(), realMPI,
+                                    MPI_MAX, coarseningComm[dir]));
+      }
+    #endif
+
+    // Smallest level reaching the factor
+    IdefixArray2D<int> level = coarseningLevel[dir];
+    const int maxLevel = coarseningMaxLevel[dir];
+    idefix_for("CoarseningCriterion_Levels", 0, np_tot[Xb], 0, np_tot[Xt],
+      KOKKOS_LAMBDA(int b, int t) {
+        int l = 1;
+        real f = ONE_F;
+        while(f < factor(b,t) && l < maxLevel) {
+          f *= 2;
+          l++;
+        }
+        level(b,t) = l;
+      });
+  }
+  idfx::popRegion();
+}
+
 void DataBlock::ComputeGridCoarseningLevels() {
   idfx::pushRegion("DataBlock::ComputeGridCoarseningLevels");
   static bool levelsHaveBeenComputedOnce = false;
-  if((gridCoarseningFunc == NULL) && (haveGridCoarsening == GridCoarsening::dynamic)) {
-    IDEFIX_ERROR("Dynamic grid Coarsening is enabled, "
-                 "but no function has been enrolled to compute coarsening levels");
+  const bool haveCriterion = (coarseningCriterion != CoarseningCriterion::userdef);
+  if((gridCoarseningFunc == NULL) && (haveGridCoarsening == GridCoarsening::dynamic)
+                                  && !haveCriterion) {
+    IDEFIX_ERROR("Dynamic grid Coarsening is enabled, but no function has been enrolled "
+                 "and no coarseningCriterion is set to compute coarsening levels");
   }
   // if grid coarsening is enabled(=static), we compute the levels once
   // levels can be either initialised with the initial conditions, or with a dedicated
   // Coarsening function (if Enrollment has been called)
   if((haveGridCoarsening == GridCoarsening::enabled) && (!levelsHaveBeenComputedOnce)) {
-    if(gridCoarseningFunc != NULL) {
+    if(haveCriterion) {
+      // Levels are valid by construction
+      ComputeCoarseningCriterion();
+    } else if(gridCoarseningFunc != NULL) {
       idfx::pushRegion("User-defined Coarsening function");
         gridCoarseningFunc(*this);
       idfx::popRegion();
       // We check the levels the first time this function is called. After that, there is no check!
       CheckCoarseningLevels();
     } else {
-      IDEFIX_ERROR("Grid coarsening requires the enrollment of a grid coarsening function");
+      IDEFIX_ERROR("Grid coarsening requires the enrollment of a grid coarsening function "
+                   "or a coarseningCriterion");
     }
     levelsHaveBeenComputedOnce = true;
   }
   if(haveGridCoarsening == GridCoarsening::dynamic) {
-    idfx::pushRegion("User-defined Coarsening function");
-      gridCoarseningFunc(*this);
-    idfx::popRegion();
+    if(haveCriterion) {
+      ComputeCoarseningCriterion();
+    } else {
+      idfx::pushRegion("User-defined Coarsening function");
+        gridCoarseningFunc(*this);
+      idfx::popRegion();
+    }
     levelsHaveBeenComputedOnce = true;
   }
   idfx::popRegion();
@@ -64,20 +277,25 @@ void DataBlock::ComputeGridCoarseningLevels() {
 
 void DataBlock::CheckCoarseningLevels() {
   idfx::pushRegion("DataBlock::CheckCoarseningLevels()");
-  // Check that the coarsening levels we have are valid
-  // NB: this is a costly procedure, we can't repeat it at each loop!
+  // Check that the coarsening levels we have are valid. The check runs on the device,
+  // the levels are only copied to the host to describe an invalid level.
   for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
     if(mygrid->coarseningDirection[dir]) {
+      IdefixArray2D<int> level = coarseningLevel[dir];
+      const int np = np_int[dir];
+      int nInvalid = 0;
+      idefix_reduce("CheckCoarseningLevels", 0, level.extent(0), 0, level.extent(1),
+        KOKKOS_LAMBDA(int j, int i, int &n) {
+          const int l = level(j,i);
+          if(l < 1 || l > 30 || np % (1 << (l-1)) != 0) n++;
+        },
+        Kokkos::Sum<int>(nInvalid));
+      if(nInvalid == 0) continue;
+
       IdefixHostArray2D<int> arr = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(),
-                                                                       coarseningLevel[dir]);
+                                                                       level);
       for(int j = 0 ; j < arr.extent(0) ; j++) {
         for(int i = 0 ; i < arr.extent(1) ; i++) {
-          if(std::isnan(arr(j,i))) {
-            std::stringstream str;
-            str << "Nan in grid coarsening levels" << std::endl;
-            str << "at (i,j)=("<< i << "," << j << "): Coarsening level is NaN!" << std::endl;
-            IDEFIX_ERROR(str);
-          }
           if(arr(j,i) < 1) {
             std::stringstream str;
             str << "Coarsening level < 1!" << std::endl;
@@ -85,14 +303,12 @@ void DataBlock::CheckCoarseningLevels() {
             str << "coarsening level= " << arr(j,i) << std::endl;
             IDEFIX_ERROR(str);
           }
-          const int factor = 1 << (arr(j,i) - 1);
-          if(np_int[dir] % factor != 0) {
+          if(arr(j,i) > 30 || np_int[dir] % (1 << (arr(j,i) - 1)) != 0) {
             std::stringstream str;
             str << "Local grid size not divisible by coarsening level." << std::endl;
             str << "at (i,j)=("<< i << "," << j << "): ";
             str << "coarsening level= " << arr(j,i) << std::endl;
-            str << np_int[dir] << " cannot be divided by 2^" << arr(j,i)-1;
-            str << " = " << factor << std::endl;
+            str << np_int[dir] << " cannot be divided by 2^" << arr(j,i)-1 << std::endl;
             IDEFIX_ERROR(str);
           }
         }
@@ -13,6 +13,7 @@
 #include "fluid.hpp"
 #include "gravity.hpp"
 #include "planetarySystem.hpp"
+#include "particles.hpp"
 #include "vtk.hpp"
 #include "dump.hpp"
 #ifdef WITH_HDF5
@@ -32,9 +33,10 @@ DataBlock::DataBlock(Grid &grid, Input &input) {
   // Get the number of points from the parent grid object
   for(int dir = 0 ; dir < 3 ; dir++) {
     nghost[dir] = grid.nghost[dir];
-    // Domain decomposition: decompose the full domain size in grid by the number of processes
-    // in that direction
-    np_int[dir] = grid.np_int[dir]/grid.nproc[dir];
+    nghostStage[dir] = grid.nghostStage[dir];
+    // Domain decomposition: the slabs of the grid along this direction
+    const int slab = grid.xproc[dir];
+    np_int[dir] = grid.procStart[dir][slab+1] - grid.procStart[dir][slab];
     np_tot[dir] = np_int[dir]+2*nghost[dir];
 
     // Boundary conditions
@@ -56,9 +58,8 @@ DataBlock::DataBlock(Grid &grid, Input &input) {
     end[dir] = grid.nghost[dir]+np_int[dir];
 
     // Where does this datablock starts and end in the grid?
-    // This assumes even distribution of points between procs
-    gbeg[dir] = grid.nghost[dir] + grid.xproc[dir]*np_int[dir];
-    gend[dir] = grid.nghost[dir] + (grid.xproc[dir]+1)*np_int[dir];
+    gbeg[dir] = grid.nghost[dir] + grid.procStart[dir][slab];
+    gend[dir] = grid.nghost[dir] + grid.procStart[dir][slab+1];
 
     // Local start and end of current datablock
     xbeg[dir] = gridHost.xl[dir](gbeg[dir]);
@@ -99,12 +100,17 @@ DataBlock::DataBlock(Grid &grid, Input &input) {
   dmu = IdefixArray1D<real>("DataBlock_dmu",np_tot[JDIR]);
 #endif
 
+  this->haveDeepHalo = grid.haveDeepHalo;
+
   // Initialize our sub-domain
   this->ExtractSubdomain();
 
   // Initialize the geometry
   this->MakeGeometry();
 
+  // Initialize the built-in grid coarsening criterion, if any
+  this->InitCoarseningCriterion(input);
+
   // Initialise the state containers
   // (by default, datablock only initialise the current state, which is a reference
   // to arrays in the daughter object
@@ -152,6 +158,12 @@ DataBlock::DataBlock(Grid &grid, Input &input) {
       dust.emplace_back(std::make_unique<Fluid<DustPhysics>>(grid, input, this, i));
     }
   }
+
+  // Initialise dust particles if needed
+  if(input.CheckBlock("Particles")) {
+    this->particles = std::make_unique<Particles>(input, this);
+    this->haveParticles = true;
+  }
   // Register variables that need to be saved in case of restart dump
   dump->RegisterVariable(&t, "time");
   dump->RegisterVariable(&dt, "dt");
@@ -159,6 +171,15 @@ DataBlock::DataBlock(Grid &grid, Input &input) {
   idfx::popRegion();
 }
 
+// Defined here, where the classes held by unique pointers are complete
+DataBlock::~DataBlock() {
+  #ifdef WITH_MPI
+    for(int dir = 0 ; dir < 3 ; dir++) {
+      if(coarseningComm[dir] != MPI_COMM_NULL) MPI_Comm_free(&coarseningComm[dir]);
+    }
+  #endif
+}
+
 /**
  * @brief Construct a new Data Block as a subgrid
  *
@@ -177,9 +198,10 @@ DataBlock::DataBlock(SubGrid *subgrid) {
   // Get the number of points from the parent grid object
   for(int dir = 0 ; dir < 3 ; dir++) {
     nghost[dir] = grid->nghost[dir];
-    // Domain decomposition: decompose the full domain size in grid by the number of processes
-    // in that direction
-    np_int[dir] = grid->np_int[dir]/grid->nproc[dir];
+    nghostStage[dir] = grid->nghostStage[dir];
+    // Domain decomposition: the slabs of the grid along this direction
+    const int slab = grid->xproc[dir];
+    np_int[dir] = grid->procStart[dir][slab+1] - grid->procStart[dir][slab];
     np_tot[dir] = np_int[dir]+2*nghost[dir];
 
     // Boundary conditions
@@ -201,9 +223,8 @@ DataBlock::DataBlock(SubGrid *subgrid) {
     end[dir] = grid->nghost[dir]+np_int[dir];
 
     // Where does this datablock starts and end in the grid?
-    // This assumes even distribution of points between procs
-    gbeg[dir] = grid->nghost[dir] + grid->xproc[dir]*np_int[dir];
-    gend[dir] = grid->nghost[dir] + (grid->xproc[dir]+1)*np_int[dir];
+    gbeg[dir] = grid->nghost[dir] + grid->procStart[dir][slab];
+    gend[dir] = grid->nghost[dir] + grid->procStart[dir][slab+1];
 
     // Local start and end of current datablock
     xbeg[dir] = gridHost.xl[dir](gbeg[dir]);
@@ -213,6 +234,7 @@ DataBlock::DataBlock(SubGrid *subgrid) {
   // Next we erase the info the slice direction
   int refdir = subgrid->direction;
   nghost[refdir] = 0;
+  nghostStage[refdir] = 0;
   np_int[refdir] = 1;
   np_tot[refdir] = 1;
   beg[refdir] = 0;
@@ -278,7 +300,7 @@ void DataBlock::PrimToCons() {
 }
 
 // Set the boundaries of the data structures in this datablock
-void DataBlock::SetBoundaries() {
+void DataBlock::SetBoundaries(bool exchange) {
   if(haveGridCoarsening) {
     ComputeGridCoarseningLevels();
     hydro->CoarsenFlow(hydro->Vc);
@@ -293,10 +315,37 @@ void DataBlock::SetBoundaries() {
   }
   if(haveDust) {
     for(int i = 0 ; i < dust.size() ; i++) {
-      dust[i]->boundary->SetBoundaries(t);
+      dust[i]->boundary->SetBoundaries(t, exchange);
+    }
+  }
+  hydro->boundary->SetBoundaries(t, exchange);
+}
+
+// With deep halos, the ghost zones filled by MPI are wide enough for all of the stages of a
+// cycle. Each intermediate stage also evolves the part of these ghost zones that the next stages
+// still need, so that these do not require any new exchange.
+void DataBlock::ExtendActiveDomain(int stagesLeft) {
+  if(!haveDeepHalo || stagesLeft == 0) return;
+  for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+    if(mygrid->nproc[dir] == 1) continue;
+    const int width = stagesLeft*nghostStage[dir];
+    if(lbound[dir] == internal || lbound[dir] == periodic) {
+      beg[dir] = nghost[dir] - width;
+    }
+    if(rbound[dir] == internal || rbound[dir] == periodic) {
+      end[dir] = nghost[dir] + np_int[dir] + width;
     }
   }
-  hydro->boundary->SetBoundaries(t);
+  activeDomainExtended = true;
+}
+
+void DataBlock::ResetActiveDomain() {
+  if(!activeDomainExtended) return;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    beg[dir] = nghost[dir];
+    end[dir] = nghost[dir] + np_int[dir];
+  }
+  activeDomainExtended = false;
 }
 
 
@@ -310,6 +359,11 @@ void DataBlock::ShowConfig() {
         << "...." << xend[dir] << std::endl;
     }
   }
+  if(coarseningCriterion != CoarseningCriterion::userdef) {
+    idfx::cout << "DataBlock: grid coarsening levels from the "
+               << (coarseningCriterion == CoarseningCriterion::cfl ? "cfl" : "aspect")
+               << " criterion, with a target ratio " << coarseningTarget << "." << std::endl;
+  }
   hydro->ShowConfig();
   if(haveFargo) fargo->ShowConfig();
   if(haveplanetarySystem) planetarySystem->ShowConfig();
@@ -327,6 +381,7 @@ void DataBlock::ShowConfig() {
       dust[i]->ShowConfig();
     }*/
   }
+  if(haveParticles) particles->ShowConfig();
 }
 
 
@@ -359,6 +414,7 @@ real DataBlock::ComputeTimestep() {
       dt = std::min(dt,dtDust);
     }
   }
+  if(haveParticles) dt = std::min(dt, particles->GetTimestep());
   Kokkos::fence();
   return(dt);
 }
@@ -38,6 +38,7 @@ class Xdmf;
 class Fargo;
 class Gravity;
 class PlanetarySystem;
+class Particles;
 template<typename Phys>
 class Fluid;
 class SubGrid;
@@ -49,6 +50,11 @@ class Dump;
 
 using GridCoarseningFunc = void(*) (DataBlock &);
 
+// Built-in criteria computing the grid coarsening levels from the grid and the flow
+enum class CoarseningCriterion {userdef,  ///< Levels given by an enrolled user function
+                                cfl,      ///< Timestep along the direction / global timestep
+                                aspect};  ///< Cell width along the direction / other widths
+
 using StepFunc = void (*) (DataBlock &, const real t, const real dt);
 
 class DataBlock {
@@ -80,13 +86,22 @@ class DataBlock {
   IdefixArray3D<real> dV;                ///< cell volume
   std::array<IdefixArray3D<real>,3> A;    ///< cell left interface area
 
+  bool haveUniformGrid{false};  ///< Uniform cartesian grid: dx, dV and A are the constants below
+  std::array<real,3> uniformDx; ///< cell width (uniform grids only)
+  real uniformdV;               ///< cell volume (uniform grids only)
+  std::array<real,3> uniformA;  ///< cell interface area (uniform grids only)
+
   std::array<int,3> np_tot;     ///< total number of grid points in datablock
   std::array<int,3> np_int;     ///< active number of grid points in datablock (excl. ghost cells)
 
   std::array<int,3> nghost;               ///< number of ghost cells at each boundary
+  std::array<int,3> nghostStage;          ///< number of ghost cells consumed by one stage
   std::array<BoundaryType,3> lbound;      ///< Boundary condition to the left
   std::array<BoundaryType,3> rbound;      ///< Boundary condition to the right
 
+  bool haveDeepHalo{false};   ///< MPI halos are exchanged once per cycle (see SetBoundaries)
+  bool activeDomainExtended{false}; ///< beg/end currently include part of the deep halos
+
   bool haveAxis{false};       ///< DataBlock contains points on the axis and a special treatment
                                ///< has been required for these.
 
@@ -94,6 +109,8 @@ class DataBlock {
                                 ///< Is grid coarsening enabled?
   GridCoarseningFunc gridCoarseningFunc{NULL};
                                ///< The user-defined grid coarsening level computation function
+  CoarseningCriterion coarseningCriterion{CoarseningCriterion::userdef};
+                               ///< How the grid coarsening levels are computed
 
 
 
@@ -105,6 +122,7 @@ class DataBlock {
 
   real dt;                     ///< Current timestep
   real t;                      ///< Current time
+  int64_t cycle{0};            ///< Current cycle number
 
   Grid *mygrid;                ///< Parent grid object
 
@@ -125,6 +143,7 @@ class DataBlock {
 
   DataBlock(Grid &, Input &);     ///< init from a Grid object
   explicit DataBlock(SubGrid *);           ///< init a minimal datablock for a subgrid
+  ~DataBlock();
 
   void ExtractSubdomain();        ///< initialise datablock sub-domain according to domain decomp.
   void MakeGeometry();            ///< Compute geometrical terms
@@ -136,12 +155,22 @@ class DataBlock {
   bool haveplanetarySystem{false};
   std::unique_ptr<PlanetarySystem> planetarySystem;
 
+  // Lagrangian dust particles
+  bool haveParticles{false};
+  std::unique_ptr<Particles> particles;
+
 
   bool rklCycle{false};           ///<  // Set to true when we're inside a RKL call
+  bool implicitCycle{false};      ///<  // Set to true when we're inside an implicit parabolic call
 
   void EvolveStage();             ///< Evolve this DataBlock by dt
   void EvolveRKLStage();          ///< Evolve this DataBlock by dt for terms impacted by RKL
-  void SetBoundaries();       ///< Enforce boundary conditions to this datablock
+                                  ///< or by the implicit parabolic integrator, and for the
+                                  ///< subcycled Hall effect
+  void SetBoundaries(bool exchange = true);  ///< Enforce boundary conditions to this datablock
+                                              ///< (skipping MPI exchanges if exchange=false)
+  void ExtendActiveDomain(int);   ///< Extend beg/end over the halos still valid for n stages
+  void ResetActiveDomain();       ///< Restore beg/end to the active domain
   void ConsToPrim();       ///< Convert conservative to primitive variables
   void PrimToCons();       ///< Convert primitive to conservative variables
   void DeriveVectorPotential(); ///< Compute magnetic fields from vector potential where applicable
@@ -173,6 +202,17 @@ class DataBlock {
  private:
   void WriteVariable(FILE* , int , int *, char *, void*);
   void ComputeGridCoarseningLevels();   ///< Call user defined function to define Coarsening levels
+  void InitCoarseningCriterion(Input &);  ///< Read the built-in coarsening criterion
+  void ComputeCoarseningCriterion();      ///< Coarsening levels from the built-in criterion
+
+  // Built-in coarsening criterion
+  real coarseningTarget{1.0};                  ///< Ratio targeted by the criterion
+  std::array<int,3> coarseningMaxLevel{1,1,1}; ///< Largest level allowed in each direction
+  std::array<IdefixArray2D<real>,3> coarseningFactor; ///< Coarsening factor needed by each row
+  #ifdef WITH_MPI
+  std::array<MPI_Comm,3> coarseningComm{MPI_COMM_NULL, MPI_COMM_NULL, MPI_COMM_NULL};
+                                               ///< Processes sharing a row in each direction
+  #endif
 
   // User Steps (either before or after the main integration loop)
   bool haveUserStepFirst{false};
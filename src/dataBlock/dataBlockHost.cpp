@@ -149,38 +149,86 @@ void DataBlockHost::SyncFromDevice() {
   this->t = data->t;
   this->dt = data->dt;
 
-  Kokkos::deep_copy(Vc,data->hydro->Vc);
-  Kokkos::deep_copy(InvDt,data->hydro->InvDt);
-
-#if MHD == YES
-  Kokkos::deep_copy(Vs,data->hydro->Vs);
-  if(this->haveCurrent && data->hydro->haveCurrent) Kokkos::deep_copy(J,data->hydro->J);
-  #ifdef EVOLVE_VECTOR_POTENTIAL
-    Kokkos::deep_copy(Ve,data->hydro->Ve);
-  #endif
-  D_EXPAND( Kokkos::deep_copy(Ex3,data->hydro->emf->ez);  ,
-                                                  ,
-            Kokkos::deep_copy(Ex1,data->hydro->emf->ex);
-            Kokkos::deep_copy(Ex2,data->hydro->emf->ey);  )
-#endif
+  for(const char *field : {"Vc", "InvDt", "Vs", "J", "Ve", "Ex1", "Ex2", "Ex3", "Uc", "dustVc",
+                           "coarseningLevel"}) {
+    SyncFromDevice(field);
+  }
+  outOfDate.clear();
 
-  Kokkos::deep_copy(Uc,data->hydro->Uc);
+  idfx::popRegion();
+}
 
-  if(haveDust) {
-    for(int i = 0 ; i < dustVc.size() ; i++) {
-      Kokkos::deep_copy(dustVc[i], data->dust[i]->Vc);
+void DataBlockHost::SyncFromDevice(const std::string &field) {
+  if(field == "Vc") {
+    Kokkos::deep_copy(Vc,data->hydro->Vc);
+  } else if(field == "InvDt") {
+    Kokkos::deep_copy(InvDt,data->hydro->InvDt);
+  } else if(field == "Uc") {
+    Kokkos::deep_copy(Uc,data->hydro->Uc);
+  } else if(field == "dustVc") {
+    if(haveDust) {
+      for(int i = 0 ; i < dustVc.size() ; i++) {
+        Kokkos::deep_copy(dustVc[i], data->dust[i]->Vc);
+      }
     }
-  }
-
-  if(haveGridCoarsening) {
-    for(int dir = 0 ; dir < 3 ; dir++) {
-      if(coarseningDirection[dir]) {
-        Kokkos::deep_copy(coarseningLevel[dir], data->coarseningLevel[dir]);
+  } else if(field == "coarseningLevel") {
+    if(haveGridCoarsening) {
+      for(int dir = 0 ; dir < 3 ; dir++) {
+        if(coarseningDirection[dir]) {
+          Kokkos::deep_copy(coarseningLevel[dir], data->coarseningLevel[dir]);
+        }
       }
     }
+#if MHD == YES
+  } else if(field == "Vs") {
+    Kokkos::deep_copy(Vs,data->hydro->Vs);
+  } else if(field == "J") {
+    if(this->haveCurrent && data->hydro->haveCurrent) Kokkos::deep_copy(J,data->hydro->J);
+  } else if(field == "Ve") {
+    #ifdef EVOLVE_VECTOR_POTENTIAL
+      Kokkos::deep_copy(Ve,data->hydro->Ve);
+    #endif
+  } else if(field == "Ex1") {
+    #if DIMENSIONS == 3
+      Kokkos::deep_copy(Ex1,data->hydro->emf->ex);
+    #endif
+  } else if(field == "Ex2") {
+    #if DIMENSIONS == 3
+      Kokkos::deep_copy(Ex2,data->hydro->emf->ey);
+    #endif
+  } else if(field == "Ex3") {
+    Kokkos::deep_copy(Ex3,data->hydro->emf->ez);
+#else
+  } else if(field == "Vs" || field == "J" || field == "Ve"
+            || field == "Ex1" || field == "Ex2" || field == "Ex3") {
+    // Not defined without MHD
+#endif
+  } else {
+    IDEFIX_ERROR("DataBlockHost: cannot synchronize unknown field "+field);
   }
+}
 
-  idfx::popRegion();
+// Mark all of the fields as out of date. They are then only synchronized from the device
+// on first access, through SyncIfOutOfDate
+void DataBlockHost::MarkOutOfDate() {
+  this->t = data->t;
+  this->dt = data->dt;
+  outOfDate = {"Vc", "InvDt", "Vs", "J", "Ve", "Ex1", "Ex2", "Ex3", "Uc", "dustVc",
+               "coarseningLevel"};
+}
+
+void DataBlockHost::SyncIfOutOfDate(const std::string &field) {
+  auto it = outOfDate.find(field);
+  if(it != outOfDate.end()) {
+    idfx::pushRegion("DataBlockHost::SyncIfOutOfDate");
+    SyncFromDevice(field);
+    outOfDate.erase(it);
+    idfx::popRegion();
+  }
+}
+
+void DataBlockHost::MarkUpToDate(const std::string &field) {
+  outOfDate.erase(field);
 }
 
 void DataBlockHost::MakeVsFromAmag(IdefixHostArray4D<real> &Ain) {
@@ -8,6 +8,8 @@
 #ifndef DATABLOCK_DATABLOCKHOST_HPP_
 #define DATABLOCK_DATABLOCKHOST_HPP_
 
+#include <set>
+#include <string>
 #include <vector>
 
 #include "idefix.hpp"
@@ -93,6 +95,13 @@ class DataBlockHost {
 
   void SyncToDevice();                            ///< Synchronize this to the device datablock
   void SyncFromDevice();                          ///< Synchronize this from the device datablock
+  void SyncFromDevice(const std::string &);       ///< Synchronize a single field (Vc, Vs...)
+                                                  ///< from the device datablock
+
+  void MarkOutOfDate();                           ///< Mark all the fields as out of date, without
+                                                  ///< synchronizing them (lazy synchronisation)
+  void SyncIfOutOfDate(const std::string &);      ///< Synchronize a field if it is out of date
+  void MarkUpToDate(const std::string &);         ///< The field should not be synchronized anymore
 
   bool haveCurrent;                               ///< Whether the electrical current J is defined
 
@@ -100,6 +109,9 @@ class DataBlockHost {
 
   // Data object to which we are the mirror
   DataBlock *data;
+
+ private:
+  std::set<std::string> outOfDate;                ///< fields waiting for a lazy synchronisation
 };
 
 #endif // DATABLOCK_DATABLOCKHOST_HPP_
@@ -39,5 +39,11 @@ void DataBlock::EvolveRKLStage() {
   if(hydro->haveRKLParabolicTerms) {
     hydro->rkl->Cycle();
   }
+  if(hydro->haveImplicitParabolicTerms) {
+    hydro->implicit->Cycle();
+  }
+  if(hydro->hallStatus.isSubcycled) {
+    hydro->hallSubcycle->Cycle();
+  }
   idfx::popRegion();
 }
@@ -213,6 +213,23 @@ void DataBlock::MakeGeometry() {
     }
   );
 
+  // On uniform cartesian grids, keep the (constant) metric terms as scalars, so that the
+  // kernels specialised for these grids do not need to load them (see CalcRightHandSide)
+  haveUniformGrid = mygrid->isUniformCartesian;
+  if(haveUniformGrid) {
+    for(int dir = 0 ; dir < 3 ; dir++) {
+      IdefixHostArray1D<real> dxHost = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(),
+                                                                            this->dx[dir]);
+      uniformDx[dir] = dxHost(0);
+    }
+    // Same expressions as in the kernels above, so that the scalars are bitwise identical
+    // to the arrays
+    uniformdV = D_EXPAND(uniformDx[IDIR], *uniformDx[JDIR], *uniformDx[KDIR]);
+    uniformA[IDIR] = D_EXPAND(1.0, *uniformDx[JDIR], *uniformDx[KDIR]);
+    uniformA[JDIR] = D_EXPAND(uniformDx[IDIR], *ONE_F, *uniformDx[KDIR]);
+    uniformA[KDIR] = D_EXPAND(uniformDx[IDIR], *uniformDx[JDIR], *ONE_F);
+  }
+
   idfx::popRegion();
 }
 
@@ -0,0 +1,874 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#include <Kokkos_Sort.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "idefix.hpp"
+#include "dataBlock.hpp"
+#include "fluid.hpp"
+#include "gravity.hpp"
+#include "gridHost.hpp"
+#include "particles.hpp"
+
+namespace {
+// Last index c of [beg,end) such that xref(c) <= x (beg if x < xref(beg))
+KOKKOS_INLINE_FUNCTION int FindCell(const IdefixArray1D<real> &xref, const int beg,
+                                    const int end, const real x) {
+  int lo = beg;
+  int hi = end-1;
+  while(lo < hi) {
+    const int mid = (lo+hi+1)/2;
+    if(xref(mid) <= x) {
+      lo = mid;
+    } else {
+      hi = mid-1;
+    }
+  }
+  return(lo);
+}
+
+// Cloud-in-cell stencil: the particle overlaps the cells c and c+1 with weights w[0] and w[1].
+// Near the edges of the subdomain, the stencil extends to the first ghost cell, whose deposits
+// are then given back to their owner (see FoldGhostDeposits), so that the weights do not
+// depend on the domain decomposition.
+KOKKOS_INLINE_FUNCTION void CicStencil(const IdefixArray1D<real> &xc, const int beg,
+                                       const int end, const real x, int &c, real w[2]) {
+  c = FindCell(xc, beg-1, end+1, x);
+  if(c == end) {
+    // Round-off: the particle is at the very end of the subdomain
+    c = end-1;
+  }
+  w[1] = (x - xc(c)) / (xc(c+1) - xc(c));
+  w[0] = ONE_F - w[1];
+}
+}  // namespace
+
+Particles::Particles(Input &input, DataBlock *datain) {
+  idfx::pushRegion("Particles::Particles");
+  this->data = datain;
+
+  #if GEOMETRY != CARTESIAN
+    IDEFIX_ERROR("Particles are only implemented in cartesian geometry");
+  #endif
+
+  // One drag parameter per species, as for the dust fluids
+  this->nSpecies = input.CheckEntry("Particles","drag") - 1;
+  if(nSpecies < 1) {
+    IDEFIX_ERROR("Particles:drag should give the drag type and one drag parameter per species");
+  }
+  for(int n = 0 ; n < nSpecies ; n++) {
+    gammaDrag.emplace_back(input, "Particles", n, data);
+  }
+
+  // Initial dust-to-gas ratio (one value for all the species, or one value per species)
+  const int nEpsilon = input.CheckEntry("Particles","epsilon");
+  if(nEpsilon > 1 && nEpsilon != nSpecies) {
+    IDEFIX_ERROR("Particles:epsilon should have one value, or one value per species");
+  }
+  for(int n = 0 ; n < nSpecies ; n++) {
+    if(nEpsilon > 1) {
+      epsilon.push_back(input.Get<real>("Particles","epsilon",n));
+    } else {
+      epsilon.push_back(input.GetOrSet<real>("Particles","epsilon",0,0.01));
+    }
+  }
+
+  this->nPerCell = input.GetOrSet<int>("Particles","nPerCell",0,1);
+  this->feedback = input.GetOrSet<bool>("Particles","feedback",0,true);
+  this->sortPeriod = input.GetOrSet<int>("Particles","sortPeriod",0,10);
+
+  // Global domain, and left edge of the slab of each process along each direction
+  Grid *grid = data->mygrid;
+  GridHost gridHost(*grid);
+  gridHost.SyncFromDevice();
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    if(grid->lbound[dir] == shearingbox || grid->rbound[dir] == shearingbox) {
+      IDEFIX_ERROR("Particles are not compatible with shearing box boundaries");
+    }
+    isPeriodic[dir] = (grid->lbound[dir] == periodic);
+    slabEdge[dir].resize(grid->nproc[dir]+1);
+    for(int s = 0 ; s < grid->nproc[dir] ; s++) {
+      slabEdge[dir][s] = gridHost.xl[dir](grid->procStart[dir][s] + grid->nghost[dir]);
+    }
+    slabEdge[dir][grid->nproc[dir]] = grid->xend[dir];
+    gxbeg[dir] = slabEdge[dir][0];
+    gxend[dir] = slabEdge[dir][grid->nproc[dir]];
+    xbeg[dir] = slabEdge[dir][grid->xproc[dir]];
+    xend[dir] = slabEdge[dir][grid->xproc[dir]+1];
+  }
+
+  this->rate = IdefixArray4D<real>("Particles_rate", nSpecies,
+                                   data->np_tot[KDIR], data->np_tot[JDIR], data->np_tot[IDIR]);
+  this->gasVelocity = IdefixArray4D<real>("Particles_gasVelocity", COMPONENTS,
+                                          data->np_tot[KDIR],
+                                          data->np_tot[JDIR],
+                                          data->np_tot[IDIR]);
+  if(feedback) {
+    this->backReaction = IdefixArray4D<real>("Particles_backReaction", COMPONENTS+2,
+                                             data->np_tot[KDIR],
+                                             data->np_tot[JDIR],
+                                             data->np_tot[IDIR]);
+    // Ghost layers of each direction: the directions folded before are restricted to the
+    // active cells, the following ones include their first ghost cells
+    for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+      std::array<int,3> n;
+      for(int d = 0 ; d < 3 ; d++) {
+        n[d] = (d > dir && d < DIMENSIONS) ? data->np_int[d]+2 : data->np_int[d];
+      }
+      n[dir] = 1;
+      // Own low and high layers, then those received from the right and left neighbours
+      ghostLayer[dir] = IdefixArray4D<real>("Particles_ghostLayer", 4*(COMPONENTS+2),
+                                            n[KDIR], n[JDIR], n[IDIR]);
+    }
+  }
+  this->state = IdefixArray2D<real>("Particles_state", nfield, 0);
+  this->scratch = IdefixArray2D<real>("Particles_scratch", nfield, 0);
+  this->key = IdefixArray1D<int>("Particles_key", 0);
+  this->status = IdefixArray1D<int>("Particles_status", 0);
+
+  idfx::popRegion();
+}
+
+void Particles::ShowConfig() {
+  idfx::cout << "Particles: " << nSpecies << " species of Lagrangian dust particles, ";
+  switch(gammaDrag[0].type) {
+    case GammaDrag::Type::Gamma:
+      idfx::cout << "constant gamma";
+      break;
+    case GammaDrag::Type::Tau:
+      idfx::cout << "constant stopping time";
+      break;
+    case GammaDrag::Type::Size:
+      idfx::cout << "constant dust size";
+      break;
+    case GammaDrag::Type::Userdef:
+      idfx::cout << "user-defined";
+      break;
+  }
+  idfx::cout << " drag law";
+  if(feedback) {
+    idfx::cout << " with feedback." << std::endl;
+  } else {
+    idfx::cout << " without feedback." << std::endl;
+  }
+  if(nPerCell > 0) {
+    idfx::cout << "Particles: " << nPerCell << " particle(s) per cell and per species are "
+               << "created with the initial conditions." << std::endl;
+  }
+  if(sortPeriod > 0) {
+    idfx::cout << "Particles: sorted by cell every " << sortPeriod << " cycles." << std::endl;
+  }
+}
+
+void Particles::EnrollUserDrag(UserDefDragFunc func) {
+  for(auto &drag : gammaDrag) {
+    drag.EnrollUserDrag(func);
+  }
+}
+
+// Make room for at least n particles
+void Particles::Reserve(int n) {
+  const int capacity = state.extent(1);
+  if(n <= capacity) return;
+  // Grow geometrically, so that particles entering the domain one by one are cheap to store
+  n = std::max(n, capacity + capacity/4);
+  Kokkos::resize(state, nfield, n);
+  Kokkos::resize(scratch, nfield, n);
+  Kokkos::resize(key, n);
+  Kokkos::resize(status, n);
+}
+
+// Seed the particles following the gas density, with a quasi-random sequence in each cell,
+// unless the setup has already created its own particles
+void Particles::InitFromGas() {
+  if(nPerCell <= 0 || GetGlobalCount() > 0) return;
+  idfx::pushRegion("Particles::InitFromGas");
+
+  const int ni = data->np_int[IDIR];
+  const int nj = data->np_int[JDIR];
+  const int nk = data->np_int[KDIR];
+  const int ncells = ni*nj*nk;
+  const int nnew = nSpecies*nPerCell*ncells;
+  Reserve(count + nnew);
+
+  IdefixArray1D<real> eps("Particles_epsilon", nSpecies);
+  auto epsHost = Kokkos::create_mirror_view(eps);
+  for(int n = 0 ; n < nSpecies ; n++) {
+    epsHost(n) = epsilon[n];
+  }
+  Kokkos::deep_copy(eps, epsHost);
+
+  // Additive recurrence of the generalised golden ratio in DIMENSIONS dimensions
+  #if DIMENSIONS == 1
+    const real alpha[3] = {0.6180339887, 0.0, 0.0};
+  #elif DIMENSIONS == 2
+    const real alpha[3] = {0.7548776662, 0.5698402910, 0.0};
+  #else
+    const real alpha[3] = {0.8191725134, 0.6710436067, 0.5497004779};
+  #endif
+  const real alpha1 = alpha[IDIR];
+  const real alpha2 = alpha[JDIR];
+  const real alpha3 = alpha[KDIR];
+
+  IdefixArray2D<real> state = this->state;
+  IdefixArray4D<real> Vc = data->hydro->Vc;
+  IdefixArray3D<real> dV = data->dV;
+  IdefixArray1D<real> x1l = data->xl[IDIR];
+  IdefixArray1D<real> x2l = data->xl[JDIR];
+  IdefixArray1D<real> x3l = data->xl[KDIR];
+  IdefixArray1D<real> dx1 = data->dx[IDIR];
+  IdefixArray1D<real> dx2 = data->dx[JDIR];
+  IdefixArray1D<real> dx3 = data->dx[KDIR];
+  const int ibeg = data->beg[IDIR];
+  const int jbeg = data->beg[JDIR];
+  const int kbeg = data->beg[KDIR];
+  const int nPerCell = this->nPerCell;
+  const int first = this->count;
+
+  idefix_for("Particles::InitFromGas", 0, nnew,
+    KOKKOS_LAMBDA(int p) {
+      const int q = p % nPerCell;
+      const int c = (p / nPerCell) % ncells;
+      const int s = p / (nPerCell*ncells);
+      const int i = ibeg + c % ni;
+      const int j = jbeg + (c / ni) % nj;
+      const int k = kbeg + c / (ni*nj);
+
+      // The first particle of each cell sits at the cell center
+      real f1 = HALF_F + q*alpha1;
+      real f2 = HALF_F + q*alpha2;
+      real f3 = HALF_F + q*alpha3;
+      f1 -= std::floor(f1);
+      f2 -= std::floor(f2);
+      f3 -= std::floor(f3);
+
+      const int n = first + p;
+      state(PX1,n) = x1l(i) + f1*dx1(i);
+      state(PX2,n) = x2l(j) + f2*dx2(j);
+      state(PX3,n) = x3l(k) + f3*dx3(k);
+      state(PV1,n) = Vc(VX1,k,j,i);
+      state(PV2,n) = ZERO_F;
+      state(PV3,n) = ZERO_F;
+      #if COMPONENTS >= 2
+        state(PV2,n) = Vc(VX2,k,j,i);
+      #endif
+      #if COMPONENTS == 3
+        state(PV3,n) = Vc(VX3,k,j,i);
+      #endif
+      state(PMASS,n) = eps(s)*Vc(RHO,k,j,i)*dV(k,j,i)/nPerCell;
+      state(PSPECIES,n) = s;
+    });
+  count += nnew;
+  Sort();
+
+  idfx::popRegion();
+}
+
+// Add particles, given on the host as (field, particle). This is collective: the particles
+// are sent to the process that owns them.
+void Particles::Add(const IdefixHostArray2D<real> &in) {
+  idfx::pushRegion("Particles::Add");
+  Append(in);
+  Migrate();
+  idfx::popRegion();
+}
+
+void Particles::Append(const IdefixHostArray2D<real> &in) {
+  const int n = in.extent(1);
+  if(n == 0) return;
+  Reserve(count + n);
+  IdefixArray2D<real> buffer("Particles_append", nfield, n);
+  Kokkos::deep_copy(buffer, in);
+  IdefixArray2D<real> state = this->state;
+  const int first = this->count;
+  idefix_for("Particles::Append", 0, nfield, 0, n,
+    KOKKOS_LAMBDA(int f, int p) {
+      state(f, first + p) = buffer(f, p);
+    });
+  count += n;
+}
+
+// Stopping rate gamma*rho of each species, evaluated with the drag law of the dust fluids
+void Particles::ComputeStoppingRates() {
+  IdefixArray4D<real> Vc = data->hydro->Vc;
+  IdefixArray4D<real> rate = this->rate;
+  for(int n = 0 ; n < nSpecies ; n++) {
+    auto gammaDrag = this->gammaDrag[n];
+    gammaDrag.RefreshUserDrag(data);
+    idefix_for("Particles::StoppingRate",
+               data->beg[KDIR], data->end[KDIR],
+               data->beg[JDIR], data->end[JDIR],
+               data->beg[IDIR], data->end[IDIR],
+      KOKKOS_LAMBDA(int k, int j, int i) {
+        rate(n,k,j,i) = gammaDrag.GetGamma(k,j,i)*Vc(RHO,k,j,i);
+      });
+  }
+}
+
+// Keep the gas velocity once the time integrator has set the boundaries of its last stage, so
+// that the CIC stencils can reach the first ghost cells without setting the boundaries again.
+void Particles::StoreGasVelocity() {
+  idfx::pushRegion("Particles::StoreGasVelocity");
+  Kokkos::deep_copy(gasVelocity, Kokkos::subview(data->hydro->Vc,
+                                                 std::make_pair(VX1, VX1+COMPONENTS),
+                                                 Kokkos::ALL(), Kokkos::ALL(), Kokkos::ALL()));
+  idfx::popRegion();
+}
+
+void Particles::Evolve(const real dt) {
+  idfx::pushRegion("Particles::Evolve");
+
+  // Particles sorted by cell gather and deposit in neighbouring memory locations
+  if(sortPeriod > 0 && data->cycle - lastSort >= sortPeriod) Sort();
+
+  ComputeStoppingRates();
+
+  IdefixArray2D<real> state = this->state;
+  IdefixArray4D<real> rate = this->rate;
+  IdefixArray4D<real> backReaction = this->backReaction;
+  IdefixArray4D<real> gasVelocity = this->gasVelocity;
+  IdefixArray1D<real> x1 = data->x[IDIR];
+  IdefixArray1D<real> x2 = data->x[JDIR];
+  IdefixArray1D<real> x3 = data->x[KDIR];
+  IdefixArray1D<real> x1l = data->xl[IDIR];
+  IdefixArray1D<real> x2l = data->xl[JDIR];
+  IdefixArray1D<real> x3l = data->xl[KDIR];
+  const int ibeg = data->beg[IDIR];
+  const int iend = data->end[IDIR];
+  const int jbeg = data->beg[JDIR];
+  const int jend = data->end[JDIR];
+  const int kbeg = data->beg[KDIR];
+  const int kend = data->end[KDIR];
+  const bool feedback = this->feedback;
+
+  bool havePotential = false;
+  bool haveBodyForce = false;
+  IdefixArray3D<real> phi;
+  IdefixArray4D<real> bodyForce;
+  if(data->haveGravity) {
+    havePotential = data->gravity->havePotential;
+    haveBodyForce = data->gravity->haveBodyForce;
+    phi = data->gravity->phiP;
+    bodyForce = data->gravity->bodyForceVector;
+  }
+
+  if(feedback) Kokkos::deep_copy(backReaction, ZERO_F);
+
+  idefix_for("Particles::Evolve", 0, count,
+    KOKKOS_LAMBDA(int p) {
+      const int s = static_cast<int>(state(PSPECIES,p));
+      const real m = state(PMASS,p);
+
+      // Cloud-in-cell stencil
+      int ic, jc, kc;
+      real wi[2];
+      real wj[2] = {ONE_F, ZERO_F};
+      real wk[2] = {ONE_F, ZERO_F};
+      CicStencil(x1, ibeg, iend, state(PX1,p), ic, wi);
+      jc = jbeg;
+      kc = kbeg;
+      #if DIMENSIONS >= 2
+        CicStencil(x2, jbeg, jend, state(PX2,p), jc, wj);
+      #endif
+      #if DIMENSIONS == 3
+        CicStencil(x3, kbeg, kend, state(PX3,p), kc, wk);
+      #endif
+
+      // Gas velocity at the particle position
+      real ug[3] = {ZERO_F, ZERO_F, ZERO_F};
+      for(int dk = 0 ; dk < 2 ; dk++) {
+        for(int dj = 0 ; dj < 2 ; dj++) {
+          for(int di = 0 ; di < 2 ; di++) {
+            const real w = wk[dk]*wj[dj]*wi[di];
+            if(w == ZERO_F) continue;
+            for(int n = 0 ; n < COMPONENTS ; n++) {
+              ug[n] += w*gasVelocity(n,kc+dk,jc+dj,ic+di);
+            }
+          }
+        }
+      }
+
+      // Stopping rate and gravity in the cell containing the particle
+      const int i = FindCell(x1l, ibeg, iend, state(PX1,p));
+      int j = jbeg;
+      int k = kbeg;
+      #if DIMENSIONS >= 2
+        j = FindCell(x2l, jbeg, jend, state(PX2,p));
+      #endif
+      #if DIMENSIONS == 3
+        k = FindCell(x3l, kbeg, kend, state(PX3,p));
+      #endif
+      const real r = rate(s,k,j,i);
+
+      real acc[3] = {ZERO_F, ZERO_F, ZERO_F};
+      if(havePotential) {
+        acc[IDIR] = -(phi(k,j,i+1) - phi(k,j,i-1)) / (x1(i+1) - x1(i-1));
+        #if DIMENSIONS >= 2
+          acc[JDIR] = -(phi(k,j+1,i) - phi(k,j-1,i)) / (x2(j+1) - x2(j-1));
+        #endif
+        #if DIMENSIONS == 3
+          acc[KDIR] = -(phi(k+1,j,i) - phi(k-1,j,i)) / (x3(k+1) - x3(k-1));
+        #endif
+      }
+      if(haveBodyForce) {
+        for(int n = 0 ; n < COMPONENTS ; n++) {
+          acc[n] += bodyForce(n,k,j,i);
+        }
+      }
+
+      // Exact solution of dv/dt = r(ug-v) + acc for a constant gas velocity and acceleration:
+      // v(dt) = v + (ug-v)*r*g + acc*g and x(dt) = x + ug*dt + (v-ug)*g + acc*h,
+      // with g = (1-exp(-r dt))/r and h = (dt-g)/r (expanded when r*dt is small)
+      const real rdt = r*dt;
+      real g, h;
+      if(rdt < 1e-3) {
+        g = dt*(ONE_F - rdt/2 + rdt*rdt/6);
+        h = dt*dt*(HALF_F - rdt/6 + rdt*rdt/24);
+      } else {
+        g = -std::expm1(-rdt)/r;
+        h = (dt - g)/r;
+      }
+
+      real dMom[3] = {ZERO_F, ZERO_F, ZERO_F};
+      real dEng = ZERO_F;
+      for(int n = 0 ; n < COMPONENTS ; n++) {
+        const real v = state(PV1+n,p);
+        const real vnew = v + (ug[n] - v)*r*g + acc[n]*g;
+        const real dx = ug[n]*dt + (v - ug[n])*g + acc[n]*h;
+        state(PV1+n,p) = vnew;
+        if(n < DIMENSIONS) state(PX1+n,p) += dx;
+        // The gas gets the opposite of the drag impulse, and the work of the drag
+        dMom[n] = m*(v - vnew + acc[n]*dt);
+        dEng += HALF_F*m*(v*v - vnew*vnew) + m*acc[n]*dx;
+      }
+
+      if(feedback) {
+        for(int dk = 0 ; dk < 2 ; dk++) {
+          for(int dj = 0 ; dj < 2 ; dj++) {
+            for(int di = 0 ; di < 2 ; di++) {
+              const real w = wk[dk]*wj[dj]*wi[di];
+              if(w == ZERO_F) continue;
+              for(int n = 0 ; n < COMPONENTS ; n++) {
+                Kokkos::atomic_add(&backReaction(n,kc+dk,jc+dj,ic+di), w*dMom[n]);
+              }
+              Kokkos::atomic_add(&backReaction(COMPONENTS,kc+dk,jc+dj,ic+di), w*dEng);
+              Kokkos::atomic_add(&backReaction(COMPONENTS+1,kc+dk,jc+dj,ic+di), w*m*r);
+            }
+          }
+        }
+      }
+    });
+
+  if(feedback) {
+    FoldGhostDeposits();
+    ApplyFeedback();
+  }
+
+  Migrate();
+
+  idfx::popRegion();
+}
+
+// Add the deposits of the first ghost cells to the active cells they belong to: those of the
+// neighbouring process, the other side of a periodic domain, or the edge cells of the domain
+// at the other boundaries. The directions are folded in turn, so that the deposits of the
+// corner ghost cells reach the right process.
+void Particles::FoldGhostDeposits() {
+  idfx::pushRegion("Particles::FoldGhostDeposits");
+  IdefixArray4D<real> backReaction = this->backReaction;
+  const int nvar = COMPONENTS+2;
+  for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+    IdefixArray4D<real> layer = ghostLayer[dir];
+    std::array<int,3> offset;
+    for(int d = 0 ; d < 3 ; d++) {
+      offset[d] = (d > dir && d < DIMENSIONS) ? data->beg[d]-1 : data->beg[d];
+    }
+    const int ioffset = offset[IDIR];
+    const int joffset = offset[JDIR];
+    const int koffset = offset[KDIR];
+    const int low = data->beg[dir]-1;
+    const int high = data->end[dir];
+    const int d = dir;
+
+    idefix_for("Particles::PackGhostDeposits",
+               0, nvar, 0, layer.extent(1), 0, layer.extent(2), 0, layer.extent(3),
+      KOKKOS_LAMBDA(int n, int k, int j, int i) {
+        const int kk = k + koffset;
+        const int jj = j + joffset;
+        const int ii = i + ioffset;
+        layer(n,k,j,i) = backReaction(n, d == KDIR ? low : kk, d == JDIR ? low : jj,
+                                         d == IDIR ? low : ii);
+        layer(nvar+n,k,j,i) = backReaction(n, d == KDIR ? high : kk, d == JDIR ? high : jj,
+                                              d == IDIR ? high : ii);
+      });
+
+    // Layer added to the first (fromLeft) and last (fromRight) active cells: received from the
+    // neighbour, or our own layer of the same side when there is no neighbour
+    int fromLeft = 0;
+    int fromRight = 1;
+    #ifdef WITH_MPI
+      const int size = layer.extent(1)*layer.extent(2)*layer.extent(3)*nvar;
+      int procLeft, procRight;
+      MPI_SAFE_CALL(MPI_Cart_shift(data->mygrid->CartComm, dir, 1, &procLeft, &procRight));
+      Kokkos::fence();
+      MPI_SAFE_CALL(MPI_Sendrecv(layer.data(), size, realMPI, procLeft, 400+dir,
+                                 layer.data()+2*size, size, realMPI, procRight, 400+dir,
+                                 data->mygrid->CartComm, MPI_STATUS_IGNORE));
+      MPI_SAFE_CALL(MPI_Sendrecv(layer.data()+size, size, realMPI, procRight, 410+dir,
+                                 layer.data()+3*size, size, realMPI, procLeft, 410+dir,
+                                 data->mygrid->CartComm, MPI_STATUS_IGNORE));
+      if(procLeft != MPI_PROC_NULL) fromLeft = 3;
+      if(procRight != MPI_PROC_NULL) fromRight = 2;
+    #else
+      if(isPeriodic[dir]) {
+        fromLeft = 1;
+        fromRight = 0;
+      }
+    #endif
+
+    const int first = data->beg[dir];
+    const int last = data->end[dir]-1;
+    idefix_for("Particles::UnpackGhostDeposits",
+               0, nvar, 0, layer.extent(1), 0, layer.extent(2), 0, layer.extent(3),
+      KOKKOS_LAMBDA(int n, int k, int j, int i) {
+        const int kk = k + koffset;
+        const int jj = j + joffset;
+        const int ii = i + ioffset;
+        backReaction(n, d == KDIR ? first : kk, d == JDIR ? first : jj,
+                        d == IDIR ? first : ii) += layer(fromLeft*nvar+n,k,j,i);
+        backReaction(n, d == KDIR ? last : kk, d == JDIR ? last : jj,
+                        d == IDIR ? last : ii) += layer(fromRight*nvar+n,k,j,i);
+      });
+  }
+  idfx::popRegion();
+}
+
+// Give back to the gas the momentum and energy deposited by the particles
+void Particles::ApplyFeedback() {
+  IdefixArray4D<real> backReaction = this->backReaction;
+  IdefixArray4D<real> Vc = data->hydro->Vc;
+  IdefixArray3D<real> dV = data->dV;
+  #if HAVE_ENERGY
+    EquationOfState eos = *(data->hydro->eos.get());
+  #endif
+
+  real invDt = 0;
+  idefix_reduce("Particles::ApplyFeedback",
+                data->beg[KDIR], data->end[KDIR],
+                data->beg[JDIR], data->end[JDIR],
+                data->beg[IDIR], data->end[IDIR],
+    KOKKOS_LAMBDA(int k, int j, int i, real &localMax) {
+      const real mg = Vc(RHO,k,j,i)*dV(k,j,i);
+      real dKinetic = ZERO_F;
+      for(int n = 0 ; n < COMPONENTS ; n++) {
+        const real v = Vc(VX1+n,k,j,i);
+        const real vnew = v + backReaction(n,k,j,i)/mg;
+        dKinetic += HALF_F*mg*(vnew*vnew - v*v);
+        Vc(VX1+n,k,j,i) = vnew;
+      }
+      #if HAVE_ENERGY
+        // What the drag does not give to the gas kinetic energy is friction heating
+        const real gamma = eos.GetGamma(Vc(PRS,k,j,i),Vc(RHO,k,j,i));
+        Vc(PRS,k,j,i) += (gamma-ONE_F)*(backReaction(COMPONENTS,k,j,i) - dKinetic)/dV(k,j,i);
+      #endif
+      // The explicit feedback is stable when dt < rho/(sum gamma rho rho_p)
+      localMax = std::fmax(localMax, backReaction(COMPONENTS+1,k,j,i)/mg);
+    },
+    Kokkos::Max<real>(invDt));
+  this->invDtFeedback = invDt;
+}
+
+real Particles::GetTimestep() const {
+  if(invDtFeedback > 0) return(ONE_F/invDtFeedback);
+  return(std::numeric_limits<real>::max());
+}
+
+// Apply the boundary conditions and send the particles that left the process to their owner
+void Particles::Migrate() {
+  IdefixArray2D<real> state = this->state;
+  IdefixArray1D<int> status = this->status;
+  Kokkos::Array<real,3> gxbeg, gxend, xbeg, xend;
+  Kokkos::Array<bool,3> isPeriodic;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    gxbeg[dir] = this->gxbeg[dir];
+    gxend[dir] = this->gxend[dir];
+    xbeg[dir] = this->xbeg[dir];
+    xend[dir] = this->xend[dir];
+    isPeriodic[dir] = this->isPeriodic[dir];
+  }
+
+  // status is 0 for the particles staying here, 1 for those leaving, -1 for those lost
+  int nOut = 0;
+  idefix_reduce("Particles::Boundaries", 0, count,
+    KOKKOS_LAMBDA(int p, int &localOut) {
+      int st = 0;
+      for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+        real x = state(PX1+dir,p);
+        if(isPeriodic[dir]) {
+          const real length = gxend[dir] - gxbeg[dir];
+          if(x >= gxend[dir]) x -= length;
+          if(x < gxbeg[dir]) x += length;
+          // Round-off errors
+          if(x >= gxend[dir]) x = gxbeg[dir];
+          state(PX1+dir,p) = x;
+        } else if(x < gxbeg[dir] || x >= gxend[dir]) {
+          st = -1;
+          break;
+        }
+        if(x < xbeg[dir] || x >= xend[dir]) st = 1;
+      }
+      status(p) = st;
+      if(st != 0) localOut++;
+    },
+    Kokkos::Sum<int>(nOut));
+
+  IdefixArray2D<real> sendBuffer;
+  if(nOut > 0) {
+    // Pack the particles leaving (and their status), and compact the remaining ones
+    IdefixArray2D<real> scratch = this->scratch;
+    sendBuffer = IdefixArray2D<real>("Particles_send", nfield+1, nOut);
+    int nStay = 0;
+    Kokkos::parallel_scan("Particles::Compact", count,
+      KOKKOS_LAMBDA(int p, int &index, const bool final) {
+        const bool stay = (status(p) == 0);
+        if(final) {
+          if(stay) {
+            for(int f = 0 ; f < nfield ; f++) scratch(f,index) = state(f,p);
+          } else {
+            const int out = p - index;
+            for(int f = 0 ; f < nfield ; f++) sendBuffer(f,out) = state(f,p);
+            sendBuffer(nfield,out) = status(p);
+          }
+        }
+        if(stay) index++;
+      }, nStay);
+    std::swap(this->state, this->scratch);
+    count = nStay;
+  }
+
+  #ifdef WITH_MPI
+    Grid *grid = data->mygrid;
+    std::vector<int> sendCount(idfx::psize, 0);
+    std::vector<int> destination;
+    IdefixHostArray2D<real> sendHost;
+    if(nOut > 0) {
+      sendHost = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), sendBuffer);
+      destination.resize(nOut, -1);
+      for(int p = 0 ; p < nOut ; p++) {
+        if(sendHost(nfield,p) < 0) continue;
+        int coords[3] = {0, 0, 0};
+        for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+          const auto &edge = slabEdge[dir];
+          const int s = std::upper_bound(edge.begin(), edge.end(), sendHost(PX1+dir,p))
+                        - edge.begin() - 1;
+          coords[dir] = std::clamp(s, 0, grid->nproc[dir]-1);
+        }
+        MPI_SAFE_CALL(MPI_Cart_rank(grid->CartComm, coords, &destination[p]));
+        sendCount[destination[p]] += nfield;
+      }
+    }
+
+    // Particles are sent as contiguous records of nfield values
+    std::vector<int> recvCount(idfx::psize);
+    MPI_SAFE_CALL(MPI_Alltoall(sendCount.data(), 1, MPI_INT, recvCount.data(), 1, MPI_INT,
+                               grid->CartComm));
+    std::vector<int> sendOffset(idfx::psize, 0);
+    std::vector<int> recvOffset(idfx::psize, 0);
+    for(int r = 1 ; r < idfx::psize ; r++) {
+      sendOffset[r] = sendOffset[r-1] + sendCount[r-1];
+      recvOffset[r] = recvOffset[r-1] + recvCount[r-1];
+    }
+    std::vector<real> sendData(sendOffset[idfx::psize-1] + sendCount[idfx::psize-1]);
+    std::vector<real> recvData(recvOffset[idfx::psize-1] + recvCount[idfx::psize-1]);
+    std::vector<int> position(sendOffset);
+    for(int p = 0 ; p < static_cast<int>(destination.size()) ; p++) {
+      if(destination[p] < 0) continue;
+      for(int f = 0 ; f < nfield ; f++) {
+        sendData[position[destination[p]]++] = sendHost(f,p);
+      }
+    }
+    MPI_SAFE_CALL(MPI_Alltoallv(sendData.data(), sendCount.data(), sendOffset.data(), realMPI,
+                                recvData.data(), recvCount.data(), recvOffset.data(), realMPI,
+                                grid->CartComm));
+
+    const int nRecv = recvData.size()/nfield;
+    IdefixHostArray2D<real> received("Particles_received", nfield, nRecv);
+    for(int p = 0 ; p < nRecv ; p++) {
+      for(int f = 0 ; f < nfield ; f++) {
+        received(f,p) = recvData[p*nfield+f];
+      }
+    }
+    Append(received);
+  #endif
+}
+
+// Sort the particles by cell
+void Particles::Sort() {
+  idfx::pushRegion("Particles::Sort");
+  lastSort = data->cycle;
+  if(count < 2) {
+    idfx::popRegion();
+    return;
+  }
+  IdefixArray2D<real> state = this->state;
+  IdefixArray1D<int> key = this->key;
+  IdefixArray1D<real> x1l = data->xl[IDIR];
+  IdefixArray1D<real> x2l = data->xl[JDIR];
+  IdefixArray1D<real> x3l = data->xl[KDIR];
+  const int ibeg = data->beg[IDIR];
+  const int iend = data->end[IDIR];
+  const int jbeg = data->beg[JDIR];
+  const int jend = data->end[JDIR];
+  const int kbeg = data->beg[KDIR];
+  const int kend = data->end[KDIR];
+  const int ni = data->np_int[IDIR];
+  const int nj = data->np_int[JDIR];
+  const int ncells = ni*nj*data->np_int[KDIR];
+
+  idefix_for("Particles::Key", 0, count,
+    KOKKOS_LAMBDA(int p) {
+      const int i = FindCell(x1l, ibeg, iend, state(PX1,p));
+      int j = jbeg;
+      int k = kbeg;
+      #if DIMENSIONS >= 2
+        j = FindCell(x2l, jbeg, jend, state(PX2,p));
+      #endif
+      #if DIMENSIONS == 3
+        k = FindCell(x3l, kbeg, kend, state(PX3,p));
+      #endif
+      key(p) = ((k-kbeg)*nj + (j-jbeg))*ni + (i-ibeg);
+    });
+
+  auto range = Kokkos::make_pair(0, count);
+  auto keys = Kokkos::subview(key, range);
+  using BinOp = Kokkos::BinOp1D<decltype(keys)>;
+  Kokkos::BinSort<decltype(keys), BinOp> sorter(keys, BinOp(ncells, 0, ncells), false);
+  sorter.create_permute_vector();
+  for(int f = 0 ; f < nfield ; f++) {
+    sorter.sort(Kokkos::subview(state, f, range));
+  }
+  idfx::popRegion();
+}
+
+int64_t Particles::GetGlobalCount() const {
+  int64_t total = count;
+  #ifdef WITH_MPI
+    MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD));
+  #endif
+  return(total);
+}
+
+// Restart file: number of particles, number of fields and size of real, followed by each field
+// of all of the particles
+void Particles::Write(const std::string &filename) {
+  idfx::pushRegion("Particles::Write");
+
+  // Contiguous copy of the particles on the host
+  IdefixArray2D<real> buffer("Particles_write", nfield, count);
+  Kokkos::deep_copy(buffer, Kokkos::subview(state, Kokkos::ALL(), Kokkos::make_pair(0, count)));
+  auto host = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), buffer);
+
+  int64_t header[3] = {count, nfield, sizeof(real)};
+  #ifdef WITH_MPI
+    int64_t first = 0;
+    int64_t local = count;
+    MPI_SAFE_CALL(MPI_Exscan(&local, &first, 1, MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD));
+    if(idfx::prank == 0) first = 0;
+    header[0] = GetGlobalCount();
+
+    if(idfx::prank == 0) std::remove(filename.c_str());
+    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_File fileHdl;
+    MPI_Status status;
+    MPI_SAFE_CALL(MPI_File_open(MPI_COMM_WORLD, filename.c_str(),
+                                MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                                MPI_INFO_NULL, &fileHdl));
+    if(idfx::prank == 0) {
+      MPI_SAFE_CALL(MPI_File_write_at(fileHdl, 0, header, 3, MPI_INT64_T, &status));
+    }
+    for(int f = 0 ; f < nfield ; f++) {
+      MPI_Offset offset = sizeof(header) + (f*header[0] + first)*sizeof(real);
+      MPI_SAFE_CALL(MPI_File_write_at_all(fileHdl, offset, host.data() + f*count, count,
+                                          realMPI, &status));
+    }
+    MPI_SAFE_CALL(MPI_File_close(&fileHdl));
+  #else
+    FILE *fileHdl = fopen(filename.c_str(), "wb");
+    if(fileHdl == NULL) {
+      IDEFIX_ERROR("Unable to open file "+filename);
+    }
+    if(fwrite(header, sizeof(int64_t), 3, fileHdl) != 3
+        || fwrite(host.data(), sizeof(real), host.size(), fileHdl) != host.size()) {
+      IDEFIX_ERROR("Unable to write to file. Check your filesystem permissions and disk quota.");
+    }
+    fclose(fileHdl);
+  #endif
+
+  idfx::popRegion();
+}
+
+// Each process reads a contiguous part of the particles, which are then sent to their owner
+// (the domain decomposition may differ from the one of the run which wrote the file).
+bool Particles::Read(const std::string &filename) {
+  idfx::pushRegion("Particles::Read");
+  int64_t header[3];
+  IdefixHostArray2D<real> host;
+
+  #ifdef WITH_MPI
+    MPI_File fileHdl;
+    MPI_Status status;
+    MPI_SAFE_CALL(MPI_File_open(MPI_COMM_WORLD, filename.c_str(), MPI_MODE_RDONLY,
+                                MPI_INFO_NULL, &fileHdl));
+    MPI_SAFE_CALL(MPI_File_read_at_all(fileHdl, 0, header, 3, MPI_INT64_T, &status));
+    if(header[1] != nfield || header[2] != sizeof(real)) {
+      MPI_SAFE_CALL(MPI_File_close(&fileHdl));
+      IDEFIX_WARNING(filename+" does not match the particle fields or precision of this run.");
+      idfx::popRegion();
+      return(false);
+    }
+    const int64_t first = header[0]*idfx::prank/idfx::psize;
+    const int n = header[0]*(idfx::prank+1)/idfx::psize - first;
+    host = IdefixHostArray2D<real>("Particles_read", nfield, n);
+    for(int f = 0 ; f < nfield ; f++) {
+      MPI_Offset offset = sizeof(header) + (f*header[0] + first)*sizeof(real);
+      MPI_SAFE_CALL(MPI_File_read_at_all(fileHdl, offset, host.data() + f*n, n,
+                                         realMPI, &status));
+    }
+    MPI_SAFE_CALL(MPI_File_close(&fileHdl));
+  #else
+    FILE *fileHdl = fopen(filename.c_str(), "rb");
+    if(fileHdl == NULL) {
+      IDEFIX_ERROR("Unable to open file "+filename);
+    }
+    if(fread(header, sizeof(int64_t), 3, fileHdl) != 3
+        || header[1] != nfield || header[2] != sizeof(real)) {
+      fclose(fileHdl);
+      IDEFIX_WARNING(filename+" does not match the particle fields or precision of this run.");
+      idfx::popRegion();
+      return(false);
+    }
+    host = IdefixHostArray2D<real>("Particles_read", nfield, header[0]);
+    if(fread(host.data(), sizeof(real), host.size(), fileHdl) != host.size()) {
+      IDEFIX_ERROR("Unable to read "+filename);
+    }
+    fclose(fileHdl);
+  #endif
+
+  count = 0;
+  Add(host);
+  Sort();
+  idfx::cout << "Particles: " << header[0] << " particles read from " << filename << "."
+             << std::endl;
+  idfx::popRegion();
+  return(true);
+}
@@ -0,0 +1,86 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#ifndef DATABLOCK_PARTICLES_PARTICLES_HPP_
+#define DATABLOCK_PARTICLES_PARTICLES_HPP_
+
+#include <array>
+#include <string>
+#include <vector>
+#include "idefix.hpp"
+#include "input.hpp"
+#include "drag.hpp"
+
+// forward class declaration
+class DataBlock;
+
+// Lagrangian dust superparticles, coupled to the gas by the drag laws of the dust fluids.
+// Each superparticle carries the mass of many grains of one species. Particles are stored as a
+// structure of arrays: state(field, particle), each field being contiguous in memory.
+class Particles {
+ public:
+  // Fields stored for each particle
+  enum Field {PX1, PX2, PX3, PV1, PV2, PV3, PMASS, PSPECIES, nfield};
+
+  Particles(Input &, DataBlock *);
+  void ShowConfig();
+
+  void InitFromGas();                       ///< Seed particles following the gas density
+  void Add(const IdefixHostArray2D<real> &); ///< Add particles (on all processes, fields x n)
+  void StoreGasVelocity();                  ///< Gas velocity (with its boundaries) used by Evolve
+  void Evolve(const real);                  ///< Drag, gravity, drift, feedback and migration
+  void Sort();                              ///< Sort the particles by cell
+  real GetTimestep() const;                 ///< Largest timestep allowed by the feedback
+
+  void EnrollUserDrag(UserDefDragFunc);     ///< User defined drag function (all species)
+
+  void Write(const std::string &);          ///< Write the particles to a restart file
+  bool Read(const std::string &);           ///< Read the particles from a restart file
+
+  int64_t GetGlobalCount() const;           ///< Number of particles on all processes
+
+  IdefixArray2D<real> state;                ///< Particles (field, particle)
+  int count{0};                             ///< Number of particles on this process
+  int nSpecies;
+
+ private:
+  void Reserve(int);                        ///< Make room for at least n particles
+  void Append(const IdefixHostArray2D<real> &); ///< Add particles to this process
+  void ComputeStoppingRates();
+  void FoldGhostDeposits();                 ///< Give the ghost cell deposits to their owner
+  void ApplyFeedback();
+  void Migrate();                           ///< Apply the boundaries and exchange particles
+
+  DataBlock *data;
+
+  std::vector<GammaDrag> gammaDrag;         ///< Drag law of each species
+  std::vector<real> epsilon;                ///< Initial dust-to-gas ratio of each species
+  int nPerCell;                             ///< Particles per cell and per species at t=0
+  bool feedback;
+  int sortPeriod;
+  int64_t lastSort{-1};                     ///< Cycle of the last sort
+
+  IdefixArray4D<real> rate;                 ///< Stopping rate (species, cell)
+  IdefixArray4D<real> gasVelocity;          ///< Gas velocity at the start of the last stage
+  IdefixArray4D<real> backReaction;         ///< Momentum, energy and drag rate deposited by
+                                            ///< the particles in each cell
+  std::array<IdefixArray4D<real>,3> ghostLayer; ///< Ghost deposits exchanged in each direction
+  IdefixArray2D<real> scratch;              ///< Compacted particles, swapped with state
+  IdefixArray1D<int> key;                   ///< Cell of each particle
+  IdefixArray1D<int> status;                ///< Where each particle goes after the drift
+  real invDtFeedback{0};                    ///< Largest drag rate of the gas by the particles
+
+  // Global domain and decomposition
+  std::array<real,3> gxbeg;
+  std::array<real,3> gxend;
+  std::array<real,3> xbeg;                  ///< Local domain
+  std::array<real,3> xend;
+  std::array<bool,3> isPeriodic;
+  std::array<std::vector<real>,3> slabEdge; ///< Left edge of each process slab (+ global end)
+};
+
+#endif // DATABLOCK_PARTICLES_PARTICLES_HPP_
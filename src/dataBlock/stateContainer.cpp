@@ -10,10 +10,12 @@
 #include <string>
 #include <algorithm>
 #include "idefix.hpp"
+#include "profiler.hpp"
 
 
 StateContainer::StateContainer() {
-  // do nothing
+  // Estimated cost per array element, for kernel profiling: 2 reads, 1 write, 3 flops
+  idfx::prof.SetKernelTraffic("StateContainer::AddAndStore", 3*sizeof(real), 3);
 }
 
 void StateContainer::CopyFrom(StateContainer &in) {
@@ -33,7 +33,7 @@ void RiemannSolver<Phys>::HllHD(IdefixArray4D<real> &Flux) {
   IdefixArray1D<real> dx = this->data->dx[DIR];
 
   ExtrapolateToFaces<Phys,DIR> extrapol = *this->GetExtrapolator<DIR>();
-  idefix_for("HLL_Kernel",
+  idefix_for(fluxKernelName,
              data->beg[KDIR],data->end[KDIR]+koffset,
              data->beg[JDIR],data->end[JDIR]+joffset,
              data->beg[IDIR],data->end[IDIR]+ioffset,
@@ -53,7 +53,7 @@ void RiemannSolver<Phys>::RoeHD(IdefixArray4D<real> &Flux) {
 
   ExtrapolateToFaces<Phys,DIR> extrapol = *this->GetExtrapolator<DIR>();
 
-  idefix_for("ROE_Kernel",
+  idefix_for(fluxKernelName,
              data->beg[KDIR],data->end[KDIR]+koffset,
              data->beg[JDIR],data->end[JDIR]+joffset,
              data->beg[IDIR],data->end[IDIR]+ioffset,
@@ -31,7 +31,7 @@ void RiemannSolver<Phys>::HllMHD(IdefixArray4D<real> &Flux) {
   if (hydro->emf->averaging == EMF::uct_hll
       || hydro->emf->averaging == EMF::uct_hlld) {
         // Need two cells in the perp direction for these schemes
-        perpExtension= data->nghost[DIR];
+        perpExtension= data->nghostStage[DIR];
   }
   // extension in perp to the direction of integration, as required by CT.
   const int iextend = (DIR==IDIR) ? 0 : perpExtension;
@@ -50,7 +50,8 @@ void RiemannSolver<Phys>::HllMHD(IdefixArray4D<real> &Flux) {
   IdefixArray4D<real> Vs = this->Vs;
   IdefixArray3D<real> cMax = this->cMax;
 
-  HydroModuleStatus haveHall = hydro->hallStatus.status;
+  // Subcycled Hall effect is integrated outside of the Riemann solver
+  HydroModuleStatus haveHall = hydro->hallStatus.isExplicit ? hydro->hallStatus.status : Disabled;
   IdefixArray4D<real> J = hydro->J;
   IdefixArray3D<real> xHallArr = hydro->xHall;
   IdefixArray1D<real> dx = data->dx[DIR];
@@ -151,7 +152,7 @@ void RiemannSolver<Phys>::HllMHD(IdefixArray4D<real> &Flux) {
   }
 
 
-  idefix_for("CalcRiemannFlux",
+  idefix_for(fluxKernelName,
              data->beg[KDIR]-kextend,data->end[KDIR]+koffset+kextend,
              data->beg[JDIR]-jextend,data->end[JDIR]+joffset+jextend,
              data->beg[IDIR]-iextend,data->end[IDIR]+ioffset+iextend,
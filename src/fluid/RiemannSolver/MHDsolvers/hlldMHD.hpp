@@ -33,7 +33,7 @@ void RiemannSolver<Phys>::HlldMHD(IdefixArray4D<real> &Flux) {
   if (hydro->emf->averaging == EMF::uct_hll
       || hydro->emf->averaging == EMF::uct_hlld) {
         // Need two cells in the perp direction for these schemes
-        perpExtension= data->nghost[DIR];
+        perpExtension= data->nghostStage[DIR];
   }
   // extension in perp to the direction of integration, as required by CT.
   const int iextend = (DIR==IDIR) ? 0 : perpExtension;
@@ -144,7 +144,7 @@ void RiemannSolver<Phys>::HlldMHD(IdefixArray4D<real> &Flux) {
       IDEFIX_ERROR("Wrong direction");
   }
 
-  idefix_for("CalcRiemannFlux",
+  idefix_for(fluxKernelName,
              data->beg[KDIR]-kextend,data->end[KDIR]+koffset+kextend,
              data->beg[JDIR]-jextend,data->end[JDIR]+joffset+jextend,
              data->beg[IDIR]-iextend,data->end[IDIR]+ioffset+iextend,
@@ -172,7 +172,7 @@ void RiemannSolver<Phys>::RoeMHD(IdefixArray4D<real> &Flux) {
       IDEFIX_ERROR("Wrong direction");
   }
 
-  idefix_for("CalcRiemannFlux",
+  idefix_for(fluxKernelName,
              data->beg[KDIR]-kextend,data->end[KDIR]+koffset+kextend,
              data->beg[JDIR]-jextend,data->end[JDIR]+joffset+jextend,
              data->beg[IDIR]-iextend,data->end[IDIR]+ioffset+iextend,
@@ -13,6 +13,7 @@
 
 #include "fluid.hpp"
 #include "input.hpp"
+#include "profiler.hpp"
 
 // Forward declaration
 template<typename Phys>
@@ -76,6 +77,7 @@ class RiemannSolver {
   DataBlock *data;
 
   Solver mySolver;
+  std::string fluxKernelName;     // name of the kernel of mySolver, built once
 
   // Because each direction is a different template, we can't use
   std::unique_ptr<ExtrapolateToFaces<Phys,IDIR>> slopeLimIDIR;
@@ -138,7 +140,7 @@ RiemannSolver<Phys>::RiemannSolver(Input &input, Fluid<Phys>* hydro) : Vc{hydro-
       IDEFIX_ERROR(msg);
     }
     // Check if Hall is enabled
-    if(input.CheckEntry(std::string(Phys::prefix),"hall")>=0) {
+    if(hydro->hallStatus.isExplicit) {
         // Check consistency
         if(mySolver != HLL_MHD )
           IDEFIX_ERROR("Hall effect is only compatible with HLL Riemann solver.");
@@ -148,6 +150,24 @@ RiemannSolver<Phys>::RiemannSolver(Input &input, Fluid<Phys>* hydro) : Vc{hydro-
     mySolver = HLL_DUST;
   }
 
+  // Estimated cost per interface of the Riemann kernel, used by kernel profiling.
+  // Memory traffic: read the primitive variables, write the fluxes and the signal speed.
+  // Flops: reconstruction to the faces (~25 flops per variable) and the solver itself.
+  double flops = 25*Phys::nvar;
+  std::string kernelName = "CalcRiemannFlux";
+  switch(mySolver) {
+    case TVDLF_MHD: flops += 200; break;
+    case HLL_MHD:   flops += 250; break;
+    case HLLD_MHD:  flops += 550; break;
+    case ROE_MHD:   flops += 900; break;
+    case TVDLF:     flops += 100; kernelName = "TVDLF_Kernel"; break;
+    case HLL:       flops += 120; kernelName = "HLL_Kernel"; break;
+    case HLLC:      flops += 180; kernelName = "HLLC_Kernel"; break;
+    case ROE:       flops += 300; kernelName = "ROE_Kernel"; break;
+    case HLL_DUST:  flops += 60;  kernelName = "HLL_Kernel"; break;
+  }
+  fluxKernelName = std::string(Phys::prefix)+"::"+kernelName;
+  idfx::prof.SetKernelTraffic(fluxKernelName, (2*Phys::nvar+1)*sizeof(real), flops);
 
 
   // Shock flattening
@@ -14,7 +14,7 @@
 // Compute parabolic fluxes
 template<typename Phys>
 template <int dir>
-void Fluid<Phys>::AddNonIdealMHDFlux(const real t) {
+void Fluid<Phys>::AddNonIdealMHDFlux(const real t, bool resetDMax) {
   idfx::pushRegion("Fluid::addNonIdealMHDFlux");
 
   if constexpr(Phys::mhd) {
@@ -32,16 +32,8 @@ void Fluid<Phys>::AddNonIdealMHDFlux(const real t) {
     HydroModuleStatus resistivity = resistivityStatus.status;
     HydroModuleStatus ambipolar   = ambipolarStatus.status;
 
-    bool haveResistivity{false};
-    bool haveAmbipolar{false};
-
-    if(data->rklCycle) {
-      haveResistivity = resistivityStatus.isRKL;
-      haveAmbipolar = ambipolarStatus.isRKL;
-    } else {
-      haveResistivity = resistivityStatus.isExplicit;
-      haveAmbipolar = ambipolarStatus.isExplicit;
-    }
+    bool haveResistivity = resistivityStatus.IsActive(data->rklCycle, data->implicitCycle);
+    bool haveAmbipolar = ambipolarStatus.IsActive(data->rklCycle, data->implicitCycle);
 
     real etaConstant = this->etaO;
     real xAConstant  = this->xA;
@@ -62,17 +54,17 @@ void Fluid<Phys>::AddNonIdealMHDFlux(const real t) {
         IDEFIX_ERROR("Wrong direction");
     }
 
-    // Load the diffusivity array when required
+    // Load the diffusivity array when required (and outdated)
     if(resistivity == UserDefFunction && dir == IDIR) {
       if(ohmicDiffusivityFunc)
-        ohmicDiffusivityFunc(*data, t, etaArr);
+        ohmicCache.Refresh(Vc, [&]() { ohmicDiffusivityFunc(*data, t, etaArr); });
       else
         IDEFIX_ERROR("No user-defined Ohmic diffusivity function has been enrolled");
     }
 
     if(ambipolar == UserDefFunction && dir == IDIR) {
       if(ambipolarDiffusivityFunc)
-        ambipolarDiffusivityFunc(*data, t, xAmbiArr);
+        ambipolarCache.Refresh(Vc, [&]() { ambipolarDiffusivityFunc(*data, t, xAmbiArr); });
       else
         IDEFIX_ERROR("No user-defined ambipolar diffusivity function has been enrolled");
     }
@@ -285,7 +277,7 @@ void Fluid<Phys>::AddNonIdealMHDFlux(const real t) {
             locdmax += xA*BdotB;
           }
         }
-        dMax(k,j,i) = FMAX(dMax(k,j,i),locdmax);
+        dMax(k,j,i) = resetDMax ? locdmax : FMAX(dMax(k,j,i),locdmax);
       }
     );
   }
@@ -7,12 +7,14 @@
 
 #ifndef FLUID_BOUNDARY_BOUNDARY_HPP_
 #define FLUID_BOUNDARY_BOUNDARY_HPP_
+#include <array>
 #include <string>
 #include <vector>
 #include <memory>
 #include "idefix.hpp"
 #include "fluid_defs.hpp"
 #include "grid.hpp"
+#include "shearingRemap.hpp"
 
 #ifdef WITH_MPI
 #include "mpi.hpp"
@@ -34,11 +36,15 @@ template <typename Phys>
 using InternalBoundaryFunc = void (*) (Fluid<Phys> *, const real t);
 using InternalBoundaryFuncOld = void (*) (DataBlock &, const real t); // DEPRECATED
 
+// Rules of the boundary plan, applied by a single kernel per direction
+enum class BoundaryRule {none, periodic, reflective, outflow};
+
 template<typename Phys>
 class Boundary {
  public:
   explicit Boundary(Fluid<Phys>*);
-  void SetBoundaries(real);                         ///< Set the ghost zones in all directions
+  void SetBoundaries(real, bool exchange = true);   ///< Set the ghost zones in all directions
+                                                    ///< (without MPI exchanges if !exchange)
   void EnforceBoundaryDir(real, int);             ///< write in the ghost zone in specific direction
   void ReconstructVcField(IdefixArray4D<real> &);  ///< reconstruct cell-centered magnetic field
   void ReconstructNormalField(int dir);           ///< reconstruct normal field using divB=0
@@ -56,6 +62,8 @@ class Boundary {
   void EnforceReflective(int, BoundarySide ); ///< Enforce reflective BC in direction and side
   void EnforceOutflow(int, BoundarySide ); ///< Enforce outflow BC in direction and side
   void EnforceShearingBox(real, int, BoundarySide ); ///< Enforce Shearing box BCs
+  void EnforcePlan(int);                   ///< Enforce the periodic, reflective and outflow
+                                           ///< BCs of both sides in direction
 
   #ifdef WITH_MPI
   Mpi mpi;                     ///< Mpi object when WITH_MPI is set
@@ -106,13 +114,18 @@ class Boundary {
                             const int &,
                             const BoundarySide &,
                             Function );
-  IdefixArray4D<real> sBArray;    ///< Array use by shearingbox boundary conditions
+  IdefixArray4D<real> sBArray;    ///< Shifted X2 strips used by shearingbox boundary conditions
+  ShearingRemap sbRemap;          ///< Gathers the shifted strips from the X2 row
 
   IdefixArray4D<real> Vc; ///< reference to cell-centered array that we should sync
   IdefixArray4D<real> Vs; ///< reference to face-centered array that we should sync
   std::unique_ptr<Axis> axis; ///< Axis object, initialised if needed.
   bool haveAxis{false};
 
+  // Boundary plan: rule of each side in each direction, built once at init
+  std::array<Kokkos::Array<BoundaryRule,2>,3> planRule;
+  std::array<bool,3> havePlan{false, false, false};
+
  private:
   friend class Axis;
   Fluid<Phys> *fluid;    // pointer to parent hydro object
@@ -139,14 +152,30 @@ Boundary<Phys>::Boundary(Fluid<Phys>* fluid) {
     this->haveAxis = true;
   }
 
+  // Build the boundary plan
+  for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+    for(int side = 0 ; side < 2 ; side++) {
+      const BoundaryType type = (side == left) ? data->lbound[dir] : data->rbound[dir];
+      BoundaryRule rule = BoundaryRule::none;
+      // Decomposed periodic directions are handled by MPI exchanges
+      if(type == BoundaryType::periodic && data->mygrid->nproc[dir] == 1) {
+        rule = BoundaryRule::periodic;
+      }
+      if(type == BoundaryType::reflective) rule = BoundaryRule::reflective;
+      if(type == BoundaryType::outflow) rule = BoundaryRule::outflow;
+      planRule[dir][side] = rule;
+      if(rule != BoundaryRule::none) havePlan[dir] = true;
+    }
+  }
+
 
-  if(data->lbound[IDIR] == shearingbox || data->rbound[IDIR] == shearingbox) {
-    // using np_tot[...]+1 points to allow this buffer to represent
-    // fields that are defined on faces
+  // Every process of the grid takes part in the creation of the remap communicators
+  if(data->mygrid->lbound[IDIR] == shearingbox || data->mygrid->rbound[IDIR] == shearingbox) {
+    sbRemap.Init(data);
     sBArray = IdefixArray4D<real>("ShearingBoxArray",
                                   nVar,
-                                  data->np_tot[KDIR]+1,
-                                  data->np_tot[JDIR]+1,
+                                  data->np_tot[KDIR],
+                                  sbRemap.width,
                                   data->nghost[IDIR]);
   }
 
@@ -233,7 +262,7 @@ void Boundary<Phys>::EnforceFluxBoundaries(int dir,const real t) {
 }
 
 template<typename Phys>
-void Boundary<Phys>::SetBoundaries(real t) {
+void Boundary<Phys>::SetBoundaries(real t, bool exchange) {
   idfx::pushRegion("Boundary::SetBoundaries");
   // set internal boundary conditions
   if(haveInternalBoundary) {
@@ -248,7 +277,7 @@ void Boundary<Phys>::SetBoundaries(real t) {
   for(int dir=0 ; dir < DIMENSIONS ; dir++ ) {
       // MPI Exchange data when needed
     #ifdef WITH_MPI
-    if(data->mygrid->nproc[dir]>1) {
+    if(data->mygrid->nproc[dir]>1 && exchange) {
       switch(dir) {
         case 0:
           mpi.ExchangeX1(this->Vc, this->Vs);
@@ -283,6 +312,9 @@ template<typename Phys>
 void Boundary<Phys>::EnforceBoundaryDir(real t, int dir) {
   idfx::pushRegion("Boundary::EnforceBoundaryDir");
 
+  // periodic, reflective and outflow boundaries of both sides
+  if(havePlan[dir]) EnforcePlan(dir);
+
   // left boundary
 
   switch(data->lbound[dir]) {
@@ -291,16 +323,9 @@ void Boundary<Phys>::EnforceBoundaryDir(real t, int dir) {
       break;
 
     case BoundaryType::periodic:
-      if(data->mygrid->nproc[dir] > 1) break; // Periodicity already enforced by MPI calls
-      EnforcePeriodic(dir,left);
-      break;
-
     case BoundaryType::reflective:
-      EnforceReflective(dir,left);
-      break;
-
     case BoundaryType::outflow:
-      EnforceOutflow(dir,left);
+      // Enforced by the boundary plan (periodicity by MPI calls when decomposed)
       break;
 
     case BoundaryType::shearingbox:
@@ -340,14 +365,9 @@ void Boundary<Phys>::EnforceBoundaryDir(real t, int dir) {
       break;
 
     case BoundaryType::periodic:
-      if(data->mygrid->nproc[dir] > 1) break; // Periodicity already enforced by MPI calls
-      EnforcePeriodic(dir,right);
-      break;
     case BoundaryType::reflective:
-      EnforceReflective(dir,right);
-      break;
     case BoundaryType::outflow:
-      EnforceOutflow(dir,right);
+      // Enforced by the boundary plan (periodicity by MPI calls when decomposed)
       break;
     case BoundaryType::shearingbox:
       EnforceShearingBox(t,dir,right);
@@ -800,13 +820,85 @@ void Boundary<Phys>::EnforceOutflow(int dir, BoundarySide side ) {
   idfx::popRegion();
 }
 
+// Enforce the periodic, reflective and outflow boundaries of both sides of direction dir,
+// for all of the cell-centered variables and face-centered field components, in one kernel.
+// The rules are the ones of EnforcePeriodic, EnforceReflective and EnforceOutflow.
+// The ghost zones of each side only read the active domain, hence both sides are independent.
+template<typename Phys>
+void Boundary<Phys>::EnforcePlan(int dir) {
+  idfx::pushRegion("Boundary::EnforcePlan");
+  IdefixArray4D<real> Vc = this->Vc;
+  IdefixArray4D<real> Vs = this->Vs;
+  const Kokkos::Array<BoundaryRule,2> rule = planRule[dir];
+
+  // Cell-centered variables, then face-centered components, for each side
+  const int nVc = this->nVar;
+  const int nSlot = nVc + (Phys::mhd ? DIMENSIONS : 0);
+
+  Kokkos::Array<int,3> ghost, nx, ntot, extent;
+  for(int d = 0 ; d < 3 ; d++) {
+    ghost[d] = data->nghost[d];
+    nx[d] = data->np_int[d];
+    ntot[d] = data->np_tot[d];
+    // Face-centered components have one more point in their own direction
+    extent[d] = ntot[d] + ((Phys::mhd && d < DIMENSIONS && d != dir) ? 1 : 0);
+  }
+  extent[dir] = ghost[dir];
+
+  std::string name = "BoundaryPlanX" + std::to_string(dir+1);
+  idefix_for(name, 0, 2*nSlot, 0, extent[KDIR], 0, extent[JDIR], 0, extent[IDIR],
+    KOKKOS_LAMBDA (int s, int k, int j, int i) {
+      const int side = s / nSlot;
+      const int slot = s - side*nSlot;
+      const BoundaryRule r = rule[side];
+      if(r == BoundaryRule::none) return;
+
+      const bool face = (slot >= nVc);
+      const int n = face ? slot - nVc : slot;
+      // Reflective and outflow boundaries leave the normal field to ReconstructNormalField
+      if(face && n == dir && r != BoundaryRule::periodic) return;
+
+      int idx[3] = {i, j, k};
+      for(int d = 0 ; d < 3 ; d++) {
+        if(d == dir) continue;
+        if(idx[d] >= ntot[d] + ((face && d == n) ? 1 : 0)) return;
+      }
+      // Position of the ghost point (the normal field has one more face in the domain)
+      const int shift = (face && n == dir) ? 1 : 0;
+      idx[dir] += side*(ghost[dir] + nx[dir] + shift);
+
+      int ref[3] = {idx[0], idx[1], idx[2]};
+      real sign = ONE_F;
+      if(r == BoundaryRule::periodic) {
+        // This hack takes care of cases where we have more ghost zones than active zones
+        ref[dir] = ghost[dir] + (idx[dir] + ghost[dir]*(nx[dir]-1))%nx[dir];
+      } else if(r == BoundaryRule::reflective) {
+        ref[dir] = 2*(ghost[dir] + side*nx[dir]) - idx[dir] - 1;
+        if(face || n == VX1+dir) sign = -ONE_F;
+      } else {
+        ref[dir] = ghost[dir] + side*(nx[dir]-1);
+      }
+
+      if(face) {
+        Vs(n,idx[KDIR],idx[JDIR],idx[IDIR]) = sign*Vs(n,ref[KDIR],ref[JDIR],ref[IDIR]);
+      } else {
+        const real q = Vc(n,ref[KDIR],ref[JDIR],ref[IDIR]);
+        // Outflow: no inflow velocity (side = 0 on the left and 1 on the right)
+        if(r == BoundaryRule::outflow && n == VX1+dir && (1-2*side)*q >= ZERO_F) {
+          Vc(n,idx[KDIR],idx[JDIR],idx[IDIR]) = ZERO_F;
+        } else {
+          Vc(n,idx[KDIR],idx[JDIR],idx[IDIR]) = sign*q;
+        }
+      }
+    });
+  idfx::popRegion();
+}
+
 template<typename Phys>
 void Boundary<Phys>::EnforceShearingBox(real t, int dir, BoundarySide side) {
   idfx::pushRegion("Boundary::EnforceShearingBox");
   if(dir != IDIR)
     IDEFIX_ERROR("Shearing box boundaries can only be applied along the X1 direction");
-  if(data->mygrid->nproc[JDIR]>1)
-    IDEFIX_ERROR("Shearing box is not yet compatible with domain decomposition in X2");
 
   // First thing is to enforce periodicity (already performed by MPI)
   if(data->mygrid->nproc[dir] == 1) EnforcePeriodic(dir, side);
@@ -815,10 +907,8 @@ void Boundary<Phys>::EnforceShearingBox(real t, int dir, BoundarySide side) {
   IdefixArray4D<real> Vc = this->Vc;
 
   const int nxi = data->np_int[IDIR];
-  const int nxj = data->np_int[JDIR];
 
   const int ighost = data->nghost[IDIR];
-  const int jghost = data->nghost[JDIR];
 
   // Where does the boundary starts along x1?
   const int istart = side*(ighost+nxi);
@@ -845,16 +935,30 @@ void Boundary<Phys>::EnforceShearingBox(real t, int dir, BoundarySide side) {
   // remainding shift
   const real eps = dL / dy - m;
 
+  // Gather the strips shifted by m cells, which can belong to other processes along X2.
+  // The cell j is remapped from the window point jo=j+2.
+  const int nv = this->nVar;
+  const int nk = data->np_tot[KDIR];
+  sbRemap.Gather(m, nv*nk*ighost,
+    KOKKOS_LAMBDA (int s, int j) {
+      const int i = s % ighost;
+      const int k = (s / ighost) % nk;
+      const int n = s / (ighost*nk);
+      return Vc(n,k,j,i+istart);
+    },
+    KOKKOS_LAMBDA (int s, int w, real value) {
+      const int i = s % ighost;
+      const int k = (s / ighost) % nk;
+      const int n = s / (ighost*nk);
+      scrh(n,k,w,i) = value;
+    });
 
   // Now we need to perform the shift
   BoundaryForAll("BoundaryShearingBox", dir, side,
         KOKKOS_LAMBDA ( int n, int k, int j, int i) {
+          const int is = i-istart;
           // jorigin
-          const int jo = jghost + ((j-m-jghost)%nxj+nxj)%nxj;
-          const int jop2 = jghost + ((jo+2-jghost)%nxj+nxj)%nxj;
-          const int jop1 = jghost + ((jo+1-jghost)%nxj+nxj)%nxj;
-          const int jom1 = jghost + ((jo-1-jghost)%nxj+nxj)%nxj;
-          const int jom2 = jghost + ((jo-2-jghost)%nxj+nxj)%nxj;
+          const int jo = j+2;
 
           // Define Left and right fluxes
           // Fluxes are defined from slope-limited interpolation
@@ -864,37 +968,32 @@ void Boundary<Phys>::EnforceShearingBox(real t, int dir, BoundarySide side) {
 
           if(eps>=ZERO_F) {
             // Compute Fl
-            dqm = Vc(n,k,jom1,i) - Vc(n,k,jom2,i);
-            dqp = Vc(n,k,jo,i) - Vc(n,k,jom1,i);
+            dqm = scrh(n,k,jo-1,is) - scrh(n,k,jo-2,is);
+            dqp = scrh(n,k,jo,is) - scrh(n,k,jo-1,is);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fl = Vc(n,k,jom1,i) + 0.5*dq*(1.0-eps);
+            Fl = scrh(n,k,jo-1,is) + 0.5*dq*(1.0-eps);
             //Compute Fr
             dqm=dqp;
-            dqp = Vc(n,k,jop1,i) - Vc(n,k,jo,i);
+            dqp = scrh(n,k,jo+1,is) - scrh(n,k,jo,is);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fr = Vc(n,k,jo,i) + 0.5*dq*(1.0-eps);
+            Fr = scrh(n,k,jo,is) + 0.5*dq*(1.0-eps);
           } else {
             //Compute Fl
-            dqm = Vc(n,k,jo,i) - Vc(n,k,jom1,i);
-            dqp = Vc(n,k,jop1,i) - Vc(n,k,jo,i);
+            dqm = scrh(n,k,jo,is) - scrh(n,k,jo-1,is);
+            dqp = scrh(n,k,jo+1,is) - scrh(n,k,jo,is);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fl = Vc(n,k,jo,i) - 0.5*dq*(1.0+eps);
+            Fl = scrh(n,k,jo,is) - 0.5*dq*(1.0+eps);
             // Compute Fr
             dqm=dqp;
-            dqp = Vc(n,k,jop2,i) - Vc(n,k,jop1,i);
+            dqp = scrh(n,k,jo+2,is) - scrh(n,k,jo+1,is);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fr = Vc(n,k,jop1,i) - 0.5*dq*(1.0+eps);
+            Fr = scrh(n,k,jo+1,is) - 0.5*dq*(1.0+eps);
           }
-          scrh(n,k,j,i-istart) = Vc(n,k,jo,i) - eps*(Fr - Fl);
-        });
-  // Copy scrach back to our boundary
-  BoundaryForAll("BoundaryShearingBoxCopy", dir, side,
-        KOKKOS_LAMBDA ( int n, int k, int j, int i) {
-          Vc(n,k,j,i) = scrh(n,k,j,i-istart);
+          Vc(n,k,j,i) = scrh(n,k,jo,is) - eps*(Fr - Fl);
           if(n==VX2) Vc(n,k,j,i) += sbVelocity;
         });
 
@@ -903,14 +1002,19 @@ void Boundary<Phys>::EnforceShearingBox(real t, int dir, BoundarySide side) {
     IdefixArray4D<real> Vs = this->Vs;
     #if DIMENSIONS >= 2
       for(int component = BX2s ; component < DIMENSIONS ; component++) {
+        sbRemap.Gather(m, nk*ighost,
+          KOKKOS_LAMBDA (int s, int j) {
+            return Vs(component,s / ighost,j,s % ighost + istart);
+          },
+          KOKKOS_LAMBDA (int s, int w, real value) {
+            scrh(0,s / ighost,w,s % ighost) = value;
+          });
+
         BoundaryFor("BoundaryShearingBoxBXs", dir, side,
         KOKKOS_LAMBDA (int k, int j, int i) {
+          const int is = i-istart;
           // jorigin
-          const int jo = jghost + ((j-m-jghost)%nxj+nxj)%nxj;
-          const int jop2 = jghost + ((jo+2-jghost)%nxj+nxj)%nxj;
-          const int jop1 = jghost + ((jo+1-jghost)%nxj+nxj)%nxj;
-          const int jom1 = jghost + ((jo-1-jghost)%nxj+nxj)%nxj;
-          const int jom2 = jghost + ((jo-2-jghost)%nxj+nxj)%nxj;
+          const int jo = j+2;
 
           // Define Left and right fluxes
           // Fluxes are defined from slope-limited interpolation
@@ -920,38 +1024,33 @@ void Boundary<Phys>::EnforceShearingBox(real t, int dir, BoundarySide side) {
 
           if(eps>=ZERO_F) {
             // Compute Fl
-            dqm = Vs(component,k,jom1,i) - Vs(component,k,jom2,i);
-            dqp = Vs(component,k,jo,i) - Vs(component,k,jom1,i);
+            dqm = scrh(0,k,jo-1,is) - scrh(0,k,jo-2,is);
+            dqp = scrh(0,k,jo,is) - scrh(0,k,jo-1,is);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fl = Vs(component,k,jom1,i) + 0.5*dq*(1.0-eps);
+            Fl = scrh(0,k,jo-1,is) + 0.5*dq*(1.0-eps);
             //Compute Fr
             dqm=dqp;
-            dqp = Vs(component,k,jop1,i) - Vs(component,k,jo,i);
+            dqp = scrh(0,k,jo+1,is) - scrh(0,k,jo,is);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fr = Vs(component,k,jo,i) + 0.5*dq*(1.0-eps);
+            Fr = scrh(0,k,jo,is) + 0.5*dq*(1.0-eps);
           } else {
             //Compute Fl
-            dqm = Vs(component,k,jo,i) - Vs(component,k,jom1,i);
-            dqp = Vs(component,k,jop1,i) - Vs(component,k,jo,i);
+            dqm = scrh(0,k,jo,is) - scrh(0,k,jo-1,is);
+            dqp = scrh(0,k,jo+1,is) - scrh(0,k,jo,is);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fl = Vs(component,k,jo,i) - 0.5*dq*(1.0+eps);
+            Fl = scrh(0,k,jo,is) - 0.5*dq*(1.0+eps);
             // Compute Fr
             dqm=dqp;
-            dqp = Vs(component,k,jop2,i) - Vs(component,k,jop1,i);
+            dqp = scrh(0,k,jo+2,is) - scrh(0,k,jo+1,is);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fr = Vs(component,k,jop1,i) - 0.5*dq*(1.0+eps);
+            Fr = scrh(0,k,jo+1,is) - 0.5*dq*(1.0+eps);
           }
-          scrh(0,k,j,i-istart) = Vs(component,k,jo,i) - eps*(Fr - Fl);
+          Vs(component,k,j,i) = scrh(0,k,jo,is) - eps*(Fr - Fl);
         });
-        // Copy scratch back to our boundary
-        BoundaryFor("BoundaryShearingBoxCopyBXs", dir, side,
-              KOKKOS_LAMBDA ( int k, int j, int i) {
-                Vs(component,k,j,i) = scrh(0,k,j,i-istart);
-              });
       }// loop on components
     #endif// DIMENSIONS
   } // MHD
@@ -0,0 +1,69 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#include <algorithm>
+#include <vector>
+#include "shearingRemap.hpp"
+#include "dataBlock.hpp"
+
+void ShearingRemap::Init(DataBlock *data) {
+  idfx::pushRegion("ShearingRemap::Init");
+  this->grid = data->mygrid;
+  this->nghost = data->nghost[JDIR];
+  this->width = data->np_tot[JDIR] + 4;
+  this->ny = grid->np_int[JDIR];
+  this->nproc = grid->nproc[JDIR];
+  this->xproc = grid->xproc[JDIR];
+  sendRuns.resize(nproc);
+  recvRuns.resize(nproc);
+
+  #ifdef WITH_MPI
+    // Communicator of the processes sharing our X1 and X3 coordinates (collective)
+    int remainDims[3] = {false, true, false};
+    if(rowComm != MPI_COMM_NULL) MPI_Comm_free(&rowComm);
+    MPI_SAFE_CALL(MPI_Cart_sub(grid->CartComm, remainDims, &rowComm));
+    rowRank.resize(nproc);
+    for(int p = 0 ; p < nproc ; p++) {
+      MPI_SAFE_CALL(MPI_Cart_rank(rowComm, &p, &rowRank[p]));
+    }
+  #endif
+  idfx::popRegion();
+}
+
+ShearingRemap::~ShearingRemap() {
+  #ifdef WITH_MPI
+    if(rowComm != MPI_COMM_NULL) MPI_Comm_free(&rowComm);
+  #endif
+}
+
+// Split the window of each process of the row into runs of contiguous points owned by a single
+// process. Every process builds the same runs, so that no negotiation is needed between the
+// senders and the receivers.
+void ShearingRemap::MakeRuns(int m) {
+  const std::vector<int> &start = grid->procStart[JDIR];
+  for(int p = 0 ; p < nproc ; p++) {
+    sendRuns[p].clear();
+    recvRuns[p].clear();
+  }
+  for(int r = 0 ; r < nproc ; r++) {
+    // Window of process r, in global active indices
+    const int gbeg = start[r] - nghost - m - 2;
+    const int nw = start[r+1] - start[r] + 2*nghost + 4;
+    int w = 0;
+    while(w < nw) {
+      const int g = ((gbeg + w) % ny + ny) % ny;
+      const int owner = std::upper_bound(start.begin(), start.end(), g) - start.begin() - 1;
+      Run run;
+      run.w = w;
+      run.j = g - start[owner] + nghost;
+      run.len = std::min(nw - w, start[owner+1] - g);
+      if(r == xproc) recvRuns[owner].push_back(run);
+      if(owner == xproc && r != xproc) sendRuns[r].push_back(run);
+      w += run.len;
+    }
+  }
+}
@@ -0,0 +1,162 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#ifndef FLUID_BOUNDARY_SHEARINGREMAP_HPP_
+#define FLUID_BOUNDARY_SHEARINGREMAP_HPP_
+
+#include <vector>
+#include "idefix.hpp"
+#include "grid.hpp"
+
+class DataBlock;
+
+// Shifted X2 strips required by the shearing-box boundary conditions.
+// The radial ghost cells at j are remapped from the periodic image at j-m (modulo the box
+// size) and its immediate neighbours, which may belong to any process of the same X2 row when
+// the domain is decomposed along X2. For an integer shift m, Gather fills a window of
+// np_tot[JDIR]+4 points, where window point w holds the source at the local index w-2-m,
+// taken periodically in the full box. The subgrid interpolation of the remap then only
+// involves the points j+2 and j+2+-1, j+2+-2 of the window.
+// The data are described by two functors: load(s,j) returns the element s (s<size) of the
+// X2 line at the local index j, and store(s,w,value) writes it in the window at w.
+class ShearingRemap {
+ public:
+  ShearingRemap() = default;
+  ~ShearingRemap();
+  // The row communicator is owned by the instance
+  ShearingRemap(const ShearingRemap&) = delete;
+  ShearingRemap& operator=(const ShearingRemap&) = delete;
+
+  void Init(DataBlock *);
+  template <typename Load, typename Store>
+  void Gather(int m, int size, Load, Store);
+
+  int width;                      // Number of points of the window (np_tot[JDIR]+4)
+
+ private:
+  struct Run {
+    int w;                        // First point of the run in the receiver window
+    int j;                        // First local index of the run in the sender subdomain
+    int len;                      // Number of points in the run
+  };
+  void MakeRuns(int m);
+
+  int nproc;                      // Number of processes in the X2 row
+  int xproc;                      // Our coordinate in the X2 row
+  std::vector<std::vector<Run>> sendRuns;   // Runs we own in the window of each process
+  std::vector<std::vector<Run>> recvRuns;   // Runs of our window owned by each process
+  Grid *grid;
+  int nghost;
+  int ny;                         // Total number of active cells along X2
+
+  IdefixArray1D<real> bufferSend;
+  IdefixArray1D<real> bufferRecv;
+#ifdef WITH_MPI
+  MPI_Comm rowComm{MPI_COMM_NULL};  // Processes sharing our X1 and X3 coordinates
+  std::vector<int> rowRank;       // Rank in rowComm of each X2 coordinate
+  std::vector<MPI_Request> requests;
+#endif
+};
+
+template <typename Load, typename Store>
+void ShearingRemap::Gather(int m, int size, Load load, Store store) {
+  idfx::pushRegion("ShearingRemap::Gather");
+  MakeRuns(m);
+
+  // Offsets of each message in the buffers
+  std::vector<int> sendOffset(nproc+1,0);
+  std::vector<int> recvOffset(nproc+1,0);
+  for(int p = 0 ; p < nproc ; p++) {
+    int nsend = 0;
+    int nrecv = 0;
+    if(p != xproc) {
+      for(auto const &run : sendRuns[p]) nsend += run.len;
+      for(auto const &run : recvRuns[p]) nrecv += run.len;
+    }
+    sendOffset[p+1] = sendOffset[p] + nsend*size;
+    recvOffset[p+1] = recvOffset[p] + nrecv*size;
+  }
+  if(bufferSend.extent(0) < sendOffset[nproc]) {
+    bufferSend = IdefixArray1D<real>("ShearingRemapSend", sendOffset[nproc]);
+  }
+  if(bufferRecv.extent(0) < recvOffset[nproc]) {
+    bufferRecv = IdefixArray1D<real>("ShearingRemapRecv", recvOffset[nproc]);
+  }
+  IdefixArray1D<real> bufferSend = this->bufferSend;
+  IdefixArray1D<real> bufferRecv = this->bufferRecv;
+
+  #ifdef WITH_MPI
+    double tStart = MPI_Wtime();
+    requests.clear();
+    for(int p = 0 ; p < nproc ; p++) {
+      const int count = recvOffset[p+1]-recvOffset[p];
+      if(count == 0) continue;
+      requests.emplace_back();
+      MPI_SAFE_CALL(MPI_Irecv(bufferRecv.data()+recvOffset[p], count, realMPI, rowRank[p],
+                              3001, rowComm, &requests.back()));
+    }
+    idfx::mpiCallsTimer += MPI_Wtime() - tStart;
+
+    // Load the send buffers
+    for(int p = 0 ; p < nproc ; p++) {
+      if(p == xproc) continue;
+      int offset = sendOffset[p];
+      for(auto const &run : sendRuns[p]) {
+        const int jbeg = run.j;
+        idefix_for("ShearingRemapPack", 0, run.len, 0, size,
+          KOKKOS_LAMBDA (int jj, int s) {
+            bufferSend(offset + jj*size + s) = load(s, jbeg+jj);
+          });
+        offset += run.len*size;
+      }
+    }
+    Kokkos::fence();
+
+    tStart = MPI_Wtime();
+    for(int p = 0 ; p < nproc ; p++) {
+      const int count = sendOffset[p+1]-sendOffset[p];
+      if(count == 0) continue;
+      requests.emplace_back();
+      MPI_SAFE_CALL(MPI_Isend(bufferSend.data()+sendOffset[p], count, realMPI, rowRank[p],
+                              3001, rowComm, &requests.back()));
+    }
+    idfx::mpiCallsTimer += MPI_Wtime() - tStart;
+  #endif
+
+  // Runs we own ourselves are directly copied
+  for(auto const &run : recvRuns[xproc]) {
+    const int jbeg = run.j;
+    const int wbeg = run.w;
+    idefix_for("ShearingRemapCopy", 0, run.len, 0, size,
+      KOKKOS_LAMBDA (int jj, int s) {
+        store(s, wbeg+jj, load(s, jbeg+jj));
+      });
+  }
+
+  #ifdef WITH_MPI
+    tStart = MPI_Wtime();
+    MPI_SAFE_CALL(MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE));
+    idfx::mpiCallsTimer += MPI_Wtime() - tStart;
+
+    // Unload the receive buffers
+    for(int p = 0 ; p < nproc ; p++) {
+      if(p == xproc) continue;
+      int offset = recvOffset[p];
+      for(auto const &run : recvRuns[p]) {
+        const int wbeg = run.w;
+        idefix_for("ShearingRemapUnpack", 0, run.len, 0, size,
+          KOKKOS_LAMBDA (int jj, int s) {
+            store(s, wbeg+jj, bufferRecv(offset + jj*size + s));
+          });
+        offset += run.len*size;
+      }
+    }
+  #endif
+  idfx::popRegion();
+}
+
+#endif // FLUID_BOUNDARY_SHEARINGREMAP_HPP_
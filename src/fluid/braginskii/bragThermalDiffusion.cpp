@@ -29,6 +29,7 @@ void BragThermalDiffusion::ShowConfig() {
     if(!bragDiffusivityFunc) {
       IDEFIX_ERROR("No braginskii thermal diffusion function has been enrolled");
     }
+    kCache.ShowConfig();
   } else {
     IDEFIX_ERROR("Unknown Braginskii thermal diffusion mode");
   }
@@ -37,6 +38,8 @@ void BragThermalDiffusion::ShowConfig() {
   } else if(status.isRKL) {
     idfx::cout << "Braginskii Thermal Diffusion: uses a Runge-Kutta-Legendre time integration."
                 << std::endl;
+  } else if(status.isImplicit) {
+    idfx::cout << "Braginskii Thermal Diffusion: uses an implicit time integration." << std::endl;
   } else {
     IDEFIX_ERROR("Unknown time integrator for braginskii thermal diffusion.");
   }
@@ -65,17 +68,17 @@ void BragThermalDiffusion::EnrollBragThermalDiffusivity(BragDiffusivityFunc myFu
 }
 
 void BragThermalDiffusion::AddBragDiffusiveFlux(int dir, const real t,
-                                                const IdefixArray4D<real> &Flux) {
+                                                const IdefixArray4D<real> &Flux, bool resetDMax) {
   idfx::pushRegion("BragThermalDiffusion::AddBragDiffusiveFlux");
   switch(limiter) {
     case PLMLimiter::VanLeer:
-      this->AddBragDiffusiveFluxLim<PLMLimiter::VanLeer>(dir,t,Flux);
+      this->AddBragDiffusiveFluxLim<PLMLimiter::VanLeer>(dir,t,Flux,resetDMax);
       break;
     case PLMLimiter::McLim:
-      this->AddBragDiffusiveFluxLim<PLMLimiter::McLim>(dir,t,Flux);
+      this->AddBragDiffusiveFluxLim<PLMLimiter::McLim>(dir,t,Flux,resetDMax);
       break;
     case PLMLimiter::MinMod:
-      this->AddBragDiffusiveFluxLim<PLMLimiter::MinMod>(dir,t,Flux);
+      this->AddBragDiffusiveFluxLim<PLMLimiter::MinMod>(dir,t,Flux,resetDMax);
       break;
     default:
       IDEFIX_ERROR("The slope limiter for the Braginskii heat flux is not defined.");
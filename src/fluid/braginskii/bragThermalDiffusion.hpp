@@ -17,6 +17,7 @@
 #include "fluid_defs.hpp"
 #include "eos.hpp"
 #include "slopeLimiter.hpp"
+#include "diffusivityCache.hpp"
 
 // Forward class hydro declaration
 template <typename Phys> class Fluid;
@@ -30,10 +31,10 @@ class BragThermalDiffusion {
 
   void ShowConfig(); // display configuration
 
-  void AddBragDiffusiveFlux(int, const real, const IdefixArray4D<real> &);
+  void AddBragDiffusiveFlux(int, const real, const IdefixArray4D<real> &, bool);
 
   template<const PLMLimiter>
-  void AddBragDiffusiveFluxLim(int, const real, const IdefixArray4D<real> &);
+  void AddBragDiffusiveFluxLim(int, const real, const IdefixArray4D<real> &, bool);
 
   // Enroll user-defined thermal conductivity
   void EnrollBragThermalDiffusivity(BragDiffusivityFunc);
@@ -54,6 +55,7 @@ class BragThermalDiffusion {
   ParabolicModuleStatus &status;
 
   BragDiffusivityFunc  bragDiffusivityFunc;
+  DiffusivityCache kCache;        // refresh policy of the user-defined coefficients
 
   bool includeCollisionlessTD{false};
 
@@ -164,6 +166,10 @@ BragThermalDiffusion::BragThermalDiffusion(Input &input, Grid &grid, Fluid<Phys>
                    "in the .ini file");
   }
 
+  if(status.status == UserDefFunction) {
+    kCache = DiffusivityCache(input, "Hydro", "bragTDiffusion", data, Phys::pressure);
+  }
+
   #ifndef MHD
     IDEFIX_ERROR("Braginskii Thermal diffusion requires MHD");
   #endif
@@ -245,7 +251,8 @@ BragThermalDiffusion::BragThermalDiffusion(Input &input, Grid &grid, Fluid<Phys>
 // (this avoids an extra array)
 template <PLMLimiter limTemplate>
 void BragThermalDiffusion::AddBragDiffusiveFluxLim(int dir, const real t,
-                                                const IdefixArray4D<real> &Flux) {
+                                                   const IdefixArray4D<real> &Flux,
+                                                   bool resetDMax) {
   idfx::pushRegion("BragThermalDiffusion::AddBragDiffusiveFluxLim");
 
   IdefixArray4D<real> Vc = this->Vc;
@@ -305,10 +312,12 @@ void BragThermalDiffusion::AddBragDiffusiveFluxLim(int dir, const real t,
 
   if(includeCollisionlessTD == false && haveThermalDiffusion == UserDefFunction && dir == IDIR) {
     if(bragDiffusivityFunc) {
-      idfx::pushRegion("UserDef::BragThermalDiffusivityFunction");
-      std::vector<IdefixArray3D<real>> userdefArr = {kparArr, knorArr};
-      bragDiffusivityFunc(*this->data, t, userdefArr);
-      idfx::popRegion();
+      kCache.Refresh(Vc, [&]() {
+        idfx::pushRegion("UserDef::BragThermalDiffusivityFunction");
+        std::vector<IdefixArray3D<real>> userdefArr = {kparArr, knorArr};
+        bragDiffusivityFunc(*this->data, t, userdefArr);
+        idfx::popRegion();
+      });
     }
     else {
       IDEFIX_ERROR("No user-defined Braginskii thermal diffusion function has been enrolled");
@@ -316,10 +325,13 @@ void BragThermalDiffusion::AddBragDiffusiveFluxLim(int dir, const real t,
   } else if(includeCollisionlessTD == true && haveThermalDiffusion == UserDefFunction
             && dir == IDIR) {
     if (bragDiffusivityFunc) {
-      idfx::pushRegion("UserDef::ClessThermalDiffusivityFunction");
-      std::vector<IdefixArray3D<real>> userdefArr = {kparArr, knorArr, clessAlphaArr, clessBetaArr};
-      bragDiffusivityFunc(*this->data, t, userdefArr);
-      idfx::popRegion();
+      kCache.Refresh(Vc, [&]() {
+        idfx::pushRegion("UserDef::ClessThermalDiffusivityFunction");
+        std::vector<IdefixArray3D<real>> userdefArr = {kparArr, knorArr,
+                                                       clessAlphaArr, clessBetaArr};
+        bragDiffusivityFunc(*this->data, t, userdefArr);
+        idfx::popRegion();
+      });
     } else {
       IDEFIX_ERROR("No user-defined Braginskii/collisionless "
                     "thermal diffusion function has been enrolled");
@@ -804,7 +816,7 @@ void BragThermalDiffusion::AddBragDiffusiveFluxLim(int dir, const real t,
         q = clessAlpha*q + (1-clessAlpha)*clessBeta*Pn*Vn;
       }
       Flux(ENG, k, j, i) -= q;
-      dMax(k,j,i) = FMAX(dMax(k,j,i),locdmax);
+      dMax(k,j,i) = resetDMax ? locdmax : FMAX(dMax(k,j,i),locdmax);
 
       if(includeCollisionlessTD) {
         dMax(k,j,i) *= clessAlpha;
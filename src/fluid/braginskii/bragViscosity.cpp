@@ -47,6 +47,7 @@ void BragViscosity::ShowConfig() {
     if(!bragViscousDiffusivityFunc) {
       IDEFIX_ERROR("No braginskii viscosity function has been enrolled");
     }
+    etaCache.ShowConfig();
   } else {
     IDEFIX_ERROR("Unknown braginskii viscosity mode");
   }
@@ -55,6 +56,8 @@ void BragViscosity::ShowConfig() {
   } else if(this->status.isRKL) {
     idfx::cout << "Braginskii Viscosity: uses a Runge-Kutta-Legendre time integration."
                 << std::endl;
+  } else if(this->status.isImplicit) {
+    idfx::cout << "Braginskii Viscosity: uses an implicit time integration." << std::endl;
   } else {
     IDEFIX_ERROR("Unknown time integrator for braginskii viscosity.");
   }
@@ -87,17 +90,18 @@ void BragViscosity::EnrollBragViscousDiffusivity(DiffusivityFunc myFunc) {
 // (this avoids an extra array)
 // Associated source terms, present in non-cartesian geometry are also computed
 // and stored in this->viscSrc for later use (in calcRhs).
-void BragViscosity::AddBragViscousFlux(int dir, const real t, const IdefixArray4D<real> &Flux) {
+void BragViscosity::AddBragViscousFlux(int dir, const real t, const IdefixArray4D<real> &Flux,
+                                       bool resetDMax) {
   idfx::pushRegion("BragViscosity::AddBragViscousFlux");
   switch(limiter) {
     case PLMLimiter::VanLeer:
-      this->AddBragViscousFluxLim<PLMLimiter::VanLeer>(dir,t,Flux);
+      this->AddBragViscousFluxLim<PLMLimiter::VanLeer>(dir,t,Flux,resetDMax);
       break;
     case PLMLimiter::McLim:
-      this->AddBragViscousFluxLim<PLMLimiter::McLim>(dir,t,Flux);
+      this->AddBragViscousFluxLim<PLMLimiter::McLim>(dir,t,Flux,resetDMax);
       break;
     case PLMLimiter::MinMod:
-      this->AddBragViscousFluxLim<PLMLimiter::MinMod>(dir,t,Flux);
+      this->AddBragViscousFluxLim<PLMLimiter::MinMod>(dir,t,Flux,resetDMax);
       break;
     default:
       IDEFIX_ERROR("The slope limiter for the Braginskii viscosity is not defined.");
@@ -15,6 +15,7 @@
 #include "grid.hpp"
 #include "fluid_defs.hpp"
 #include "slopeLimiter.hpp"
+#include "diffusivityCache.hpp"
 
 // Forward class hydro declaration
 template <typename Phys> class Fluid;
@@ -25,10 +26,10 @@ class BragViscosity {
   template <typename Phys>
   BragViscosity(Input &, Grid &, Fluid<Phys> *);
   void ShowConfig();                    // print configuration
-  void AddBragViscousFlux(int, const real, const IdefixArray4D<real> &);
+  void AddBragViscousFlux(int, const real, const IdefixArray4D<real> &, bool);
 
   template <const PLMLimiter>
-  void AddBragViscousFluxLim(int, const real, const IdefixArray4D<real> &);
+  void AddBragViscousFluxLim(int, const real, const IdefixArray4D<real> &, bool);
 
   // Enroll user-defined viscous diffusivity
   void EnrollBragViscousDiffusivity(DiffusivityFunc);
@@ -50,6 +51,7 @@ class BragViscosity {
   ParabolicModuleStatus &status;
 
   DiffusivityFunc bragViscousDiffusivityFunc;
+  DiffusivityCache etaCache;      // refresh policy of etaBragArr
 
   bool haveSlopeLimiter{false};
   bool haveMonotizedCentral{false};
@@ -110,6 +112,10 @@ BragViscosity::BragViscosity(Input &input, Grid &grid, Fluid<Phys> *hydroin):
                    "in the .ini file");
   }
 
+  if(status.status == UserDefFunction) {
+    etaCache = DiffusivityCache(input, "Hydro", "bragViscosity", data, Phys::pressure);
+  }
+
   InitArrays();
 
   idfx::popRegion();
@@ -169,7 +175,8 @@ BragViscosity::BragViscosity(Input &input, Grid &grid, Fluid<Phys> *hydroin):
 // Associated source terms, present in non-cartesian geometry are also computed
 // and stored in this->bragViscSrc for later use (in calcRhs).
 template <PLMLimiter limTemplate>
-void BragViscosity::AddBragViscousFluxLim(int dir, const real t, const IdefixArray4D<real> &Flux) {
+void BragViscosity::AddBragViscousFluxLim(int dir, const real t, const IdefixArray4D<real> &Flux,
+                                          bool resetDMax) {
   idfx::pushRegion("BragViscosity::AddBragViscousFlux");
   IdefixArray4D<real> Vc = this->Vc;
   IdefixArray4D<real> Vs = this->Vs;
@@ -203,7 +210,7 @@ void BragViscosity::AddBragViscousFluxLim(int dir, const real t, const IdefixArr
   // Compute viscosity if needed
   if(haveViscosity == UserDefFunction && dir == IDIR) {
     if(bragViscousDiffusivityFunc) {
-      bragViscousDiffusivityFunc(*this->data, t, etaBragArr);
+      etaCache.Refresh(Vc, [&]() { bragViscousDiffusivityFunc(*this->data, t, etaBragArr); });
     } else {
       IDEFIX_ERROR("No user-defined Braginskii viscosity function has been enrolled");
     }
@@ -546,7 +553,7 @@ void BragViscosity::AddBragViscousFluxLim(int dir, const real t, const IdefixArr
         #endif
 
         real locdmax = etaBrag/(0.5*(Vc(RHO,k,j,i)+Vc(RHO,k,j,i-1)));
-        dMax(k,j,i) = FMAX(dMax(k,j,i),locdmax);
+        dMax(k,j,i) = resetDMax ? locdmax : FMAX(dMax(k,j,i),locdmax);
       }
 
 
@@ -756,7 +763,7 @@ void BragViscosity::AddBragViscousFluxLim(int dir, const real t, const IdefixArr
         #endif
 
         real locdmax = etaBrag/(0.5*(Vc(RHO,k,j,i)+Vc(RHO,k,j-1,i)));
-        dMax(k,j,i) = FMAX(dMax(k,j,i),locdmax);
+        dMax(k,j,i) = resetDMax ? locdmax : FMAX(dMax(k,j,i),locdmax);
       }
 
 
@@ -930,7 +937,7 @@ void BragViscosity::AddBragViscousFluxLim(int dir, const real t, const IdefixArr
         #endif
 
         real locdmax = etaBrag/(0.5*(Vc(RHO,k,j,i)+Vc(RHO,k-1,j,i)));
-        dMax(k,j,i) = FMAX(dMax(k,j,i),locdmax);
+        dMax(k,j,i) = resetDMax ? locdmax : FMAX(dMax(k,j,i),locdmax);
       }
   });
   idfx::popRegion();
@@ -10,7 +10,6 @@
 #include "fluid.hpp"
 #include "dataBlock.hpp"
 #include "addNonIdealMHDFlux.hpp"
-#include "fargo.hpp"
 
 // Compute parabolic fluxes
 template <typename Phys>
@@ -18,53 +17,40 @@ template <int dir>
 void Fluid<Phys>::CalcParabolicFlux(const real t) {
   idfx::pushRegion("Fluid::CalcParabolicFlux");
 
-  IdefixArray3D<real> dMax = this->dMax;
+  const bool rklCycle = data->rklCycle;
+  const bool implicitCycle = data->implicitCycle;
 
-  // Reset Max diffusion coefficient
-  idefix_for("HydroParabolicResetStage",0,data->np_tot[KDIR],
-                                        0,data->np_tot[JDIR],
-                                        0,data->np_tot[IDIR],
-    KOKKOS_LAMBDA (int k, int j, int i) {
-        dMax(k,j,i) = ZERO_F;
-      }
-  );
+  // dMax is initialised by the first active module, instead of a separate reset of the grid
+  bool resetDMax = true;
 
-  if( (resistivityStatus.isExplicit  && (! data->rklCycle))
-    || (resistivityStatus.isRKL  && ( data->rklCycle))
-    || (ambipolarStatus.isExplicit  && (! data->rklCycle))
-    || (ambipolarStatus.isRKL  && ( data->rklCycle)) ) {
-      this->AddNonIdealMHDFlux<dir>(t);
+  if( resistivityStatus.IsActive(rklCycle, implicitCycle)
+    || ambipolarStatus.IsActive(rklCycle, implicitCycle) ) {
+      this->AddNonIdealMHDFlux<dir>(t, resetDMax);
+      resetDMax = false;
   }
 
-  if( (viscosityStatus.isExplicit && (!data->rklCycle))
-    || (viscosityStatus.isRKL && data->rklCycle))  {
-      // Add fargo velocity if using fargo
-    if(data->haveFargo && viscosityStatus.isExplicit) {
-      data->fargo->AddVelocityFluid(t,this);
-    }
-    this->viscosity->AddViscousFlux(dir,t, this->FluxRiemann);
-
-    // Remove back Fargo velocity
-    if(data->haveFargo && viscosityStatus.isExplicit) {
-      data->fargo->SubstractVelocityFluid(t,this);
-    }
-  }
-
-  // Add thermal diffusion
-  if( (thermalDiffusionStatus.isExplicit && (!data->rklCycle))
-    || (thermalDiffusionStatus.isRKL && data->rklCycle))  {
-    this->thermalDiffusion->AddDiffusiveFlux(dir,t, this->FluxRiemann);
+  const bool haveThermalDiffusion = thermalDiffusionStatus.IsActive(rklCycle, implicitCycle);
+
+  // The Fargo mean velocity is added on the fly by the viscous stress kernels
+  // When both are active, thermal diffusion is computed in the sweep of the viscous stress
+  if(viscosityStatus.IsActive(rklCycle, implicitCycle))  {
+    this->viscosity->AddViscousFlux(dir,t, this->FluxRiemann, resetDMax,
+                                    haveThermalDiffusion ? this->thermalDiffusion.get() : nullptr);
+    resetDMax = false;
+  } else if(haveThermalDiffusion) {
+    // Add thermal diffusion
+    this->thermalDiffusion->AddDiffusiveFlux(dir,t, this->FluxRiemann, resetDMax);
+    resetDMax = false;
   }
 
-  if( (bragViscosityStatus.isExplicit && (!data->rklCycle))
-    || (bragViscosityStatus.isRKL && data->rklCycle))  {
-    this->bragViscosity->AddBragViscousFlux(dir,t, this->FluxRiemann);
+  if(bragViscosityStatus.IsActive(rklCycle, implicitCycle))  {
+    this->bragViscosity->AddBragViscousFlux(dir,t, this->FluxRiemann, resetDMax);
+    resetDMax = false;
   }
 
   // Add braginskii thermal diffusion
-  if( (bragThermalDiffusionStatus.isExplicit && (!data->rklCycle))
-    || (bragThermalDiffusionStatus.isRKL && data->rklCycle))  {
-    this->bragThermalDiffusion->AddBragDiffusiveFlux(dir,t, this->FluxRiemann);
+  if(bragThermalDiffusionStatus.IsActive(rklCycle, implicitCycle))  {
+    this->bragThermalDiffusion->AddBragDiffusiveFlux(dir,t, this->FluxRiemann, resetDMax);
   }
 
   idfx::popRegion();
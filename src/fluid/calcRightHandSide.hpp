@@ -12,7 +12,9 @@
 #include "dataBlock.hpp"
 #include "gravity.hpp"
 
-template<typename Phys, int dir>
+// uniformGrid: specialisation for uniform cartesian grids, where the metric terms are
+// constants that are kept as scalars instead of being loaded from memory in every cell
+template<typename Phys, int dir, bool uniformGrid>
 struct Fluid_CorrectFluxFunctor {
   // Correct the flux to take into account non-cartesian geometries and Fargo
   //*****************************************************************
@@ -28,6 +30,7 @@ struct Fluid_CorrectFluxFunctor {
     x1   = hydro->data->x[IDIR];
     sinx2m   = hydro->data->sinx2m;
     sinx2 = hydro->data->sinx2;
+    if constexpr(uniformGrid) uniformA = hydro->data->uniformA[dir];
 
     this->dt = dt;
     // Fargo
@@ -61,6 +64,7 @@ struct Fluid_CorrectFluxFunctor {
   IdefixArray1D<real> x1;
   IdefixArray1D<real> sinx2m;
   IdefixArray1D<real> sinx2;
+  real uniformA;
 
   // Fargo
   IdefixArray2D<real> fargoVelocity;
@@ -154,7 +158,13 @@ struct Fluid_CorrectFluxFunctor {
       //////////////////////////////////////////////
 
       real Ax[Phys::nvar]; // corrected Area
-      for(int nv = 0 ; nv < Phys::nvar ; nv++) Ax[nv] = A(k,j,i);
+      real area;
+      if constexpr(uniformGrid) {
+        area = uniformA;
+      } else {
+        area = A(k,j,i);
+      }
+      for(int nv = 0 ; nv < Phys::nvar ; nv++) Ax[nv] = area;
 
       // Curvature terms
       #if    (GEOMETRY == POLAR       && COMPONENTS >= 2) \
@@ -197,7 +207,7 @@ struct Fluid_CorrectFluxFunctor {
 
 
 
-template<typename Phys, int dir>
+template<typename Phys, int dir, bool uniformGrid>
 struct Fluid_CalcRHSFunctor {
   //*****************************************************************
   // Functor constructor
@@ -221,6 +231,10 @@ struct Fluid_CalcRHSFunctor {
     cMax = hydro->cMax;
     dMax = hydro->dMax;
     this->dt = dt;
+    if constexpr(uniformGrid) {
+      uniformDtdV = dt / hydro->data->uniformdV;
+      uniformDl = hydro->data->uniformDx[dir];
+    }
 
     // Grid coarsening
     if(hydro->data->haveGridCoarsening) {
@@ -289,6 +303,10 @@ struct Fluid_CalcRHSFunctor {
   IdefixArray3D<real> dMax;
   IdefixArray4D<real> viscSrc;
 
+  // Uniform grids
+  real uniformDtdV;
+  real uniformDl;
+
   // Grid coarsening
   bool haveGridCoarsening{false};
   IdefixArray2D<int> coarseningLevel;
@@ -335,7 +353,12 @@ struct Fluid_CalcRHSFunctor {
     const int joffset = (dir==JDIR) ? 1 : 0;
     const int koffset = (dir==KDIR) ? 1 : 0;
 
-    real dtdV=dt / dV(k,j,i);
+    real dtdV;
+    if constexpr(uniformGrid) {
+      dtdV = uniformDtdV;
+    } else {
+      dtdV = dt / dV(k,j,i);
+    }
     real rhs[Phys::nvar];
 
     #pragma unroll
@@ -426,7 +449,12 @@ struct Fluid_CalcRHSFunctor {
 
     // elmentary length for gradient computations
     const int ig = ioffset*i + joffset*j + koffset*k;
-    real dl = dx(ig);
+    real dl;
+    if constexpr(uniformGrid) {
+      dl = uniformDl;
+    } else {
+      dl = dx(ig);
+    }
     #if GEOMETRY == POLAR
       if constexpr (dir==JDIR)
         dl = dl*x1(i);
@@ -557,7 +585,24 @@ void Fluid<Phys>::CalcRightHandSide(real t, real dt) {
     data->fargo->GetFargoVelocity(t);
   }
 
-  auto fluxCorrection = Fluid_CorrectFluxFunctor<Phys,dir>(this,dt);
+  #if GEOMETRY == CARTESIAN
+    if(data->haveUniformGrid) {
+      CalcRightHandSideKernels<dir,true>(t, dt);
+    } else {
+      CalcRightHandSideKernels<dir,false>(t, dt);
+    }
+  #else
+    CalcRightHandSideKernels<dir,false>(t, dt);
+  #endif
+
+  idfx::popRegion();
+}
+
+// Flux correction and divergence, with scalar metric terms on uniform grids (uniformGrid)
+template<typename Phys>
+template<int dir, bool uniformGrid>
+void Fluid<Phys>::CalcRightHandSideKernels(real t, real dt) {
+  auto fluxCorrection = Fluid_CorrectFluxFunctor<Phys,dir,uniformGrid>(this,dt);
 
   /////////////////////////////////////////////////////////////////////////////
   // Flux correction (for fargo/non-cartesian geometry)
@@ -575,17 +620,14 @@ void Fluid<Phys>::CalcRightHandSide(real t, real dt) {
   // If user has requested specific flux functions for the boundaries, here they come
   if(boundary->haveFluxBoundary) boundary->EnforceFluxBoundaries(dir,t);
 
-  auto calcRHS = Fluid_CalcRHSFunctor<Phys,dir>(this,dt);
+  auto calcRHS = Fluid_CalcRHSFunctor<Phys,dir,uniformGrid>(this,dt);
   /////////////////////////////////////////////////////////////////////////////
   // Final conserved quantity budget from fluxes divergence
   /////////////////////////////////////////////////////////////////////////////
-  idefix_for("CalcRightHandSide",
+  idefix_for(rhsName,
              data->beg[KDIR],data->end[KDIR],
              data->beg[JDIR],data->end[JDIR],
              data->beg[IDIR],data->end[IDIR],
               calcRHS);
-
-
-  idfx::popRegion();
 }
 #endif // FLUID_CALCRIGHTHANDSIDE_HPP_
@@ -33,16 +33,8 @@ void ConstrainedTransport<Phys>::CalcNonidealEMF(real t) {
   HydroModuleStatus resistivity = hydro->resistivityStatus.status;
   HydroModuleStatus ambipolar = hydro->ambipolarStatus.status;
 
-  bool haveResistivity{false};
-  bool haveAmbipolar{false};
-
-  if(data->rklCycle) {
-    haveResistivity = hydro->resistivityStatus.isRKL;
-    haveAmbipolar = hydro->ambipolarStatus.isRKL;
-  } else {
-    haveResistivity = hydro->resistivityStatus.isExplicit;
-    haveAmbipolar = hydro->ambipolarStatus.isExplicit;
-  }
+  bool haveResistivity = hydro->resistivityStatus.IsActive(data->rklCycle, data->implicitCycle);
+  bool haveAmbipolar = hydro->ambipolarStatus.IsActive(data->rklCycle, data->implicitCycle);
 
   real etaConstant = hydro->etaO;
   real xAConstant = hydro->xA;
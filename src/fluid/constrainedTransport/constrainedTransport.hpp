@@ -70,6 +70,7 @@ class ConstrainedTransport {
   IdefixArray2D<real>     sbEyL;
   IdefixArray2D<real>     sbEyR;
   IdefixArray2D<real>     sbEyRL;
+  IdefixArray2D<real>     sbEyW;      // Shifted X2 strip (see ShearingRemap)
 
   // Range of existence
 
@@ -170,7 +171,7 @@ ConstrainedTransport<Phys>::ConstrainedTransport(Input &input, Fluid<Phys> *hydr
       IDEFIX_ERROR("Unknown EMF averaging scheme");
     }
   } else {
-    if(hydro->hallStatus.status == HydroModuleStatus::Disabled) {
+    if(!hydro->hallStatus.isExplicit) {
       // by default, use uct_contact
       this->averaging = uct_contact;
     } else {
@@ -186,6 +187,7 @@ ConstrainedTransport<Phys>::ConstrainedTransport(Input &input, Fluid<Phys> *hydr
     sbEyL = IdefixArray2D<real>("EMF_sbEyL", data->np_tot[KDIR], data->np_tot[JDIR]);
     sbEyR = IdefixArray2D<real>("EMF_sbEyR", data->np_tot[KDIR], data->np_tot[JDIR]);
     sbEyRL = IdefixArray2D<real>("EMF_sbEyRL", data->np_tot[KDIR], data->np_tot[JDIR]);
+    sbEyW = IdefixArray2D<real>("EMF_sbEyW", data->np_tot[KDIR], data->np_tot[JDIR]+4);
   }
 
   D_EXPAND( ez = IdefixArray3D<real>("EMF_ez",
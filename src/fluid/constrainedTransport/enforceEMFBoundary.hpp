@@ -36,8 +36,9 @@ void ConstrainedTransport<Phys>::EnforceEMFBoundary() {
   #ifdef ENFORCE_EMF_CONSISTENCY
     #ifdef WITH_MPI
       // This average the EMFs at the domain surface with immediate neighbours
-      // to ensure the EMFs exactly match
-      this->ExchangeAll();
+      // to ensure the EMFs exactly match. With deep halos, the intermediate stages
+      // evolve the overlap on both sides, so this is only done on the last stage.
+      if(!data->activeDomainExtended) this->ExchangeAll();
     #endif
   #endif
 
@@ -137,7 +138,6 @@ void ConstrainedTransport<Phys>::SymmetrizeEMFShearingBox() {
                             });
     }
 
-    // todo: exchange sbEyR and sbEyL when domain-decomposed along y
     #ifdef WITH_MPI
       if(data->mygrid->nproc[IDIR]>1) {
         int procLeft, procRight;
@@ -192,11 +192,7 @@ template<typename Phys>
 void ConstrainedTransport<Phys>::ExtrapolateEMFShearingBox(BoundarySide side,
                                                    IdefixArray2D<real> Ein,
                                                    IdefixArray2D<real> Eout) {
-  const int nxi = data->np_int[IDIR];
-  const int nxj = data->np_int[JDIR];
-
-  const int ighost = data->nghost[IDIR];
-  const int jghost = data->nghost[JDIR];
+  IdefixArray2D<real> Ew = this->sbEyW;
 
   // Shear rate
   const real S  = hydro->sbS;
@@ -220,16 +216,22 @@ void ConstrainedTransport<Phys>::ExtrapolateEMFShearingBox(BoundarySide side,
   // remainding shift
   const real eps = dL / dy - m;
 
+  // Gather the strips shifted by m cells, which can belong to other processes along X2.
+  // The edge j is remapped from the window point jo=j+2.
+  hydro->boundary->sbRemap.Gather(m, data->np_tot[KDIR],
+    KOKKOS_LAMBDA (int k, int j) {
+      return Ein(k,j);
+    },
+    KOKKOS_LAMBDA (int k, int w, real value) {
+      Ew(k,w) = value;
+    });
+
   // New we need to perform the shift
   idefix_for("BoundaryShearingBoxEMF", 0, data->np_tot[KDIR],
                                        0, data->np_tot[JDIR],
         KOKKOS_LAMBDA (int k, int j) {
           // jorigin
-          const int jo = jghost + ((j-m-jghost)%nxj+nxj)%nxj;
-          const int jop2 = jghost + ((jo+2-jghost)%nxj+nxj)%nxj;
-          const int jop1 = jghost + ((jo+1-jghost)%nxj+nxj)%nxj;
-          const int jom1 = jghost + ((jo-1-jghost)%nxj+nxj)%nxj;
-          const int jom2 = jghost + ((jo-2-jghost)%nxj+nxj)%nxj;
+          const int jo = j+2;
 
           // Define Left and right fluxes
           // Fluxes are defined from slope-limited interpolation
@@ -239,32 +241,32 @@ void ConstrainedTransport<Phys>::ExtrapolateEMFShearingBox(BoundarySide side,
 
           if(eps>=ZERO_F) {
             // Compute Fl
-            dqm = Ein(k,jom1) - Ein(k,jom2);
-            dqp = Ein(k,jo) - Ein(k,jom1);
+            dqm = Ew(k,jo-1) - Ew(k,jo-2);
+            dqp = Ew(k,jo) - Ew(k,jo-1);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fl = Ein(k,jom1) + 0.5*dq*(1.0-eps);
+            Fl = Ew(k,jo-1) + 0.5*dq*(1.0-eps);
             //Compute Fr
             dqm=dqp;
-            dqp = Ein(k,jop1) - Ein(k,jo);
+            dqp = Ew(k,jo+1) - Ew(k,jo);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fr = Ein(k,jo) + 0.5*dq*(1.0-eps);
+            Fr = Ew(k,jo) + 0.5*dq*(1.0-eps);
           } else {
             //Compute Fl
-            dqm = Ein(k,jo) - Ein(k,jom1);
-            dqp = Ein(k,jop1) - Ein(k,jo);
+            dqm = Ew(k,jo) - Ew(k,jo-1);
+            dqp = Ew(k,jo+1) - Ew(k,jo);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fl = Ein(k,jo) - 0.5*dq*(1.0+eps);
+            Fl = Ew(k,jo) - 0.5*dq*(1.0+eps);
             // Compute Fr
             dqm=dqp;
-            dqp = Ein(k,jop2) - Ein(k,jop1);
+            dqp = Ew(k,jo+2) - Ew(k,jo+1);
             dq = (dqp*dqm > ZERO_F ? TWO_F*dqp*dqm/(dqp + dqm) : ZERO_F);
 
-            Fr = Ein(k,jop1) - 0.5*dq*(1.0+eps);
+            Fr = Ew(k,jo+1) - 0.5*dq*(1.0+eps);
           }
-          Eout(k,j) = Ein(k,jo) - eps*(Fr - Fl);
+          Eout(k,j) = Ew(k,jo) - eps*(Fr - Fl);
         });
 }
 #endif // FLUID_CONSTRAINEDTRANSPORT_ENFORCEEMFBOUNDARY_HPP_
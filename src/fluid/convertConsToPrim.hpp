@@ -120,7 +120,7 @@ void Fluid<Phys>::ConvertConsToPrim() {
     boundary->ReconstructVcField(Uc);
   }
 
-  idefix_for("ConsToPrim",
+  idefix_for(consToPrimName,
              0,data->np_tot[KDIR],
              0,data->np_tot[JDIR],
              0,data->np_tot[IDIR],
@@ -160,7 +160,7 @@ void Fluid<Phys>::ConvertPrimToCons() {
     eos = *(this->eos.get());
   }
 
-  idefix_for("ConvertPrimToCons",
+  idefix_for(primToConsName,
              0,data->np_tot[KDIR],
              0,data->np_tot[JDIR],
              0,data->np_tot[IDIR],
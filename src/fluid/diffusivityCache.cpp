@@ -0,0 +1,122 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#include <string>
+
+#include "diffusivityCache.hpp"
+#include "dataBlock.hpp"
+
+DiffusivityCache::DiffusivityCache(Input &input, std::string blockName, std::string name,
+                                   DataBlock *data, bool havePressure):
+                                   data(data),
+                                   name(name),
+                                   havePressure(havePressure) {
+  const std::string entry = name+"Refresh";
+  if(input.CheckEntry(blockName, entry) < 0) return;
+
+  std::string type = input.Get<std::string>(blockName, entry, 0);
+  if(type.compare("stage") == 0) {
+    policy = Policy::Stage;
+  } else if(type.compare("cycle") == 0) {
+    policy = Policy::Cycle;
+  } else if(type.compare("every") == 0) {
+    policy = Policy::Period;
+    period = input.Get<int>(blockName, entry, 1);
+    if(period < 1) {
+      IDEFIX_ERROR(blockName+":"+entry+" should refresh at least every cycle.");
+    }
+  } else if(type.compare("threshold") == 0) {
+    policy = Policy::Threshold;
+    threshold = input.Get<real>(blockName, entry, 1);
+    Vref = IdefixArray4D<real>("DiffusivityCache_Vref", havePressure ? 2 : 1,
+                                data->np_tot[KDIR], data->np_tot[JDIR], data->np_tot[IDIR]);
+  } else {
+    IDEFIX_ERROR("Unknown refresh policy "+type+" for "+blockName+":"+entry
+                 +". Can only be stage, cycle, every or threshold.");
+  }
+}
+
+void DiffusivityCache::ShowConfig() {
+  switch(policy) {
+    case Policy::Stage:
+      break;
+    case Policy::Cycle:
+      idfx::cout << "DiffusivityCache: " << name << " is refreshed once per cycle." << std::endl;
+      break;
+    case Policy::Period:
+      idfx::cout << "DiffusivityCache: " << name << " is refreshed every " << period
+                 << " cycles." << std::endl;
+      break;
+    case Policy::Threshold:
+      idfx::cout << "DiffusivityCache: " << name << " is refreshed when the flow changes by more "
+                 << "than " << threshold << " in relative value." << std::endl;
+      break;
+  }
+}
+
+bool DiffusivityCache::NeedRefresh(const IdefixArray4D<real> &Vc) {
+  if(!ready) return(true);
+  switch(policy) {
+    case Policy::Stage:
+      return(true);
+    case Policy::Cycle:
+      return(data->cycle != lastRefresh);
+    case Policy::Period:
+      return(data->cycle >= lastRefresh + period);
+    case Policy::Threshold:
+      if(data->cycle == lastCheck) return(false);
+      lastCheck = data->cycle;
+      return(MaxRelativeChange(Vc) > threshold);
+  }
+  return(true);
+}
+
+void DiffusivityCache::Refreshed(const IdefixArray4D<real> &Vc) {
+  if(policy == Policy::Threshold) {
+    IdefixArray4D<real> Vref = this->Vref;
+    const bool havePressure = this->havePressure;
+    idefix_for("DiffusivityCache::StoreReference",
+               0, data->np_tot[KDIR],
+               0, data->np_tot[JDIR],
+               0, data->np_tot[IDIR],
+      KOKKOS_LAMBDA(int k, int j, int i) {
+        Vref(0,k,j,i) = Vc(RHO,k,j,i);
+        #if HAVE_ENERGY
+          if(havePressure) Vref(1,k,j,i) = Vc(PRS,k,j,i);
+        #endif
+      });
+    lastCheck = data->cycle;
+  }
+  lastRefresh = data->cycle;
+  ready = true;
+  nRefresh++;
+}
+
+// Maximum relative change of the density (and pressure) since the last refresh
+real DiffusivityCache::MaxRelativeChange(const IdefixArray4D<real> &Vc) {
+  IdefixArray4D<real> Vref = this->Vref;
+  const bool havePressure = this->havePressure;
+  real change = 0;
+  idefix_reduce("DiffusivityCache::MaxRelativeChange",
+                data->beg[KDIR], data->end[KDIR],
+                data->beg[JDIR], data->end[JDIR],
+                data->beg[IDIR], data->end[IDIR],
+    KOKKOS_LAMBDA(int k, int j, int i, real &localMax) {
+      real delta = std::fabs(Vc(RHO,k,j,i)/Vref(0,k,j,i) - ONE_F);
+      #if HAVE_ENERGY
+        if(havePressure) delta = std::fmax(delta, std::fabs(Vc(PRS,k,j,i)/Vref(1,k,j,i) - ONE_F));
+      #endif
+      localMax = std::fmax(localMax, delta);
+    },
+    Kokkos::Max<real>(change));
+
+  // All the ranks refresh together, so that the user function can be collective
+  #ifdef WITH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &change, 1, realMPI, MPI_MAX, MPI_COMM_WORLD);
+  #endif
+  return(change);
+}
@@ -0,0 +1,68 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#ifndef FLUID_DIFFUSIVITYCACHE_HPP_
+#define FLUID_DIFFUSIVITYCACHE_HPP_
+
+#include <string>
+#include "idefix.hpp"
+#include "input.hpp"
+
+class DataBlock;
+
+// Decides when the arrays filled by a user-defined diffusivity function are refreshed.
+// The policy is read from the entry <name>Refresh of the fluid block:
+//   stage            : at each evaluation (default, including each RKL stage)
+//   cycle            : once per cycle, shared by the explicit, RKL and implicit integrators
+//   every N          : once every N cycles
+//   threshold eps    : once the density (or pressure) changed by more than eps in relative
+//                      value anywhere since the last refresh (checked once per cycle)
+class DiffusivityCache {
+ public:
+  enum class Policy {Stage, Cycle, Period, Threshold};
+
+  DiffusivityCache() = default;
+  DiffusivityCache(Input &, std::string blockName, std::string name, DataBlock *,
+                   bool havePressure);
+
+  void ShowConfig();
+
+  // Call refreshFunc to recompute the cached diffusivities when they are outdated
+  template <typename F>
+  void Refresh(const IdefixArray4D<real> &Vc, F refreshFunc);
+
+  int64_t nRefresh{0};         // # of refreshes done so far
+
+ private:
+  bool NeedRefresh(const IdefixArray4D<real> &);
+  real MaxRelativeChange(const IdefixArray4D<real> &);
+  void Refreshed(const IdefixArray4D<real> &);
+
+  DataBlock *data{nullptr};
+  std::string name;
+  Policy policy{Policy::Stage};
+  int period{1};
+  real threshold{0};
+  bool havePressure{false};
+
+  bool ready{false};           // whether the arrays have been filled at least once
+  int64_t lastRefresh{0};      // cycle of the last refresh
+  int64_t lastCheck{-1};       // cycle of the last threshold check
+
+  IdefixArray4D<real> Vref;    // Density (and pressure) at the last refresh
+};
+
+template <typename F>
+void DiffusivityCache::Refresh(const IdefixArray4D<real> &Vc, F refreshFunc) {
+  if(!NeedRefresh(Vc)) return;
+  idfx::pushRegion("DiffusivityCache::Refresh("+name+")");
+  refreshFunc();
+  Refreshed(Vc);
+  idfx::popRegion();
+}
+
+#endif // FLUID_DIFFUSIVITYCACHE_HPP_
@@ -43,9 +43,9 @@ void Fluid<Phys>::EvolveStage(const real t, const real dt) {
   // Compute current when needed
   if(needExplicitCurrent) CalcCurrent();
 
-  if(hallStatus.status == UserDefFunction) {
+  if(hallStatus.isExplicit && hallStatus.status == UserDefFunction) {
     if(hallDiffusivityFunc)
-      hallDiffusivityFunc(*data, t, xHall);
+      hallCache.Refresh(Vc, [&]() { hallDiffusivityFunc(*data, t, xHall); });
     else
       IDEFIX_ERROR("No user-defined Hall diffusivity function has been enrolled");
   }
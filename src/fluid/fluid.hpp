@@ -15,7 +15,9 @@
 #include "idefix.hpp"
 #include "grid.hpp"
 #include "fluid_defs.hpp"
+#include "profiler.hpp"
 #include "eos.hpp"
+#include "diffusivityCache.hpp"
 #include "thermalDiffusion.hpp"
 #include "bragThermalDiffusion.hpp"
 #include "selfGravity.hpp"
@@ -36,6 +38,12 @@ class ConstrainedTransport;
 template<typename Phys>
 class RKLegendre;
 
+template<typename Phys>
+class ImplicitParabolic;
+
+template<typename Phys>
+class HallSubcycle;
+
 template<typename Phys>
 class RiemannSolver;
 
@@ -57,8 +65,9 @@ class Fluid {
   void ConvertConsToPrim();
   void ConvertPrimToCons();
   template <int> void CalcParabolicFlux(const real);
-  template <int> void AddNonIdealMHDFlux(const real);
+  template <int> void AddNonIdealMHDFlux(const real, bool);
   template <int> void CalcRightHandSide(real, real );
+  template <int, bool> void CalcRightHandSideKernels(real, real);
   void CalcCurrent();
   void AddSourceTerms(real, real );
   void CoarsenFlow(IdefixArray4D<real>&);
@@ -82,13 +91,19 @@ class Fluid {
   // Parabolic terms
   bool haveExplicitParabolicTerms{false};
   bool haveRKLParabolicTerms{false};
+  bool haveImplicitParabolicTerms{false};
 
   std::unique_ptr<RKLegendre<Phys>> rkl;
+  std::unique_ptr<ImplicitParabolic<Phys>> implicit;
+
+  // Operator-split Hall effect
+  std::unique_ptr<HallSubcycle<Phys>> hallSubcycle;
 
   // Current
   bool haveCurrent{false};
   bool needExplicitCurrent{false};
   bool needRKLCurrent{false};
+  bool needImplicitCurrent{false};
 
   // Nonideal MHD effects coefficients
   ParabolicModuleStatus resistivityStatus, ambipolarStatus, hallStatus;
@@ -193,10 +208,17 @@ class Fluid {
   std::string prefix;
   int instanceNumber;
 
+  // Names of the main kernels, which are passed to each launch and so only built once. They are
+  // qualified by the fluid type (not by the instance), like their traffic estimates.
+  const std::string consToPrimName{std::string(Phys::prefix)+"::ConsToPrim"};
+  const std::string primToConsName{std::string(Phys::prefix)+"::ConvertPrimToCons"};
+  const std::string rhsName{std::string(Phys::prefix)+"::CalcRightHandSide"};
+
  private:
   friend class ConstrainedTransport<Phys>;
   friend class Fargo;
   friend class RKLegendre<Phys>;
+  friend class HallSubcycle<Phys>;
   friend class Boundary<Phys>;
   friend class ShockFlattening<Phys>;
   friend class RiemannSolver<Phys>;
@@ -209,10 +231,10 @@ class Fluid {
   template <typename P>
   friend struct Fluid_AddSourceTermsFunctor;
 
-  template <typename P, int dir>
+  template <typename P, int dir, bool uniformGrid>
   friend struct Fluid_CorrectFluxFunctor;
 
-  template <typename P, int dir>
+  template <typename P, int dir, bool uniformGrid>
   friend struct Fluid_CalcRHSFunctor;
 
   template<typename P>
@@ -234,6 +256,11 @@ class Fluid {
   DiffusivityFunc ambipolarDiffusivityFunc{NULL};
   DiffusivityFunc hallDiffusivityFunc{NULL};
 
+  // Refresh policies of the function-defined nonideal diffusivities
+  DiffusivityCache ohmicCache;
+  DiffusivityCache ambipolarCache;
+  DiffusivityCache hallCache;
+
   IdefixArray3D<real> cMax;    // Maximum propagation speed
 
   // Nonideal effect diffusion coefficient (only allocated when needed)
@@ -252,6 +279,8 @@ class Fluid {
 #include "constrainedTransport.hpp"
 #include "axis.hpp"
 #include "rkl.hpp"
+#include "implicitParabolic.hpp"
+#include "hallSubcycle.hpp"
 #include "riemannSolver.hpp"
 #include "viscosity.hpp"
 #include "bragViscosity.hpp"
@@ -351,6 +380,9 @@ Fluid<Phys>::Fluid(Grid &grid, Input &input, DataBlock *datain, int n) {
     } else if(opType.compare("rkl") == 0 ) {
       haveRKLParabolicTerms = true;
       viscosityStatus.isRKL = true;
+    } else if(opType.compare("implicit") == 0 ) {
+      haveImplicitParabolicTerms = true;
+      viscosityStatus.isImplicit = true;
     } else {
       std::stringstream msg;
       msg  << "Unknown integration type for viscosity: " << opType;
@@ -377,6 +409,9 @@ Fluid<Phys>::Fluid(Grid &grid, Input &input, DataBlock *datain, int n) {
     } else if(opType.compare("rkl") == 0 ) {
       haveRKLParabolicTerms = true;
       thermalDiffusionStatus.isRKL = true;
+    } else if(opType.compare("implicit") == 0 ) {
+      haveImplicitParabolicTerms = true;
+      thermalDiffusionStatus.isImplicit = true;
     } else {
       std::stringstream msg;
       msg  << "Unknown integration type for thermal diffusion: " << opType;
@@ -403,6 +438,9 @@ Fluid<Phys>::Fluid(Grid &grid, Input &input, DataBlock *datain, int n) {
     } else if(opType.compare("rkl") == 0 ) {
       haveRKLParabolicTerms = true;
       bragViscosityStatus.isRKL = true;
+    } else if(opType.compare("implicit") == 0 ) {
+      haveImplicitParabolicTerms = true;
+      bragViscosityStatus.isImplicit = true;
     } else {
       std::stringstream msg;
       msg  << "Unknown integration type for braginskii viscosity: " << opType;
@@ -421,6 +459,9 @@ Fluid<Phys>::Fluid(Grid &grid, Input &input, DataBlock *datain, int n) {
     } else if(opType.compare("rkl") == 0 ) {
       haveRKLParabolicTerms = true;
       bragThermalDiffusionStatus.isRKL = true;
+    } else if(opType.compare("implicit") == 0 ) {
+      haveImplicitParabolicTerms = true;
+      bragThermalDiffusionStatus.isImplicit = true;
     } else {
       std::stringstream msg;
       msg  << "Unknown integration type for braginskii thermal diffusion: " << opType;
@@ -450,6 +491,10 @@ Fluid<Phys>::Fluid(Grid &grid, Input &input, DataBlock *datain, int n) {
           haveRKLParabolicTerms = true;
           resistivityStatus.isRKL = true;
           needRKLCurrent = true;
+        } else if(opType.compare("implicit") == 0 ) {
+          haveImplicitParabolicTerms = true;
+          resistivityStatus.isImplicit = true;
+          needImplicitCurrent = true;
         } else {
           std::stringstream msg;
           msg  << "Unknown integration type for resistivity: " << opType;
@@ -478,6 +523,10 @@ Fluid<Phys>::Fluid(Grid &grid, Input &input, DataBlock *datain, int n) {
           haveRKLParabolicTerms = true;
           ambipolarStatus.isRKL = true;
           needRKLCurrent = true;
+        } else if(opType.compare("implicit") == 0 ) {
+          haveImplicitParabolicTerms = true;
+          ambipolarStatus.isImplicit = true;
+          needImplicitCurrent = true;
         } else {
           std::stringstream msg;
           msg  << "Unknown integration type for ambipolar: " << opType;
@@ -501,6 +550,8 @@ Fluid<Phys>::Fluid(Grid &grid, Input &input, DataBlock *datain, int n) {
         if(opType.compare("explicit") == 0 ) {
           hallStatus.isExplicit = true;
           needExplicitCurrent = true;
+        } else if(opType.compare("subcycle") == 0 ) {
+          hallStatus.isSubcycled = true;
         } else if(opType.compare("rkl") == 0 ) {
           IDEFIX_ERROR("RKL inegration is incompatible with Hall");
         } else {
@@ -576,6 +627,16 @@ Fluid<Phys>::Fluid(Grid &grid, Input &input, DataBlock *datain, int n) {
     xHall = IdefixArray3D<real>(prefix+"_xHall",
                                   data->np_tot[KDIR], data->np_tot[JDIR], data->np_tot[IDIR]);
 
+  if(this->resistivityStatus.status == UserDefFunction)
+    ohmicCache = DiffusivityCache(input, std::string(Phys::prefix), "resistivity", data,
+                                   Phys::pressure);
+  if(this->ambipolarStatus.status == UserDefFunction)
+    ambipolarCache = DiffusivityCache(input, std::string(Phys::prefix), "ambipolar", data,
+                                       Phys::pressure);
+  if(this->hallStatus.status == UserDefFunction)
+    hallCache = DiffusivityCache(input, std::string(Phys::prefix), "hall", data,
+                                  Phys::pressure);
+
   // Fill the names of the fields
   std::string outputPrefix("");
   // If we have hydro, the output prefix is "" for backward compatibility
@@ -703,6 +764,13 @@ Fluid<Phys>::Fluid(Grid &grid, Input &input, DataBlock *datain, int n) {
     // Initialise Riemann Solver
   this->rSolver = std::make_unique<RiemannSolver<Phys>>(input, this);
 
+  // Estimated cost per cell of the main kernels, used by kernel profiling
+  // (bytes read/written from memory assuming perfect cache reuse, rough flops count)
+  // Kernel names are qualified by the fluid prefix, so that gas and dust entries are kept apart
+  idfx::prof.SetKernelTraffic(consToPrimName, 2*Phys::nvar*sizeof(real), 5*Phys::nvar);
+  idfx::prof.SetKernelTraffic(primToConsName, 2*Phys::nvar*sizeof(real), 4*Phys::nvar);
+  idfx::prof.SetKernelTraffic(rhsName, (3*Phys::nvar+2)*sizeof(real), 6*Phys::nvar);
+
   if constexpr(Phys::mhd) {
     this->emf = std::make_unique<ConstrainedTransport<Phys>>(input, this);
   }
@@ -719,6 +787,12 @@ Fluid<Phys>::Fluid(Grid &grid, Input &input, DataBlock *datain, int n) {
   if(haveRKLParabolicTerms) {
     this->rkl = std::make_unique<RKLegendre<Phys>>(input,this);
   }
+  if(haveImplicitParabolicTerms) {
+    this->implicit = std::make_unique<ImplicitParabolic<Phys>>(input,this);
+  }
+  if(hallStatus.isSubcycled) {
+    this->hallSubcycle = std::make_unique<HallSubcycle<Phys>>(input,this);
+  }
 
   // Thermal diffusion
   if(thermalDiffusionStatus.status != Disabled ) {
@@ -33,6 +33,16 @@ struct ParabolicModuleStatus {
   HydroModuleStatus status{Disabled};
   bool isExplicit{false};
   bool isRKL{false};
+  bool isImplicit{false};
+  bool isSubcycled{false};        // Operator-split subcycling (Hall effect only)
+
+  // Whether the term should be computed in the current step: the explicit terms in the main
+  // integration loop, the others in the RKL or implicit cycle that integrates them.
+  bool IsActive(bool rklCycle, bool implicitCycle) const {
+    if(rklCycle) return(isRKL);
+    if(implicitCycle) return(isImplicit);
+    return(isExplicit);
+  }
 };
 
 
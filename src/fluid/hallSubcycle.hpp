@@ -0,0 +1,330 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#ifndef FLUID_HALLSUBCYCLE_HPP_
+#define FLUID_HALLSUBCYCLE_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include "idefix.hpp"
+#include "input.hpp"
+#include "fluid_defs.hpp"
+#ifdef WITH_MPI
+#include "mpi.hpp"
+#endif
+
+// Operator-split integration of the Hall term in the induction equation. When the Hall
+// effect is "subcycle"d, it is removed from the Riemann solver (so that the whistler speed
+// no longer limits the hydro timestep), and the field is instead advanced here by dt with
+// the constrained transport EMF E = xH J x B, in a series of substeps set by the whistler
+// CFL condition
+//      dt_hall = cfl / max(|xH| |B| sum_dir 1/dl^2)
+// Each substep uses the 3rd order SSP Runge-Kutta scheme, whose stability region includes
+// the imaginary axis (whistlers are not damped by the spatial scheme, unlike with the HLL
+// fan). Only the magnetic field is evolved: the gas pressure is left unchanged.
+template<typename Phys>
+class HallSubcycle {
+ public:
+  HallSubcycle(Input &, Fluid<Phys>*);
+  void Cycle();
+  void ShowConfig();
+
+  real dt{std::numeric_limits<real>::max()};  // Hall substep of the last cycle
+  int nsubsteps{0};                           // # of substeps of the last cycle
+  real cfl{0.3};                              // Hall CFL number
+  real rmax{100.0};                           // Maximum ratio between dt and the Hall substep
+
+ private:
+  void ComputeDt();
+  void CalcEMF();
+  void UpdateDiffusivity(real);
+  void SetBoundaries(real);       // Enforce boundary conditions on the magnetic field
+  void AddAndStore(real, real);   // B = wc B + w0 B0
+
+  bool checkNan{false};
+
+  IdefixArray4D<real> Vs0;        // Field (or vector potential) at the beginning of the substep
+
+  DataBlock *data;
+  Fluid<Phys> *hydro;
+
+#ifdef WITH_MPI
+  Mpi mpi;                        // MPI layer exchanging only Vs
+#endif
+};
+
+#include "fluid.hpp"
+#include "dataBlock.hpp"
+
+template<typename Phys>
+HallSubcycle<Phys>::HallSubcycle(Input &input, Fluid<Phys> *hydroin) {
+  idfx::pushRegion("HallSubcycle::HallSubcycle");
+  // The Hall EMF of the substeps is only implemented for the three components of the current
+  #if DIMENSIONS < 3
+    IDEFIX_ERROR("Hall subcycling requires DIMENSIONS=3");
+  #endif
+  this->data = hydroin->data;
+  this->hydro = hydroin;
+
+  this->cfl = input.GetOrSet<real>("Hall","cfl",0, this->cfl);
+  this->rmax = input.GetOrSet<real>("Hall","rmax",0, this->rmax);
+  this->checkNan = input.GetOrSet<bool>("Hall","check_nan",0, this->checkNan);
+
+  #ifdef WITH_MPI
+    std::vector<int> varListHost;   // No cell-centered variable is exchanged
+    mpi.Init(data->mygrid, varListHost, data->nghost.data(), data->np_int.data(), true);
+  #endif
+
+  #ifdef EVOLVE_VECTOR_POTENTIAL
+    Vs0 = IdefixArray4D<real>("HallSubcycle_Ve0", hydro->Ve.extent(0),
+                              hydro->Ve.extent(1), hydro->Ve.extent(2), hydro->Ve.extent(3));
+  #else
+    Vs0 = IdefixArray4D<real>("HallSubcycle_Vs0", hydro->Vs.extent(0),
+                              hydro->Vs.extent(1), hydro->Vs.extent(2), hydro->Vs.extent(3));
+  #endif
+  idfx::popRegion();
+}
+
+template<typename Phys>
+void HallSubcycle<Phys>::ShowConfig() {
+  idfx::cout << "HallSubcycle: Hall cfl set to " << cfl <<  "." << std::endl;
+  idfx::cout << "HallSubcycle: maximum number of substeps per cycle " << rmax <<  "."
+             << std::endl;
+  if(checkNan) {
+    idfx::cout << "HallSubcycle: will check consistency of solution in the integrator (slow!)."
+               << std::endl;
+  }
+}
+
+template<typename Phys>
+void HallSubcycle<Phys>::Cycle() {
+  idfx::pushRegion("HallSubcycle::Cycle");
+  real time = data->t;
+  const real dtCycle = data->dt;
+
+  // Apply Boundary conditions on the full set of variables
+  hydro->boundary->SetBoundaries(time);
+  UpdateDiffusivity(time);
+
+  ComputeDt();
+  nsubsteps = std::max(1, static_cast<int>(std::ceil(dtCycle/dt)));
+  const real dtSub = dtCycle/nsubsteps;
+
+  // SSP-RK3 weights of the previous stage (wc) and of the substep initial state (w0)
+  const real wc[3] = {ONE_F, 0.25, 2.0/3.0};
+  const real w0[3] = {ZERO_F, 0.75, 1.0/3.0};
+  const real tStage[3] = {ZERO_F, ONE_F, HALF_F};
+
+  for(int n = 0 ; n < nsubsteps ; n++) {
+    #ifdef EVOLVE_VECTOR_POTENTIAL
+      Kokkos::deep_copy(Vs0, hydro->Ve);
+    #else
+      Kokkos::deep_copy(Vs0, hydro->Vs);
+    #endif
+    for(int stage = 0 ; stage < 3 ; stage++) {
+      const real t = time + tStage[stage]*dtSub;
+      if(n > 0 || stage > 0) {
+        SetBoundaries(t);
+        UpdateDiffusivity(t);
+      }
+      hydro->CalcCurrent();
+      CalcEMF();
+      hydro->emf->EnforceEMFBoundary();
+      #ifdef EVOLVE_VECTOR_POTENTIAL
+        hydro->emf->EvolveVectorPotential(dtSub, hydro->Ve);
+        if(stage > 0) AddAndStore(wc[stage], w0[stage]);
+        hydro->emf->ComputeMagFieldFromA(hydro->Ve, hydro->Vs);
+      #else
+        hydro->emf->EvolveMagField(t, dtSub, hydro->Vs);
+        if(stage > 0) AddAndStore(wc[stage], w0[stage]);
+      #endif
+    }
+    time += dtSub;
+  }
+
+  // Remake the cell-centered field
+  hydro->boundary->ReconstructVcField(hydro->Vc);
+
+  if(checkNan) {
+    if(data->CheckNan()>0) {
+      throw std::runtime_error(std::string("Nan found during Hall subcycle"));
+    }
+  }
+  idfx::popRegion();
+}
+
+template<typename Phys>
+void HallSubcycle<Phys>::UpdateDiffusivity(real t) {
+  if(hydro->hallStatus.status == UserDefFunction) {
+    if(hydro->hallDiffusivityFunc)
+      hydro->hallCache.Refresh(hydro->Vc, [&]() {
+        hydro->hallDiffusivityFunc(*data, t, hydro->xHall);
+      });
+    else
+      IDEFIX_ERROR("No user-defined Hall diffusivity function has been enrolled");
+  }
+}
+
+template<typename Phys>
+void HallSubcycle<Phys>::ComputeDt() {
+  idfx::pushRegion("HallSubcycle::ComputeDt");
+#if MHD == YES && DIMENSIONS == 3
+  IdefixArray4D<real> Vc = hydro->Vc;
+  IdefixArray3D<real> xHallArr = hydro->xHall;
+  const bool userDef = (hydro->hallStatus.status == UserDefFunction);
+  const real xHConstant = hydro->xH;
+
+  IdefixArray1D<real> dx1 = data->dx[IDIR];
+  IdefixArray1D<real> dx2 = data->dx[JDIR];
+  IdefixArray1D<real> dx3 = data->dx[KDIR];
+  [[maybe_unused]] IdefixArray1D<real> x1 = data->x[IDIR];
+  [[maybe_unused]] IdefixArray1D<real> rt = data->rt;
+  [[maybe_unused]] IdefixArray1D<real> dmu = data->dmu;
+
+  real invDt = ZERO_F;
+  idefix_reduce("HallSubcycle_Timestep",
+    data->beg[KDIR], data->end[KDIR],
+    data->beg[JDIR], data->end[JDIR],
+    data->beg[IDIR], data->end[IDIR],
+    KOKKOS_LAMBDA (int k, int j, int i, real &invdt) {
+      const real xH = userDef ? xHallArr(k,j,i) : xHConstant;
+      const real B2 = Vc(BX1,k,j,i)*Vc(BX1,k,j,i) + Vc(BX2,k,j,i)*Vc(BX2,k,j,i)
+                    + Vc(BX3,k,j,i)*Vc(BX3,k,j,i);
+      real dl1 = dx1(i);
+      real dl2 = dx2(j);
+      real dl3 = dx3(k);
+      #if GEOMETRY == POLAR
+        dl2 = dl2*x1(i);
+      #elif GEOMETRY == SPHERICAL
+        dl2 = dl2*rt(i);
+        dl3 = dl3*rt(i)*dmu(j)/dx2(j);
+      #endif
+      const real rate = FABS(xH)*std::sqrt(B2)*(ONE_F/(dl1*dl1) + ONE_F/(dl2*dl2)
+                                                + ONE_F/(dl3*dl3));
+      invdt = FMAX(invdt, rate);
+    },
+    Kokkos::Max<real>(invDt));
+
+  #ifdef WITH_MPI
+    if(idfx::psize>1) {
+      MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &invDt, 1, realMPI, MPI_MAX, MPI_COMM_WORLD));
+    }
+  #endif
+
+  // No Hall effect anywhere: a single substep will do
+  dt = (invDt > ZERO_F) ? cfl/invDt : std::numeric_limits<real>::max();
+#endif
+  idfx::popRegion();
+}
+
+// Edge-centered Hall EMFs, using the same averages as the ambipolar EMF
+template<typename Phys>
+void HallSubcycle<Phys>::CalcEMF() {
+  idfx::pushRegion("HallSubcycle::CalcEMF");
+#if MHD == YES && DIMENSIONS == 3
+  IdefixArray3D<real> ex = hydro->emf->ex;
+  IdefixArray3D<real> ey = hydro->emf->ey;
+  IdefixArray3D<real> ez = hydro->emf->ez;
+  IdefixArray4D<real> J = hydro->J;
+  IdefixArray4D<real> Vs = hydro->Vs;
+  IdefixArray3D<real> xHallArr = hydro->xHall;
+  const bool userDef = (hydro->hallStatus.status == UserDefFunction);
+  const real xHConstant = hydro->xH;
+
+  idefix_for("HallSubcycle_CalcEMF",
+             data->beg[KDIR],data->end[KDIR]+KOFFSET,
+             data->beg[JDIR],data->end[JDIR]+JOFFSET,
+             data->beg[IDIR],data->end[IDIR]+IOFFSET,
+    KOKKOS_LAMBDA (int k, int j, int i) {
+      real Bx1, Bx2, Bx3;
+      real Jx1, Jx2, Jx3;
+      real xH = xHConstant;
+
+      // X1 EMF component
+      if(userDef) xH = AVERAGE_3D_YZ(xHallArr,k,j,i);
+      Bx1 = AVERAGE_4D_XYZ(Vs, BX1s, k,j,i+1);
+      Bx2 = AVERAGE_4D_Z(Vs, BX2s, k, j, i);
+      Bx3 = AVERAGE_4D_Y(Vs, BX3s, k, j, i);
+      Jx1 = J(IDIR,k,j,i);
+      Jx2 = AVERAGE_4D_XY(J, JDIR, k, j, i+1);
+      Jx3 = AVERAGE_4D_XZ(J, KDIR, k, j, i+1);
+      ex(k,j,i) = xH * (Jx2*Bx3 - Jx3*Bx2);
+
+      // X2 EMF component
+      if(userDef) xH = AVERAGE_3D_XZ(xHallArr,k,j,i);
+      Bx1 = AVERAGE_4D_Z(Vs, BX1s, k, j, i);
+      Bx2 = AVERAGE_4D_XYZ(Vs, BX2s, k, j+1, i);
+      Bx3 = AVERAGE_4D_X(Vs, BX3s, k, j, i);
+      Jx1 = AVERAGE_4D_XY(J, IDIR, k, j+1, i);
+      Jx2 = J(JDIR,k,j,i);
+      Jx3 = AVERAGE_4D_YZ(J, KDIR, k, j+1, i);
+      ey(k,j,i) = xH * (Jx3*Bx1 - Jx1*Bx3);
+
+      // X3 EMF component
+      if(userDef) xH = AVERAGE_3D_XY(xHallArr,k,j,i);
+      Bx1 = AVERAGE_4D_Y(Vs, BX1s, k, j, i);
+      Bx2 = AVERAGE_4D_X(Vs, BX2s, k, j, i);
+      Bx3 = AVERAGE_4D_XYZ(Vs, BX3s, k+1, j, i);
+      Jx1 = AVERAGE_4D_XZ(J, IDIR, k+1, j, i);
+      Jx2 = AVERAGE_4D_YZ(J, JDIR, k+1, j, i);
+      Jx3 = J(KDIR,k,j,i);
+      ez(k,j,i) = xH * (Jx1*Bx2 - Jx2*Bx1);
+    });
+#endif
+  idfx::popRegion();
+}
+
+template<typename Phys>
+void HallSubcycle<Phys>::AddAndStore(real wc, real w0) {
+  #ifdef EVOLVE_VECTOR_POTENTIAL
+    IdefixArray4D<real> B = hydro->Ve;
+  #else
+    IdefixArray4D<real> B = hydro->Vs;
+  #endif
+  IdefixArray4D<real> B0 = this->Vs0;
+  idefix_for("HallSubcycle_AddAndStore", 0, B.extent(0), 0, B.extent(1),
+                                         0, B.extent(2), 0, B.extent(3),
+    KOKKOS_LAMBDA (int n, int k, int j, int i) {
+      B(n,k,j,i) = wc*B(n,k,j,i) + w0*B0(n,k,j,i);
+    });
+}
+
+template<typename Phys>
+void HallSubcycle<Phys>::SetBoundaries(real t) {
+  idfx::pushRegion("HallSubcycle::SetBoundaries");
+#if MHD == YES
+  if(data->haveGridCoarsening) {
+    hydro->CoarsenMagField(hydro->Vs);
+  }
+  for(int dir=0 ; dir < DIMENSIONS ; dir++ ) {
+    #ifdef WITH_MPI
+    if(data->mygrid->nproc[dir]>1) {
+      switch(dir) {
+        case 0:
+          this->mpi.ExchangeX1(hydro->Vc, hydro->Vs);
+          break;
+        case 1:
+          this->mpi.ExchangeX2(hydro->Vc, hydro->Vs);
+          break;
+        case 2:
+          this->mpi.ExchangeX3(hydro->Vc, hydro->Vs);
+          break;
+      }
+    }
+    #endif
+    hydro->boundary->EnforceBoundaryDir(t, dir);
+    hydro->boundary->ReconstructNormalField(dir);
+  }
+  hydro->boundary->ReconstructVcField(hydro->Vc);
+#endif
+  idfx::popRegion();
+}
+
+#endif // FLUID_HALLSUBCYCLE_HPP_
@@ -62,6 +62,7 @@ void Fluid<Phys>::ShowConfig() {
       if(!ohmicDiffusivityFunc) {
         IDEFIX_ERROR("No user-defined Ihmic resistivity function has been enrolled.");
       }
+      ohmicCache.ShowConfig();
     } else {
       IDEFIX_ERROR("Unknown Ohmic resistivity mode");
     }
@@ -72,6 +73,9 @@ void Fluid<Phys>::ShowConfig() {
       idfx::cout << Phys::prefix
                  << ": Ohmic resistivity uses a Runge-Kutta-Legendre time integration."
                  << std::endl;
+    } else if(resistivityStatus.isImplicit) {
+      idfx::cout << Phys::prefix << ": Ohmic resistivity uses an implicit time integration."
+                 << std::endl;
     } else {
       IDEFIX_ERROR("Unknown time integrator for Ohmic resistivity");
     }
@@ -88,6 +92,7 @@ void Fluid<Phys>::ShowConfig() {
       if(!ambipolarDiffusivityFunc) {
         IDEFIX_ERROR("No user-defined ambipolar diffusion function has been enrolled.");
       }
+      ambipolarCache.ShowConfig();
     } else {
       IDEFIX_ERROR("Unknown Ambipolar diffusion mode");
     }
@@ -98,6 +103,9 @@ void Fluid<Phys>::ShowConfig() {
       idfx::cout << Phys::prefix
                  << ": Ambipolar diffusion uses a Runge-Kutta-Legendre time integration."
                  << std::endl;
+    } else if(ambipolarStatus.isImplicit) {
+      idfx::cout << Phys::prefix << ": Ambipolar diffusion uses an implicit time integration."
+                 << std::endl;
     } else {
       IDEFIX_ERROR("Unknown time integrator for ambipolar diffusion");
     }
@@ -113,11 +121,14 @@ void Fluid<Phys>::ShowConfig() {
       if(!hallDiffusivityFunc) {
         IDEFIX_ERROR("No user-defined Hall diffusivity function has been enrolled.");
       }
+      hallCache.ShowConfig();
     } else {
       IDEFIX_ERROR("Unknown Hall effect mode");
     }
     if(hallStatus.isExplicit) {
       idfx::cout << Phys::prefix << ": Hall effect uses an explicit time integration." << std::endl;
+    } else if(hallStatus.isSubcycled) {
+      idfx::cout << Phys::prefix << ": Hall effect is subcycled." << std::endl;
     }  else {
       IDEFIX_ERROR("Unknown time integrator for Hall effect");
     }
@@ -146,13 +157,20 @@ void Fluid<Phys>::ShowConfig() {
   if(haveRKLParabolicTerms) {
     rkl->ShowConfig();
   }
-  if(viscosityStatus.isExplicit || viscosityStatus.isRKL) {
+  if(haveImplicitParabolicTerms) {
+    implicit->ShowConfig();
+  }
+  if(hallStatus.isSubcycled) {
+    hallSubcycle->ShowConfig();
+  }
+  if(viscosityStatus.isExplicit || viscosityStatus.isRKL || viscosityStatus.isImplicit) {
     viscosity->ShowConfig();
   }
   if(thermalDiffusionStatus.status != Disabled) {
     thermalDiffusion->ShowConfig();
   }
-  if(bragViscosityStatus.isExplicit || bragViscosityStatus.isRKL) {
+  if(bragViscosityStatus.isExplicit || bragViscosityStatus.isRKL
+     || bragViscosityStatus.isImplicit) {
     bragViscosity->ShowConfig();
   }
   if(bragThermalDiffusionStatus.status != Disabled) {
@@ -26,6 +26,7 @@ void ThermalDiffusion::ShowConfig() {
     if(!diffusivityFunc) {
       IDEFIX_ERROR("No thermal diffusion function has been enrolled");
     }
+    kappaCache.ShowConfig();
   } else {
     IDEFIX_ERROR("Unknown thermal diffusion mode");
   }
@@ -34,6 +35,8 @@ void ThermalDiffusion::ShowConfig() {
   } else if(status.isRKL) {
     idfx::cout << "Thermal Diffusion: uses a Runge-Kutta-Legendre time integration."
                 << std::endl;
+  } else if(status.isImplicit) {
+    idfx::cout << "Thermal Diffusion: uses an implicit time integration." << std::endl;
   } else {
     IDEFIX_ERROR("Unknown time integrator for viscosity.");
   }
@@ -47,40 +50,52 @@ void ThermalDiffusion::EnrollThermalDiffusivity(DiffusivityFunc myFunc) {
   this->diffusivityFunc = myFunc;
 }
 
-// This function computes the viscous flux and stores it in hydro->fluxRiemann
-// (this avoids an extra array)
-// Associated source terms, present in non-cartesian geometry are also computed
-// and stored in this->viscSrc for later use (in calcRhs).
-void ThermalDiffusion::AddDiffusiveFlux(int dir, const real t, const IdefixArray4D<real> &Flux) {
-  idfx::pushRegion("ThermalDiffusion::AddDiffusiveFlux");
-  IdefixArray4D<real> Vc = this->Vc;
-  IdefixArray3D<real> dMax = this->dMax;
-  IdefixArray3D<real> kappaArr = this->kappaArr;
-  IdefixArray1D<real> dx = this->data->dx[dir];
-
-  EquationOfState eos = *(this->eos);
+// This function prepares the functor computing the thermal diffusion flux along dir,
+// and computes the user-defined diffusivity when needed.
+ThermalDiffusionFlux ThermalDiffusion::GetFlux(int dir, const real t) {
+  ThermalDiffusionFlux flux;
+  flux.Vc = this->Vc;
+  flux.kappaArr = this->kappaArr;
+  flux.dx = this->data->dx[dir];
+  flux.eos = *(this->eos);
   #if GEOMETRY == POLAR
-    IdefixArray1D<real> x1 = this->data->x[IDIR];
+    flux.x1 = this->data->x[IDIR];
   #endif
   #if GEOMETRY == SPHERICAL
-    IdefixArray1D<real> rt   = this->data->rt;
-    IdefixArray1D<real> dmu  = this->data->dmu;
-    IdefixArray1D<real> dx2 = this->data->dx[JDIR];
+    flux.rt   = this->data->rt;
+    flux.dmu  = this->data->dmu;
+    flux.dx2 = this->data->dx[JDIR];
   #endif
 
-  HydroModuleStatus haveThermalDiffusion = this->status.status;
+  flux.haveThermalDiffusion = this->status.status;
+  flux.kappaConstant = this->kappa;
+  flux.dir = dir;
+  flux.ioffset = (dir==IDIR) ? 1 : 0;
+  flux.joffset = (dir==JDIR) ? 1 : 0;
+  flux.koffset = (dir==KDIR) ? 1 : 0;
 
   // Compute thermal diffusion if needed
-  if(haveThermalDiffusion == UserDefFunction && dir == IDIR) {
+  if(flux.haveThermalDiffusion == UserDefFunction && dir == IDIR) {
     if(diffusivityFunc) {
-      idfx::pushRegion("UserDef::ThermalDiffusivityFunction");
-      diffusivityFunc(*this->data, t, kappaArr);
-      idfx::popRegion();
+      kappaCache.Refresh(Vc, [&]() {
+        idfx::pushRegion("UserDef::ThermalDiffusivityFunction");
+        diffusivityFunc(*this->data, t, kappaArr);
+        idfx::popRegion();
+      });
     } else {
       IDEFIX_ERROR("No user-defined thermal diffusion function has been enrolled");
     }
   }
+  return(flux);
+}
 
+// This function computes the thermal diffusion flux and adds it to Flux.
+// When resetDMax is set, dMax is initialised with the local diffusion coefficient.
+void ThermalDiffusion::AddDiffusiveFlux(int dir, const real t, const IdefixArray4D<real> &Flux,
+                                        bool resetDMax) {
+  idfx::pushRegion("ThermalDiffusion::AddDiffusiveFlux");
+  IdefixArray3D<real> dMax = this->dMax;
+  ThermalDiffusionFlux thermalFlux = GetFlux(dir, t);
 
   int ibeg, iend, jbeg, jend, kbeg, kend;
   ibeg = this->data->beg[IDIR];
@@ -90,60 +105,16 @@ void ThermalDiffusion::AddDiffusiveFlux(int dir, const real t, const IdefixArray
   kbeg = this->data->beg[KDIR];
   kend = this->data->end[KDIR];
 
-  real kappaConstant = this->kappa;
-
   if(dir==IDIR) iend++;
   if(dir==JDIR) jend++;
   if(dir==KDIR) kend++;
 
-  const int ioffset = (dir==IDIR) ? 1 : 0;
-  const int joffset = (dir==JDIR) ? 1 : 0;
-  const int koffset = (dir==KDIR) ? 1 : 0;
-
   idefix_for("ThermalDiffusionFlux",kbeg, kend, jbeg, jend, ibeg, iend,
       KOKKOS_LAMBDA (int k, int j, int i) {
-        // Compute gradT
-        real gradT;
-
-        gradT = Vc(PRS,k,j,i) / Vc(RHO,k,j,i)
-               - Vc(PRS,k-koffset,j-joffset,i-ioffset) / Vc(RHO,k-koffset,j-joffset,i-ioffset);
-
-        // index along dir
-        const int ig = ioffset*i + joffset*j + koffset*k;
-
-        // dx at the interface is the averaged between the two adjacent centered dx
-        real dl = HALF_F*(dx(ig-1) + dx(ig));
-        #if GEOMETRY == POLAR
-        if(dir==JDIR)
-          dl = dl*x1(i);
-
-        #elif GEOMETRY == SPHERICAL
-          if(dir==JDIR)
-            dl = dl*rt(i);
-          else
-            if(dir==KDIR)
-              dl = dl*rt(i)*dmu(j)/dx2(j);
-        #endif // GEOMETRY
-
-        gradT = gradT/dl;
-
-        // Compute diffusion coefficient at the interface
-        real kappa;
-        if(haveThermalDiffusion == UserDefFunction) {
-          kappa = HALF_F*(kappaArr(k,j,i) +  kappaArr(k-koffset,j-joffset,i-ioffset));
-        } else {
-          kappa = kappaConstant;
-        }
-
+        real locdmax = ZERO_F;
         // Add thermal diffusion to the flux
-        Flux(ENG,k,j,i) += -kappa*gradT;
-
-        // Compute total diffusion coefficient
-        real gamma = eos.GetGamma(Vc(PRS,k,j,i),Vc(RHO,k,j,i));
-
-        real locdmax = kappa * (gamma-ONE_F) /
-                        (HALF_F * ( Vc(RHO,k,j,i) + Vc(RHO,k-koffset,j-joffset,i-ioffset)));
-        dMax(k,j,i) = FMAX(dMax(k,j,i) , locdmax);
+        Flux(ENG,k,j,i) += thermalFlux(k,j,i,locdmax);
+        dMax(k,j,i) = resetDMax ? locdmax : FMAX(dMax(k,j,i) , locdmax);
       });
   idfx::popRegion();
 }
@@ -15,6 +15,7 @@
 #include "grid.hpp"
 #include "fluid_defs.hpp"
 #include "eos.hpp"
+#include "diffusivityCache.hpp"
 
 
 // Forward class hydro declaration
@@ -22,6 +23,69 @@ template <typename Phys> class Fluid;
 
 class DataBlock;
 
+// Thermal diffusion flux through the left interface of cell (k,j,i) along dir. It is evaluated
+// by the thermal diffusion kernel, or on the fly by the viscous kernels when both terms are
+// integrated explicitly, so that they share a single sweep of the interfaces.
+struct ThermalDiffusionFlux {
+  IdefixArray4D<real> Vc;
+  IdefixArray3D<real> kappaArr;
+  IdefixArray1D<real> dx;
+  IdefixArray1D<real> x1;
+  IdefixArray1D<real> rt;
+  IdefixArray1D<real> dmu;
+  IdefixArray1D<real> dx2;
+  EquationOfState eos;
+  HydroModuleStatus haveThermalDiffusion;
+  real kappaConstant;
+  int dir;
+  int ioffset, joffset, koffset;
+
+  // Returns the energy flux, and raises locdmax to the thermal diffusion coefficient
+  KOKKOS_INLINE_FUNCTION real operator()(int k, int j, int i, real &locdmax) const {
+    // Compute gradT
+    real gradT;
+
+    gradT = Vc(PRS,k,j,i) / Vc(RHO,k,j,i)
+           - Vc(PRS,k-koffset,j-joffset,i-ioffset) / Vc(RHO,k-koffset,j-joffset,i-ioffset);
+
+    // index along dir
+    const int ig = ioffset*i + joffset*j + koffset*k;
+
+    // dx at the interface is the averaged between the two adjacent centered dx
+    real dl = HALF_F*(dx(ig-1) + dx(ig));
+    #if GEOMETRY == POLAR
+    if(dir==JDIR)
+      dl = dl*x1(i);
+
+    #elif GEOMETRY == SPHERICAL
+      if(dir==JDIR)
+        dl = dl*rt(i);
+      else
+        if(dir==KDIR)
+          dl = dl*rt(i)*dmu(j)/dx2(j);
+    #endif // GEOMETRY
+
+    gradT = gradT/dl;
+
+    // Compute diffusion coefficient at the interface
+    real kappa;
+    if(haveThermalDiffusion == UserDefFunction) {
+      kappa = HALF_F*(kappaArr(k,j,i) +  kappaArr(k-koffset,j-joffset,i-ioffset));
+    } else {
+      kappa = kappaConstant;
+    }
+
+    // Compute total diffusion coefficient
+    real gamma = eos.GetGamma(Vc(PRS,k,j,i),Vc(RHO,k,j,i));
+
+    real dmax = kappa * (gamma-ONE_F) /
+                    (HALF_F * ( Vc(RHO,k,j,i) + Vc(RHO,k-koffset,j-joffset,i-ioffset)));
+    locdmax = FMAX(locdmax, dmax);
+
+    return -kappa*gradT;
+  }
+};
+
 class ThermalDiffusion {
  public:
   template <typename Phys>
@@ -29,7 +93,8 @@ class ThermalDiffusion {
 
   void ShowConfig(); // display configuration
 
-  void AddDiffusiveFlux(int, const real, const IdefixArray4D<real> &);
+  void AddDiffusiveFlux(int, const real, const IdefixArray4D<real> &, bool);
+  ThermalDiffusionFlux GetFlux(int, const real);   // Device functor of the flux along dir
 
   // Enroll user-defined viscous diffusivity
   void EnrollThermalDiffusivity(DiffusivityFunc);
@@ -47,6 +112,7 @@ class ThermalDiffusion {
   ParabolicModuleStatus &status;
 
   DiffusivityFunc diffusivityFunc;
+  DiffusivityCache kappaCache;    // refresh policy of kappaArr
 
   // helper array
   IdefixArray4D<real> &Vc;
@@ -77,6 +143,8 @@ ThermalDiffusion::ThermalDiffusion(Input &input, Grid &grid, Fluid<Phys> *hydroi
     this->kappaArr = IdefixArray3D<real>("ThermalDiffusionKappaArray",data->np_tot[KDIR],
                                                                  data->np_tot[JDIR],
                                                                  data->np_tot[IDIR]);
+    this->kappaCache = DiffusivityCache(input, std::string(Phys::prefix), "TDiffusion", data,
+                                        Phys::pressure);
   } else {
     IDEFIX_ERROR("Unknown thermal diffusion definition in idefix.ini. "
                   "Can only be constant or userdef.");
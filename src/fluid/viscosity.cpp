@@ -14,6 +14,7 @@
 #include "dataBlock.hpp"
 #include "fluid.hpp"
 #include "fargo.hpp"
+#include "thermalDiffusion.hpp"
 
 
 #define D_DX_I(q,n)  (q(n,k,j,i) - q(n,k,j,i - 1))
@@ -38,6 +39,59 @@
 #define D_DY_K(q,n)  (  0.25*(q(n,k,j + 1,i) + q(n,k - 1,j + 1,i)) \
                     - 0.25*(q(n,k,j - 1,i) + q(n,k - 1,j - 1,i)))
 
+// Primitive variables seen by the viscous stress. During the explicit integration with Fargo,
+// Vc only holds the deviations from the Fargo mean velocity, which is added back on the fly
+// rather than by two passes over the whole grid.
+struct ViscousVariables {
+  IdefixArray4D<real> Vc;
+  IdefixArray2D<real> meanV;
+  IdefixArray1D<real> x1;
+  Fargo::FargoType fargoType{Fargo::none};
+  real sbS{0};
+
+  KOKKOS_INLINE_FUNCTION real operator()(int n, int k, int j, int i) const {
+    real q = Vc(n,k,j,i);
+    #if GEOMETRY == CARTESIAN || GEOMETRY == POLAR
+      if(n == VX2) {
+        if(fargoType == Fargo::userdef) {
+          q += meanV(k,i);
+        } else if(fargoType == Fargo::shearingbox) {
+          q += sbS*x1(i);
+        }
+      }
+    #elif GEOMETRY == SPHERICAL
+      if(n == VX3 && fargoType != Fargo::none) q += meanV(j,i);
+    #endif
+    return(q);
+  }
+
+  // Add (sign=1) or remove (sign=-1) the mean velocity in Vc itself, for user functions that
+  // expect the full velocity field
+  void ShiftMeanVelocity(const real sign) const {
+    if(fargoType == Fargo::none) return;
+    IdefixArray4D<real> Vc = this->Vc;
+    IdefixArray2D<real> meanV = this->meanV;
+    IdefixArray1D<real> x1 = this->x1;
+    const Fargo::FargoType fargoType = this->fargoType;
+    const real sbS = this->sbS;
+    const int nk = Vc.extent(1);
+    const int nj = Vc.extent(2);
+    const int ni = Vc.extent(3);
+    idefix_for("ViscosityShiftMeanVelocity", 0, nk, 0, nj, 0, ni,
+      KOKKOS_LAMBDA (int k, int j, int i) {
+        #if GEOMETRY == CARTESIAN || GEOMETRY == POLAR
+          if(fargoType == Fargo::userdef) {
+            Vc(VX2,k,j,i) += sign*meanV(k,i);
+          } else if(fargoType == Fargo::shearingbox) {
+            Vc(VX2,k,j,i) += sign*sbS*x1(i);
+          }
+        #elif GEOMETRY == SPHERICAL
+          Vc(VX3,k,j,i) += sign*meanV(j,i);
+        #endif
+      });
+  }
+};
+
 
 
 
@@ -72,6 +126,7 @@ void Viscosity::ShowConfig() {
     if(!viscousDiffusivityFunc) {
       IDEFIX_ERROR("No viscosity function has been enrolled");
     }
+    etaCache.ShowConfig();
   } else {
     IDEFIX_ERROR("Unknown viscosity mode");
   }
@@ -80,6 +135,8 @@ void Viscosity::ShowConfig() {
   } else if(this->status.isRKL) {
     idfx::cout << "Viscosity: uses a Runge-Kutta-Legendre time integration."
                 << std::endl;
+  } else if(this->status.isImplicit) {
+    idfx::cout << "Viscosity: uses an implicit time integration." << std::endl;
   } else {
     IDEFIX_ERROR("Unknown time integrator for viscosity.");
   }
@@ -97,9 +154,22 @@ void Viscosity::EnrollViscousDiffusivity(ViscousDiffusivityFunc myFunc) {
 // (this avoids an extra array)
 // Associated source terms, present in non-cartesian geometry are also computed
 // and stored in this->viscSrc for later use (in calcRhs).
-void Viscosity::AddViscousFlux(int dir, const real t, const IdefixArray4D<real> &Flux) {
+// When resetDMax is set, dMax is initialised with the local diffusion coefficient.
+// When thermal is provided, the thermal diffusion flux is added in the same sweep.
+void Viscosity::AddViscousFlux(int dir, const real t, const IdefixArray4D<real> &Flux,
+                               bool resetDMax, ThermalDiffusion *thermal) {
   idfx::pushRegion("Viscosity::AddViscousFlux");
-  IdefixArray4D<real> Vc = this->Vc;
+  // The stress is computed from the full velocity field, including the Fargo mean velocity
+  ViscousVariables Vc;
+  Vc.Vc = this->Vc;
+  if(data->haveFargo && status.isExplicit) {
+    Fargo *fargo = data->fargo.get();
+    if(fargo->type == Fargo::userdef) fargo->GetFargoVelocity(t);
+    Vc.fargoType = fargo->type;
+    Vc.meanV = fargo->meanVelocity;
+    Vc.x1 = data->x[IDIR];
+    Vc.sbS = this->sbS;
+  }
   IdefixArray4D<real> viscSrc = this->viscSrc;
   IdefixArray3D<real> dMax = this->dMax;
   IdefixArray3D<real> eta1Arr = this->eta1Arr;
@@ -132,10 +202,22 @@ void Viscosity::AddViscousFlux(int dir, const real t, const IdefixArray4D<real>
 
   HydroModuleStatus haveViscosity = this->status.status;
 
+  #if HAVE_ENERGY
+    bool haveThermalDiffusion = (thermal != nullptr);
+    ThermalDiffusionFlux thermalFlux;
+    if(haveThermalDiffusion) thermalFlux = thermal->GetFlux(dir, t);
+  #endif
+
   // Compute viscosity if needed
   if(haveViscosity == UserDefFunction && dir == IDIR) {
     if(viscousDiffusivityFunc) {
-      viscousDiffusivityFunc(*data, t, eta1Arr, eta2Arr);
+      // The user function sees the full velocity field, as when Vc was shifted for the whole
+      // viscous flux computation. Only the refreshes pay for the shift.
+      etaCache.Refresh(this->Vc, [&]() {
+        Vc.ShiftMeanVelocity(1.0);
+        viscousDiffusivityFunc(*data, t, eta1Arr, eta2Arr);
+        Vc.ShiftMeanVelocity(-1.0);
+      });
     } else {
       IDEFIX_ERROR("No user-defined viscosity function has been enrolled");
     }
@@ -384,7 +466,12 @@ void Viscosity::AddViscousFlux(int dir, const real t, const IdefixArray4D<real>
         #endif
 
         real locdmax = (FMAX(eta1,eta2))/(0.5*(Vc(RHO,k,j,i)+Vc(RHO,k,j,i-1)));
-        dMax(k,j,i) = FMAX(dMax(k,j,i),locdmax);
+        #if HAVE_ENERGY
+          if(haveThermalDiffusion) {
+            Flux(ENG,k,j,i) += thermalFlux(k,j,i,locdmax);
+          }
+        #endif
+        dMax(k,j,i) = resetDMax ? locdmax : FMAX(dMax(k,j,i),locdmax);
       });
 
   } else if(dir==JDIR) {
@@ -597,7 +684,12 @@ void Viscosity::AddViscousFlux(int dir, const real t, const IdefixArray4D<real>
       #endif
 
       real locdmax = (FMAX(eta1,eta2))/(0.5*(Vc(RHO,k,j,i)+Vc(RHO,k,j-1,i)));
-      dMax(k,j,i) = FMAX(dMax(k,j,i),locdmax);
+      #if HAVE_ENERGY
+        if(haveThermalDiffusion) {
+          Flux(ENG,k,j,i) += thermalFlux(k,j,i,locdmax);
+        }
+      #endif
+      dMax(k,j,i) = resetDMax ? locdmax : FMAX(dMax(k,j,i),locdmax);
     });
 
   } else if(dir==KDIR) {
@@ -741,7 +833,12 @@ void Viscosity::AddViscousFlux(int dir, const real t, const IdefixArray4D<real>
       #endif
 
       real locdmax = (FMAX(eta1,eta2))/(0.5*(Vc(RHO,k,j,i)+Vc(RHO,k-1,j,i)));
-      dMax(k,j,i) = FMAX(dMax(k,j,i),locdmax);;
+      #if HAVE_ENERGY
+        if(haveThermalDiffusion) {
+          Flux(ENG,k,j,i) += thermalFlux(k,j,i,locdmax);
+        }
+      #endif
+      dMax(k,j,i) = resetDMax ? locdmax : FMAX(dMax(k,j,i),locdmax);
     });
   }
 
@@ -14,12 +14,14 @@
 #include "input.hpp"
 #include "grid.hpp"
 #include "fluid_defs.hpp"
+#include "diffusivityCache.hpp"
 
 
 
 // Forward class hydro declaration
 template <typename Phys> class Fluid;
 class DataBlock;
+class ThermalDiffusion;
 
 using ViscousDiffusivityFunc = void (*) (DataBlock &, const real t,
                                          IdefixArray3D<real> &, IdefixArray3D<real> &);
@@ -29,7 +31,8 @@ class Viscosity {
   template <typename Phys>
   Viscosity(Input &, Grid &, Fluid<Phys> *);
   void ShowConfig();                    // print configuration
-  void AddViscousFlux(int, const real, const IdefixArray4D<real> &);
+  void AddViscousFlux(int, const real, const IdefixArray4D<real> &, bool,
+                      ThermalDiffusion * = nullptr);
 
   // Enroll user-defined viscous diffusivity
   void EnrollViscousDiffusivity(ViscousDiffusivityFunc);
@@ -51,6 +54,7 @@ class Viscosity {
   ParabolicModuleStatus &status;
 
   ViscousDiffusivityFunc viscousDiffusivityFunc;
+  DiffusivityCache etaCache;      // refresh policy of eta1Arr and eta2Arr
 
   IdefixArray4D<real> &Vc;
   IdefixArray3D<real> &dMax;
@@ -85,6 +89,8 @@ Viscosity::Viscosity(Input &input, Grid &grid, Fluid<Phys> *hydroin):
     this->eta2Arr = IdefixArray3D<real>("ViscosityEta1Array",data->np_tot[KDIR],
                                                               data->np_tot[JDIR],
                                                               data->np_tot[IDIR]);
+    this->etaCache = DiffusivityCache(input, std::string(Phys::prefix), "viscosity", data,
+                                      Phys::pressure);
   } else {
         IDEFIX_ERROR("Unknown viscosity definition in idefix.ini. "
                      "Can only be constant or userdef.");
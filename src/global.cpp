@@ -11,6 +11,7 @@
 #include "idefix.hpp"
 #include "global.hpp"
 #include "profiler.hpp"
+#include "loopTuner.hpp"
 
 #ifdef WITH_MPI
 #include "mpi.hpp"
@@ -25,9 +26,17 @@ double mpiCallsTimer = 0.0;
 
 bool warningsAreErrors{false};
 
+// In debug mode, each kernel is followed in the region tree (as it used to be)
+#ifdef DEBUG
+bool kernelProfiling{true};
+#else
+bool kernelProfiling{false};
+#endif
+
 IdefixOutStream cout;
 IdefixErrStream cerr;
 Profiler prof;
+LoopTuner tuner;
 LoopPattern defaultLoopPattern;
 
 #ifdef DEBUG
@@ -54,6 +63,10 @@ int initialize() {
     defaultLoopPattern = LoopPattern::TPX;    // On cpus, works best (generally)
   #endif
 
+  #ifdef LOOP_AUTOTUNE
+    tuner.enabled = true;
+  #endif
+
   #ifdef WITH_MPI
     Mpi::CheckConfig();
   #endif
@@ -66,6 +79,7 @@ void pushRegion(const std::string& kName) {
   if(prof.perfEnabled) {
     prof.currentRegion = prof.currentRegion->GetChild(kName);
     prof.currentRegion->Start();
+    if(prof.traceEnabled) prof.currentRegion->traceStart = prof.Clock();
   }
 #ifdef DEBUG
   regionIndent=regionIndent+4;
@@ -81,6 +95,7 @@ void popRegion() {
   if(prof.perfEnabled) {
     Kokkos::fence();
     prof.currentRegion->Stop();
+    if(prof.traceEnabled) prof.AddTraceEvent(prof.currentRegion);
     prof.currentRegion = prof.currentRegion->parent;
   }
 #ifdef DEBUG
@@ -92,6 +107,21 @@ void popRegion() {
 #endif
 }
 
+// Region enclosing a single kernel, which also tracks the number of cells it processes
+void pushKernelRegion(const std::string& kind, const std::string& kName, int64_t cells) {
+  pushRegion(kind+"("+kName+")");
+  if(prof.perfEnabled) {
+    prof.currentRegion->isKernel = true;
+    prof.currentRegion->kernelName = kName;
+    prof.currentRegion->nCells += cells;
+  }
+}
+
+void popKernelRegion() {
+  Kokkos::fence();
+  popRegion();
+}
+
 // Init the iostream with defined rank
 void IdefixOutStream::init(int rank) {
   if(rank==0)
@@ -103,6 +133,8 @@ void IdefixOutStream::init(int rank) {
 
 // disable the log file
 void IdefixOutStream::enableLogFile() {
+  // Already open (when the code restarts itself to rebalance the domain)
+  if(this->logFileEnabled) return;
   std::stringstream sslogFileName;
   sslogFileName << "idefix." << idfx::prank << ".log";
 
@@ -139,6 +171,9 @@ void safeExit(int retCode) {
     MPI_Abort(MPI_COMM_WORLD,retCode);
     #endif
   } else {
+    #ifdef WITH_MPI
+    Mpi::Finalize();
+    #endif
     Kokkos::finalize();
     #ifdef WITH_MPI
     MPI_Finalize();
@@ -20,18 +20,23 @@ void safeExit(int );       // Exit the code
 class IdefixOutStream;
 class IdefixErrStream;
 class Profiler;
+class LoopTuner;
 
 extern int prank;                       //< parallel rank
 extern int psize;
 extern IdefixOutStream cout;              //< custom cout for idefix
 extern IdefixErrStream cerr;              //< custom cerr for idefix
 extern Profiler prof;                   //< profiler (for memory & performance usage)
+extern LoopTuner tuner;                 //< runtime choice of the idefix_for loop strategies
 extern double mpiCallsTimer;            //< time significant MPI calls
 extern LoopPattern defaultLoopPattern;  //< default loop patterns (for idefix_for loops)
 extern bool warningsAreErrors;    //< whether warnings should be considered as errors
+extern bool kernelProfiling;      //< whether each idefix_for/idefix_reduce has its own region
 
 void pushRegion(const std::string&);
 void popRegion();
+void pushKernelRegion(const std::string&, const std::string&, int64_t);  //< kind, name, cells
+void popKernelRegion();
 
 template<typename T>
 IdefixArray1D<T> ConvertVectorToIdefixArray(std::vector<T> &inputVector) {
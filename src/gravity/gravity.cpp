@@ -51,6 +51,14 @@ Gravity::Gravity(Input &input, DataBlock *datain) {
     this->havePotential = true;
   }
 
+  if(haveUserDefPotential) {
+    this->userDefPotentialIsStatic = input.GetOrSet<bool>("Gravity","userdefStatic",0, false);
+  }
+  this->haveStaticPotential = haveCentralMassPotential
+                              || (haveUserDefPotential && userDefPotentialIsStatic);
+  this->haveDynamicPotential = havePlanetsPotential || haveSelfGravityPotential
+                              || (haveUserDefPotential && !userDefPotentialIsStatic);
+
   // Body Force
   if(input.CheckEntry("Gravity","bodyForce")>=0) {
     std::string potentialString = input.Get<std::string>("Gravity","bodyForce",0);
@@ -69,6 +77,12 @@ Gravity::Gravity(Input &input, DataBlock *datain) {
     phiP = IdefixArray3D<real>("Gravity_PhiP",
                                 data->np_tot[KDIR], data->np_tot[JDIR], data->np_tot[IDIR]);
     haveInitialisedPotential = true;
+    if(haveStaticPotential && haveDynamicPotential) {
+      phiStatic = IdefixArray3D<real>("Gravity_PhiStatic",
+                                  data->np_tot[KDIR], data->np_tot[JDIR], data->np_tot[IDIR]);
+    } else {
+      phiStatic = phiP;
+    }
   }
   if(haveBodyForce && !haveInitialisedBodyForce) {
     bodyForceVector = IdefixArray4D<real>("Gravity_bodyForce", COMPONENTS,
@@ -100,7 +114,8 @@ void Gravity::ShowConfig() {
     idfx::cout << "Gravity: ENABLED." << std::endl;
     idfx::cout << "Gravity: G=" << gravCst << "." << std::endl;
     if(haveUserDefPotential) {
-      idfx::cout << "Gravity: User-defined gravitational potential ENABLED." << std::endl;
+      idfx::cout << "Gravity: User-defined gravitational potential ENABLED";
+      idfx::cout << (userDefPotentialIsStatic ? " (time-independent)." : ".") << std::endl;
       if(!gravPotentialFunc) {
         IDEFIX_ERROR("No user-defined gravitational potential has been enrolled.");
       }
@@ -132,29 +147,46 @@ void Gravity::ShowConfig() {
 void Gravity::ComputeGravity(int stepNumber) {
   idfx::pushRegion("Gravity::ComputeGravity");
   if(havePotential) {
-    if(haveUserDefPotential) {
-      if(gravPotentialFunc == nullptr) {
-        IDEFIX_ERROR("Gravitational potential is enabled, "
-                   "but no user-defined potential has been enrolled.");
-      }
-      idfx::pushRegion("Gravity::user-defined:gravPotentialFunc");
-      gravPotentialFunc(*data, data->t, data->x[IDIR], data->x[JDIR], data->x[KDIR], phiP);
-      idfx::popRegion();
-    } else {
-      ResetPotential();
-    }
-    if(haveCentralMassPotential) {
-      AddCentralMassPotential();
+    // Time-independent layers are only computed once (or when their parameters change)
+    if(haveStaticPotential && (!staticPotentialReady || centralMass != staticCentralMass
+                                || gravCst != staticGravCst)) {
+      ComputeStaticPotential();
     }
-    if(havePlanetsPotential) {
-      data->planetarySystem->AddPlanetsPotential(phiP, data->t);
-    }
-    if(haveSelfGravityPotential) {
-      // Solving Poisson for the current gas density distribution
-      if(stepNumber % selfGravity.skipSelfGravity == 0) selfGravity.SolvePoisson();
+    if(haveDynamicPotential) {
+      if(haveUserDefPotential && !userDefPotentialIsStatic) {
+        if(gravPotentialFunc == nullptr) {
+          IDEFIX_ERROR("Gravitational potential is enabled, "
+                     "but no user-defined potential has been enrolled.");
+        }
+        idfx::pushRegion("Gravity::user-defined:gravPotentialFunc");
+        gravPotentialFunc(*data, data->t, data->x[IDIR], data->x[JDIR], data->x[KDIR], phiP);
+        idfx::popRegion();
+        if(haveStaticPotential) {
+          IdefixArray3D<real> phiP = this->phiP;
+          IdefixArray3D<real> phiStatic = this->phiStatic;
+          idefix_for("Gravity::AddStaticPotential",
+                      0, data->np_tot[KDIR],
+                      0, data->np_tot[JDIR],
+                      0, data->np_tot[IDIR],
+                      KOKKOS_LAMBDA(int k, int j, int i) {
+                        phiP(k,j,i) += phiStatic(k,j,i);
+                      });
+        }
+      } else if(haveStaticPotential) {
+        Kokkos::deep_copy(phiP, phiStatic);
+      } else {
+        ResetPotential(phiP);
+      }
+      if(havePlanetsPotential) {
+        data->planetarySystem->AddPlanetsPotential(phiP, data->t);
+      }
+      if(haveSelfGravityPotential) {
+        // Solving Poisson for the current gas density distribution
+        if(stepNumber % selfGravity.skipSelfGravity == 0) selfGravity.SolvePoisson();
 
-      // Adding gas self-gravity contribution to global gravity potential
-      selfGravity.AddSelfGravityPotential(phiP);
+        // Adding gas self-gravity contribution to global gravity potential
+        selfGravity.AddSelfGravityPotential(phiP);
+      }
     }
   }
   if(haveBodyForce) {
@@ -178,6 +210,29 @@ void Gravity::ComputeGravity(int stepNumber) {
   idfx::popRegion();
 }
 
+// Compute the time-independent layers of the potential in phiStatic
+void Gravity::ComputeStaticPotential() {
+  idfx::pushRegion("Gravity::ComputeStaticPotential");
+  if(haveUserDefPotential && userDefPotentialIsStatic) {
+    if(gravPotentialFunc == nullptr) {
+      IDEFIX_ERROR("Gravitational potential is enabled, "
+                 "but no user-defined potential has been enrolled.");
+    }
+    idfx::pushRegion("Gravity::user-defined:gravPotentialFunc");
+    gravPotentialFunc(*data, data->t, data->x[IDIR], data->x[JDIR], data->x[KDIR], phiStatic);
+    idfx::popRegion();
+  } else {
+    ResetPotential(phiStatic);
+  }
+  if(haveCentralMassPotential) {
+    AddCentralMassPotential(phiStatic);
+  }
+  staticCentralMass = centralMass;
+  staticGravCst = gravCst;
+  staticPotentialReady = true;
+  idfx::popRegion();
+}
+
 void Gravity::EnrollPotential(GravPotentialFunc myFunc) {
   if(!this->haveUserDefPotential) {
     IDEFIX_WARNING("In order to enroll your gravitational potential, "
@@ -185,6 +240,7 @@ void Gravity::EnrollPotential(GravPotentialFunc myFunc) {
                  "with the potential entry in [Gravity].");
   }
   this->gravPotentialFunc = myFunc;
+  this->staticPotentialReady = false;
 }
 
 void Gravity::EnrollBodyForce(BodyForceFunc myFunc) {
@@ -197,9 +253,8 @@ void Gravity::EnrollBodyForce(BodyForceFunc myFunc) {
 }
 
 // Fill the gravitational potential with zeros
-void Gravity::ResetPotential() {
+void Gravity::ResetPotential(IdefixArray3D<real> &phiP) {
   idfx::pushRegion("Gravity::ResetPotential");
-  IdefixArray3D<real> phiP = this->phiP;
   idefix_for("Gravity::ResetPotential",
               0, data->np_tot[KDIR],
               0, data->np_tot[JDIR],
@@ -210,12 +265,11 @@ void Gravity::ResetPotential() {
   idfx::popRegion();
 }
 
-void Gravity::AddCentralMassPotential() {
+void Gravity::AddCentralMassPotential(IdefixArray3D<real> &phiP) {
   idfx::pushRegion("Gravity::AddCentralMassPotential");
   IdefixArray1D<real> x1 = data->x[IDIR];
   IdefixArray1D<real> x2 = data->x[JDIR];
   IdefixArray1D<real> x3 = data->x[KDIR];
-  IdefixArray3D<real> phiP = this->phiP;
   real mass = this->centralMass;
   real gravCst = this->gravCst;
   #if GEOMETRY == CARTESIAN
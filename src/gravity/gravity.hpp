@@ -31,9 +31,9 @@ class Gravity {
   void EnrollPotential(GravPotentialFunc);
   void EnrollBodyForce(BodyForceFunc);
 
-  void ResetPotential();            ///< fill the potential with zeros.
+  void ResetPotential(IdefixArray3D<real> &);           ///< fill the potential with zeros.
 
-  void AddCentralMassPotential();   ///< Àdd the potential due to a centrall mass
+  void AddCentralMassPotential(IdefixArray3D<real> &);  ///< Àdd the potential due to a centrall mass
 
   void ShowConfig();                ///< Show the gravity configuration
   bool havePotential{false};        ///< Whether a gravitational potential is present
@@ -42,6 +42,7 @@ class Gravity {
   bool haveCentralMassPotential{false}; ///< Whether a potential is due to the central mass
   bool havePlanetsPotential{false};     ///< Whether a potential is due to planet(s)
   bool haveSelfGravityPotential{false}; ///< Whether a potential is defined through self-gravity
+  bool userDefPotentialIsStatic{false}; ///< Whether the user-defined potential is time-independent
 
   bool haveBodyForce{false};            ///< Whether a body force (=acceleration) is present
 
@@ -71,6 +72,17 @@ class Gravity {
   bool haveInitialisedBodyForce{false};     ///< whether a body force has already been initialised
   bool haveInitialisedSelfGravity{false};   ///< whether self-gravity has already been initialised
 
+  // The time-independent layers of the potential (central mass, static user-defined potential)
+  // are computed once in phiStatic, and only recomputed when the central mass or G change.
+  // When there is no time-dependent layer, phiStatic is phiP itself.
+  void ComputeStaticPotential();
+  bool haveStaticPotential{false};          ///< whether the potential has time-independent layers
+  bool haveDynamicPotential{false};         ///< whether the potential has time-dependent layers
+  bool staticPotentialReady{false};         ///< whether phiStatic is up to date
+  real staticCentralMass;                   ///< central mass used to compute phiStatic
+  real staticGravCst;                       ///< gravitational constant used to compute phiStatic
+  IdefixArray3D<real> phiStatic;
+
   DataBlock *data;
 
   // User defined gravitational potential
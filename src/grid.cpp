@@ -5,11 +5,17 @@
 // Licensed under CeCILL 2.1 License, see COPYING for more information
 // ***********************************************************************************
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
 #include <string>
+#include <vector>
 
 #include "idefix.hpp"
 #include "gridHost.hpp"
 #include "grid.hpp"
+#include "dump.hpp"
 
 Grid::Grid(SubGrid * subgrid) {
   idfx::pushRegion("Grid::Grid(SubGrid)");
@@ -26,6 +32,9 @@ Grid::Grid(SubGrid * subgrid) {
   np_int = subgrid->parentGrid->np_int;
 
   nghost = subgrid->parentGrid->nghost;
+  nghostStage = subgrid->parentGrid->nghostStage;
+  haveDeepHalo = subgrid->parentGrid->haveDeepHalo;
+  isUniformCartesian = subgrid->parentGrid->isUniformCartesian;
 
   lbound = subgrid->parentGrid->lbound;
   rbound = subgrid->parentGrid->rbound;
@@ -35,6 +44,7 @@ Grid::Grid(SubGrid * subgrid) {
 
   nproc = subgrid->parentGrid->nproc;
   xproc = subgrid->parentGrid->xproc;
+  procStart = subgrid->parentGrid->procStart;
 
   // Now slice if along the chosen direction
   SliceMe(subgrid);
@@ -42,6 +52,13 @@ Grid::Grid(SubGrid * subgrid) {
   idfx::popRegion();
 }
 
+Grid::~Grid() {
+  #ifdef WITH_MPI
+    if(AxisComm != MPI_COMM_NULL) MPI_Comm_free(&AxisComm);
+    if(CartComm != MPI_COMM_NULL) MPI_Comm_free(&CartComm);
+  #endif
+}
+
 Grid::Grid(Input &input) {
   idfx::pushRegion("Grid::Grid(Input)");
 
@@ -72,6 +89,7 @@ Grid::Grid(Input &input) {
   }
 
   for(int dir = 0 ; dir < 3 ; dir++) {
+    nghostStage[dir] = nghost[dir];
     np_tot[dir] = npoints[dir] + 2*nghost[dir];
     np_int[dir] = npoints[dir];
     lbound[dir] = undefined;
@@ -136,14 +154,6 @@ Grid::Grid(Input &input) {
     }
   }
 
-  // Allocate the grid structure on device. Initialisation will come from GridHost
-  for(int dir = 0 ; dir < 3 ; dir++) {
-    x[dir] = IdefixArray1D<real>("Grid_x",np_tot[dir]);
-    xr[dir] = IdefixArray1D<real>("Grid_xr",np_tot[dir]);
-    xl[dir] = IdefixArray1D<real>("Grid_xl",np_tot[dir]);
-    dx[dir] = IdefixArray1D<real>("Grid_dx",np_tot[dir]);
-  }
-
   // Allocate proc structure (by default: one proc in each direction, size one)
   for(int i=0 ; i < 3; i++) {
     nproc[i] = 1;
@@ -169,25 +179,9 @@ Grid::Grid(Input &input) {
       IDEFIX_ERROR("Total grid size must be a multiple of the number of mpi process");
     // Check that dec option has been passed
     if(input.CheckEntry("CommandLine","dec")  != DIMENSIONS) {
-      // No command line decomposition, make auto-decomposition if possible
-      // (only when nproc and dimensions are powers of 2, and in 1D)
-      if(DIMENSIONS == 1) {
-        nproc[0] = idfx::psize;
-      } else {
-        if(!isPow2(idfx::psize))
-          IDEFIX_ERROR(
-            "Automatic domain decomposition requires the number of processes to be a power of 2. "
-            "Alternatively, set a manual decomposition with -dec"
-          );
-        for(int dir = 0; dir < 3; dir++) {
-          if(!isPow2(np_int[dir]))
-            IDEFIX_ERROR(
-              "Automatic domain decomposition requires nx1, nx2 and nx3 to be powers of 2. "
-              "Alternatively, set a manual decomposition with -dec"
-            );
-        }
-        makeDomainDecomposition();
-      }
+      // No command line decomposition, find the decomposition minimising the MPI exchanges
+      makeDomainDecomposition(input);
+      autoDecomposition = true;
     } else {
       // Manual domain decomposition (with -dec option)
       int ntot=1;
@@ -213,6 +207,11 @@ Grid::Grid(Input &input) {
     }
   }
 
+  // Volume of the halo exchanges implied by this decomposition (for ShowConfig)
+  if(idfx::psize>1) {
+    haloCells = static_cast<int64_t>(DecompositionCost(nproc, GetExchangeWidth(input), false));
+  }
+
   // Add periodicity indications
   for(int dir=0 ; dir < DIMENSIONS; dir++) {
     if(rbound[dir] == periodic || rbound[dir] == shearingbox) period[dir] = 1;
@@ -233,6 +232,27 @@ Grid::Grid(Input &input) {
   }
 #endif
 
+  // By default, each direction is split in slabs of equal width
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    procStart[dir].resize(nproc[dir]+1);
+    for(int n = 0 ; n <= nproc[dir] ; n++) {
+      procStart[dir][n] = n*(np_int[dir]/nproc[dir]);
+    }
+  }
+
+  // Deepen the MPI halos so that they are only exchanged once per cycle
+  if(input.GetOrSet<bool>("TimeIntegrator","deepHalo",0,false)) {
+    InitDeepHalo(input);
+  }
+
+  // Allocate the grid structure on device. Initialisation will come from GridHost
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    x[dir] = IdefixArray1D<real>("Grid_x",np_tot[dir]);
+    xr[dir] = IdefixArray1D<real>("Grid_xr",np_tot[dir]);
+    xl[dir] = IdefixArray1D<real>("Grid_xl",np_tot[dir]);
+    dx[dir] = IdefixArray1D<real>("Grid_dx",np_tot[dir]);
+  }
+
   // init coarsening
   if(input.CheckEntry("Grid","coarsening")>=0) {
     std::string coarsenType = input.Get<std::string>("Grid","coarsening",0);
@@ -262,50 +282,348 @@ Grid::Grid(Input &input) {
         IDEFIX_ERROR(msg);
       }
     }
+  }
 
-    this->haveGridCoarsening = GridCoarsening::enabled;
+  if(input.CheckEntry("Grid","loadBalance")>=0) {
+    InitLoadBalance(input);
   }
   idfx::popRegion();
 }
 
-bool Grid::isPow2(int n) {
-  return( (n & (n-1)) == 0);
+// Allocate nstages times more ghost cells in the decomposed directions, so that a single MPI
+// exchange per cycle provides enough valid cells for all of the stages of the time integrator.
+void Grid::InitDeepHalo(Input &input) {
+  #ifndef WITH_MPI
+    IDEFIX_WARNING("Deep halos only reduce the number of MPI exchanges. Disabled without MPI.");
+  #else
+    const int nstages = input.Get<int>("TimeIntegrator","nstages",0);
+    if(nstages < 2) {
+      IDEFIX_WARNING("Deep halos are useless with a single-stage integrator. Disabled.");
+      return;
+    }
+    // These modules exchange or remap their ghost zones on their own at every stage
+    if(input.CheckBlock("Fargo") || input.CheckEntry("Hydro","fargo")>=0) {
+      IDEFIX_ERROR("Deep halos are not compatible with Fargo");
+    }
+    if(input.CheckEntry("Grid","coarsening")>=0) {
+      IDEFIX_ERROR("Deep halos are not compatible with grid coarsening");
+    }
+    if(haveAxis) {
+      IDEFIX_ERROR("Deep halos are not compatible with axis boundaries");
+    }
+    for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+      if(lbound[dir] == shearingbox || rbound[dir] == shearingbox) {
+        IDEFIX_ERROR("Deep halos are not compatible with shearingbox boundaries");
+      }
+    }
+    for(int n = 0 ; n < input.CheckEntry("Gravity","potential") ; n++) {
+      if(input.Get<std::string>("Gravity","potential",n).compare("selfgravity") == 0) {
+        IDEFIX_ERROR("Deep halos are not compatible with self-gravity");
+      }
+    }
+
+    for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+      if(nproc[dir] == 1) continue;
+      nghost[dir] = nstages*nghostStage[dir];
+      np_tot[dir] = np_int[dir] + 2*nghost[dir];
+      // The halo is filled from the active domain of the neighbouring process, so that the
+      // narrowest slab should be at least as wide as the halo. Load balancing keeps this true
+      // for the slabs it computes later on (see SetDecomposition and BalanceLoad).
+      int minWidth = np_int[dir];
+      for(int n = 0 ; n < nproc[dir] ; n++) {
+        minWidth = std::min(minWidth, procStart[dir][n+1] - procStart[dir][n]);
+      }
+      if(minWidth < nghost[dir]) {
+        std::stringstream msg;
+        msg << "Deep halos require at least " << nghost[dir] << " cells per process along X"
+            << dir+1 << ". Use fewer processes in this direction or disable deepHalo.";
+        IDEFIX_ERROR(msg);
+      }
+    }
+    haveDeepHalo = true;
+  #endif
 }
 
-// Produce a domain decomposition in nProc assuming psize and np_int[] are powers of 2
-void Grid::makeDomainDecomposition() {
-  // initialize the routine
-  int nleft=idfx::psize;
-  int nlocal[3];
-  for(int dir = 0; dir < 3; dir++) {
-    nproc[dir] = 1;
-    nlocal[dir] = np_int[dir];
+// Enable the load balancing along the directions listed in [Grid] loadBalance, and recover the
+// balanced decomposition from the restart dump when there is one.
+void Grid::InitLoadBalance(Input &input) {
+  #ifndef WITH_MPI
+    IDEFIX_WARNING("Load balancing requires MPI. It is disabled in this run.");
+  #else
+    const bool haveFargo = input.CheckBlock("Fargo") || input.CheckEntry("Hydro","fargo")>=0;
+    #if GEOMETRY == SPHERICAL
+      const int fargoDirection = KDIR;
+    #else
+      const int fargoDirection = JDIR;
+    #endif
+    const int directions = input.CheckEntry("Grid","loadBalance");
+    for(int i = 0 ; i < directions ; i++) {
+      std::string dirname = input.Get<std::string>("Grid","loadBalance",i);
+      int dir;
+      if(dirname.compare("X1")==0) {
+        dir = IDIR;
+      } else if(dirname.compare("X2")==0) {
+        dir = JDIR;
+      } else if(dirname.compare("X3")==0) {
+        dir = KDIR;
+      } else {
+        std::stringstream msg;
+        msg << "Load balancing direction can only be X1, X2 and/or X3. I got: " << dirname;
+        IDEFIX_ERROR(msg);
+      }
+      if(dir >= DIMENSIONS) {
+        IDEFIX_ERROR("Load balancing direction " + dirname + " is not part of this problem");
+      }
+      // These exchanges assume that all of the slabs have the same width
+      if(dir == KDIR && haveAxis) {
+        IDEFIX_ERROR("Load balancing along X3 is not compatible with axis boundaries");
+      }
+      if(dir == fargoDirection && haveFargo) {
+        IDEFIX_ERROR("Load balancing is not compatible with Fargo in the advection direction");
+      }
+      if(haveGridCoarsening && coarseningDirection[dir]) {
+        IDEFIX_ERROR("Load balancing is not compatible with grid coarsening in the same direction");
+      }
+      balanceDirection[dir] = true;
+    }
+    #ifdef WITH_PYTHON
+      if(input.CheckBlock("Python")) {
+        IDEFIX_ERROR("Load balancing restarts the code, which is not possible with Pydefix");
+      }
+    #endif
+    if(input.forceNoWrite) {
+      IDEFIX_WARNING("Load balancing restarts from dump files, it is disabled by -nowrite.");
+      return;
+    }
+    balanceThreshold = input.GetOrSet<double>("Grid","loadBalanceThreshold",0, 20.0);
+    haveLoadBalance = true;
+
+    // Restart dumps written by balanced runs carry their decomposition
+    if(input.restartRequested) {
+      std::vector<int> layout;
+      if(Dump::ReadDecomposition(input, layout) && !SetDecomposition(layout)) {
+        IDEFIX_WARNING("The decomposition stored in the restart dump does not match this run. "
+                       "Reverting to slabs of equal width.");
+      }
+    }
+  #endif
+}
+
+// Decomposition stored in dump files: the number of processes in each direction followed by
+// the slab boundaries in each direction. A pending balanced decomposition takes precedence, so
+// that restarting from the dump applies it.
+std::vector<int> Grid::GetDecomposition() {
+  const std::array<std::vector<int>,3> &start = rebalanceRequested ? balancedStart : procStart;
+  std::vector<int> layout(nproc.begin(), nproc.end());
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    layout.insert(layout.end(), start[dir].begin(), start[dir].end());
   }
+  return(layout);
+}
+
+// Apply a decomposition produced by GetDecomposition. Returns false when it is not compatible
+// with the current process layout.
+bool Grid::SetDecomposition(const std::vector<int> &layout) {
+  if(layout.size() < 3) return(false);
+  size_t expected = 3;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    if(layout[dir] != nproc[dir]) return(false);
+    expected += nproc[dir]+1;
+  }
+  if(layout.size() != expected) return(false);
+
+  std::array<std::vector<int>,3> start;
+  auto it = layout.begin()+3;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    start[dir].assign(it, it+nproc[dir]+1);
+    it += nproc[dir]+1;
+    if(start[dir][0] != 0 || start[dir][nproc[dir]] != np_int[dir]) return(false);
+    for(int n = 0 ; n < nproc[dir] ; n++) {
+      const int minWidth = nproc[dir] > 1 ? std::max(nghost[dir], 1) : 1;
+      if(start[dir][n+1] - start[dir][n] < minWidth) return(false);
+    }
+  }
+  procStart = start;
+  return(true);
+}
+
+// Compute slabs of variable widths balancing the compute time measured on each process. The
+// cost of a slab is the time spent by all of its processes, assumed evenly distributed among
+// its cells. This is collective, but the cost and imbalance are only needed on the root process.
+void Grid::BalanceLoad(const std::vector<double> &cost, double imbalance) {
+#ifdef WITH_MPI
+  // Minimum reduction of the most expensive slab for a rebalancing to be worth a restart
+  const double minGain = 0.05;
+  int request = 0;
+  std::array<std::vector<int>,3> start = procStart;
+
+  if(idfx::prank == 0 && imbalance > balanceThreshold) {
+    for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+      const int n = nproc[dir];
+      if(!balanceDirection[dir] || n == 1) continue;
+      std::vector<double> slabCost(n, 0.0);
+      for(int rank = 0 ; rank < idfx::psize ; rank++) {
+        int coords[3];
+        MPI_Cart_coords(CartComm, rank, 3, coords);
+        slabCost[coords[dir]] += cost[rank];
+      }
+      // Cost of the cells [0, i[ along dir
+      auto cumulatedCost = [&](int i) {
+        double sum = 0;
+        for(int s = 0 ; s < n ; s++) {
+          const int width = procStart[dir][s+1] - procStart[dir][s];
+          const int inside = std::min(std::max(i - procStart[dir][s], 0), width);
+          sum += slabCost[s]*inside/width;
+        }
+        return(sum);
+      };
+      const double total = cumulatedCost(np_int[dir]);
+      if(total <= 0) continue;
+
+      // New boundaries are located where the cumulated cost reaches a multiple of total/n
+      for(int b = 1 ; b < n ; b++) {
+        const double target = b*total/n;
+        int i = procStart[dir][b];
+        while(i > 0 && cumulatedCost(i) > target) i--;
+        while(i < np_int[dir] && cumulatedCost(i+1) <= target) i++;
+        start[dir][b] = i;
+      }
+      // Slabs remain at least as wide as the ghost zones they exchange
+      const int minWidth = std::max(nghost[dir], 1);
+      for(int b = 1 ; b < n ; b++) {
+        start[dir][b] = std::max(start[dir][b], start[dir][b-1] + minWidth);
+      }
+      for(int b = n-1 ; b > 0 ; b--) {
+        start[dir][b] = std::min(start[dir][b], start[dir][b+1] - minWidth);
+      }
 
-  // Loop
-  while(nleft>1) {
-    // Find the direction where there is a maximum of point
-    int dirmax;
-    int nmax=1;
-    int ndir=2;
-
-    for(int dir = ndir; dir >= 0; dir--) {
-      // We do this loop backward so that we divide the domain first in the last dimension
-      // (better for cache optimisation)
-      if(nlocal[dir]>nmax ) {
-        nmax=nlocal[dir];
-        dirmax=dir;
-      }
-    }
-    // At this point, we have nmax points in direction dirmax,
-    // which is the direction we're going to divide by 2
-    if(nmax==1)
-      IDEFIX_ERROR("Your domain size is too small to be decomposed "
-                   "on this number of MPI processes");
-    nlocal[dirmax]=nlocal[dirmax]/2;
-    nproc[dirmax]=nproc[dirmax]*2;
-    nleft=nleft/2;
+      double oldMax = 0;
+      double newMax = 0;
+      for(int s = 0 ; s < n ; s++) {
+        oldMax = std::max(oldMax, slabCost[s]);
+        newMax = std::max(newMax, cumulatedCost(start[dir][s+1]) - cumulatedCost(start[dir][s]));
+      }
+      if(newMax < (1.0-minGain)*oldMax) {
+        request = 1;
+      } else {
+        start[dir] = procStart[dir];
+      }
+    }
   }
+  MPI_Bcast(&request, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if(request) {
+    for(int dir = 0 ; dir < 3 ; dir++) {
+      MPI_Bcast(start[dir].data(), start[dir].size(), MPI_INT, 0, MPI_COMM_WORLD);
+    }
+    balancedStart = start;
+    rebalanceRequested = true;
+    for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+      if(start[dir] == procStart[dir]) continue;
+      idfx::cout << "Grid: balanced slab widths along X" << dir+1 << ":";
+      for(int s = 0 ; s < nproc[dir] ; s++) {
+        idfx::cout << " " << start[dir][s+1] - start[dir][s];
+      }
+      idfx::cout << std::endl;
+    }
+  }
+#endif
+}
+
+// Width of the halo exchanged in each direction when the domain is decomposed along it
+std::array<int,3> Grid::GetExchangeWidth(Input &input) {
+  std::array<int,3> width = nghost;
+  // Deep halos are nstages times deeper in the decomposed directions (see InitDeepHalo)
+  if(input.GetOrSet<bool>("TimeIntegrator","deepHalo",0,false)) {
+    const int nstages = input.Get<int>("TimeIntegrator","nstages",0);
+    if(nstages >= 2) {
+      for(int dir = 0 ; dir < 3 ; dir++) width[dir] *= nstages;
+    }
+  }
+  // Fargo exchanges maxShift additional cells when there is a decomposition in its direction
+  if(input.CheckBlock("Fargo") || input.CheckEntry("Hydro","fargo")>=0) {
+    int maxShift = 10;
+    if(input.CheckEntry("Fargo","maxShift")>=0) maxShift = input.Get<int>("Fargo","maxShift",0);
+    #if GEOMETRY == SPHERICAL
+      width[KDIR] += maxShift;
+    #else
+      width[JDIR] += maxShift;
+    #endif
+  }
+  return(width);
+}
+
+// Number of ghost cells each process exchanges with its neighbours for the decomposition n.
+// When weighted, each direction is weighted by the relative cost of its exchanges: X1 buffers
+// are gathered from strided memory, while X3 buffers are contiguous slabs.
+double Grid::DecompositionCost(const std::array<int,3> &n, const std::array<int,3> &width,
+                               bool weighted) {
+  const std::array<double,3> weight = {1.25, 1.1, 1.0};
+  std::array<int64_t,3> nlocal;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    nlocal[dir] = np_int[dir]/n[dir];
+  }
+  double cost = 0;
+  for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+    if(n[dir] == 1) continue;
+    double surface = 2*width[dir];
+    for(int d2 = 0 ; d2 < DIMENSIONS ; d2++) {
+      if(d2 != dir) surface *= nlocal[d2];
+    }
+    cost += weighted ? weight[dir]*surface : surface;
+  }
+  return(cost);
+}
+
+// Produce the domain decomposition in nproc which minimises the halo exchanges. All of the
+// factorisations of psize compatible with the grid dimensions are tried.
+void Grid::makeDomainDecomposition(Input &input) {
+  const std::array<int,3> width = GetExchangeWidth(input);
+
+  // An axis spanning 2pi requires an even number of processes along X3 (or a single one)
+  bool axisTwoPi = false;
+  #if DIMENSIONS == 3
+  if(haveAxis) {
+    const int numPatch = input.Get<int>("Grid","X3-grid",0);
+    const real x3beg = input.Get<real>("Grid","X3-grid",1);
+    const real x3end = input.Get<real>("Grid","X3-grid",3*numPatch+1);
+    axisTwoPi = std::fabs(x3end - x3beg - 2.0*M_PI) < 1e-10;
+  }
+  #endif
+
+  auto isValid = [&](int dir, int n) {
+    if(n == 1) return(true);
+    if(dir >= DIMENSIONS) return(false);
+    if(np_int[dir] % n) return(false);
+    // Subdomains should be at least as large as the halo they exchange
+    if(np_int[dir]/n < width[dir]) return(false);
+    if(dir == KDIR && axisTwoPi && n % 2) return(false);
+    return(true);
+  };
+
+  double costMin = -1;
+  std::array<int,3> best = {1, 1, 1};
+  const int psize = idfx::psize;
+  for(int n1 = 1 ; n1 <= psize ; n1++) {
+    if(psize % n1 || !isValid(IDIR, n1)) continue;
+    for(int n2 = 1 ; n2 <= psize/n1 ; n2++) {
+      if((psize/n1) % n2 || !isValid(JDIR, n2)) continue;
+      const int n3 = psize/(n1*n2);
+      if(!isValid(KDIR, n3)) continue;
+      const std::array<int,3> n = {n1, n2, n3};
+      const double cost = DecompositionCost(n, width, true);
+      if(costMin < 0 || cost < costMin) {
+        costMin = cost;
+        best = n;
+      }
+    }
+  }
+  if(costMin < 0) {
+    std::stringstream msg;
+    msg << "Cannot find a domain decomposition of the grid on " << psize << " MPI processes."
+        << std::endl << "Change the number of processes or set a manual decomposition with -dec";
+    IDEFIX_ERROR(msg);
+  }
+  nproc = best;
 }
 /*
 Grid& Grid::operator=(const Grid& grid) {
@@ -391,12 +709,27 @@ void Grid::ShowConfig() {
                  << "...." << np_int[dir] << "...." << xend[dir] << "\t" << rboundString
                  << std::endl;
   }
+  if(isUniformCartesian) {
+    idfx::cout << "Grid: uniform cartesian grid, metric terms are treated as constants."
+               << std::endl;
+  }
   #ifdef WITH_MPI
     idfx::cout << "Grid: MPI domain decomposition is (";
     for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
       idfx::cout << " " << nproc[dir] << " ";
     }
-    idfx::cout << ")" << std::endl;
+    idfx::cout << ")" << (autoDecomposition ? " (automatic)" : "") << std::endl;
+    if(idfx::psize > 1) {
+      int64_t localCells = 1;
+      for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+        localCells *= np_int[dir]/nproc[dir];
+      }
+      std::stringstream ratio;
+      ratio << std::fixed << std::setprecision(1) << 100.0*haloCells/localCells;
+      idfx::cout << "Grid: predicted MPI exchange volume is " << haloCells
+                 << " cells per process and per variable (" << ratio.str()
+                 << "% of the subdomain)." << std::endl;
+    }
     idfx::cout << "Grid: Current MPI proc coordinates (";
 
     for(int dir = 0; dir < 3; dir++) {
@@ -404,6 +737,32 @@ void Grid::ShowConfig() {
       if(dir < 2) idfx::cout << ", ";
     }
     idfx::cout << ")" << std::endl;
+    if(haveDeepHalo) {
+      idfx::cout << "Grid: deep MPI halos of (";
+      for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+        idfx::cout << " " << nghost[dir] << " ";
+      }
+      idfx::cout << ") ghost cells, exchanged once per cycle." << std::endl;
+    }
+    if(haveLoadBalance) {
+      idfx::cout << "Grid: load balancing enabled in direction(s) ";
+      for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+        if(balanceDirection[dir]) idfx::cout << "X" << dir+1 << " ";
+      }
+      idfx::cout << "above " << balanceThreshold << "% of MPI imbalance." << std::endl;
+      for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+        bool uniform = true;
+        for(int s = 0 ; s <= nproc[dir] ; s++) {
+          if(procStart[dir][s] != s*(np_int[dir]/nproc[dir])) uniform = false;
+        }
+        if(uniform) continue;
+        idfx::cout << "Grid: slab widths along X" << dir+1 << ":";
+        for(int s = 0 ; s < nproc[dir] ; s++) {
+          idfx::cout << " " << procStart[dir][s+1] - procStart[dir][s];
+        }
+        idfx::cout << std::endl;
+      }
+    }
   #endif
   if(haveGridCoarsening) {
     if(haveGridCoarsening == GridCoarsening::enabled ) {
@@ -451,6 +810,7 @@ void Grid::SliceMe(SubGrid *subgrid) {
   this->dx[dir] = dx;
 
   this->nghost[dir] = 0;
+  this->nghostStage[dir] = 0;
   this->np_tot[dir] = 1;
   this->np_int[dir] = 1;
   this->xbeg[dir] = subgrid->x0;
@@ -464,4 +824,5 @@ void Grid::SliceMe(SubGrid *subgrid) {
     nproc[dir] = 1;
     xproc[dir] = 0;
   #endif
+  procStart[dir] = {0, 1};
 }
@@ -36,11 +36,14 @@ class Grid {
   std::array<int,3> np_int;          ///< internal number of grid points (excluding ghosts)
 
   std::array<int,3> nghost;          ///< number of ghost cells
+  std::array<int,3> nghostStage;     ///< number of ghost cells consumed by one integration stage
   std::array<BoundaryType,3> lbound;          ///< Boundary condition to the left
   std::array<BoundaryType,3> rbound;          ///< Boundary condition to the right
 
   bool haveAxis{false};    ///< Do we require a special treatment of the axis in spherical coords?
   bool isRegularCartesian{true}; ///< whether the grid is regular and cartesian (true) or not
+  bool isUniformCartesian{false}; ///< whether the grid is cartesian with a constant spacing
+                                  ///< in each direction
 
   GridCoarsening haveGridCoarsening{GridCoarsening::disabled}; ///< Is grid coarsening enabled?
   std::array<bool,3> coarseningDirection;  ///< whether a coarsening is used in each direction
@@ -48,27 +51,50 @@ class Grid {
   // MPI data
   std::array<int,3> nproc;           ///</< Total number of procs in each direction
   std::array<int,3> xproc;           ///</< Coordinates of current proc in the array of procs
+  std::array<std::vector<int>,3> procStart; ///< First internal cell of each process slab
+                                            ///< (nproc+1 entries, the last one being np_int)
+
+  bool haveLoadBalance{false};       ///< Are the slab widths adapted to the measured load?
+  bool rebalanceRequested{false};    ///< Is a balanced decomposition waiting for a restart?
+  bool haveDeepHalo{false};          ///< Are the MPI halos deep enough for a full cycle?
 
   #ifdef WITH_MPI
-  MPI_Comm CartComm;                ///< Cartesian communicator for the planned domain decomposition
-  MPI_Comm AxisComm;                ///< Cartesian communicator to exchange data accross the axis
+  MPI_Comm CartComm{MPI_COMM_NULL}; ///< Cartesian communicator for the domain decomposition
+  MPI_Comm AxisComm{MPI_COMM_NULL}; ///< Cartesian communicator to exchange data accross the axis
                                     ///< (when applicable)
   #endif
 
   // Constructor
   explicit Grid(Input &);
   explicit Grid(SubGrid *);
+  ~Grid();
+  // The communicators are owned by the grid (freed in the destructor)
+  Grid(const Grid&) = delete;
+  Grid& operator=(const Grid&) = delete;
 
   void ShowConfig();
 
   void SliceMe(SubGrid *);       ///< Slice this grid according to the subgrid (internal function)
 
+  ///< Compute slab widths balancing the compute time measured on each process (collective)
+  void BalanceLoad(const std::vector<double> &, double);
+  std::vector<int> GetDecomposition(); ///< Decomposition to be stored in restart dumps
+
   Grid() = default;
 
  private:
-  // Check if number is a power of 2
-  bool isPow2(int);
-  void makeDomainDecomposition();
+  void makeDomainDecomposition(Input &);
+  std::array<int,3> GetExchangeWidth(Input &);
+  double DecompositionCost(const std::array<int,3> &, const std::array<int,3> &, bool);
+  bool autoDecomposition{false};     ///< whether the decomposition was chosen automatically
+  int64_t haloCells{0};              ///< cells exchanged by each process in the MPI halos
+
+  void InitDeepHalo(Input &);
+  void InitLoadBalance(Input &);
+  bool SetDecomposition(const std::vector<int> &);
+  std::array<bool,3> balanceDirection{false, false, false};
+  double balanceThreshold{20.0};     ///< MPI imbalance (in %) above which we rebalance
+  std::array<std::vector<int>,3> balancedStart; ///< Pending balanced decomposition
 };
 
 /**
@@ -29,6 +29,7 @@ GridHost::GridHost(Grid &grid) {
   haveAxis = grid.haveAxis;
 
   isRegularCartesian = grid.isRegularCartesian;
+  isUniformCartesian = grid.isUniformCartesian;
 
   // Create mirrors on host
   for(int dir = 0 ; dir < 3 ; dir++) {
@@ -262,6 +263,15 @@ if(haveAxis) {
   }
 }
 
+  // A uniform grid has exactly the same spacing in all the cells of each direction, so that
+  // the metric terms are constants
+  isUniformCartesian = isRegularCartesian;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    for(int i = 1 ; i < np_tot[dir] ; i++) {
+      if(dx[dir](i) != dx[dir](0)) isUniformCartesian = false;
+    }
+  }
+
   idfx::popRegion();
 }
 
@@ -278,6 +288,7 @@ void GridHost::SyncFromDevice() {
   xbeg = grid->xbeg;
   xend = grid->xend;
   isRegularCartesian = grid->isRegularCartesian;
+  isUniformCartesian = grid->isUniformCartesian;
 
   idfx::popRegion();
 }
@@ -296,6 +307,7 @@ void GridHost::SyncToDevice() {
   grid->xbeg = xbeg;
   grid->xend = xend;
   grid->isRegularCartesian = isRegularCartesian;
+  grid->isUniformCartesian = isUniformCartesian;
 
   idfx::popRegion();
 }
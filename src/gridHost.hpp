@@ -39,6 +39,7 @@ class GridHost {
 
   bool haveAxis=false;    ///< Do we require a special treatment of the axis in spherical coords?
   bool isRegularCartesian; ///< whether the grid is regular and cartesian or not
+  bool isUniformCartesian; ///< whether the grid is cartesian with a constant spacing in each dir
 
   explicit GridHost(Grid&);   ///< Constructor from a corresponding Grid on the Device.
                               ///< (NB: this constructor does not sync any data)
@@ -20,6 +20,7 @@
 #include "input.hpp"
 #include "version.hpp"
 #include "profiler.hpp"
+#include "loopTuner.hpp"
 
 // Flag will be set if a signal has been received
 bool Input::abortRequested = false;
@@ -171,11 +172,27 @@ void Input::ParseCommandLine(int argc, char **argv) {
       this->forceInitRequested = true;
     } else if(std::string(argv[i]) == "-nowrite") {
       this->forceNoWrite = true;
+      idfx::tuner.DisableCacheWrite();
       enableLogs = false;
     } else if(std::string(argv[i]) == "-nolog") {
       enableLogs = false;
     } else if(std::string(argv[i]) == "-profile") {
       idfx::prof.EnablePerformanceProfiling();
+    } else if(std::string(argv[i]) == "-perfreport") {
+      if((++i) >= argc) IDEFIX_ERROR(
+                      "You must specify -perfreport filename where filename is the JSON report.");
+      idfx::prof.EnablePerformanceReport(std::string(argv[i]));
+    } else if(std::string(argv[i]) == "-perftrace") {
+      if((++i) >= argc) IDEFIX_ERROR(
+                      "You must specify -perftrace prefix where prefix is the trace file prefix.");
+      idfx::prof.EnableTrace(std::string(argv[i]));
+    } else if(std::string(argv[i]) == "-profile_kernels") {
+      idfx::prof.EnablePerformanceProfiling();
+      idfx::kernelProfiling = true;
+    } else if(std::string(argv[i]) == "-tuningcache") {
+      if((++i) >= argc) IDEFIX_ERROR(
+                      "You must specify -tuningcache filename where filename is the cache file.");
+      idfx::tuner.SetCacheFile(std::string(argv[i]));
     } else if(std::string(argv[i]) == "-Werror") {
       idfx::warningsAreErrors = true;
     } else if(std::string(argv[i]) == "-version" || std::string(argv[i]) == "-v") {
@@ -406,6 +423,17 @@ void Input::PrintOptions() {
   idfx::cout << "         Do not write any log file." << std::endl;
   idfx::cout << " -profile" << std::endl;
   idfx::cout << "         Enable on-the-fly performance profiling." << std::endl;
+  idfx::cout << " -perfreport xxx" << std::endl;
+  idfx::cout << "         Enable performance profiling and write a JSON performance report in xxx."
+             << std::endl;
+  idfx::cout << " -perftrace xxx" << std::endl;
+  idfx::cout << "         Enable performance profiling and write the timeline of each process in "
+             << "xxx.<rank>.json (Chrome trace format)." << std::endl;
+  idfx::cout << " -profile_kernels" << std::endl;
+  idfx::cout << "         Enable performance profiling down to each individual kernel (slower)."
+             << std::endl;
+  idfx::cout << " -tuningcache xxx" << std::endl;
+  idfx::cout << "         Use xxx as the loop tuning cache (Idefix_LOOP_AUTOTUNE)." << std::endl;
   idfx::cout << " -Werror" << std::endl;
   idfx::cout << "         Consider warnings as errors." << std::endl;
   idfx::cout << " -v/-version" << std::endl;
@@ -15,6 +15,7 @@
 #include <string>
 #include "idefix.hpp"
 #include "global.hpp"
+#include "loopTuner.hpp"
 
 #define KOKKOS_VECTOR_LENGTH  8
 
@@ -81,9 +82,7 @@ template <typename Function>
 inline void idefix_for(const std::string & NAME,
                        const int & IB, const int & IE,
                        Function function) {
-  #ifdef DEBUG
-  idfx::pushRegion("idefix_for("+NAME+")");
-  #endif
+  if(idfx::kernelProfiling) idfx::pushKernelRegion("idefix_for", NAME, static_cast<int64_t>(IE-IB));
   const int NI = IE - IB;
   Kokkos::parallel_for(NAME, NI,
     KOKKOS_LAMBDA (const int& IDX) {
@@ -91,24 +90,18 @@ inline void idefix_for(const std::string & NAME,
       i += IB;
       function(i);
   });
-  #ifdef DEBUG
-  Kokkos::fence();
-  idfx::popRegion();
-  #endif
+  if(idfx::kernelProfiling) idfx::popKernelRegion();
 }
 
 
-// 2D loop
-template <typename Function>
-inline void idefix_for(const std::string & NAME,
-                       const int & JB, const int & JE,
-                       const int & IB, const int & IE,
-                       Function function) {
-  #ifdef DEBUG
-  idfx::pushRegion("idefix_for("+NAME+")");
-  #endif
+// 2D loop with a given pattern (and innermost tile size for MDRange loops)
+template <LoopPattern pattern, typename Function>
+inline void idefix_for_pattern(const std::string & NAME, const int tile,
+                               const int & JB, const int & JE,
+                               const int & IB, const int & IE,
+                               Function function) {
   // Kokkos 1D Range
-  if constexpr(defaultLoop == LoopPattern::RANGE) {
+  if constexpr(pattern == LoopPattern::RANGE) {
     const int NJ = JE - JB;
     const int NI = IE - IB;
     const int NJNI = NJ * NI;
@@ -122,13 +115,17 @@ inline void idefix_for(const std::string & NAME,
     });
 
     // MDRange loops
-  } else if constexpr(defaultLoop == LoopPattern::MDRANGE) {
-    Kokkos::parallel_for(NAME,
-      Kokkos::MDRangePolicy<Kokkos::Rank<2, Kokkos::Iterate::Right, Kokkos::Iterate::Right>>
-        ({JB,IB},{JE,IE}), function);
+  } else if constexpr(pattern == LoopPattern::MDRANGE) {
+    using policy = Kokkos::MDRangePolicy<Kokkos::Rank<2, Kokkos::Iterate::Right,
+                                                         Kokkos::Iterate::Right>>;
+    if(tile > 0) {
+      Kokkos::parallel_for(NAME, policy({JB,IB},{JE,IE},{1,tile}), function);
+    } else {
+      Kokkos::parallel_for(NAME, policy({JB,IB},{JE,IE}), function);
+    }
 
     // TeamPolicies with single inner loops
-  } else if constexpr(defaultLoop == LoopPattern::TPX || defaultLoop == LoopPattern::TPTTRTVR ) {
+  } else if constexpr(pattern == LoopPattern::TPX || pattern == LoopPattern::TPTTRTVR ) {
     const int NJ = JE - JB;
     Kokkos::parallel_for(NAME, team_policy (NJ, Kokkos::AUTO,KOKKOS_VECTOR_LENGTH),
       KOKKOS_LAMBDA (member_type team_member) {
@@ -140,7 +137,7 @@ inline void idefix_for(const std::string & NAME,
     });
 
     // SIMD FOR loops
-  } else if constexpr(defaultLoop == LoopPattern::SIMDFOR) {
+  } else if constexpr(pattern == LoopPattern::SIMDFOR) {
     for (auto j = JB; j < JE; j++)
 #pragma omp simd
       for (auto i = IB; i < IE; i++)
@@ -148,25 +145,18 @@ inline void idefix_for(const std::string & NAME,
   } else {
     throw std::runtime_error("Unknown/undefined LoopPattern used.");
   }
-  #ifdef DEBUG
-  Kokkos::fence();
-  idfx::popRegion();
-  #endif
 }
 
 
-// 3D loop
-template <typename Function>
-inline void idefix_for(const std::string & NAME,
-                       const int & KB, const int & KE,
-                       const int & JB, const int & JE,
-                       const int & IB, const int & IE,
-                       Function function) {
-  #ifdef DEBUG
-  idfx::pushRegion("idefix_for("+NAME+")");
-  #endif
+// 3D loop with a given pattern
+template <LoopPattern pattern, typename Function>
+inline void idefix_for_pattern(const std::string & NAME, const int tile,
+                               const int & KB, const int & KE,
+                               const int & JB, const int & JE,
+                               const int & IB, const int & IE,
+                               Function function) {
   // Kokkos 1D Range
-  if constexpr(defaultLoop == LoopPattern::RANGE) {
+  if constexpr(pattern == LoopPattern::RANGE) {
     const int NK = KE - KB;
     const int NJ = JE - JB;
     const int NI = IE - IB;
@@ -184,13 +174,17 @@ inline void idefix_for(const std::string & NAME,
     });
 
   // MDRange loops
-  } else if constexpr(defaultLoop == LoopPattern::MDRANGE) {
-    Kokkos::parallel_for(NAME,
-      Kokkos::MDRangePolicy<Kokkos::Rank<3, Kokkos::Iterate::Right, Kokkos::Iterate::Right>>
-        ({KB,JB,IB},{KE,JE,IE}), function);
+  } else if constexpr(pattern == LoopPattern::MDRANGE) {
+    using policy = Kokkos::MDRangePolicy<Kokkos::Rank<3, Kokkos::Iterate::Right,
+                                                         Kokkos::Iterate::Right>>;
+    if(tile > 0) {
+      Kokkos::parallel_for(NAME, policy({KB,JB,IB},{KE,JE,IE},{1,1,tile}), function);
+    } else {
+      Kokkos::parallel_for(NAME, policy({KB,JB,IB},{KE,JE,IE}), function);
+    }
 
   // TeamPolicy with single inner loops
-  } else if constexpr(defaultLoop == LoopPattern::TPX) {
+  } else if constexpr(pattern == LoopPattern::TPX) {
     const int NK = KE - KB;
     const int NJ = JE - JB;
     const int NKNJ = NK * NJ;
@@ -206,7 +200,7 @@ inline void idefix_for(const std::string & NAME,
       });
 
   // TeamPolicy with nested TeamThreadRange and ThreadVectorRange
-  } else if constexpr(defaultLoop == LoopPattern::TPTTRTVR) {
+  } else if constexpr(pattern == LoopPattern::TPTTRTVR) {
     const int NK = KE - KB;
     Kokkos::parallel_for(NAME,
       team_policy (NK, Kokkos::AUTO,KOKKOS_VECTOR_LENGTH),
@@ -224,7 +218,7 @@ inline void idefix_for(const std::string & NAME,
       });
 
   // SIMD FOR loops
-  } else if constexpr(defaultLoop == LoopPattern::SIMDFOR) {
+  } else if constexpr(pattern == LoopPattern::SIMDFOR) {
     for (auto k = KB; k < KE; k++)
       for (auto j = JB; j < JE; j++)
 #pragma omp simd
@@ -233,25 +227,18 @@ inline void idefix_for(const std::string & NAME,
   } else {
     throw std::runtime_error("Unknown/undefined LoopPattern used.");
   }
-  #ifdef DEBUG
-  Kokkos::fence();
-  idfx::popRegion();
-  #endif
 }
 
-// 4D loop
-template <typename Function>
-inline void idefix_for(const std::string & NAME,
-                       const int NB, const int NE,
-                       const int KB, const int KE,
-                       const int JB, const int JE,
-                       const int IB, const int IE,
-                       Function function) {
-  #ifdef DEBUG
-  idfx::pushRegion("idefix_for("+NAME+")");
-  #endif
+// 4D loop with a given pattern
+template <LoopPattern pattern, typename Function>
+inline void idefix_for_pattern(const std::string & NAME, const int tile,
+                               const int NB, const int NE,
+                               const int KB, const int KE,
+                               const int JB, const int JE,
+                               const int IB, const int IE,
+                               Function function) {
   // Kokkos 1D Range
-  if constexpr(defaultLoop == LoopPattern::RANGE) {
+  if constexpr(pattern == LoopPattern::RANGE) {
     const int NN = (NE) - (NB);
     const int NK = (KE) - (KB);
     const int NJ = (JE) - (JB);
@@ -273,13 +260,17 @@ inline void idefix_for(const std::string & NAME,
     });
 
   // MDRange loops
-  } else if constexpr(defaultLoop == LoopPattern::MDRANGE) {
-    Kokkos::parallel_for(NAME,
-      Kokkos::MDRangePolicy<Kokkos::Rank<4,Kokkos::Iterate::Right, Kokkos::Iterate::Right>>
-        ({NB,KB,JB,IB},{NE,KE,JE,IE}), function);
+  } else if constexpr(pattern == LoopPattern::MDRANGE) {
+    using policy = Kokkos::MDRangePolicy<Kokkos::Rank<4, Kokkos::Iterate::Right,
+                                                         Kokkos::Iterate::Right>>;
+    if(tile > 0) {
+      Kokkos::parallel_for(NAME, policy({NB,KB,JB,IB},{NE,KE,JE,IE},{1,1,1,tile}), function);
+    } else {
+      Kokkos::parallel_for(NAME, policy({NB,KB,JB,IB},{NE,KE,JE,IE}), function);
+    }
 
   // TeamPolicy loops
-  } else if constexpr(defaultLoop == LoopPattern::TPX) {
+  } else if constexpr(pattern == LoopPattern::TPX) {
     const int NN = NE - NB;
     const int NK = KE - KB;
     const int NJ = JE - JB;
@@ -301,7 +292,7 @@ inline void idefix_for(const std::string & NAME,
       });
 
   // TeamPolicy with nested TeamThreadRange and ThreadVectorRange
-  } else if constexpr(defaultLoop == LoopPattern::TPTTRTVR) {
+  } else if constexpr(pattern == LoopPattern::TPTTRTVR) {
     const int NN = NE - NB;
     const int NK = KE - KB;
     const int NNNK = NN * NK;
@@ -322,7 +313,7 @@ inline void idefix_for(const std::string & NAME,
       });
 
   // SIMD FOR loops
-  } else if constexpr(defaultLoop == LoopPattern::SIMDFOR) {
+  } else if constexpr(pattern == LoopPattern::SIMDFOR) {
     for (auto n = NB; n < NE; n++)
       for (auto k = KB; k < KE; k++)
         for (auto j = JB; j < JE; j++)
@@ -332,10 +323,78 @@ inline void idefix_for(const std::string & NAME,
   } else {
     throw std::runtime_error("Unknown/undefined LoopPattern used.");
   }
-  #ifdef DEBUG
-  Kokkos::fence();
-  idfx::popRegion();
-  #endif
+}
+
+// Run a multidimensional loop with the compile-time default pattern, or with the strategy
+// chosen at runtime for this kernel by the loop autotuner
+template <typename... Args>
+inline void idefix_for_dispatch(const std::string & NAME, const int rank, const int64_t cells,
+                                Args... args) {
+#ifdef LOOP_AUTOTUNE
+  if(idfx::tuner.enabled) {
+    // One handle per call site, since each kernel lambda instantiates its own dispatch
+    static idfx::TunerHandle handle;
+    idfx::tuner.Run(handle, NAME, rank, cells, [&] (const idfx::LoopStrategy &strategy) {
+      switch(strategy.pattern) {
+        case LoopPattern::RANGE:
+          idefix_for_pattern<LoopPattern::RANGE>(NAME, strategy.tile, args...);
+          break;
+        case LoopPattern::MDRANGE:
+          idefix_for_pattern<LoopPattern::MDRANGE>(NAME, strategy.tile, args...);
+          break;
+        case LoopPattern::TPX:
+          idefix_for_pattern<LoopPattern::TPX>(NAME, strategy.tile, args...);
+          break;
+        case LoopPattern::TPTTRTVR:
+          idefix_for_pattern<LoopPattern::TPTTRTVR>(NAME, strategy.tile, args...);
+          break;
+        default:
+          throw std::runtime_error("Unknown/undefined LoopPattern used.");
+      }
+    });
+    return;
+  }
+#endif
+  idefix_for_pattern<defaultLoop>(NAME, 0, args...);
+}
+
+// 2D loop
+template <typename Function>
+inline void idefix_for(const std::string & NAME,
+                       const int & JB, const int & JE,
+                       const int & IB, const int & IE,
+                       Function function) {
+  const int64_t cells = static_cast<int64_t>(JE-JB)*(IE-IB);
+  if(idfx::kernelProfiling) idfx::pushKernelRegion("idefix_for", NAME, cells);
+  idefix_for_dispatch(NAME, 2, cells, JB, JE, IB, IE, function);
+  if(idfx::kernelProfiling) idfx::popKernelRegion();
+}
+
+// 3D loop
+template <typename Function>
+inline void idefix_for(const std::string & NAME,
+                       const int & KB, const int & KE,
+                       const int & JB, const int & JE,
+                       const int & IB, const int & IE,
+                       Function function) {
+  const int64_t cells = static_cast<int64_t>(KE-KB)*(JE-JB)*(IE-IB);
+  if(idfx::kernelProfiling) idfx::pushKernelRegion("idefix_for", NAME, cells);
+  idefix_for_dispatch(NAME, 3, cells, KB, KE, JB, JE, IB, IE, function);
+  if(idfx::kernelProfiling) idfx::popKernelRegion();
+}
+
+// 4D loop
+template <typename Function>
+inline void idefix_for(const std::string & NAME,
+                       const int NB, const int NE,
+                       const int KB, const int KE,
+                       const int JB, const int JE,
+                       const int IB, const int IE,
+                       Function function) {
+  const int64_t cells = static_cast<int64_t>(NE-NB)*(KE-KB)*(JE-JB)*(IE-IB);
+  if(idfx::kernelProfiling) idfx::pushKernelRegion("idefix_for", NAME, cells);
+  idefix_for_dispatch(NAME, 4, cells, NB, NE, KB, KE, JB, JE, IB, IE, function);
+  if(idfx::kernelProfiling) idfx::popKernelRegion();
 }
 
 #endif // LOOP_HPP_
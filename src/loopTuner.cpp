@@ -0,0 +1,312 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "idefix.hpp"
+#include "loopTuner.hpp"
+#include "global.hpp"
+
+namespace idfx {
+
+static std::string PatternName(LoopPattern pattern) {
+  switch(pattern) {
+    case LoopPattern::SIMDFOR:
+      return("SIMD");
+    case LoopPattern::RANGE:
+      return("Range");
+    case LoopPattern::MDRANGE:
+      return("MDRange");
+    case LoopPattern::TPX:
+      return("TeamPolicy");
+    case LoopPattern::TPTTRTVR:
+      return("TeamPolicyInnerVector");
+    default:
+      return("Undefined");
+  }
+}
+
+static std::string KernelKey(const std::string &name, int rank, int sizeClass) {
+  return(std::to_string(rank) + " " + std::to_string(sizeClass) + " " + name);
+}
+
+// Kernels whose number of cells is within a factor of two share their strategy
+int LoopTuner::SizeClass(int64_t cells) {
+  int sizeClass = 0;
+  while(cells > 1) {
+    cells >>= 1;
+    sizeClass++;
+  }
+  return(sizeClass);
+}
+
+// Loop strategies tried for kernels of a given number of dimensions
+const std::vector<LoopStrategy>& LoopTuner::Candidates(int rank) {
+  static const std::vector<LoopStrategy> candidates2D = {
+    {LoopPattern::RANGE, 0},
+    {LoopPattern::MDRANGE, 0},
+    {LoopPattern::MDRANGE, 32},
+    {LoopPattern::MDRANGE, 128},
+    {LoopPattern::TPX, 0}
+  };
+  // TPX and TPTTRTVR only differ for loops of 3 dimensions and more
+  static const std::vector<LoopStrategy> candidates = {
+    {LoopPattern::RANGE, 0},
+    {LoopPattern::MDRANGE, 0},
+    {LoopPattern::MDRANGE, 32},
+    {LoopPattern::MDRANGE, 128},
+    {LoopPattern::TPX, 0},
+    {LoopPattern::TPTTRTVR, 0}
+  };
+  return(rank == 2 ? candidates2D : candidates);
+}
+
+// Tuning results are only valid for the execution space (and number of threads) they were
+// obtained with
+std::string LoopTuner::Signature() {
+  std::stringstream signature;
+  signature << Kokkos::DefaultExecutionSpace::name() << "/"
+            << Kokkos::DefaultExecutionSpace().concurrency();
+  return(signature.str());
+}
+
+void LoopTuner::SetCacheFile(std::string filename) {
+  this->cacheFile = filename;
+}
+
+void LoopTuner::DisableCacheWrite() {
+  this->writeCache = false;
+}
+
+// The map nodes are never erased, so that the call sites can keep a pointer to them
+TunedKernel& LoopTuner::GetKernel(const std::string &name, int rank, int sizeClass) {
+  if(!loaded) Load();
+  const std::string key = KernelKey(name, rank, sizeClass);
+  auto it = kernels.find(key);
+  if(it == kernels.end()) {
+    TunedKernel kernel;
+    kernel.time.resize(Candidates(rank).size(), std::numeric_limits<double>::max());
+    it = kernels.emplace(key, kernel).first;
+  }
+  return(it->second);
+}
+
+void LoopTuner::Record(TunedKernel &kernel, int rank, double time) {
+  const std::vector<LoopStrategy> &candidates = Candidates(rank);
+  const int candidate = kernel.nCalls / nTrials;
+  kernel.time[candidate] = std::min(kernel.time[candidate], time);
+  kernel.nCalls++;
+  if(kernel.nCalls == nTrials*static_cast<int>(candidates.size())) {
+    // Provisional winner, until the ranks agree on it in Synchronize
+    const int best = BestCandidate(kernel.time);
+    kernel.best = candidates[best];
+    kernel.bestTime = kernel.time[best];
+    kernel.measured = true;
+  }
+}
+
+int LoopTuner::BestCandidate(const std::vector<double> &time) {
+  int best = 0;
+  for(int n = 1 ; n < time.size() ; n++) {
+    if(time[n] < time[best]) best = n;
+  }
+  return(best);
+}
+
+// Each rank times the candidates on its own subdomain, so that the local winners may differ.
+// The ranks agree here on the candidate that is the fastest on the slowest rank, which is what
+// sets the time step duration. This is collective, and called at the end of each cycle, since
+// kernels are not necessarily launched by all the ranks at the same time.
+void LoopTuner::Synchronize() {
+  if(!enabled) return;
+  int nMeasured = 0;
+  for(auto const &[key, kernel] : kernels) {
+    if(kernel.measured && !kernel.tuned) nMeasured++;
+  }
+#ifdef WITH_MPI
+  if(idfx::psize > 1) {
+    int nMeasuredGlobal;
+    MPI_SAFE_CALL(MPI_Allreduce(&nMeasured, &nMeasuredGlobal, 1, MPI_INT, MPI_SUM,
+                                MPI_COMM_WORLD));
+    if(nMeasuredGlobal == 0) return;
+
+    // Send the candidate times of the kernels measured since the last call to rank 0, one line
+    // per kernel: <rank> <size class> <time of each candidate> <kernel name>
+    std::stringstream local;
+    local << std::scientific << std::setprecision(17);
+    for(auto const &[key, kernel] : kernels) {
+      if(!kernel.measured || kernel.tuned) continue;
+      // the key is "<rank> <size class> <name>"
+      const size_t space = key.find(' ', key.find(' ')+1);
+      local << key.substr(0, space);
+      for(double time : kernel.time) local << " " << time;
+      local << " " << key.substr(space+1) << "\n";
+    }
+    const std::string localTimes = local.str();
+    int localSize = static_cast<int>(localTimes.size());
+    std::vector<int> sizes(idfx::psize), offsets(idfx::psize, 0);
+    MPI_SAFE_CALL(MPI_Gather(&localSize, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0,
+                             MPI_COMM_WORLD));
+    int globalSize = 0;
+    if(idfx::prank == 0) {
+      for(int p = 0 ; p < idfx::psize ; p++) {
+        offsets[p] = globalSize;
+        globalSize += sizes[p];
+      }
+    }
+    std::string globalTimes(globalSize, ' ');
+    MPI_SAFE_CALL(MPI_Gatherv(localTimes.data(), localSize, MPI_CHAR, globalTimes.data(),
+                              sizes.data(), offsets.data(), MPI_CHAR, 0, MPI_COMM_WORLD));
+
+    // Rank 0 keeps the time of the slowest rank for each candidate, and chooses the winners:
+    // <rank> <size class> <winner> <time per cell> <kernel name>
+    std::string winners;
+    if(idfx::prank == 0) {
+      std::map<std::string, std::vector<double>> slowest;
+      std::istringstream lines(globalTimes);
+      std::string line;
+      while(std::getline(lines, line)) {
+        std::istringstream entry(line);
+        int rank, sizeClass;
+        entry >> rank >> sizeClass;
+        std::vector<double> time(Candidates(rank).size());
+        for(double &t : time) entry >> t;
+        std::string name;
+        entry >> std::ws;
+        std::getline(entry, name);
+        auto it = slowest.emplace(KernelKey(name, rank, sizeClass), time).first;
+        for(int n = 0 ; n < time.size() ; n++) {
+          it->second[n] = std::max(it->second[n], time[n]);
+        }
+      }
+      std::stringstream decision;
+      decision << std::scientific << std::setprecision(17);
+      for(auto const &[key, time] : slowest) {
+        const size_t space = key.find(' ', key.find(' ')+1);
+        const int best = BestCandidate(time);
+        decision << key.substr(0, space) << " " << best << " " << time[best] << " "
+                 << key.substr(space+1) << "\n";
+      }
+      winners = decision.str();
+    }
+    int winnersSize = static_cast<int>(winners.size());
+    MPI_SAFE_CALL(MPI_Bcast(&winnersSize, 1, MPI_INT, 0, MPI_COMM_WORLD));
+    winners.resize(winnersSize);
+    MPI_SAFE_CALL(MPI_Bcast(winners.data(), winnersSize, MPI_CHAR, 0, MPI_COMM_WORLD));
+
+    // Every rank applies the winners, including to the kernels it has not measured (yet)
+    std::istringstream lines(winners);
+    std::string line;
+    while(std::getline(lines, line)) {
+      std::istringstream entry(line);
+      int rank, sizeClass, best;
+      double time;
+      std::string name;
+      entry >> rank >> sizeClass >> best >> time >> std::ws;
+      std::getline(entry, name);
+      TunedKernel &kernel = GetKernel(name, rank, sizeClass);
+      if(!kernel.tuned) nTuned++;
+      kernel.best = Candidates(rank)[best];
+      kernel.bestTime = time;
+      kernel.tuned = true;
+    }
+    return;
+  }
+#endif
+  if(nMeasured == 0) return;
+  for(auto &[key, kernel] : kernels) {
+    if(!kernel.measured || kernel.tuned) continue;
+    kernel.tuned = true;
+    nTuned++;
+  }
+}
+
+// Read the strategies found by previous runs. The file format is one line per kernel:
+// <rank> <size class> <pattern> <tile> <time per cell> <kernel name>
+void LoopTuner::Load() {
+  loaded = true;
+  std::ifstream file(cacheFile);
+  if(!file.is_open()) return;
+
+  std::string line;
+  std::getline(file, line);
+  if(line != "# Idefix loop tuning cache v2 for " + Signature()) {
+    IDEFIX_WARNING("Loop tuning cache " + cacheFile
+                   + " was obtained on another architecture or by an older version, it is"
+                   + " ignored.");
+    return;
+  }
+  int nRead = 0;
+  while(std::getline(file, line)) {
+    if(line.empty() || line[0] == '#') continue;
+    std::istringstream entry(line);
+    int rank, sizeClass;
+    std::string patternName;
+    LoopStrategy strategy;
+    double time;
+    std::string name;
+    entry >> rank >> sizeClass >> patternName >> strategy.tile >> time >> std::ws;
+    std::getline(entry, name);
+    if(entry.fail() || name.empty() || rank < 2 || rank > 4 || sizeClass < 0) continue;
+    // Only accept strategies the tuner would have chosen from
+    bool valid = false;
+    for(const LoopStrategy &candidate : Candidates(rank)) {
+      if(PatternName(candidate.pattern) == patternName && candidate.tile == strategy.tile) {
+        strategy.pattern = candidate.pattern;
+        valid = true;
+      }
+    }
+    if(!valid) continue;
+    TunedKernel kernel;
+    kernel.tuned = true;
+    kernel.best = strategy;
+    kernel.bestTime = time;
+    kernels[KernelKey(name, rank, sizeClass)] = kernel;
+    nRead++;
+  }
+  idfx::cout << "LoopTuner: read the loop strategies of " << nRead << " kernels from "
+             << cacheFile << "." << std::endl;
+}
+
+void LoopTuner::Finalize() {
+  if(!enabled) return;
+  Synchronize();
+  int nPending = 0;
+  for(auto const &[key, kernel] : kernels) {
+    if(!kernel.tuned && kernel.nCalls > 0) nPending++;
+  }
+  idfx::cout << "LoopTuner: " << nTuned << " kernels tuned during this run";
+  if(nPending > 0) idfx::cout << ", " << nPending << " not called often enough to be tuned";
+  idfx::cout << "." << std::endl;
+
+  if(nTuned == 0 || !writeCache || idfx::prank != 0) return;
+
+  std::ofstream file(cacheFile);
+  if(!file.is_open()) {
+    IDEFIX_WARNING("Cannot write the loop tuning cache " + cacheFile);
+    return;
+  }
+  file << "# Idefix loop tuning cache v2 for " << Signature() << std::endl;
+  file << "# rank size_class pattern tile time_per_cell(s) kernel" << std::endl;
+  for(auto const &[key, kernel] : kernels) {
+    if(!kernel.tuned) continue;
+    // the key is "<rank> <size class> <name>"
+    const size_t space = key.find(' ', key.find(' ')+1);
+    file << key.substr(0, space) << " " << PatternName(kernel.best.pattern) << " "
+         << kernel.best.tile << " " << std::scientific << std::setprecision(3)
+         << kernel.bestTime << " " << key.substr(space+1) << std::endl;
+  }
+  idfx::cout << "LoopTuner: loop strategies saved in " << cacheFile << "." << std::endl;
+}
+
+}// namespace idfx
@@ -0,0 +1,107 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#ifndef LOOPTUNER_HPP_
+#define LOOPTUNER_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "idefix.hpp"
+
+namespace idfx {
+
+// One way of running an idefix_for loop
+struct LoopStrategy {
+  LoopPattern pattern{LoopPattern::UNDEFINED};
+  int tile{0};    // innermost tile of MDRange loops (0: let Kokkos decide)
+};
+
+// Tuning state of a kernel
+struct TunedKernel {
+  bool tuned{false};            // strategy agreed by all the ranks
+  bool measured{false};         // all the candidates were timed on this rank
+  LoopStrategy best;            // provisional local winner until the kernel is tuned
+  double bestTime{0};           // time per cell of the best strategy
+  int nCalls{0};                // number of timed calls so far
+  std::vector<double> time;     // best time per cell of each candidate strategy
+};
+
+// Tuning state last used by an idefix_for call site, which saves the lookup of the kernel on
+// the following launches as long as the size class does not change (a call site always
+// launches the same kernel)
+struct TunerHandle {
+  TunedKernel *kernel{nullptr};
+  int sizeClass{-1};
+};
+
+// LoopTuner chooses at runtime the fastest loop strategy of each multidimensional idefix_for.
+// The candidates are timed in turn on the first calls of each kernel (identified by its name,
+// its number of dimensions and its size class, since the best strategy depends on the extents).
+// Once a rank has timed all the candidates of a kernel, it runs its local winner until the next
+// Synchronize, where the ranks agree on the candidate with the lowest time on the slowest rank.
+// The winners are saved in a cache file at the end of the run, so that the next runs on the
+// same machine start tuned.
+class LoopTuner {
+ public:
+  // handle, name, rank, cells, loop(LoopStrategy)
+  template <typename Loop>
+  void Run(TunerHandle &, const std::string &, int, int64_t, Loop);
+  void SetCacheFile(std::string);
+  void DisableCacheWrite();
+  void Synchronize();                     // Agree on the winners measured so far (collective)
+  void Finalize();                        // Save the cache file and show a summary
+
+  bool enabled{false};
+
+ private:
+  TunedKernel& GetKernel(const std::string &, int, int);
+  void Record(TunedKernel &, int, double);
+  void Load();
+  static const std::vector<LoopStrategy>& Candidates(int);
+  static int BestCandidate(const std::vector<double> &);
+  static std::string Signature();
+  static int SizeClass(int64_t);
+
+  std::map<std::string, TunedKernel> kernels;   // indexed by "<rank> <size class> <name>"
+  std::string cacheFile{"idefix.tuning"};
+  bool loaded{false};
+  bool writeCache{true};
+  int nTuned{0};                          // number of kernels agreed on during this run
+  static constexpr int nTrials{3};        // timed calls per candidate (the fastest is kept)
+};
+
+template <typename Loop>
+void LoopTuner::Run(TunerHandle &handle, const std::string &name, int rank, int64_t cells,
+                    Loop loop) {
+  const std::vector<LoopStrategy> &candidates = Candidates(rank);
+  // Empty loops tell nothing about the candidates
+  if(cells <= 0) {
+    loop(candidates[0]);
+    return;
+  }
+  const int sizeClass = SizeClass(cells);
+  if(handle.kernel == nullptr || handle.sizeClass != sizeClass) {
+    handle.kernel = &GetKernel(name, rank, sizeClass);
+    handle.sizeClass = sizeClass;
+  }
+  TunedKernel &kernel = *handle.kernel;
+  if(kernel.tuned || kernel.measured) {
+    loop(kernel.best);
+    return;
+  }
+  const int candidate = kernel.nCalls / nTrials;
+  Kokkos::fence();
+  Kokkos::Timer timer;
+  loop(candidates[candidate]);
+  Kokkos::fence();
+  Record(kernel, rank, timer.seconds()/static_cast<double>(cells));
+}
+
+}// namespace idfx
+
+#endif // LOOPTUNER_HPP_
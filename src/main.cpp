@@ -29,11 +29,13 @@
 
 #include "idefix.hpp"
 #include "profiler.hpp"
+#include "loopTuner.hpp"
 #include "input.hpp"
 #include "grid.hpp"
 #include "gridHost.hpp"
 #include "fluid.hpp"
 #include "dataBlock.hpp"
+#include "particles.hpp"
 #include "timeIntegrator.hpp"
 #include "setup.hpp"
 #include "output.hpp"
@@ -69,13 +71,21 @@ int main( int argc, char* argv[] ) {
   if(!initKokkosBeforeMPI) Kokkos::initialize( argc, argv );
 
 
-  {
-    idfx::initialize();
+  idfx::initialize();
+  // Dump from which the code restarts when the domain decomposition is rebalanced
+  int rebalanceDump = -1;
+
+  do {
     ///////////////////////////////
     // Initialization
     ///////////////////////////////
 
     Input input(argc, argv);
+    if(rebalanceDump >= 0) {
+      input.restartRequested = true;
+      input.restartFileNumber = rebalanceDump;
+      rebalanceDump = -1;
+    }
     input.PrintLogo();
     idfx::cout << "Main: initialization stage." << std::endl;
 
@@ -168,6 +178,7 @@ int main( int argc, char* argv[] ) {
       idfx::popRegion();
       data.DeriveVectorPotential();   // This does something only when evolveVectorPotential is on
       data.SetBoundaries();
+      if(data.haveParticles) data.particles->InitFromGas();
       data.Validate();
       output.CheckForWrites(data);
     }
@@ -205,6 +216,11 @@ int main( int argc, char* argv[] ) {
         break;
       }
       output.CheckForWrites(data);
+      if(grid.rebalanceRequested) {
+        idfx::cout << "Main: Saving current state to rebalance the domain." << std::endl;
+        rebalanceDump = output.ForceWriteDump(data);
+        break;
+      }
       if(input.CheckForAbort() || Tint.CheckForMaxRuntime() ) {
         idfx::cout << "Main: Saving current state and aborting calculation." << std::endl;
         output.ForceWriteDump(data);
@@ -218,6 +234,13 @@ int main( int argc, char* argv[] ) {
         }
       }
     }
+    if(rebalanceDump >= 0) {
+      idfx::cout << "Main: Restarting from dump " << rebalanceDump << "." << std::endl;
+      // The performance report only covers the run with the final decomposition
+      idfx::prof.Reset();
+      idfx::mpiCallsTimer = 0.0;
+      continue;
+    }
 
     int n_days{0}, n_hours{0}, n_minutes{0}, n_seconds{0};
     div_t divres;
@@ -276,9 +299,22 @@ int main( int argc, char* argv[] ) {
     idfx::cout << "Outputs represent "
                << static_cast<int>(100.0*output.GetTimer()/timer.seconds())
               << "% of total run time." << std::endl;
+
+    // Global metrics for the machine-readable performance report
+    idfx::prof.AddMetric("cell_updates_per_second", 1/perfs);
+    idfx::prof.AddMetric("cells", static_cast<double>(grid.np_int[IDIR])*grid.np_int[JDIR]
+                                   *grid.np_int[KDIR]);
+    idfx::prof.AddMetric("cycles", static_cast<double>(Tint.GetNCycles()));
+    idfx::prof.AddMetric("wallclock_seconds", timer.seconds());
+    idfx::prof.AddMetric("output_overhead_percent", 100.0*output.GetTimer()/timer.seconds());
+    #ifdef WITH_MPI
+      idfx::prof.AddMetric("mpi_overhead_percent", 100.0*idfx::mpiCallsTimer/timer.seconds());
+    #endif
     // Show profiler output
     idfx::prof.Show();
-  }
+  } while(rebalanceDump >= 0);
+
+  idfx::tuner.Finalize();
 
   if(returnCode<0) {
     idfx::cout << "Main: Job was interrupted before completion." << std::endl;
@@ -287,6 +323,9 @@ int main( int argc, char* argv[] ) {
   } else {
     idfx::cout << "Main: Job completed successfully." << std::endl;
   }
+#ifdef WITH_MPI
+  Mpi::Finalize();
+#endif
   Kokkos::finalize();
 
 #ifdef WITH_MPI
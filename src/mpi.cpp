@@ -8,6 +8,7 @@
 
 #include "mpi.hpp"
 #include <signal.h>
+#include <algorithm>
 #include <string>
 #include <chrono>   // NOLINT [build/c++11]
 #include <thread>  // NOLINT [build/c++11]
@@ -15,6 +16,7 @@
 #include <vector>
 #include "idefix.hpp"
 #include "dataBlock.hpp"
+#include "profiler.hpp"
 
 
 #if defined(OPEN_MPI) && OPEN_MPI
@@ -25,8 +27,160 @@
 //#define MPI_NON_BLOCKING
 #define MPI_PERSISTENT
 
+#ifdef MPI_SHARED_MEMORY
+  #ifndef MPI_PERSISTENT
+    #error "MPI_SHARED_MEMORY requires MPI_PERSISTENT communications"
+  #endif
+  static_assert(Kokkos::SpaceAccessibility<Kokkos::DefaultExecutionSpace,
+                                           Kokkos::HostSpace>::accessible,
+                "MPI_SHARED_MEMORY requires an execution space able to access host memory");
+#endif
+
 // init the number of instances
 int Mpi::nInstances = 0;
+MPI_Comm Mpi::nodeComm = MPI_COMM_NULL;
+std::vector<Mpi*> Mpi::sharedInstances;
+
+///
+/// Allocate the send buffers of one direction. When compiled with MPI_SHARED_MEMORY, the buffers
+/// are allocated in an MPI-3 shared memory window, so that neighbours running on the same node
+/// unpack them in place instead of receiving a copy through MPI. Both ends then only exchange
+/// zero-size messages to tell when a buffer is packed ("ready") and when it has been read ("done").
+/// @param dir: direction of the exchange
+/// @param bufferSize: number of reals in each buffer
+/// @param sendBuffer: send buffers of this process (output)
+/// @param neighbourBuffer: send buffers of the node-local neighbours, if any (output)
+///
+void Mpi::InitSendBuffers(int dir, int bufferSize, Buffer *sendBuffer, Buffer *neighbourBuffer) {
+#ifdef MPI_SHARED_MEMORY
+  if(mygrid->nproc[dir] > 1) {
+    if(nodeComm == MPI_COMM_NULL) {
+      MPI_SAFE_CALL(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, idfx::prank,
+                                        MPI_INFO_NULL, &nodeComm));
+    }
+    // Our segment of the window holds the right send buffer, followed by the left one
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "alloc_shared_noncontig", "true");
+    real *base;
+    MPI_SAFE_CALL(MPI_Win_allocate_shared(2*bufferSize*sizeof(real), sizeof(real), info,
+                                          nodeComm, &base, &window[dir]));
+    MPI_Info_free(&info);
+    MPI_SAFE_CALL(MPI_Win_lock_all(MPI_MODE_NOCHECK, window[dir]));
+    haveSharedWindow[dir] = true;
+    if(std::find(sharedInstances.begin(), sharedInstances.end(), this) == sharedInstances.end()) {
+      sharedInstances.push_back(this);
+    }
+
+    sendBuffer[faceRight] = Buffer(base, bufferSize, dir);
+    sendBuffer[faceLeft] = Buffer(base + bufferSize, bufferSize, dir);
+
+    int neighbour[2];
+    MPI_SAFE_CALL(MPI_Cart_shift(mygrid->CartComm, dir, 1,
+                                 &neighbour[faceLeft], &neighbour[faceRight]));
+
+    MPI_Group cartGroup, nodeGroup;
+    MPI_SAFE_CALL(MPI_Comm_group(mygrid->CartComm, &cartGroup));
+    MPI_SAFE_CALL(MPI_Comm_group(nodeComm, &nodeGroup));
+
+    for(int face : {faceRight, faceLeft}) {
+      int nodeRank = MPI_UNDEFINED;
+      if(neighbour[face] != MPI_PROC_NULL) {
+        MPI_SAFE_CALL(MPI_Group_translate_ranks(cartGroup, 1, &neighbour[face],
+                                                nodeGroup, &nodeRank));
+      }
+      localNeighbour[dir][face] = (nodeRank != MPI_UNDEFINED);
+      if(localNeighbour[dir][face]) {
+        // Our right neighbour sends us its left buffer, and conversely
+        MPI_Aint size;
+        int dispUnit;
+        real *ptr;
+        MPI_SAFE_CALL(MPI_Win_shared_query(window[dir], nodeRank, &size, &dispUnit, &ptr));
+        neighbourBuffer[face] = Buffer(face == faceRight ? ptr + bufferSize : ptr, bufferSize,
+                                       dir);
+      }
+      // Notifications: messages travelling to the right and to the left have different tags.
+      // Remote faces talk to MPI_PROC_NULL, so that all the requests can be started together.
+      const int peer = localNeighbour[dir][face] ? neighbour[face] : MPI_PROC_NULL;
+      const int tagTo = thisInstance*1000 + 10*dir + (face == faceRight ? 2 : 3);
+      const int tagFrom = thisInstance*1000 + 10*dir + (face == faceRight ? 3 : 2);
+      MPI_SAFE_CALL(MPI_Send_init(nullptr, 0, MPI_BYTE, peer, tagTo, mygrid->CartComm,
+                                  &readyRequest[dir][face]));
+      MPI_SAFE_CALL(MPI_Recv_init(nullptr, 0, MPI_BYTE, peer, tagFrom, mygrid->CartComm,
+                                  &readyRequest[dir][2+face]));
+      MPI_SAFE_CALL(MPI_Send_init(nullptr, 0, MPI_BYTE, peer, tagTo+2, mygrid->CartComm,
+                                  &doneRequest[dir][face]));
+      MPI_SAFE_CALL(MPI_Recv_init(nullptr, 0, MPI_BYTE, peer, tagFrom+2, mygrid->CartComm,
+                                  &doneRequest[dir][2+face]));
+    }
+    MPI_Group_free(&cartGroup);
+    MPI_Group_free(&nodeGroup);
+    return;
+  }
+#endif
+  sendBuffer[faceLeft] = Buffer(bufferSize, dir);
+  sendBuffer[faceRight] = Buffer(bufferSize, dir);
+}
+
+// Start the persistent requests of the faces whose neighbour is not on our node
+void Mpi::StartRemoteRequests(MPI_Request *request, int dir) {
+  for(int face : {faceRight, faceLeft}) {
+    if(!localNeighbour[dir][face]) MPI_SAFE_CALL(MPI_Start(&request[face]));
+  }
+}
+
+// Publish our packed send buffers, and wait until the node-local neighbours have packed theirs
+void Mpi::ShareBuffers(int dir) {
+  if(!haveSharedWindow[dir]) return;
+  Kokkos::fence();
+  MPI_SAFE_CALL(MPI_Win_sync(window[dir]));
+  MPI_SAFE_CALL(MPI_Startall(4, readyRequest[dir]));
+  MPI_SAFE_CALL(MPI_Waitall(4, readyRequest[dir], MPI_STATUSES_IGNORE));
+  MPI_SAFE_CALL(MPI_Win_sync(window[dir]));
+}
+
+// Tell the node-local neighbours that we are done reading their send buffers
+void Mpi::ReleaseSharedBuffers(int dir) {
+  if(!haveSharedWindow[dir]) return;
+  Kokkos::fence();
+  MPI_SAFE_CALL(MPI_Startall(4, doneRequest[dir]));
+  donePending[dir] = true;
+}
+
+// Our send buffers can only be overwritten once the node-local neighbours have read them
+void Mpi::WaitSharedBuffersReleased(int dir) {
+  if(!donePending[dir]) return;
+  MPI_SAFE_CALL(MPI_Waitall(4, doneRequest[dir], MPI_STATUSES_IGNORE));
+  donePending[dir] = false;
+}
+
+// Free the shared windows of this instance and their notification requests (collective on the
+// node)
+void Mpi::FreeSharedWindows() {
+  for(int dir=0 ; dir < 3 ; dir++) {
+    if(!haveSharedWindow[dir]) continue;
+    WaitSharedBuffersReleased(dir);
+    for(int i=0 ; i < 4 ; i++) {
+      MPI_Request_free( &readyRequest[dir][i]);
+      MPI_Request_free( &doneRequest[dir][i]);
+    }
+    MPI_Win_unlock_all(window[dir]);
+    MPI_Win_free(&window[dir]);
+    haveSharedWindow[dir] = false;
+  }
+  sharedInstances.erase(std::remove(sharedInstances.begin(), sharedInstances.end(), this),
+                        sharedInstances.end());
+}
+
+// The instances are normally destroyed with the objects holding them, but some may outlive the
+// run (e.g. static objects of a setup): their windows, and the node communicator shared by all
+// the instances, have to be freed before MPI is finalized.
+void Mpi::Finalize() {
+  while(!sharedInstances.empty()) {
+    sharedInstances.back()->FreeSharedWindows();
+  }
+  if(nodeComm != MPI_COMM_NULL) MPI_Comm_free(&nodeComm);
+}
 
 // MPI Routines exchange
 void Mpi::ExchangeAll() {
@@ -69,6 +223,18 @@ void Mpi::Init(Grid *grid, std::vector<int> inputMap,
     this->end[dir] = nghost[dir]+nint[dir];
   }
 
+  // Each packed or unpacked point is one read and one write, for the bandwidth of the
+  // kernel profiling reports. The kernels are shared by all of the Mpi instances.
+  static bool haveKernelTraffic = false;
+  if(!haveKernelTraffic) {
+    for(int dir = 0 ; dir < 3 ; dir++) {
+      const std::string name = "BufferX" + std::to_string(dir+1);
+      idfx::prof.SetKernelTraffic("Pack" + name, 2*sizeof(real), 0);
+      idfx::prof.SetKernelTraffic("Unpack" + name, 2*sizeof(real), 0);
+    }
+    haveKernelTraffic = true;
+  }
+
   /////////////////////////////////////////////////////////////////////////////
   // Init exchange datasets
   bufferSizeX1 = 0;
@@ -90,10 +256,9 @@ void Mpi::Init(Grid *grid, std::vector<int> inputMap,
   }
 
 
-  BufferRecvX1[faceLeft ] = Buffer(bufferSizeX1);
-  BufferRecvX1[faceRight] = Buffer(bufferSizeX1);
-  BufferSendX1[faceLeft ] = Buffer(bufferSizeX1);
-  BufferSendX1[faceRight] = Buffer(bufferSizeX1);
+  BufferRecvX1[faceLeft ] = Buffer(bufferSizeX1, IDIR);
+  BufferRecvX1[faceRight] = Buffer(bufferSizeX1, IDIR);
+  InitSendBuffers(IDIR, bufferSizeX1, BufferSendX1, BufferNeighbourX1);
 
   // Number of cells in X2 boundary condition (only required when problem >2D):
 #if DIMENSIONS >= 2
@@ -109,10 +274,9 @@ void Mpi::Init(Grid *grid, std::vector<int> inputMap,
     #endif  // DIMENSIONS
   }
 
-  BufferRecvX2[faceLeft ] = Buffer(bufferSizeX2);
-  BufferRecvX2[faceRight] = Buffer(bufferSizeX2);
-  BufferSendX2[faceLeft ] = Buffer(bufferSizeX2);
-  BufferSendX2[faceRight] = Buffer(bufferSizeX2);
+  BufferRecvX2[faceLeft ] = Buffer(bufferSizeX2, JDIR);
+  BufferRecvX2[faceRight] = Buffer(bufferSizeX2, JDIR);
+  InitSendBuffers(JDIR, bufferSizeX2, BufferSendX2, BufferNeighbourX2);
 
 #endif
 // Number of cells in X3 boundary condition (only required when problem is 3D):
@@ -128,10 +292,9 @@ void Mpi::Init(Grid *grid, std::vector<int> inputMap,
     bufferSizeX3 += ntot[IDIR] * ntot[JDIR] * nghost[KDIR];
   }
 
-  BufferRecvX3[faceLeft ] = Buffer(bufferSizeX3);
-  BufferRecvX3[faceRight] = Buffer(bufferSizeX3);
-  BufferSendX3[faceLeft ] = Buffer(bufferSizeX3);
-  BufferSendX3[faceRight] = Buffer(bufferSizeX3);
+  BufferRecvX3[faceLeft ] = Buffer(bufferSizeX3, KDIR);
+  BufferRecvX3[faceRight] = Buffer(bufferSizeX3, KDIR);
+  InitSendBuffers(KDIR, bufferSizeX3, BufferSendX3, BufferNeighbourX3);
 #endif // DIMENSIONS
 
 #ifdef MPI_PERSISTENT
@@ -202,6 +365,17 @@ void Mpi::Init(Grid *grid, std::vector<int> inputMap,
 
 #endif // MPI_Persistent
 
+#ifdef MPI_SHARED_MEMORY
+  if(thisInstance==1) {
+    int nLocal = 0;
+    for(int dir=0 ; dir < DIMENSIONS ; dir++) {
+      nLocal += localNeighbour[dir][faceLeft] + localNeighbour[dir][faceRight];
+    }
+    idfx::cout << "Mpi(" << thisInstance << "): exchanging halos with " << nLocal
+               << " node-local neighbour(s) through shared memory." << std::endl;
+  }
+#endif
+
   // say this instance is initialized.
   isInitialized = true;
 
@@ -216,6 +390,7 @@ Mpi::~Mpi() {
     #ifdef MPI_PERSISTENT
       idfx::cout << "Mpi(" << thisInstance
                 << "): Cleaning up MPI persistent communication channels" << std::endl;
+      FreeSharedWindows();
       for(int i=0 ; i< 2; i++) {
         MPI_Request_free( &sendRequestX1[i]);
         MPI_Request_free( &recvRequestX1[i]);
@@ -260,7 +435,9 @@ void Mpi::ExchangeX1(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
   MPI_Status sendStatus[2];
   MPI_Status recvStatus[2];
 
-  MPI_SAFE_CALL(MPI_Startall(2, recvRequestX1));
+  StartRemoteRequests(recvRequestX1, IDIR);
+  // Wait until node-local neighbours are done reading our previous send buffers
+  WaitSharedBuffersReleased(IDIR);
   idfx::mpiCallsTimer += MPI_Wtime() - tStart;
 #endif
   myTimer += MPI_Wtime();
@@ -328,7 +505,8 @@ void Mpi::ExchangeX1(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
   myTimer -= MPI_Wtime();
   tStart = MPI_Wtime();
 #ifdef MPI_PERSISTENT
-  MPI_SAFE_CALL(MPI_Startall(2, sendRequestX1));
+  StartRemoteRequests(sendRequestX1, IDIR);
+  ShareBuffers(IDIR);
   // Wait for buffers to be received
   MPI_Waitall(2,recvRequestX1,recvStatus);
 
@@ -387,6 +565,11 @@ void Mpi::ExchangeX1(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
   // Unpack
   BufferLeft=BufferRecvX1[faceLeft];
   BufferRight=BufferRecvX1[faceRight];
+#ifdef MPI_PERSISTENT
+  // Node-local neighbours: read their send buffers directly
+  if(localNeighbour[IDIR][faceLeft]) BufferLeft = BufferNeighbourX1[faceLeft];
+  if(localNeighbour[IDIR][faceRight]) BufferRight = BufferNeighbourX1[faceRight];
+#endif
 
   BufferLeft.ResetPointer();
   BufferRight.ResetPointer();
@@ -437,6 +620,7 @@ myTimer -= MPI_Wtime();
 #endif
 
 #ifdef MPI_PERSISTENT
+  ReleaseSharedBuffers(IDIR);
   MPI_Waitall(2, sendRequestX1, sendStatus);
 #endif
   myTimer += MPI_Wtime();
@@ -462,7 +646,9 @@ void Mpi::ExchangeX2(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
   MPI_Status sendStatus[2];
   MPI_Status recvStatus[2];
 
-  MPI_SAFE_CALL(MPI_Startall(2, recvRequestX2));
+  StartRemoteRequests(recvRequestX2, JDIR);
+  // Wait until node-local neighbours are done reading our previous send buffers
+  WaitSharedBuffersReleased(JDIR);
   idfx::mpiCallsTimer += MPI_Wtime() - tStart;
 #endif
   myTimer += MPI_Wtime();
@@ -527,7 +713,8 @@ void Mpi::ExchangeX2(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
   myTimer -= MPI_Wtime();
   tStart = MPI_Wtime();
 #ifdef MPI_PERSISTENT
-  MPI_SAFE_CALL(MPI_Startall(2, sendRequestX2));
+  StartRemoteRequests(sendRequestX2, JDIR);
+  ShareBuffers(JDIR);
   MPI_Waitall(2,recvRequestX2,recvStatus);
 
 #else
@@ -585,6 +772,11 @@ void Mpi::ExchangeX2(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
   // Unpack
   BufferLeft=BufferRecvX2[faceLeft];
   BufferRight=BufferRecvX2[faceRight];
+#ifdef MPI_PERSISTENT
+  // Node-local neighbours: read their send buffers directly
+  if(localNeighbour[JDIR][faceLeft]) BufferLeft = BufferNeighbourX2[faceLeft];
+  if(localNeighbour[JDIR][faceRight]) BufferRight = BufferNeighbourX2[faceRight];
+#endif
 
   BufferLeft.ResetPointer();
   BufferRight.ResetPointer();
@@ -634,6 +826,7 @@ void Mpi::ExchangeX2(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
 #endif
 
 #ifdef MPI_PERSISTENT
+  ReleaseSharedBuffers(JDIR);
   MPI_Waitall(2, sendRequestX2, sendStatus);
 #endif
   myTimer += MPI_Wtime();
@@ -661,7 +854,9 @@ void Mpi::ExchangeX3(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
   MPI_Status sendStatus[2];
   MPI_Status recvStatus[2];
 
-  MPI_SAFE_CALL(MPI_Startall(2, recvRequestX3));
+  StartRemoteRequests(recvRequestX3, KDIR);
+  // Wait until node-local neighbours are done reading our previous send buffers
+  WaitSharedBuffersReleased(KDIR);
   idfx::mpiCallsTimer += MPI_Wtime() - tStart;
 #endif
   myTimer += MPI_Wtime();
@@ -727,7 +922,8 @@ void Mpi::ExchangeX3(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
   myTimer -= MPI_Wtime();
   tStart = MPI_Wtime();
 #ifdef MPI_PERSISTENT
-  MPI_SAFE_CALL(MPI_Startall(2, sendRequestX3));
+  StartRemoteRequests(sendRequestX3, KDIR);
+  ShareBuffers(KDIR);
   MPI_Waitall(2,recvRequestX3,recvStatus);
   idfx::mpiCallsTimer += MPI_Wtime() - tStart;
 
@@ -785,6 +981,11 @@ void Mpi::ExchangeX3(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
   // Unpack
   BufferLeft=BufferRecvX3[faceLeft];
   BufferRight=BufferRecvX3[faceRight];
+#ifdef MPI_PERSISTENT
+  // Node-local neighbours: read their send buffers directly
+  if(localNeighbour[KDIR][faceLeft]) BufferLeft = BufferNeighbourX3[faceLeft];
+  if(localNeighbour[KDIR][faceRight]) BufferRight = BufferNeighbourX3[faceRight];
+#endif
 
   BufferLeft.ResetPointer();
   BufferRight.ResetPointer();
@@ -837,6 +1038,7 @@ void Mpi::ExchangeX3(IdefixArray4D<real> Vc, IdefixArray4D<real> Vs) {
 #endif
 
 #ifdef MPI_PERSISTENT
+  ReleaseSharedBuffers(KDIR);
   MPI_Waitall(2, sendRequestX3, sendStatus);
 #endif
   myTimer += MPI_Wtime();
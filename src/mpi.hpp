@@ -9,6 +9,7 @@
 #define MPI_HPP_
 
 #include <signal.h>
+#include <string>
 #include <vector>
 #include <utility>
 #include "idefix.hpp"
@@ -16,10 +17,18 @@
 
 
 class DataBlock;
+// Message buffer of the MPI exchanges along one direction. Each variable of a box is stored
+// contiguously (structure of arrays). The points of a box are stored, and visited by the pack
+// and unpack kernels, with the longest dimension of the face innermost: i for the X2 and X3
+// faces, j for the X1 faces, which are only nghost cells wide.
 class Buffer {
  public:
   Buffer() = default;
-  explicit Buffer(size_t size): pointer{0}, array{IdefixArray1D<real>("BufferArray",size)} { };
+  Buffer(size_t size, int dir): pointer{0}, array{IdefixArray1D<real>("BufferArray",size)},
+                                direction{dir} { };
+  // Buffer in memory allocated elsewhere (e.g. in an MPI shared memory window)
+  Buffer(real *ptr, size_t size, int dir): pointer{0}, array{IdefixArray1D<real>(ptr,size)},
+                                           direction{dir} { };
 
   void* data() {
     return(array.data());
@@ -37,22 +46,11 @@ class Buffer {
        std::pair<int,int> ib,
        std::pair<int,int> jb,
        std::pair<int,int> kb) {
-    const int ni = ib.second-ib.first;
-    const int ninj = (jb.second-jb.first)*ni;
-    const int ninjnk = (kb.second-kb.first)*ninj;
-    const int ibeg = ib.first;
-    const int jbeg = jb.first;
-    const int kbeg = kb.first;
-    const int offset = this->pointer;
-
     auto arr = this->array;
-    idefix_for("LoadBuffer3D",kb.first,kb.second,jb.first,jb.second,ib.first,ib.second,
-      KOKKOS_LAMBDA (int k, int j, int i) {
-      arr(i-ibeg + (j-jbeg)*ni + (k-kbeg)*ninj + offset ) = in(k,j,i);
-    });
-
-    // Update pointer
-    this->pointer += ninjnk;
+    ForEach("PackBuffer", 1, ib, jb, kb,
+      KOKKOS_LAMBDA (int n, int k, int j, int i, int m) {
+        arr(m) = in(k,j,i);
+      });
   }
 
   void Pack(IdefixArray4D<real>& in,
@@ -60,22 +58,11 @@ class Buffer {
        std::pair<int,int> ib,
        std::pair<int,int> jb,
        std::pair<int,int> kb) {
-    const int ni = ib.second-ib.first;
-    const int ninj = (jb.second-jb.first)*ni;
-    const int ninjnk = (kb.second-kb.first)*ninj;
-    const int ibeg = ib.first;
-    const int jbeg = jb.first;
-    const int kbeg = kb.first;
-    const int offset = this->pointer;
-
     auto arr = this->array;
-    idefix_for("LoadBuffer4D",kb.first,kb.second,jb.first,jb.second,ib.first,ib.second,
-      KOKKOS_LAMBDA (int k, int j, int i) {
-      arr(i-ibeg + (j-jbeg)*ni + (k-kbeg)*ninj + offset ) = in(var, k,j,i);
-    });
-
-    // Update pointer
-    this->pointer += ninjnk;
+    ForEach("PackBuffer", 1, ib, jb, kb,
+      KOKKOS_LAMBDA (int n, int k, int j, int i, int m) {
+        arr(m) = in(var,k,j,i);
+      });
   }
 
   void Pack(IdefixArray4D<real>& in,
@@ -83,47 +70,22 @@ class Buffer {
        std::pair<int,int> ib,
        std::pair<int,int> jb,
        std::pair<int,int> kb) {
-    const int ni = ib.second-ib.first;
-    const int ninj = (jb.second-jb.first)*ni;
-    const int ninjnk = (kb.second-kb.first)*ninj;
-    const int ibeg = ib.first;
-    const int jbeg = jb.first;
-    const int kbeg = kb.first;
-    const int offset = this->pointer;
     auto arr = this->array;
-
-    idefix_for("LoadBuffer4D",0,map.size(),
-                             kb.first,kb.second,
-                             jb.first,jb.second,
-                             ib.first,ib.second,
-      KOKKOS_LAMBDA (int n, int k, int j, int i) {
-      arr(i-ibeg + (j-jbeg)*ni + (k-kbeg)*ninj + n*ninjnk + offset ) = in(map(n), k,j,i);
-    });
-
-    // Update pointer
-    this->pointer += ninjnk*map.size();
+    ForEach("PackBuffer", map.size(), ib, jb, kb,
+      KOKKOS_LAMBDA (int n, int k, int j, int i, int m) {
+        arr(m) = in(map(n),k,j,i);
+      });
   }
 
   void Unpack(IdefixArray3D<real>& out,
        std::pair<int,int> ib,
        std::pair<int,int> jb,
        std::pair<int,int> kb) {
-    const int ni = ib.second-ib.first;
-    const int ninj = (jb.second-jb.first)*ni;
-    const int ninjnk = (kb.second-kb.first)*ninj;
-    const int ibeg = ib.first;
-    const int jbeg = jb.first;
-    const int kbeg = kb.first;
-    const int offset = this->pointer;
     auto arr = this->array;
-
-    idefix_for("LoadBuffer3D",kb.first,kb.second,jb.first,jb.second,ib.first,ib.second,
-      KOKKOS_LAMBDA (int k, int j, int i) {
-        out(k,j,i) = arr(i-ibeg + (j-jbeg)*ni + (k-kbeg)*ninj + offset );
-    });
-
-    // Update pointer
-    this->pointer += ninjnk;
+    ForEach("UnpackBuffer", 1, ib, jb, kb,
+      KOKKOS_LAMBDA (int n, int k, int j, int i, int m) {
+        out(k,j,i) = arr(m);
+      });
   }
 
   void Unpack(IdefixArray4D<real>& out,
@@ -131,22 +93,11 @@ class Buffer {
        std::pair<int,int> ib,
        std::pair<int,int> jb,
        std::pair<int,int> kb) {
-    const int ni = ib.second-ib.first;
-    const int ninj = (jb.second-jb.first)*ni;
-    const int ninjnk = (kb.second-kb.first)*ninj;
-    const int ibeg = ib.first;
-    const int jbeg = jb.first;
-    const int kbeg = kb.first;
-    const int offset = this->pointer;
-
     auto arr = this->array;
-    idefix_for("LoadBuffer3D",kb.first,kb.second,jb.first,jb.second,ib.first,ib.second,
-      KOKKOS_LAMBDA (int k, int j, int i) {
-        out(var,k,j,i) = arr(i-ibeg + (j-jbeg)*ni + (k-kbeg)*ninj + offset );
-    });
-
-    // Update pointer
-    this->pointer += ninjnk;
+    ForEach("UnpackBuffer", 1, ib, jb, kb,
+      KOKKOS_LAMBDA (int n, int k, int j, int i, int m) {
+        out(var,k,j,i) = arr(m);
+      });
   }
 
   void Unpack(IdefixArray4D<real>& out,
@@ -154,31 +105,53 @@ class Buffer {
        std::pair<int,int> ib,
        std::pair<int,int> jb,
        std::pair<int,int> kb) {
+    auto arr = this->array;
+    ForEach("UnpackBuffer", map.size(), ib, jb, kb,
+      KOKKOS_LAMBDA (int n, int k, int j, int i, int m) {
+        out(map(n),k,j,i) = arr(m);
+      });
+  }
+
+ private:
+  // Call function(n,k,j,i,m) on each point (k,j,i) of the box for the nv variables n,
+  // m being the position of the point in the buffer. Then move the pointer after the box.
+  template <typename Function>
+  void ForEach(const std::string &prefix, const int nv,
+               std::pair<int,int> ib,
+               std::pair<int,int> jb,
+               std::pair<int,int> kb,
+               Function function) {
     const int ni = ib.second-ib.first;
-    const int ninj = (jb.second-jb.first)*ni;
+    const int nj = jb.second-jb.first;
+    const int ninj = nj*ni;
     const int ninjnk = (kb.second-kb.first)*ninj;
     const int ibeg = ib.first;
     const int jbeg = jb.first;
     const int kbeg = kb.first;
     const int offset = this->pointer;
-
-    auto arr = this->array;
-    idefix_for("LoadBuffer4D",0,map.size(),
-                              kb.first,kb.second,
-                              jb.first,jb.second,
-                              ib.first,ib.second,
-      KOKKOS_LAMBDA (int n, int k, int j, int i) {
-        out(map(n),k,j,i) = arr(i-ibeg + (j-jbeg)*ni + (k-kbeg)*ninj + n*ninjnk + offset );
-    });
+    const std::string name = prefix + "X" + std::to_string(direction+1);
+
+    if(direction == IDIR) {
+      // j innermost
+      idefix_for(name, 0, nv, kb.first, kb.second, ib.first, ib.second, jb.first, jb.second,
+        KOKKOS_LAMBDA (int n, int k, int i, int j) {
+          function(n, k, j, i, j-jbeg + (i-ibeg)*nj + (k-kbeg)*ninj + n*ninjnk + offset);
+        });
+    } else {
+      // i innermost
+      idefix_for(name, 0, nv, kb.first, kb.second, jb.first, jb.second, ib.first, ib.second,
+        KOKKOS_LAMBDA (int n, int k, int j, int i) {
+          function(n, k, j, i, i-ibeg + (j-jbeg)*ni + (k-kbeg)*ninj + n*ninjnk + offset);
+        });
+    }
 
     // Update pointer
-    this->pointer += ninjnk*map.size();
+    this->pointer += ninjnk*nv;
   }
 
-
- private:
   size_t pointer;
   IdefixArray1D<real> array;
+  int direction{IDIR};         // Direction of the exchange
 };
 
 class Mpi {
@@ -206,6 +179,9 @@ class Mpi {
   // Check that MPI processes are synced
   static bool CheckSync(real);
 
+  // Release the MPI resources shared by all the instances, before MPI_Finalize
+  static void Finalize();
+
 
   // Destructor
   ~Mpi();
@@ -232,6 +208,9 @@ class Mpi {
   Buffer BufferRecvX1[2];
   Buffer BufferRecvX2[2];
   Buffer BufferRecvX3[2];
+  Buffer BufferNeighbourX1[2];  // send buffers of node-local neighbours (shared memory)
+  Buffer BufferNeighbourX2[2];
+  Buffer BufferNeighbourX3[2];
 
   IdefixArray1D<int>  mapVars;
   int mapNVars{0};
@@ -256,6 +235,23 @@ class Mpi {
   MPI_Request recvRequestX2[2];
   MPI_Request recvRequestX3[2];
 
+  // Halo exchanges through MPI-3 shared memory with the neighbours on the same node
+  static MPI_Comm nodeComm;               // processes sharing our node
+  static std::vector<Mpi*> sharedInstances;  // instances holding shared windows
+  bool localNeighbour[3][2]{{false, false}, {false, false}, {false, false}};
+  bool haveSharedWindow[3]{false, false, false};
+  bool donePending[3]{false, false, false};
+  MPI_Win window[3];                      // windows holding our send buffers
+  MPI_Request readyRequest[3][4];         // "buffer packed" notifications
+  MPI_Request doneRequest[3][4];          // "buffer read" notifications
+
+  void InitSendBuffers(int, int, Buffer *, Buffer *);
+  void StartRemoteRequests(MPI_Request *, int);
+  void ShareBuffers(int);
+  void ReleaseSharedBuffers(int);
+  void WaitSharedBuffersReleased(int);
+  void FreeSharedWindows();
+
   Grid *mygrid;
 
   // MPI throughput timer specific to this object
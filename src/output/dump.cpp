@@ -19,17 +19,16 @@
 #include <iomanip>
 #include <string>
 #include <cstdio>
+#include <vector>
 #include "dump.hpp"
+#include "dumpStaging.hpp"
+#include "dumpRemap.hpp"
 #include "version.hpp"
 #include "dataBlockHost.hpp"
 #include "gridHost.hpp"
 #include "output.hpp"
 #include "fluid.hpp"
-
-// Max size of array name
-#define  NAMESIZE     16
-#define  FILENAMESIZE   256
-#define  HEADERSIZE 128
+#include "particles.hpp"
 
 // Register a variable to be dumped (and read)
 
@@ -155,6 +154,36 @@ void Dump::CreateMPIDataType(GridBox gb, bool read) {
   #endif
 }
 
+void Dump::FreeMPIDataType(bool read) {
+  #ifdef WITH_MPI
+    if(read) {
+      MPI_SAFE_CALL(MPI_Type_free(&this->descCR));
+    } else {
+      MPI_SAFE_CALL(MPI_Type_free(&this->descCW));
+    }
+    for(int dir = 0; dir < 3 ; dir++) {
+      if(read) {
+        MPI_SAFE_CALL(MPI_Type_free(&this->descSR[dir]));
+        MPI_SAFE_CALL(MPI_Type_free(&this->descER[dir]));
+      } else {
+        MPI_SAFE_CALL(MPI_Type_free(&this->descSW[dir]));
+        MPI_SAFE_CALL(MPI_Type_free(&this->descEW[dir]));
+      }
+    }
+  #endif
+}
+
+// Part of the global grid held by this process
+GridBox Dump::LocalGridBox() {
+  GridBox gb;
+  for(int dir = 0; dir < 3 ; dir++) {
+    gb.start[dir] = data->gbeg[dir]-data->nghost[dir];
+    gb.size[dir] = data->np_int[dir];
+    gb.sizeGlob[dir] = data->mygrid->np_int[dir];
+  }
+  return(gb);
+}
+
 void Dump::Init(DataBlock *datain) {
   idfx::pushRegion("Dump::Init");
   this->data = datain;
@@ -194,16 +223,9 @@ void Dump::Init(DataBlock *datain) {
   this->scrch = new real[nmax];
 
   #ifdef WITH_MPI
-    Grid *grid = data->mygrid;
-    GridBox gb;
-    for(int dir = 0; dir < 3 ; dir++) {
-      gb.start[dir] = data->gbeg[dir]-data->nghost[dir];
-      gb.size[dir] = data->np_int[dir];
-      gb.sizeGlob[dir] = grid->np_int[dir];
-    }
     // Create MPI datatypes for read/write
-    CreateMPIDataType(gb, false);
-    CreateMPIDataType(gb, true);
+    CreateMPIDataType(LocalGridBox(), false);
+    CreateMPIDataType(LocalGridBox(), true);
   #endif
 
   // Register variables that are needed in restart dumps
@@ -226,6 +248,12 @@ Dump::Dump(Input &input, DataBlock *datain) {
     outputDirectory = "./";
   }
   Init(datain);
+
+  // Multi-level checkpoints through node-local storage
+  if(input.CheckEntry("Output","dmp_local")>0) {
+    staging = std::make_unique<DumpStaging>(input, this);
+    staging->ShowConfig();
+  }
 }
 
 Dump::Dump(DataBlock *datain) {
@@ -625,6 +653,83 @@ int Dump::GetLastDumpInDirectory(fs::path &directory) {
   }
   return(num);
 }
+
+// The particles of dump.xxxx.dmp are stored in particles.xxxx.pdmp
+fs::path Dump::GetParticlesFilename(const fs::path &directory, int number) {
+  std::stringstream ssFileName;
+  ssFileName << "particles." << std::setfill('0') << std::setw(4) << number << ".pdmp";
+  return(directory/ssFileName.str());
+}
+
+// Restore the particles of the dump we have just read
+void Dump::ReadParticles(const fs::path &directory) {
+  if(!data->haveParticles) return;
+  fs::path filename = GetParticlesFilename(directory, dumpFileNumber-1);
+  if(!fs::exists(filename)) {
+    IDEFIX_WARNING("cannot find "+filename.string()+", the particles are not restored.");
+    return;
+  }
+  data->particles->Read(filename.string());
+}
+
+// This is called by the grid constructor, before any DataBlock (and Dump) exists: the root
+// process scans the fields following the coordinates and broadcasts the decomposition.
+bool Dump::ReadDecomposition(Input &input, std::vector<int> &layout) {
+  int size = 0;
+  if(idfx::prank == 0) {
+    fs::path readDir = "./";
+    if(input.CheckEntry("Output","dmp_dir")>=0) {
+      readDir = input.Get<std::string>("Output","dmp_dir",0);
+    }
+    int readNumber = input.restartFileNumber;
+    if(readNumber<0 && fs::is_directory(readDir)) readNumber = GetLastDumpInDirectory(readDir);
+    if(readNumber<0) {
+      readDir = ".";
+      readNumber = GetLastDumpInDirectory(readDir);
+    }
+    std::stringstream ssFileName;
+    ssFileName << "dump." << std::setfill('0') << std::setw(4) << readNumber << ".dmp";
+    fs::path filename = readDir/ssFileName.str();
+
+    FILE *fileHdl = fopen(filename.c_str(),"rb");
+    if(fileHdl != NULL) {
+      fseek(fileHdl, HEADERSIZE, SEEK_SET);
+      while(true) {
+        char fieldName[NAMESIZE+1] = {0};
+        int type, ndim;
+        int dim[3];
+        if(fread(fieldName, sizeof(char), NAMESIZE, fileHdl) < NAMESIZE) break;
+        if(fread(&type, sizeof(int), 1, fileHdl) < 1) break;
+        if(fread(&ndim, sizeof(int), 1, fileHdl) < 1 || ndim < 1 || ndim > 3) break;
+        if(fread(dim, sizeof(int), ndim, fileHdl) < ndim) break;
+        int64_t ntot = 1;
+        for(int n = 0 ; n < ndim ; n++) ntot *= dim[n];
+
+        std::string name(fieldName);
+        if(name.compare("decomposition") == 0 && type == IntegerType) {
+          layout.resize(ntot);
+          if(fread(layout.data(), sizeof(int), ntot, fileHdl) == ntot) size = ntot;
+          break;
+        }
+        // The decomposition directly follows the coordinates
+        if(name[0] != 'x') break;
+        int typeSize = sizeof(double);
+        if(type == SingleType) typeSize = sizeof(float);
+        if(type == IntegerType) typeSize = sizeof(int);
+        if(type == BoolType) typeSize = sizeof(bool);
+        fseek(fileHdl, ntot*typeSize, SEEK_CUR);
+      }
+      fclose(fileHdl);
+    }
+  }
+  #ifdef WITH_MPI
+    MPI_Bcast(&size, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    layout.resize(size);
+    MPI_Bcast(layout.data(), size, MPI_INT, 0, MPI_COMM_WORLD);
+  #endif
+  return(size>0);
+}
+
 bool Dump::Read(Output& output, int readNumber ) {
   fs::path filename;
   int nx[3];
@@ -639,6 +744,17 @@ bool Dump::Read(Output& output, int readNumber ) {
 
   fs::path readDir = this->outputDirectory;
 
+  // Node-local dumps are preferred when they are at least as recent as the ones in readDir
+  if(staging) {
+    const int globalNumber = (readNumber < 0) ? GetLastDumpInDirectory(readDir) : readNumber;
+    if(staging->Read(readNumber, globalNumber)) {
+      ReadParticles(this->outputDirectory);
+      idfx::cout << "Restarting from t=" << data->t << "." << std::endl;
+      idfx::popRegion();
+      return(true);
+    }
+  }
+
   if(readNumber<0) {
     // We actually don't know which file we're supposed to read, so let's guess
     readNumber = GetLastDumpInDirectory(readDir);
@@ -689,24 +805,49 @@ bool Dump::Read(Output& output, int readNumber ) {
   fseek(fileHdl, HEADERSIZE, SEEK_SET);
 #endif
 
-  // First thing is compare the total domain size
+  // First thing is compare the grid of the dump with the current one
+  GridHost gridHost(*data->mygrid);
+  gridHost.SyncFromDevice();
+  DumpRemap::Coordinates dumpXl, dumpXr;
+  bool sameGrid = true;
   for(int dir=0 ; dir < 3; dir++) {
     ReadNextFieldProperties(fileHdl, ndim, nx, type, fieldName);
     if(ndim>1) IDEFIX_ERROR("Wrong coordinate array dimensions while reading restart dump");
-    if(nx[0] != data->mygrid->np_int[dir]) {
-      idfx::cout << "dir " << dir << ", restart has " << nx[0] << " points " << std::endl;
-      IDEFIX_ERROR("Domain size from the restart dump is different from the current one");
-    }
+    // skip cell centers
+    Skip(fileHdl, ndim, nx, type);
 
-    // Read coordinates
-    ReadSerial(fileHdl, ndim, nx, type, scrch);
-
-    // skip left and right edges arrays
-    for (int iside=0; iside < 2; iside++) {
+    // Read left and right edges arrays
+    for(auto *edges : {&dumpXl[dir], &dumpXr[dir]}) {
       ReadNextFieldProperties(fileHdl, ndim, nx, type, fieldName);
-      ReadSerial(fileHdl, ndim, nx, type, scrch);
+      edges->resize(nx[0]);
+      ReadSerial(fileHdl, ndim, nx, type, edges->data());
+    }
+
+    if(nx[0] != gridHost.np_int[dir]) {
+      sameGrid = false;
+    } else if(dir < DIMENSIONS) {
+      for(int i = 0 ; i < nx[0] ; i++) {
+        const int ig = i + gridHost.nghost[dir];
+        const real eps = 1e-6*(gridHost.xr[dir](ig) - gridHost.xl[dir](ig));
+        if(std::fabs(dumpXl[dir][i] - gridHost.xl[dir](ig)) > eps
+            || std::fabs(dumpXr[dir][i] - gridHost.xr[dir](ig)) > eps) {
+          sameGrid = false;
+        }
+      }
     }
-    // Todo: check that coordinates are identical
+  }
+
+  // Dumps written on another grid are remapped on the current one
+  std::unique_ptr<DumpRemap> remap;
+  if(!sameGrid) {
+    idfx::cout << std::endl << "Dump: the grid of the restart dump (" << dumpXl[IDIR].size();
+    for(int dir = 1 ; dir < DIMENSIONS ; dir++) idfx::cout << "x" << dumpXl[dir].size();
+    idfx::cout << " cells) is different from the current one, remapping..." << std::flush;
+    remap = std::make_unique<DumpRemap>(this, dumpXl, dumpXr);
+    #ifdef WITH_MPI
+      FreeMPIDataType(true);
+      CreateMPIDataType(remap->GetReadBox(), true);
+    #endif
   }
 
   std::unordered_set<std::string> notFound {};
@@ -725,6 +866,9 @@ bool Dump::Read(Output& output, int readNumber ) {
     if(fieldName.compare(eof) == 0) {
       // We have reached end of dump file
       break;
+    } else if(fieldName.compare("decomposition") == 0) {
+      // Already used by the grid when it was built
+      Skip(fileHdl, ndim, nxglob, type);
     } else {
       if(auto it = dumpFieldMap.find(fieldName) ; it != dumpFieldMap.end()) {
         // This key has been registered
@@ -733,6 +877,19 @@ bool Dump::Read(Output& output, int readNumber ) {
         if(scalar.GetType() == DumpField::Type::IdefixArray) {
           // Distributed idefix array
           int direction = scalar.GetDirection();
+          IdfxDataDescriptor &desc = (scalar.GetLocation() == DumpField::ArrayLocation::Face)
+                                      ? descSR[direction]
+                                      : (scalar.GetLocation() == DumpField::ArrayLocation::Edge)
+                                      ? descER[direction] : descCR;
+
+          if(remap) {
+            // Read the part of the dump overlapping the local domain, and remap it
+            std::array<int,3> n = remap->GetReadSize(scalar.GetLocation(), direction);
+            std::vector<real> buffer(static_cast<int64_t>(n[IDIR])*n[JDIR]*n[KDIR]);
+            ReadDistributed(fileHdl, ndim, n.data(), nxglob, desc, buffer.data());
+            remap->Remap(fieldName, scalar, buffer.data());
+            continue;
+          }
 
           // Load it
           for(int dir = 0 ; dir < 3; dir++) {
@@ -748,13 +905,7 @@ bool Dump::Read(Output& output, int readNumber ) {
               if(i!=direction) nx[i] ++;
             }
           }
-          if(scalar.GetLocation() == DumpField::ArrayLocation::Center) {
-            ReadDistributed(fileHdl, ndim, nx, nxglob, descCR, scrch);
-          } else if(scalar.GetLocation() == DumpField::ArrayLocation::Face) {
-            ReadDistributed(fileHdl, ndim, nx, nxglob, descSR[direction], scrch);
-          } else if(scalar.GetLocation() == DumpField::ArrayLocation::Edge) {
-            ReadDistributed(fileHdl, ndim, nx, nxglob, descER[direction], scrch);
-          }
+          ReadDistributed(fileHdl, ndim, nx, nxglob, desc, scrch);
           auto toRead = scalar.GetHostField<IdefixHostArray3D<real>>();
           // Load the scratch space in designated field
           for(int k = 0; k < nx[KDIR]; k++) {
@@ -786,6 +937,15 @@ bool Dump::Read(Output& output, int readNumber ) {
       }
     }
   }
+  if(remap) {
+    remap->Finalize();
+    // Keep the cfl condition on the finer grid during the first step
+    data->dt /= remap->GetRefinement();
+    #ifdef WITH_MPI
+      FreeMPIDataType(true);
+      CreateMPIDataType(LocalGridBox(), true);
+    #endif
+  }
   if (notFound.size() > 0) {
     std::stringstream msg {};
     msg << "The following fields were not found in " << filename << ": ";
@@ -801,6 +961,7 @@ bool Dump::Read(Output& output, int readNumber ) {
   #endif
 
   idfx::cout << "done in " << timer.seconds() << " s." << std::endl;
+  ReadParticles(readDir);
   idfx::cout << "Restarting from t=" << data->t << "." << std::endl;
 
   idfx::popRegion();
@@ -809,7 +970,7 @@ bool Dump::Read(Output& output, int readNumber ) {
 }
 
 
-int Dump::Write(Output& output) {
+int Dump::Write(Output& output, bool stage) {
   fs::path filename;
   char fieldName[NAMESIZE+1]; // +1 is just in case
   int nx[3];
@@ -824,6 +985,9 @@ int Dump::Write(Output& output) {
 
   idfx::pushRegion("Dump::Write");
 
+  // Only one dump is drained at a time, and direct writes should not race with a pending drain
+  if(staging) staging->Wait();
+
   idfx::cout << "Dump: Write file n " << dumpFileNumber << "..." << std::flush;
 
   // Reset timer
@@ -838,6 +1002,19 @@ int Dump::Write(Output& output) {
 
   dumpFileNumber++;   // For next one
 
+  // Particles are written directly in their own file, even when the dump is staged
+  if(data->haveParticles) {
+    data->particles->Write(GetParticlesFilename(outputDirectory, dumpFileNumber-1).string());
+  }
+
+  if(stage && staging) {
+    if(staging->Write(dumpFileNumber-1, filename)) {
+      idfx::cout << "staged in " << timer.seconds() << " s." << std::endl;
+      idfx::popRegion();
+      return(dumpFileNumber-1);
+    }
+  }
+
   // Check if file exists, if yes, delete it
   if(idfx::prank==0) {
     if(fs::exists(filename)) {
@@ -898,6 +1075,14 @@ int Dump::Write(Output& output) {
                 reinterpret_cast<void*> (gridHost.xr[dir].data()+gridHost.nghost[dir]));
   }
 
+  // Non-uniform domain decomposition of load-balanced runs
+  if(data->mygrid->haveLoadBalance) {
+    std::vector<int> layout = data->mygrid->GetDecomposition();
+    std::snprintf(fieldName, NAMESIZE, "decomposition");
+    nx[0] = layout.size();
+    WriteSerial(fileHdl, 1, nx, IntegerType, fieldName, layout.data());
+  }
+
   // Then write raw data from Vc
 
   for(auto const& [name, scalar] : dumpFieldMap) {
@@ -979,7 +1164,7 @@ int Dump::Write(Output& output) {
 
   idfx::cout << "done in " << timer.seconds() << " s." << std::endl;
   idfx::popRegion();
-  // One day, we will have a return code.
 
-  return(0);
+  // Number of the file we have just written
+  return(dumpFileNumber-1);
 }
@@ -10,6 +10,8 @@
 #include <string>
 #include <map>
 #include <array>
+#include <memory>
+#include <vector>
 #if __has_include(<filesystem>)
   #include <filesystem> // NOLINT [build/c++17]
   namespace fs = std::filesystem;
@@ -23,6 +25,10 @@
 #include "input.hpp"
 #include "dataBlock.hpp"
 
+// Max size of array name
+#define  NAMESIZE     16
+#define  FILENAMESIZE   256
+#define  HEADERSIZE 128
 
 enum DataType {DoubleType, SingleType, IntegerType, BoolType};
 
@@ -37,6 +43,8 @@ enum DataType {DoubleType, SingleType, IntegerType, BoolType};
 //class Vtk;
 class Output;
 class DataBlock;
+class DumpStaging;
+class DumpRemap;
 
 
 class DumpField {
@@ -174,15 +182,20 @@ struct GridBox {
 
 class Dump {
   friend class DumpImage; // Allow dumpimag to have access to dump API
+  friend class DumpStaging; // Allow staging to have access to the dumped fields
+  friend class DumpRemap; // Allow remapping to have access to the current grid
  public:
   explicit Dump(Input &, DataBlock *);               // Create Dump Object
   explicit Dump(DataBlock *);               // Create a dump object independent of input
   ~Dump();
 
   // Create a Dump file from the current state of the code
-  int Write(Output&);
+  // (staged on node-local storage when allowed and enabled)
+  int Write(Output&, bool stage = false);
   // Read and load a dump file as current state of the code
   bool Read(Output&, int);
+  // Read the domain decomposition stored in the restart dump, before the grid is built
+  static bool ReadDecomposition(Input &, std::vector<int> &);
 
   // Register IdefixArrays
   void RegisterVariable(IdefixArray3D<real>&,
@@ -247,10 +260,16 @@ class Dump {
   void ReadSerial(IdfxFileHandler, int, int*, DataType, void*);
   void ReadDistributed(IdfxFileHandler, int, int*, int*, IdfxDataDescriptor&, void*);
   void Skip(IdfxFileHandler, int, int *, DataType);
-  int GetLastDumpInDirectory(fs::path &);
+  static int GetLastDumpInDirectory(fs::path &);
+  static fs::path GetParticlesFilename(const fs::path &, int);
+  void ReadParticles(const fs::path &);
   void CreateMPIDataType(GridBox, bool);
+  void FreeMPIDataType(bool);
+  GridBox LocalGridBox();
 
   fs::path outputDirectory;
+
+  std::unique_ptr<DumpStaging> staging;   // multi-level checkpoints (when enabled)
 };
 
 
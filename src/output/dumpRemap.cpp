@@ -0,0 +1,443 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "dumpRemap.hpp"
+#include "dataBlock.hpp"
+
+// Primitive of the volume element along dir, so that the volume of a cell is the tensor
+// product of the differences of this function in each direction.
+static real VolumePrimitive(int dir, real x) {
+  #if GEOMETRY == CYLINDRICAL || GEOMETRY == POLAR
+    if(dir == IDIR) return(0.5*x*std::fabs(x));
+  #elif GEOMETRY == SPHERICAL
+    if(dir == IDIR) return(x*x*x/3.0);
+    if(dir == JDIR) return(-std::cos(x));
+  #endif
+  return(x);
+}
+
+DumpRemap::DumpRemap(Dump *dump, const Coordinates &xl, const Coordinates &xr):
+                     dump(dump),
+                     data(dump->data),
+                     dumpXl(xl),
+                     dumpXr(xr) {
+  idfx::pushRegion("DumpRemap::DumpRemap");
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    IdefixHostArray1D<real> xlHost = Kokkos::create_mirror(data->xl[dir]);
+    IdefixHostArray1D<real> xrHost = Kokkos::create_mirror(data->xr[dir]);
+    Kokkos::deep_copy(xlHost, data->xl[dir]);
+    Kokkos::deep_copy(xrHost, data->xr[dir]);
+    const int n = data->np_int[dir];
+    gridXl[dir].resize(n);
+    gridXr[dir].resize(n);
+    for(int i = 0 ; i < n ; i++) {
+      gridXl[dir][i] = xlHost(i+data->beg[dir]);
+      gridXr[dir][i] = xrHost(i+data->beg[dir]);
+    }
+
+    const int nDump = dumpXl[dir].size();
+    if(dir >= DIMENSIONS) {
+      // Nothing to remap in the directions which are not integrated
+      if(nDump != 1) IDEFIX_ERROR("The restart dump does not have the same dimensions");
+      lo[dir] = overlapLo[dir] = 0;
+      hi[dir] = overlapHi[dir] = 1;
+      tolerance[dir] = 0;
+      continue;
+    }
+
+    // Tolerance on the coordinates of coincident faces
+    real width = gridXr[dir][0] - gridXl[dir][0];
+    for(int i = 0 ; i < n ; i++) width = std::fmin(width, gridXr[dir][i] - gridXl[dir][i]);
+    for(int i = 0 ; i < nDump ; i++) width = std::fmin(width, dumpXr[dir][i] - dumpXl[dir][i]);
+    tolerance[dir] = 1e-6*width;
+
+    if(gridXl[dir][0] < dumpXl[dir][0] - tolerance[dir]
+        || gridXr[dir][n-1] > dumpXr[dir][nDump-1] + tolerance[dir]) {
+      IDEFIX_ERROR("The domain of the restart dump does not cover the current domain along X"
+                   + std::to_string(dir+1));
+    }
+    // Dump cells overlapping the local domain
+    overlapLo[dir] = std::upper_bound(dumpXr[dir].begin(), dumpXr[dir].end(),
+                                      gridXl[dir][0] + tolerance[dir]) - dumpXr[dir].begin();
+    overlapHi[dir] = std::lower_bound(dumpXl[dir].begin(), dumpXl[dir].end(),
+                                      gridXr[dir][n-1] - tolerance[dir]) - dumpXl[dir].begin();
+    overlapLo[dir] = std::min(overlapLo[dir], nDump-1);
+    overlapHi[dir] = std::max(overlapHi[dir], overlapLo[dir]+1);
+
+    #ifdef WITH_MPI
+      // Each process only reads the part of the dump it needs
+      lo[dir] = overlapLo[dir];
+      hi[dir] = overlapHi[dir];
+    #else
+      // Serial reads go through the whole dump
+      lo[dir] = 0;
+      hi[dir] = nDump;
+    #endif
+  }
+
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    ComputeCellWeights(dir, true, volumeWeights[dir]);
+    ComputeCellWeights(dir, false, lineWeights[dir]);
+    ComputeFaceWeights(dir, faceWeights[dir]);
+  }
+  idfx::popRegion();
+}
+
+GridBox DumpRemap::GetReadBox() const {
+  GridBox gb;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    gb.start[dir] = lo[dir];
+    gb.size[dir] = hi[dir]-lo[dir];
+    gb.sizeGlob[dir] = dumpXl[dir].size();
+  }
+  return(gb);
+}
+
+std::array<int,3> DumpRemap::GetReadSize(DumpField::ArrayLocation loc, int direction) const {
+  std::array<int,3> n;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    n[dir] = hi[dir]-lo[dir];
+  }
+  if(loc == DumpField::ArrayLocation::Face) {
+    n[direction]++;
+  }
+  if(loc == DumpField::ArrayLocation::Edge) {
+    for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+      if(dir != direction) n[dir]++;
+    }
+  }
+  return(n);
+}
+
+// Fraction of each current cell covered by the dump cells, measured in volume or in length
+void DumpRemap::ComputeCellWeights(int dir, bool volume, Weights &weights) const {
+  const int n = gridXl[dir].size();
+  weights.assign(n, {});
+  if(dir >= DIMENSIONS) {
+    weights[0].push_back({0, ONE_F});
+    return;
+  }
+  auto measure = [&](real x) {
+    return(volume ? VolumePrimitive(dir, x) : x);
+  };
+  for(int i = 0 ; i < n ; i++) {
+    const real a = gridXl[dir][i];
+    const real b = gridXr[dir][i];
+    int m = std::upper_bound(dumpXr[dir].begin(), dumpXr[dir].end(), a) - dumpXr[dir].begin();
+    m = std::max(m, overlapLo[dir]);
+    real total = 0;
+    for( ; m < overlapHi[dir] && dumpXl[dir][m] < b ; m++) {
+      const real overlap = measure(std::fmin(b, dumpXr[dir][m]))
+                         - measure(std::fmax(a, dumpXl[dir][m]));
+      if(overlap > 0) {
+        weights[i].push_back({m-lo[dir], overlap});
+        total += overlap;
+      }
+    }
+    if(weights[i].empty() || total <= 0) {
+      IDEFIX_ERROR("Cannot find the cells of the restart dump overlapping the current grid");
+    }
+    // Normalise by the covered measure, so that uniform fields remain exactly uniform
+    for(auto &w : weights[i]) w.second /= total;
+  }
+}
+
+// Linear interpolation of the values on the dump faces onto the current faces
+void DumpRemap::ComputeFaceWeights(int dir, Weights &weights) const {
+  const int n = gridXl[dir].size();
+  if(dir >= DIMENSIONS) {
+    weights.assign(n, {{0, ONE_F}});
+    return;
+  }
+  weights.assign(n+1, {});
+  const int nDump = dumpXl[dir].size();
+  auto dumpFace = [&](int m) {
+    return(m < nDump ? dumpXl[dir][m] : dumpXr[dir][nDump-1]);
+  };
+  for(int i = 0 ; i <= n ; i++) {
+    const real x = (i < n) ? gridXl[dir][i] : gridXr[dir][n-1];
+    int m = std::upper_bound(dumpXl[dir].begin(), dumpXl[dir].end(), x)
+            - dumpXl[dir].begin() - 1;
+    m = std::clamp(m, overlapLo[dir], overlapHi[dir]-1);
+    real t = (x - dumpFace(m)) / (dumpFace(m+1) - dumpFace(m));
+    t = std::clamp(t, ZERO_F, ONE_F);
+    weights[i].push_back({m-lo[dir], ONE_F-t});
+    weights[i].push_back({m+1-lo[dir], t});
+  }
+}
+
+void DumpRemap::Apply(const std::array<const Weights*,3> &weights, const std::array<int,3> &n,
+                      const std::array<int,3> &nRead, const real *in,
+                      IdefixHostArray3D<real> &out) const {
+  for(int k = 0 ; k < n[KDIR] ; k++) {
+    for(int j = 0 ; j < n[JDIR] ; j++) {
+      for(int i = 0 ; i < n[IDIR] ; i++) {
+        real q = 0;
+        for(auto [mk, wk] : (*weights[KDIR])[k]) {
+          for(auto [mj, wj] : (*weights[JDIR])[j]) {
+            for(auto [mi, wi] : (*weights[IDIR])[i]) {
+              q += wk*wj*wi*in[mi + nRead[IDIR]*(mj + nRead[JDIR]*mk)];
+            }
+          }
+        }
+        out(k+data->beg[KDIR], j+data->beg[JDIR], i+data->beg[IDIR]) = q;
+      }
+    }
+  }
+}
+
+void DumpRemap::Remap(const std::string &name, const DumpField &field, const real *in) {
+  const int direction = field.GetDirection();
+  const DumpField::ArrayLocation loc = field.GetLocation();
+  std::array<int,3> nRead = GetReadSize(loc, direction);
+
+  if(loc == DumpField::ArrayLocation::Face) {
+    // The components of a face-centered field only differ by their direction number
+    std::string group = name;
+    const size_t pos = group.find_last_of("123");
+    if(pos != std::string::npos) group.erase(pos, 1);
+    faceFields[group][direction] = &field;
+    faceData[group][direction].assign(in, in + static_cast<int64_t>(nRead[IDIR])
+                                                *nRead[JDIR]*nRead[KDIR]);
+    return;
+  }
+
+  std::array<int,3> n;
+  std::array<const Weights*,3> weights;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    n[dir] = data->np_int[dir];
+    weights[dir] = &volumeWeights[dir];
+  }
+  if(loc == DumpField::ArrayLocation::Edge) {
+    for(int dir = 0 ; dir < 3 ; dir++) {
+      if(dir == direction) {
+        weights[dir] = &lineWeights[dir];
+      } else if(dir < DIMENSIONS) {
+        weights[dir] = &faceWeights[dir];
+        n[dir]++;
+      }
+    }
+  }
+  auto out = field.GetHostField<IdefixHostArray3D<real>>();
+  Apply(weights, n, nRead, in, out);
+  field.SyncFrom(out);
+}
+
+void DumpRemap::Finalize() {
+  for(auto &[group, fields] : faceFields) {
+    for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+      if(fields[dir] == nullptr) {
+        IDEFIX_ERROR("Cannot remap "+group+" from the restart dump: some of its components "
+                     "are missing");
+      }
+    }
+    Prolongate(fields, faceData[group]);
+  }
+  faceFields.clear();
+  faceData.clear();
+}
+
+// Split the magnetic flux through each dump face among the current faces it contains.
+// The faces lying on the dump faces inherit the dump field. The faces inside a dump cell are
+// then set plane after plane, direction after direction, from the flux through the previous
+// plane minus the flux leaving through the sides of the slab in between, the field being
+// uniform on each plane. Each new cell is therefore divergence-free, as measured by CheckDivB.
+void DumpRemap::Prolongate(std::array<const DumpField*,3> &fields,
+                           std::array<std::vector<real>,3> &in) {
+  idfx::pushRegion("DumpRemap::Prolongate");
+  // Current faces coincident with the dump faces
+  std::array<std::vector<int>,3> child;
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    if(dir >= DIMENSIONS) {
+      child[dir] = {0, 1};
+      continue;
+    }
+    const int n = gridXl[dir].size();
+    const int nDump = dumpXl[dir].size();
+    std::vector<real> faces(gridXl[dir]);
+    faces.push_back(gridXr[dir][n-1]);
+    for(int m = overlapLo[dir] ; m <= overlapHi[dir] ; m++) {
+      const real x = (m < nDump) ? dumpXl[dir][m] : dumpXr[dir][nDump-1];
+      int f = std::lower_bound(faces.begin(), faces.end(), x - tolerance[dir]) - faces.begin();
+      if(f > n || std::fabs(faces[f] - x) > tolerance[dir]
+          || (m == overlapLo[dir] && f != 0) || (m == overlapHi[dir] && f != n)) {
+        IDEFIX_ERROR("The magnetic field can only be remapped from a restart dump when the "
+                     "current grid is a refinement of the dump grid (each face of the dump grid "
+                     "is also a face of the current grid, including the faces bounding the "
+                     "domain of each MPI process) along X" + std::to_string(dir+1));
+      }
+      child[dir].push_back(f);
+    }
+  }
+
+  std::array<IdefixHostArray3D<real>,3> B;
+  std::array<IdefixHostArray3D<real>,3> A;
+  std::array<std::array<int,3>,3> nRead;
+  for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+    B[dir] = fields[dir]->GetHostField<IdefixHostArray3D<real>>();
+    A[dir] = Kokkos::create_mirror(data->A[dir]);
+    Kokkos::deep_copy(A[dir], data->A[dir]);
+    nRead[dir] = GetReadSize(DumpField::ArrayLocation::Face, dir);
+  }
+  const int ib = data->beg[IDIR];
+  const int jb = data->beg[JDIR];
+  const int kb = data->beg[KDIR];
+
+  // Field and flux on the current faces, in local indices
+  auto field = [&](int dir, int k, int j, int i) -> real& {
+    return(B[dir](k+kb, j+jb, i+ib));
+  };
+  auto flux = [&](int dir, int k, int j, int i) {
+    return(A[dir](k+kb, j+jb, i+ib)*B[dir](k+kb, j+jb, i+ib));
+  };
+  auto area = [&](int dir, int k, int j, int i) {
+    return(A[dir](k+kb, j+jb, i+ib));
+  };
+
+  for(int mk = overlapLo[KDIR] ; mk < overlapHi[KDIR] ; mk++) {
+    const int k0 = child[KDIR][mk-overlapLo[KDIR]];
+    const int k1 = child[KDIR][mk-overlapLo[KDIR]+1];
+    for(int mj = overlapLo[JDIR] ; mj < overlapHi[JDIR] ; mj++) {
+      const int j0 = child[JDIR][mj-overlapLo[JDIR]];
+      const int j1 = child[JDIR][mj-overlapLo[JDIR]+1];
+      for(int mi = overlapLo[IDIR] ; mi < overlapHi[IDIR] ; mi++) {
+        const int i0 = child[IDIR][mi-overlapLo[IDIR]];
+        const int i1 = child[IDIR][mi-overlapLo[IDIR]+1];
+
+        // Field on the faces of the dump cell
+        auto dumpField = [&](int dir, int side) {
+          std::array<int,3> m = {mi-lo[IDIR], mj-lo[JDIR], mk-lo[KDIR]};
+          m[dir] += side;
+          return(in[dir][m[IDIR] + nRead[dir][IDIR]*(m[JDIR] + nRead[dir][JDIR]*m[KDIR])]);
+        };
+        for(int k = k0 ; k < k1 ; k++) {
+          for(int j = j0 ; j < j1 ; j++) {
+            field(IDIR, k, j, i0) = dumpField(IDIR, 0);
+            field(IDIR, k, j, i1) = dumpField(IDIR, 1);
+          }
+        }
+        #if DIMENSIONS >= 2
+        for(int k = k0 ; k < k1 ; k++) {
+          for(int i = i0 ; i < i1 ; i++) {
+            field(JDIR, k, j0, i) = dumpField(JDIR, 0);
+            field(JDIR, k, j1, i) = dumpField(JDIR, 1);
+          }
+        }
+        #endif
+        #if DIMENSIONS == 3
+        for(int j = j0 ; j < j1 ; j++) {
+          for(int i = i0 ; i < i1 ; i++) {
+            field(KDIR, k0, j, i) = dumpField(KDIR, 0);
+            field(KDIR, k1, j, i) = dumpField(KDIR, 1);
+          }
+        }
+        #endif
+
+        // X1 planes crossing the dump cell
+        real phi = 0;
+        for(int k = k0 ; k < k1 ; k++) {
+          for(int j = j0 ; j < j1 ; j++) {
+            phi += flux(IDIR, k, j, i0);
+          }
+        }
+        for(int i = i0 ; i < i1-1 ; i++) {
+          #if DIMENSIONS >= 2
+          for(int k = k0 ; k < k1 ; k++) {
+            phi -= flux(JDIR, k, j1, i) - flux(JDIR, k, j0, i);
+          }
+          #endif
+          #if DIMENSIONS == 3
+          for(int j = j0 ; j < j1 ; j++) {
+            phi -= flux(KDIR, k1, j, i) - flux(KDIR, k0, j, i);
+          }
+          #endif
+          real surface = 0;
+          for(int k = k0 ; k < k1 ; k++) {
+            for(int j = j0 ; j < j1 ; j++) {
+              surface += area(IDIR, k, j, i+1);
+            }
+          }
+          const real b = (surface > 0) ? phi/surface : ZERO_F;
+          for(int k = k0 ; k < k1 ; k++) {
+            for(int j = j0 ; j < j1 ; j++) {
+              field(IDIR, k, j, i+1) = b;
+            }
+          }
+        }
+
+        // X2 planes crossing each X1 slab
+        #if DIMENSIONS >= 2
+        for(int i = i0 ; i < i1 ; i++) {
+          phi = 0;
+          for(int k = k0 ; k < k1 ; k++) {
+            phi += flux(JDIR, k, j0, i);
+          }
+          for(int j = j0 ; j < j1-1 ; j++) {
+            for(int k = k0 ; k < k1 ; k++) {
+              phi -= flux(IDIR, k, j, i+1) - flux(IDIR, k, j, i);
+            }
+            if constexpr(DIMENSIONS == 3) {
+              phi -= flux(KDIR, k1, j, i) - flux(KDIR, k0, j, i);
+            }
+            real surface = 0;
+            for(int k = k0 ; k < k1 ; k++) {
+              surface += area(JDIR, k, j+1, i);
+            }
+            const real b = (surface > 0) ? phi/surface : ZERO_F;
+            for(int k = k0 ; k < k1 ; k++) {
+              field(JDIR, k, j+1, i) = b;
+            }
+          }
+        }
+        #endif
+
+        // X3 faces crossing each X2 row of each X1 slab
+        #if DIMENSIONS == 3
+        for(int j = j0 ; j < j1 ; j++) {
+          for(int i = i0 ; i < i1 ; i++) {
+            phi = flux(KDIR, k0, j, i);
+            for(int k = k0 ; k < k1-1 ; k++) {
+              phi -= flux(IDIR, k, j, i+1) - flux(IDIR, k, j, i)
+                   + flux(JDIR, k, j+1, i) - flux(JDIR, k, j, i);
+              const real surface = area(KDIR, k+1, j, i);
+              field(KDIR, k+1, j, i) = (surface > 0) ? phi/surface : ZERO_F;
+            }
+          }
+        }
+        #endif
+      }
+    }
+  }
+
+  for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+    fields[dir]->SyncFrom(B[dir]);
+  }
+  idfx::popRegion();
+}
+
+real DumpRemap::GetRefinement() const {
+  real ratio = ONE_F;
+  for(int dir = 0 ; dir < DIMENSIONS ; dir++) {
+    real dumpWidth = dumpXr[dir][0] - dumpXl[dir][0];
+    real gridWidth = gridXr[dir][0] - gridXl[dir][0];
+    for(size_t i = 0 ; i < dumpXl[dir].size() ; i++) {
+      dumpWidth = std::fmin(dumpWidth, dumpXr[dir][i] - dumpXl[dir][i]);
+    }
+    for(size_t i = 0 ; i < gridXl[dir].size() ; i++) {
+      gridWidth = std::fmin(gridWidth, gridXr[dir][i] - gridXl[dir][i]);
+    }
+    ratio = std::fmax(ratio, dumpWidth/gridWidth);
+  }
+  #ifdef WITH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &ratio, 1, realMPI, MPI_MAX, MPI_COMM_WORLD);
+  #endif
+  return(ratio);
+}
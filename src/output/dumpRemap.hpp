@@ -0,0 +1,80 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#ifndef OUTPUT_DUMPREMAP_HPP_
+#define OUTPUT_DUMPREMAP_HPP_
+
+#include <array>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "idefix.hpp"
+#include "dump.hpp"
+
+// Restart from a dump written on a different grid (resolution and/or extent).
+// Each process reads the part of the dump grid overlapping its own domain, and remaps it:
+//  - cell-centered fields are averaged over the overlap of the old and new cells, weighted by
+//    the volume of the overlap. The volume integral of each field is conserved.
+//  - face-centered fields (the magnetic field) are prolongated by splitting the flux of each old
+//    face among the new faces, direction after direction, so that the magnetic flux through
+//    each old face is conserved and the new field is divergence-free to machine precision.
+//    This requires the new grid to be a refinement of the old one (every old face is a new face).
+//  - edge-centered fields (the vector potential) are averaged along the edge and interpolated
+//    linearly across it. The magnetic field derived from them is divergence-free by construction.
+class DumpRemap {
+ public:
+  using Coordinates = std::array<std::vector<real>,3>;
+  // Cell left and right edges of the dump grid in each direction
+  DumpRemap(Dump *, const Coordinates &, const Coordinates &);
+
+  // Part of the dump grid to be read by this process
+  GridBox GetReadBox() const;
+  // Number of points of a field of the read box with the given location and direction
+  std::array<int,3> GetReadSize(DumpField::ArrayLocation, int) const;
+
+  // Remap a field read in the box (face-centered fields are only stored until Finalize)
+  void Remap(const std::string &, const DumpField &, const real *);
+  // Prolongate the face-centered fields
+  void Finalize();
+
+  // Largest ratio between the smallest cell widths of the dump grid and of the current grid
+  real GetRefinement() const;
+
+ private:
+  using Weights = std::vector<std::vector<std::pair<int,real>>>;
+
+  void ComputeCellWeights(int, bool, Weights &) const;
+  void ComputeFaceWeights(int, Weights &) const;
+  void Apply(const std::array<const Weights*,3> &, const std::array<int,3> &,
+             const std::array<int,3> &, const real *, IdefixHostArray3D<real> &) const;
+  void Prolongate(std::array<const DumpField*,3> &, std::array<std::vector<real>,3> &);
+
+  Dump *dump;
+  DataBlock *data;
+
+  Coordinates dumpXl;               // Dump grid (global)
+  Coordinates dumpXr;
+  Coordinates gridXl;               // Current grid (local, without ghosts)
+  Coordinates gridXr;
+
+  std::array<int,3> overlapLo;      // First dump cell overlapping the local domain
+  std::array<int,3> overlapHi;      // Last dump cell overlapping the local domain +1
+  std::array<int,3> lo;             // First dump cell read by this process
+  std::array<int,3> hi;             // Last dump cell read by this process +1
+  std::array<real,3> tolerance;     // On the coordinates of coincident faces
+
+  std::array<Weights,3> volumeWeights;   // Overlap volume fractions
+  std::array<Weights,3> lineWeights;     // Overlap length fractions (along edges)
+  std::array<Weights,3> faceWeights;     // Linear interpolation on the cell faces
+
+  // Face-centered fields, waiting for all of their components
+  std::map<std::string, std::array<const DumpField*,3>> faceFields;
+  std::map<std::string, std::array<std::vector<real>,3>> faceData;
+};
+
+#endif // OUTPUT_DUMPREMAP_HPP_
@@ -0,0 +1,453 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <chrono> // NOLINT [build/c++11]
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "dumpStaging.hpp"
+#include "gridHost.hpp"
+#include "version.hpp"
+
+DumpStaging::DumpStaging(Input &input, Dump *dump): dump(dump) {
+  localDirectory = input.Get<std::string>("Output","dmp_local",0);
+  nKeep = input.GetOrSet<int>("Output","dmp_local",1,1);
+  if(nKeep < 1) {
+    IDEFIX_ERROR("[Output]:dmp_local should keep at least one node-local dump per process");
+  }
+  // All the processes of a node may try to create the directory at the same time
+  std::error_code error;
+  fs::create_directories(localDirectory, error);
+  if(!fs::is_directory(localDirectory)) {
+    std::stringstream msg;
+    msg << "Cannot create the node-local dump directory " << localDirectory << std::endl;
+    IDEFIX_ERROR(msg);
+  }
+}
+
+DumpStaging::~DumpStaging() {
+  // Do not leave before the last dump has reached the parallel filesystem
+  Wait();
+}
+
+void DumpStaging::ShowConfig() {
+  idfx::cout << "Dump: multi-level checkpoints, dumps are staged in " << localDirectory
+             << " (" << nKeep << " kept per process) and drained in the background."
+             << std::endl;
+}
+
+fs::path DumpStaging::LocalFile(int number) const {
+  std::stringstream ssFileName;
+  ssFileName << "dump." << std::setfill('0') << std::setw(4) << number
+             << ".r" << std::setw(5) << idfx::prank << ".ldmp";
+  return(localDirectory/ssFileName.str());
+}
+
+// Numbers of the complete level-1 dumps of this process, in increasing order
+std::vector<int> DumpStaging::LocalDumps() const {
+  std::vector<int> dumps;
+  std::stringstream ssSuffix;
+  ssSuffix << ".r" << std::setfill('0') << std::setw(5) << idfx::prank << ".ldmp";
+  const std::string suffix = ssSuffix.str();
+  for(const auto &entry : fs::directory_iterator(localDirectory)) {
+    const std::string name = entry.path().filename().string();
+    if(name.size() <= suffix.size() + 5 || name.compare(0, 5, "dump.") != 0) continue;
+    if(name.compare(name.size()-suffix.size(), suffix.size(), suffix) != 0) continue;
+    try {
+      dumps.push_back(std::stoi(name.substr(5, name.size()-suffix.size()-5)));
+    } catch(...) {
+      // not one of our files
+    }
+  }
+  std::sort(dumps.begin(), dumps.end());
+  return(dumps);
+}
+
+void DumpStaging::RemoveOldLocalDumps() {
+  std::vector<int> dumps = LocalDumps();
+  for(int n = 0 ; n < static_cast<int>(dumps.size()) - nKeep ; n++) {
+    std::error_code error;
+    fs::remove(LocalFile(dumps[n]), error);
+  }
+}
+
+// Go through all the pieces of a dump file, in the order and format of Dump::Write. For each
+// piece, piece(type, offset in the dump file, pointer, size in bytes) is called. When reading,
+// the pointed memory is filled by piece() and then loaded in the dumped fields, so the
+// pieces should only be read once they are known to be valid.
+template <typename Function>
+void DumpStaging::Traverse(bool read, Function &&piece) {
+  #ifndef SINGLE_PRECISION
+  const DataType realType = DoubleType;
+  #else
+  const DataType realType = SingleType;
+  #endif
+  DataBlock *data = dump->data;
+  int64_t offset = 0;
+
+  auto metadata = [&](std::vector<char> bytes) {
+    piece(PieceType::Metadata, offset, bytes.data(), static_cast<int64_t>(bytes.size()));
+    offset += bytes.size();
+  };
+  // Name, type and dimensions that precede each field
+  auto fieldHeader = [](const std::string &name, int type, int ndim, const int *dim) {
+    std::vector<char> bytes(NAMESIZE+(2+ndim)*sizeof(int), 0);
+    std::snprintf(bytes.data(), NAMESIZE, "%s", name.c_str());
+    std::memcpy(bytes.data()+NAMESIZE, &type, sizeof(int));
+    std::memcpy(bytes.data()+NAMESIZE+sizeof(int), &ndim, sizeof(int));
+    std::memcpy(bytes.data()+NAMESIZE+2*sizeof(int), dim, ndim*sizeof(int));
+    return(bytes);
+  };
+
+  // File header
+  std::string endian = "big";
+  int tmp1 = 1;
+  if(*reinterpret_cast<unsigned char *>(&tmp1) != 0) endian = "little";
+  std::vector<char> header(HEADERSIZE, 0);
+  std::snprintf(header.data(), HEADERSIZE, "Idefix %s Dump Data %s endian",
+                IDEFIX_VERSION, endian.c_str());
+  metadata(header);
+
+  // Coordinates
+  GridHost gridHost(*data->mygrid);
+  gridHost.SyncFromDevice();
+  for(int dir = 0 ; dir < 3 ; dir++) {
+    const int n = gridHost.np_int[dir];
+    const std::array<IdefixHostArray1D<real>,3> coords = {gridHost.x[dir], gridHost.xl[dir],
+                                                          gridHost.xr[dir]};
+    const std::array<std::string,3> names = {"x", "xl", "xr"};
+    for(int c = 0 ; c < 3 ; c++) {
+      std::vector<char> bytes = fieldHeader(names[c]+std::to_string(dir+1), realType, 1, &n);
+      const char *x = reinterpret_cast<const char *>(coords[c].data()+gridHost.nghost[dir]);
+      bytes.insert(bytes.end(), x, x+n*sizeof(real));
+      metadata(bytes);
+    }
+  }
+
+  // Non-uniform domain decomposition of load-balanced runs
+  if(data->mygrid->haveLoadBalance) {
+    std::vector<int> layout = data->mygrid->GetDecomposition();
+    const int n = layout.size();
+    std::vector<char> bytes = fieldHeader("decomposition", IntegerType, 1, &n);
+    const char *l = reinterpret_cast<const char *>(layout.data());
+    bytes.insert(bytes.end(), l, l+n*sizeof(int));
+    metadata(bytes);
+  }
+
+  std::vector<real> row;
+  for(auto const& [name, scalar] : dump->dumpFieldMap) {
+    if(scalar.GetType() == DumpField::Type::IdefixArray) {
+      auto field = scalar.template GetHostField<IdefixHostArray3D<real>>();
+      const int dir = scalar.GetDirection();
+      int nx[3], nxtot[3], start[3];
+      for(int i = 0 ; i < 3 ; i++) {
+        nx[i] = data->np_int[i];
+        nxtot[i] = data->mygrid->np_int[i];
+        start[i] = data->gbeg[i] - data->nghost[i];
+      }
+      // Same extra faces and edges as in Dump::Write. On restart, Dump::Read also loads the
+      // faces and edges shared with the next process, which are staged as halo pieces.
+      int nxRead[3] = {nx[IDIR], nx[JDIR], nx[KDIR]};
+      if(scalar.GetLocation() == DumpField::ArrayLocation::Face) {
+        if(data->mygrid->xproc[dir] == data->mygrid->nproc[dir] - 1) nx[dir]++;
+        nxtot[dir]++;
+        nxRead[dir]++;
+      }
+      if(scalar.GetLocation() == DumpField::ArrayLocation::Edge) {
+        for(int i = 0 ; i < DIMENSIONS ; i++) {
+          if(i != dir) {
+            if(data->mygrid->xproc[i] == data->mygrid->nproc[i] - 1) nx[i]++;
+            nxtot[i]++;
+            nxRead[i]++;
+          }
+        }
+      }
+      metadata(fieldHeader(name, realType, 3, nxtot));
+
+      // Each row along x1 is a contiguous piece of the dump file
+      row.resize(nxRead[IDIR]);
+      for(int k = 0 ; k < nxRead[KDIR] ; k++) {
+        for(int j = 0 ; j < nxRead[JDIR] ; j++) {
+          const int64_t position = (static_cast<int64_t>(start[KDIR]+k)*nxtot[JDIR]
+                                    + start[JDIR]+j)*nxtot[IDIR] + start[IDIR];
+          if(!read) {
+            for(int i = 0 ; i < nxRead[IDIR] ; i++) {
+              row[i] = field(k+data->beg[KDIR], j+data->beg[JDIR], i+data->beg[IDIR]);
+            }
+          }
+          const bool dumped = (k < nx[KDIR] && j < nx[JDIR]);
+          const int nDumped = dumped ? nx[IDIR] : 0;
+          if(dumped) {
+            piece(PieceType::Data, offset + position*static_cast<int64_t>(sizeof(real)),
+                  row.data(), static_cast<int64_t>(nDumped*sizeof(real)));
+          }
+          if(nxRead[IDIR] > nDumped) {
+            piece(PieceType::Halo, offset + (position+nDumped)*static_cast<int64_t>(sizeof(real)),
+                  row.data()+nDumped, static_cast<int64_t>((nxRead[IDIR]-nDumped)*sizeof(real)));
+          }
+          if(read) {
+            for(int i = 0 ; i < nxRead[IDIR] ; i++) {
+              field(k+data->beg[KDIR], j+data->beg[JDIR], i+data->beg[IDIR]) = row[i];
+            }
+          }
+        }
+      }
+      offset += static_cast<int64_t>(nxtot[IDIR])*nxtot[JDIR]*nxtot[KDIR]*sizeof(real);
+      if(read) scalar.SyncFrom(field);
+    } else {
+      // Fundamental type, written by the root process only
+      DataType type;
+      int size;
+      if(scalar.GetType()==DumpField::Type::Int) {
+        type = DataType::IntegerType;
+        size = sizeof(int);
+      } else if(scalar.GetType()==DumpField::Type::Single) {
+        type = DataType::SingleType;
+        size = sizeof(float);
+      } else if(scalar.GetType()==DumpField::Type::Double) {
+        type = DataType::DoubleType;
+        size = sizeof(double);
+      } else {
+        type = DataType::BoolType;
+        size = sizeof(bool);
+      }
+      const int n = scalar.GetSize();
+      metadata(fieldHeader(name, type, 1, &n));
+      piece(PieceType::Scalar, offset, scalar.template GetHostField<void*>(),
+            static_cast<int64_t>(n)*size);
+      offset += static_cast<int64_t>(n)*size;
+    }
+  }
+
+  // End of file
+  const int one = 1;
+  std::vector<char> eof = fieldHeader("eof", realType, 1, &one);
+  eof.resize(eof.size()+sizeof(real), 0);
+  metadata(eof);
+}
+
+// Copy the records of a level-1 file into the level-2 file. This is executed by the drainer
+// thread, and hence must not call MPI nor Kokkos.
+bool DumpStaging::Drain(const fs::path localFile, const fs::path globalFile,
+                        const bool drainScalars) {
+  FILE *in = fopen(localFile.c_str(), "rb");
+  if(in == NULL) return(false);
+  const int fd = open(globalFile.c_str(), O_WRONLY);
+  if(fd < 0) {
+    fclose(in);
+    return(false);
+  }
+  bool success = true;
+  std::vector<char> buffer;
+  Record record;
+  while(success && fread(&record, sizeof(Record), 1, in) == 1) {
+    buffer.resize(record.size);
+    if(fread(buffer.data(), 1, record.size, in) != record.size) {
+      success = false;
+      break;
+    }
+    // The fundamental types are identical on all processes: only the root process writes them
+    if(record.type == static_cast<int32_t>(PieceType::Scalar) && !drainScalars) continue;
+    // Halos belong to the dump of the next process
+    if(record.type == static_cast<int32_t>(PieceType::Halo)) continue;
+    int64_t written = 0;
+    while(written < record.size) {
+      const ssize_t n = pwrite(fd, buffer.data()+written, record.size-written,
+                               record.offset+written);
+      if(n <= 0) {
+        success = false;
+        break;
+      }
+      written += n;
+    }
+  }
+  if(ferror(in)) success = false;
+  if(fsync(fd) != 0) success = false;
+  if(close(fd) != 0) success = false;
+  fclose(in);
+  return(success);
+}
+
+bool DumpStaging::Write(int number, const fs::path &filename) {
+  idfx::pushRegion("DumpStaging::Write");
+  // Only one dump is drained at a time
+  Wait();
+
+  // Level 1: node-local copy. It only gets its final name once complete
+  const fs::path localFile = LocalFile(number);
+  fs::path tmpFile = localFile;
+  tmpFile += ".tmp";
+  FILE *fileHdl = fopen(tmpFile.c_str(), "wb");
+  bool success = (fileHdl != NULL);
+  Traverse(false, [&](PieceType type, int64_t offset, void *ptr, int64_t size) {
+    if(type == PieceType::Metadata && idfx::prank != 0) return;
+    if(!success) return;
+    Record record{offset, size, static_cast<int32_t>(type), 0};
+    success = fwrite(&record, sizeof(Record), 1, fileHdl) == 1
+              && fwrite(ptr, 1, size, fileHdl) == size;
+  });
+  if(fileHdl != NULL && fclose(fileHdl) != 0) success = false;
+  std::error_code error;
+  if(success) fs::rename(tmpFile, localFile, error);
+  if(error) success = false;
+
+  int allSuccess = success;
+  #ifdef WITH_MPI
+    MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &allSuccess, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD));
+  #endif
+  if(!allSuccess) {
+    fs::remove(tmpFile, error);
+    fs::remove(localFile, error);
+    IDEFIX_WARNING("Cannot stage the dump in " + localDirectory.string()
+                   + ", it is written directly instead.");
+    idfx::popRegion();
+    return(false);
+  }
+  RemoveOldLocalDumps();
+
+  // Level 2: the dump file is created before any process drains into it, and is only renamed
+  // once all the processes are done (see Wait())
+  fs::path partFile = filename;
+  partFile += ".part";
+  if(idfx::prank == 0) {
+    const int fd = open(partFile.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if(fd >= 0) close(fd);
+  }
+  #ifdef WITH_MPI
+    MPI_SAFE_CALL(MPI_Barrier(MPI_COMM_WORLD));
+  #endif
+
+  pendingNumber = number;
+  pendingFile = filename;
+  drainSuccess = false;
+  const bool drainScalars = (idfx::prank == 0);
+  drainer = std::thread([this, localFile, partFile, drainScalars]() {
+    auto start = std::chrono::steady_clock::now();
+    drainSuccess = Drain(localFile, partFile, drainScalars);
+    drainTime = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  });
+
+  idfx::popRegion();
+  return(true);
+}
+
+void DumpStaging::Wait() {
+  if(pendingNumber < 0) return;
+  idfx::pushRegion("DumpStaging::Wait");
+  drainer.join();
+
+  int success = drainSuccess;
+  double time = drainTime;
+  #ifdef WITH_MPI
+    MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &success, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD));
+    MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD));
+  #endif
+  fs::path partFile = pendingFile;
+  partFile += ".part";
+  // Restarts never see incomplete dump files
+  int renamed = success;
+  if(success && idfx::prank == 0) {
+    std::error_code error;
+    fs::rename(partFile, pendingFile, error);
+    if(error) renamed = false;
+  }
+  #ifdef WITH_MPI
+    MPI_SAFE_CALL(MPI_Bcast(&renamed, 1, MPI_INT, 0, MPI_COMM_WORLD));
+  #endif
+  if(renamed) {
+    idfx::cout << "Dump: file n " << pendingNumber << " drained to " << pendingFile
+               << " in " << time << " s." << std::endl;
+  } else {
+    std::stringstream msg;
+    msg << "Dump file n " << pendingNumber << " could not be drained to " << pendingFile
+        << ", it is only available in " << localDirectory << ".";
+    IDEFIX_WARNING(msg);
+  }
+  pendingNumber = -1;
+  idfx::popRegion();
+}
+
+bool DumpStaging::Read(int readNumber, int globalNumber) {
+  idfx::pushRegion("DumpStaging::Read");
+  // Newest level-1 dump available on all the processes
+  std::vector<int> dumps = LocalDumps();
+  int number = readNumber;
+  if(number < 0) {
+    number = dumps.empty() ? -1 : dumps.back();
+    #ifdef WITH_MPI
+      MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &number, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD));
+    #endif
+  }
+  int usable = (number >= 0)
+               && (std::find(dumps.begin(), dumps.end(), number) != dumps.end())
+               && (readNumber >= 0 || number >= globalNumber);
+  #ifdef WITH_MPI
+    MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &usable, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD));
+  #endif
+  if(!usable) {
+    idfx::popRegion();
+    return(false);
+  }
+
+  idfx::cout << "Dump: Reading node-local dump n " << number << " from " << localDirectory
+             << "..." << std::flush;
+  Kokkos::Timer timer;
+  FILE *fileHdl = fopen(LocalFile(number).c_str(), "rb");
+  bool success = (fileHdl != NULL);
+  // The records are first staged in memory, without touching the fields, and are only loaded
+  // once we know that the whole dump can be read by all the processes
+  std::vector<char> staged;
+  Traverse(false, [&](PieceType type, int64_t offset, void *ptr, int64_t size) {
+    if(type == PieceType::Metadata && idfx::prank != 0) return;
+    if(!success) return;
+    // The records should match the fields and the domain decomposition of this run
+    Record record;
+    success = fread(&record, sizeof(Record), 1, fileHdl) == 1 && record.offset == offset
+              && record.size == size && record.type == static_cast<int32_t>(type);
+    if(!success) return;
+    if(type == PieceType::Metadata) {
+      // The coordinates, names and sizes of the fields should be those of this run. Only the
+      // file header (at offset 0) may differ, by the version of the code.
+      std::vector<char> bytes(size);
+      success = fread(bytes.data(), 1, size, fileHdl) == size
+                && (offset == 0 || std::memcmp(bytes.data(), ptr, size) == 0);
+    } else {
+      const size_t position = staged.size();
+      staged.resize(position+size);
+      success = fread(staged.data()+position, 1, size, fileHdl) == size;
+    }
+  });
+  if(fileHdl != NULL) fclose(fileHdl);
+
+  int allSuccess = success;
+  #ifdef WITH_MPI
+    MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &allSuccess, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD));
+  #endif
+  if(!allSuccess) {
+    idfx::cout << "failed." << std::endl;
+    IDEFIX_WARNING("The node-local dump does not match the current run and is ignored.");
+    idfx::popRegion();
+    return(false);
+  }
+  // The pieces are traversed in the same order, so the staged records are simply consumed
+  size_t position = 0;
+  Traverse(true, [&](PieceType type, int64_t offset, void *ptr, int64_t size) {
+    if(type == PieceType::Metadata) return;
+    std::memcpy(ptr, staged.data()+position, size);
+    position += size;
+  });
+  idfx::cout << "done in " << timer.seconds() << " s." << std::endl;
+  idfx::popRegion();
+  return(true);
+}
@@ -0,0 +1,75 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#ifndef OUTPUT_DUMPSTAGING_HPP_
+#define OUTPUT_DUMPSTAGING_HPP_
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "idefix.hpp"
+#include "input.hpp"
+#include "dump.hpp"
+
+// Multi-level checkpoints.
+// Each process first writes its part of a dump to node-local storage (level 1, e.g. a tmpfs),
+// which only takes a few seconds, and returns to the integration. A background thread then
+// drains it into the usual dump file of the parallel filesystem (level 2). The level-1 file of
+// each process is a list of records, each one being a piece of the dump file with its offset in
+// that file, so that draining only needs independent POSIX writes.
+// On restart, the newest level-1 dump available on all the processes is preferred to the
+// level-2 dumps.
+class DumpStaging {
+ public:
+  DumpStaging(Input &, Dump *);
+  ~DumpStaging();
+
+  // Stage the dump number n, to be drained into the given file. Returns false if the dump
+  // could not be staged, in which case it should be written directly.
+  bool Write(int, const fs::path &);
+  // Restart from the newest level-1 dump (or from the given dump number) when it is at least
+  // as recent as the level-2 dump number provided. Returns false if no level-1 dump was used.
+  bool Read(int, int);
+  // Wait for the pending drain, and make the level-2 dump visible once it is complete
+  void Wait();
+
+  void ShowConfig();
+
+ private:
+  // Halo pieces are the faces and edges shared with the next process, which are not drained
+  // but needed on restart
+  enum class PieceType {Metadata, Scalar, Data, Halo};
+  // Header of each record of the level-1 files
+  struct Record {
+    int64_t offset;     // offset in the level-2 dump file
+    int64_t size;       // size of the record, in bytes
+    int32_t type;       // PieceType
+    int32_t padding;
+  };
+
+  template <typename Function>
+  void Traverse(bool, Function &&);
+  static bool Drain(const fs::path, const fs::path, const bool);
+  fs::path LocalFile(int) const;
+  std::vector<int> LocalDumps() const;
+  void RemoveOldLocalDumps();
+
+  Dump *dump;
+  fs::path localDirectory;       // Node-local storage
+  int nKeep{1};                  // Number of level-1 dumps kept by each process
+
+  // Pending drain
+  std::thread drainer;
+  std::atomic<bool> drainSuccess{false};
+  double drainTime{0};
+  int pendingNumber{-1};
+  fs::path pendingFile;
+};
+
+#endif // OUTPUT_DUMPSTAGING_HPP_
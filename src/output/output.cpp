@@ -10,6 +10,7 @@
 #include "dataBlock.hpp"
 #include "fluid.hpp"
 #include "slice.hpp"
+#include "timeAverage.hpp"
 #include "dataBlockHost.hpp"
 
 #ifdef WITH_PYTHON
@@ -130,6 +131,17 @@ Output::Output(Input &input, DataBlock &data)
     }
   }
 
+  // Look for time-averaged outputs (in the form of VTK files)
+  if(input.CheckEntry("Output","vtk_avg1")>0) {
+    haveAverages = true;
+    int n = 1;
+    while(input.CheckEntry("Output","vtk_avg"+std::to_string(n))>0) {
+      averages.emplace_back(std::make_unique<TimeAverage>(input, data, n));
+      averages[n-1]->ShowConfig();
+      n++;
+    }
+  }
+
   // Initialise python script outputs
   if(input.CheckEntry("Output","python")>0) {
     #ifndef WITH_PYTHON
@@ -261,6 +273,14 @@ int Output::CheckForWrites(DataBlock &data) {
     }
   }
 
+  if(haveAverages) {
+    elapsedTime -= timer.seconds();
+    for(int i = 0 ; i < averages.size() ; i++) {
+      averages[i]->CheckForWrite(data);
+    }
+    elapsedTime += timer.seconds();
+  }
+
   #ifdef WITH_PYTHON
   if(pythonEnabled) {
     if(data.t >= pythonLast + pythonPeriod) {
@@ -304,7 +324,7 @@ int Output::CheckForWrites(DataBlock &data) {
     // so it's important that this part happens last.
     if(havePeriodicDump || haveClockDump) {
       elapsedTime -= timer.seconds();
-      data.dump->Write(*this);
+      data.dump->Write(*this, true);
       nfiles++;
       elapsedTime += timer.seconds();
 
@@ -332,12 +352,13 @@ bool Output::RestartFromDump(DataBlock &data, int readNumber) {
   return(result);
 }
 
-void Output::ForceWriteDump(DataBlock &data) {
+int Output::ForceWriteDump(DataBlock &data) {
   idfx::pushRegion("Output::ForceWriteDump");
-
-  if(!forceNoWrite) data.dump->Write(*this);
+  int dumpNumber = -1;
+  if(!forceNoWrite) dumpNumber = data.dump->Write(*this);
 
   idfx::popRegion();
+  return(dumpNumber);
 }
 
 void Output::ForceWriteVtk(DataBlock &data) {
@@ -23,6 +23,7 @@
 #endif
 #include "dump.hpp"
 #include "slice.hpp"
+#include "timeAverage.hpp"
 
 using AnalysisFunc = void (*) (DataBlock &);
 
@@ -41,7 +42,7 @@ class Output {
   Output(Input &, DataBlock &);           // Create Output Object
   int CheckForWrites(DataBlock &);        // Check if outputs are needed at this stage
   bool RestartFromDump(DataBlock &, int);  // Restart from a dump file.
-  void ForceWriteDump(DataBlock &);            // Force write dumps (needed during an abort)
+  int ForceWriteDump(DataBlock &);             // Force write dumps (returns the dump number)
   void ForceWriteVtk(DataBlock &);            // Force write vtks
   #ifdef WITH_HDF5
   void ForceWriteXdmf(DataBlock &);          // Force write xdmfs
@@ -82,6 +83,9 @@ class Output {
   bool haveSlices = false;
   std::vector<std::unique_ptr<Slice>> slices;
 
+  bool haveAverages = false;
+  std::vector<std::unique_ptr<TimeAverage>> averages;
+
   #ifdef WITH_PYTHON
     Pydefix pydefix;
     bool pythonEnabled = false;
@@ -0,0 +1,280 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#include <string>
+#include <memory>
+#include <vector>
+#include "timeAverage.hpp"
+#include "input.hpp"
+#include "physics.hpp"
+#include "dataBlock.hpp"
+#include "fluid.hpp"
+#include "gridHost.hpp"
+#include "vtk.hpp"
+
+TimeAverage::TimeAverage(Input &input, DataBlock &data, int nAverage): nAverage(nAverage) {
+  idfx::pushRegion("TimeAverage::TimeAverage");
+  const std::string entry = "vtk_avg"+std::to_string(nAverage);
+  const std::string prefix = "avg"+std::to_string(nAverage);
+
+  const int nParams = input.CheckEntry("Output", entry);
+  if(nParams < 4) {
+    IDEFIX_ERROR("[Output]:"+entry+" expects a period, a sampling interval (in cycles), "
+                 "a direction and at least one quantity");
+  }
+  this->averagePeriod = input.Get<real>("Output", entry, 0);
+  this->sampleEvery = input.Get<int>("Output", entry, 1);
+  this->direction = input.Get<int>("Output", entry, 2);
+  if(averagePeriod <= 0.0) {
+    IDEFIX_ERROR("[Output]:"+entry+" the averaging period should be positive");
+  }
+  if(sampleEvery < 1) {
+    IDEFIX_ERROR("[Output]:"+entry+" the sampling interval should be at least one cycle");
+  }
+  if(direction < -1 || direction >= DIMENSIONS) {
+    IDEFIX_ERROR("[Output]:"+entry+" the direction should be -1 (none) or a dimension of the"
+                 " domain");
+  }
+  // The first average covers one full period
+  this->averageLast = data.t;
+  this->sampleLast = data.t;
+  data.dump->RegisterVariable(&averageLast, std::string("avgLast-")+std::to_string(nAverage));
+  data.dump->RegisterVariable(&sampleLast, std::string("avgSample-")+std::to_string(nAverage));
+  data.dump->RegisterVariable(&cycle, std::string("avgCycle-")+std::to_string(nAverage));
+
+  // Reduce along direction on a subgrid located at the first cell of the domain
+  DataBlock *target = &data;
+  if(direction >= 0) {
+    GridHost gridHost(*data.mygrid);
+    gridHost.SyncFromDevice();
+    const real x0 = gridHost.x[direction](gridHost.nghost[direction]);
+    this->subgrid = std::make_unique<SubGrid>(data.mygrid, SliceType::Average, direction, x0);
+    this->averageData = std::make_unique<DataBlock>(subgrid.get());
+    this->containsX0 = (data.xbeg[direction] <= x0) && (data.xend[direction] > x0);
+    target = averageData.get();
+    #ifdef WITH_MPI
+      int remainDims[3] = {false, false, false};
+      remainDims[direction] = true;
+      MPI_SAFE_CALL(MPI_Cart_sub(data.mygrid->CartComm, remainDims, &avgComm));
+    #endif
+  }
+
+  this->vtk = std::make_unique<Vtk>(input, target, prefix);
+  data.dump->RegisterVariable(&vtk->vtkFileNumber,
+                              std::string("avgNumber-")+std::to_string(nAverage));
+
+  // Quantities, as products of primitive variables: "RHO", "VX1*VX2", "RHO*VX1*VX2"...
+  const std::vector<std::string> &VcName = data.hydro->VcName;
+  for(int n = 3 ; n < nParams ; n++) {
+    Quantity q;
+    q.name = input.Get<std::string>("Output", entry, n);
+    q.factors.fill(-1);
+    int nFactors = 0;
+    size_t begin = 0;
+    while(begin <= q.name.size()) {
+      size_t end = q.name.find('*', begin);
+      if(end == std::string::npos) end = q.name.size();
+      const std::string factor = q.name.substr(begin, end-begin);
+      int index = -1;
+      for(int nv = 0 ; nv < VcName.size() ; nv++) {
+        if(VcName[nv] == factor) index = nv;
+      }
+      if(index < 0) {
+        IDEFIX_ERROR("[Output]:"+entry+" unknown variable "+factor+" in "+q.name);
+      }
+      if(nFactors == maxFactors) {
+        IDEFIX_ERROR("[Output]:"+entry+" "+q.name+" has more than "
+                     +std::to_string(maxFactors)+" factors");
+      }
+      q.factors[nFactors++] = index;
+      begin = end+1;
+    }
+    q.accumulator = IdefixArray3D<real>("TimeAverage_"+q.name,
+                                        target->np_tot[KDIR],
+                                        target->np_tot[JDIR],
+                                        target->np_tot[IDIR]);
+    q.average = IdefixHostArray3D<real>("TimeAverage_Vc",
+                                        target->np_tot[KDIR],
+                                        target->np_tot[JDIR],
+                                        target->np_tot[IDIR]);
+    vtk->RegisterVariable(q.average, q.name);
+    quantities.push_back(q);
+  }
+
+  // Time averages carry on across restarts. The line integrals of volume-averaged quantities
+  // only span the local subdomain and depend on the decomposition, so these restart their
+  // averaging window instead.
+  if(direction < 0) {
+    for(int n = 0 ; n < quantities.size() ; n++) {
+      data.dump->RegisterVariable(quantities[n].accumulator,
+                                  "avgAcc-"+std::to_string(nAverage)+"-"+std::to_string(n));
+    }
+    data.dump->RegisterVariable(&weight, std::string("avgWeight-")+std::to_string(nAverage));
+  }
+
+  // Volume of each line along direction, to normalise the spatial averages
+  if(direction >= 0) {
+    IdefixArray3D<real> volume("TimeAverage_lineVolume", target->np_tot[KDIR],
+                                                          target->np_tot[JDIR],
+                                                          target->np_tot[IDIR]);
+    IdefixArray3D<real> dV = data.dV;
+    const int dir = direction;
+    const int nbeg = data.beg[dir];
+    const int nend = data.end[dir];
+    idefix_for("TimeAverage_LineVolume", 0, target->np_tot[KDIR],
+                                         0, target->np_tot[JDIR],
+                                         0, target->np_tot[IDIR],
+      KOKKOS_LAMBDA (int k, int j, int i) {
+        real sum = 0;
+        for(int n = nbeg ; n < nend ; n++) {
+          sum += dV(dir == KDIR ? n : k, dir == JDIR ? n : j, dir == IDIR ? n : i);
+        }
+        volume(k,j,i) = sum;
+      });
+    lineVolume = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), volume);
+    #ifdef WITH_MPI
+      MPI_Allreduce(MPI_IN_PLACE, lineVolume.data(), lineVolume.size(),
+                    realMPI, MPI_SUM, avgComm);
+    #endif
+  }
+  idfx::popRegion();
+}
+
+// Defined here, where the classes held by unique pointers are complete
+TimeAverage::~TimeAverage() {
+  #ifdef WITH_MPI
+    if(avgComm != MPI_COMM_NULL) MPI_Comm_free(&avgComm);
+  #endif
+}
+
+void TimeAverage::ShowConfig() {
+  idfx::cout << "Output: time averages avg" << nAverage << " every " << averagePeriod
+             << ", sampled every " << sampleEvery << " cycles";
+  if(direction >= 0) idfx::cout << " and averaged along X" << direction+1;
+  idfx::cout << ":";
+  for(auto const &q : quantities) idfx::cout << " " << q.name;
+  idfx::cout << "." << std::endl;
+}
+
+// Add the current state to the time integrals, weighted by the time elapsed since the last
+// sample
+void TimeAverage::Accumulate(DataBlock &data) {
+  idfx::pushRegion("TimeAverage::Accumulate");
+  const real w = data.t - sampleLast;
+  sampleLast = data.t;
+  if(w <= 0.0) {
+    idfx::popRegion();
+    return;
+  }
+  weight += w;
+
+  IdefixArray4D<real> Vc = data.hydro->Vc;
+  IdefixArray3D<real> dV = data.dV;
+  const int dir = direction;
+  int beg[3], end[3];
+  for(int d = 0 ; d < 3 ; d++) {
+    beg[d] = data.beg[d];
+    end[d] = data.end[d];
+  }
+  int nbeg = 0, nend = 0;
+  if(dir >= 0) {
+    nbeg = beg[dir];
+    nend = end[dir];
+    beg[dir] = 0;
+    end[dir] = 1;
+  }
+
+  for(auto &q : quantities) {
+    IdefixArray3D<real> acc = q.accumulator;
+    const int f0 = q.factors[0];
+    const int f1 = q.factors[1];
+    const int f2 = q.factors[2];
+    if(dir < 0) {
+      idefix_for("TimeAverage_Accumulate", beg[KDIR], end[KDIR],
+                                           beg[JDIR], end[JDIR],
+                                           beg[IDIR], end[IDIR],
+        KOKKOS_LAMBDA (int k, int j, int i) {
+          real v = Vc(f0,k,j,i);
+          if(f1 >= 0) v *= Vc(f1,k,j,i);
+          if(f2 >= 0) v *= Vc(f2,k,j,i);
+          acc(k,j,i) += w*v;
+        });
+    } else {
+      // Each thread integrates one line along dir
+      idefix_for("TimeAverage_AccumulateLine", beg[KDIR], end[KDIR],
+                                               beg[JDIR], end[JDIR],
+                                               beg[IDIR], end[IDIR],
+        KOKKOS_LAMBDA (int k, int j, int i) {
+          real sum = 0;
+          for(int n = nbeg ; n < nend ; n++) {
+            const int kk = (dir == KDIR) ? n : k;
+            const int jj = (dir == JDIR) ? n : j;
+            const int ii = (dir == IDIR) ? n : i;
+            real v = Vc(f0,kk,jj,ii);
+            if(f1 >= 0) v *= Vc(f1,kk,jj,ii);
+            if(f2 >= 0) v *= Vc(f2,kk,jj,ii);
+            sum += v*dV(kk,jj,ii);
+          }
+          acc(k,j,i) += w*sum;
+        });
+    }
+  }
+  idfx::popRegion();
+}
+
+void TimeAverage::Write(DataBlock &data) {
+  idfx::pushRegion("TimeAverage::Write");
+  for(auto &q : quantities) {
+    auto acc = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), q.accumulator);
+    if(direction < 0) {
+      for(int k = 0 ; k < acc.extent(0) ; k++) {
+        for(int j = 0 ; j < acc.extent(1) ; j++) {
+          for(int i = 0 ; i < acc.extent(2) ; i++) {
+            q.average(k,j,i) = weight > 0.0 ? acc(k,j,i)/weight : 0.0;
+      }}}
+    } else {
+      #ifdef WITH_MPI
+        MPI_Allreduce(MPI_IN_PLACE, acc.data(), acc.size(), realMPI, MPI_SUM, avgComm);
+      #endif
+      for(int k = 0 ; k < acc.extent(0) ; k++) {
+        for(int j = 0 ; j < acc.extent(1) ; j++) {
+          for(int i = 0 ; i < acc.extent(2) ; i++) {
+            const real norm = weight*lineVolume(k,j,i);
+            q.average(k,j,i) = norm > 0.0 ? acc(k,j,i)/norm : 0.0;
+      }}}
+    }
+    // New averaging period
+    Kokkos::deep_copy(q.accumulator, 0.0);
+  }
+  weight = 0.0;
+
+  if(direction >= 0) averageData->t = data.t;
+  if(containsX0) {
+    vtk->Write();
+  } else {
+    vtk->vtkFileNumber++; // increment file number so that each process stay in sync
+  }
+  idfx::popRegion();
+}
+
+void TimeAverage::CheckForWrite(DataBlock &data) {
+  idfx::pushRegion("TimeAverage::CheckForWrite");
+  const bool haveWrite = (data.t >= averageLast + averagePeriod);
+  cycle++;
+  // Averages always extend up to the time they are written
+  if(cycle % sampleEvery == 0 || haveWrite) Accumulate(data);
+  if(haveWrite) {
+    Write(data);
+    averageLast += averagePeriod;
+    if(averageLast + averagePeriod <= data.t) {
+      while(averageLast <= data.t - averagePeriod) {
+        averageLast += averagePeriod;
+      }
+    }
+  }
+  idfx::popRegion();
+}
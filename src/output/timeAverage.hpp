@@ -0,0 +1,69 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+
+#ifndef OUTPUT_TIMEAVERAGE_HPP_
+#define OUTPUT_TIMEAVERAGE_HPP_
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include "idefix.hpp"
+#include "dataBlock.hpp"
+#include "input.hpp"
+
+class SubGrid;
+class Vtk;
+
+// In-situ time averages of products of primitive variables (e.g. RHO, VX1*VX1 or
+// RHO*VX1*VX2, from which variances and Reynolds/Maxwell stresses follow), optionally
+// volume-averaged along one direction. The accumulators live on the device and are
+// updated every few cycles; the averages are written to VTK files at the end of each
+// averaging period, and the accumulators are then reset.
+class TimeAverage {
+ public:
+  TimeAverage(Input &, DataBlock &, int);
+  ~TimeAverage();
+  void CheckForWrite(DataBlock &);
+  void ShowConfig();
+
+  real averagePeriod = 0.0;
+  real averageLast = 0.0;
+
+ private:
+  static constexpr int maxFactors = 3;
+  struct Quantity {
+    std::string name;
+    std::array<int, maxFactors> factors;   // Indices in Vc, -1 for unused factors
+    IdefixArray3D<real> accumulator;       // Time integral of the (reduced) quantity
+    IdefixHostArray3D<real> average;       // What is written in the vtk files
+  };
+
+  void Accumulate(DataBlock &);
+  void Write(DataBlock &);
+
+  int nAverage;
+  int direction{-1};                      // Reduced direction, -1 if none
+  int sampleEvery{1};                     // Number of cycles between two samples
+  int cycle{0};
+  real sampleLast{0};                     // Time of the last sample
+  real weight{0};                         // Time covered by the accumulators
+  bool containsX0{true};
+
+  std::vector<Quantity> quantities;
+  IdefixHostArray3D<real> lineVolume;     // Volume of each line along the reduced direction
+
+  std::unique_ptr<SubGrid> subgrid;
+  std::unique_ptr<DataBlock> averageData;
+  std::unique_ptr<Vtk> vtk;
+  #ifdef WITH_MPI
+    MPI_Comm avgComm{MPI_COMM_NULL};  // Communicator for the reductions along direction
+  #endif
+};
+
+#endif // OUTPUT_TIMEAVERAGE_HPP_
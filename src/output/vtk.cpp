@@ -11,6 +11,7 @@
 #include <cstdio>
 #include <sstream>
 #include <iomanip>
+#include <vector>
 #if __has_include(<filesystem>)
   #include <filesystem> // NOLINT [build/c++17]
   namespace fs = std::filesystem;
@@ -26,6 +27,7 @@
 #include "gridHost.hpp"
 #include "output.hpp"
 #include "fluid.hpp"
+#include "particles.hpp"
 
 #define VTK_RECTILINEAR_GRID    14
 #define VTK_STRUCTURED_GRID     35
@@ -280,8 +282,9 @@ Vtk::Vtk(Input &input, DataBlock *datain, std::string filebase) {
                 && (data->mygrid->xproc[2] == 0);
 #endif
 
-  // Register variables that are required in restart dumps
-  if(data->dump.get() != nullptr)
+  // Register variables that are required in restart dumps (other vtk outputs of this
+  // datablock, such as time averages, register their own file number)
+  if(data->dump.get() != nullptr && this->filebase == "data")
     data->dump->RegisterVariable(&vtkFileNumber, "vtkFileNumber");
 }
 
@@ -351,6 +354,11 @@ int Vtk::Write() {
   fclose(fileHdl);
 #endif
 
+  // Particles are written in a separate polydata file with the same number
+  if(data->haveParticles && this->filebase == "data") {
+    WriteParticles(outputDirectory/("particles."+ssvtkFileNum.str()+".vtk"));
+  }
+
   vtkFileNumber++;
   // Make file number
   idfx::cout << "done in " << timer.seconds() << " s." << std::endl;
@@ -361,6 +369,138 @@ int Vtk::Write() {
 }
 
 
+void Vtk::WriteParticles(const fs::path &filename) {
+  idfx::pushRegion("Vtk::WriteParticles");
+  Particles *particles = data->particles.get();
+
+  // Contiguous copy of the particles on the host
+  const int n = particles->count;
+  IdefixArray2D<real> buffer("Vtk_particles", Particles::nfield, n);
+  Kokkos::deep_copy(buffer, Kokkos::subview(particles->state, Kokkos::ALL(),
+                                            Kokkos::make_pair(0, n)));
+  auto host = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), buffer);
+
+  // Position of our particles in the file
+  int64_t first = 0;
+  int64_t total = n;
+#ifdef WITH_MPI
+  int rank;
+  MPI_Comm_rank(this->comm, &rank);
+  MPI_SAFE_CALL(MPI_Exscan(&total, &first, 1, MPI_INT64_T, MPI_SUM, this->comm));
+  if(rank == 0) first = 0;
+  MPI_SAFE_CALL(MPI_Allreduce(MPI_IN_PLACE, &total, 1, MPI_INT64_T, MPI_SUM, this->comm));
+#endif
+
+  std::vector<float> points(3*n);
+  std::vector<float> velocity(3*n);
+  std::vector<float> mass(n);
+  std::vector<int32_t> species(n);
+  std::vector<int32_t> vertices(2*n);
+  for(int p = 0 ; p < n ; p++) {
+    for(int dir = 0 ; dir < 3 ; dir++) {
+      points[3*p+dir] = bigEndian(static_cast<float>(host(Particles::PX1+dir,p)));
+      velocity[3*p+dir] = bigEndian(static_cast<float>(host(Particles::PV1+dir,p)));
+    }
+    mass[p] = bigEndian(static_cast<float>(host(Particles::PMASS,p)));
+    species[p] = bigEndian(static_cast<int32_t>(host(Particles::PSPECIES,p)));
+    vertices[2*p] = bigEndian(static_cast<int32_t>(1));
+    vertices[2*p+1] = bigEndian(static_cast<int32_t>(first+p));
+  }
+
+  if(this->isRoot) {
+    if(fs::exists(filename)) {
+      fs::remove(filename);
+    }
+  }
+
+  IdfxFileHandler fileHdl;
+#ifdef WITH_MPI
+  MPI_Barrier(this->comm);
+  MPI_SAFE_CALL(MPI_File_open(this->comm, filename.c_str(),
+                              MPI_MODE_CREATE | MPI_MODE_RDWR
+                              | MPI_MODE_EXCL | MPI_MODE_UNIQUE_OPEN,
+                              MPI_INFO_NULL, &fileHdl));
+  this->offset = 0;
+#else
+  fileHdl = fopen(filename.c_str(),"wb");
+  if(fileHdl == NULL) {
+    std::stringstream msg;
+    msg << "Unable to open file " << filename << std::endl;
+    msg << "Check that you have write access and that you don't exceed your quota." << std::endl;
+    IDEFIX_ERROR(msg);
+  }
+#endif
+
+  std::stringstream ssheader;
+  ssheader << "# vtk DataFile Version 2.0" << std::endl;
+  ssheader << "Idefix " << IDEFIX_VERSION << " VTK Particles" << std::endl;
+  ssheader << "BINARY" << std::endl;
+  ssheader << "DATASET POLYDATA" << std::endl;
+  ssheader << "FIELD FieldData 1" << std::endl;
+  ssheader << "TIME 1 1 float" << std::endl;
+  std::string header = ssheader.str();
+  WriteHeaderString(header.c_str(), fileHdl);
+  float timeBE = bigEndian(static_cast<float>(data->t));
+  WriteHeaderBinary(&timeBE, 1, fileHdl);
+
+  ssheader.str(std::string());
+  ssheader << std::endl << "POINTS " << total << " float" << std::endl;
+  header = ssheader.str();
+  WriteHeaderString(header.c_str(), fileHdl);
+  WriteParticleData(fileHdl, points, 3, first, total);
+
+  ssheader.str(std::string());
+  ssheader << std::endl << "VERTICES " << total << " " << 2*total << std::endl;
+  header = ssheader.str();
+  WriteHeaderString(header.c_str(), fileHdl);
+  WriteParticleData(fileHdl, vertices, 2, first, total);
+
+  ssheader.str(std::string());
+  ssheader << std::endl << "POINT_DATA " << total << std::endl;
+  ssheader << "VECTORS VELOCITY float" << std::endl;
+  header = ssheader.str();
+  WriteHeaderString(header.c_str(), fileHdl);
+  WriteParticleData(fileHdl, velocity, 3, first, total);
+
+  ssheader.str(std::string());
+  ssheader << std::endl << "SCALARS MASS float" << std::endl;
+  ssheader << "LOOKUP_TABLE default" << std::endl;
+  header = ssheader.str();
+  WriteHeaderString(header.c_str(), fileHdl);
+  WriteParticleData(fileHdl, mass, 1, first, total);
+
+  ssheader.str(std::string());
+  ssheader << std::endl << "SCALARS SPECIES int" << std::endl;
+  ssheader << "LOOKUP_TABLE default" << std::endl;
+  header = ssheader.str();
+  WriteHeaderString(header.c_str(), fileHdl);
+  WriteParticleData(fileHdl, species, 1, first, total);
+
+#ifdef WITH_MPI
+  MPI_SAFE_CALL(MPI_File_close(&fileHdl));
+#else
+  fclose(fileHdl);
+#endif
+  idfx::popRegion();
+}
+
+// Write the ncomp values of each particle of this process, the first one being particle first
+template<typename T>
+void Vtk::WriteParticleData(IdfxFileHandler fvtk, const std::vector<T> &in, int ncomp,
+                            int64_t first, int64_t total) {
+#ifdef WITH_MPI
+  MPI_SAFE_CALL(MPI_File_set_view(fvtk, this->offset, MPI_BYTE, MPI_CHAR,
+                                  "native", MPI_INFO_NULL));
+  MPI_SAFE_CALL(MPI_File_write_at_all(fvtk, first*ncomp*sizeof(T), in.data(),
+                                      in.size()*sizeof(T), MPI_CHAR, MPI_STATUS_IGNORE));
+  this->offset = this->offset + total*ncomp*sizeof(T);
+#else
+  if(fwrite(in.data(), sizeof(T), in.size(), fvtk) != in.size()) {
+    IDEFIX_ERROR("Unable to write to file. Check your filesystem permissions and disk quota.");
+  }
+#endif
+}
+
 /* ********************************************************************* */
 void Vtk::WriteHeader(IdfxFileHandler fvtk, real time) {
 /*!
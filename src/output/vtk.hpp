@@ -9,6 +9,7 @@
 #define OUTPUT_VTK_HPP_
 #include <string>
 #include <map>
+#include <vector>
 #if __has_include(<filesystem>)
   #include <filesystem> // NOLINT [build/c++17]
   namespace fs = std::filesystem;
@@ -105,6 +106,7 @@ class BaseVtk {
 class Vtk : public BaseVtk {
   friend class Dump;
   friend class Slice;
+  friend class TimeAverage;
 
  public:
   explicit Vtk(Input &, DataBlock *, std::string filebase = "data");   // init VTK object
@@ -149,6 +151,9 @@ class Vtk : public BaseVtk {
   void WriteHeader(IdfxFileHandler, real);
   void WriteScalar(IdfxFileHandler, float*,  const std::string &);
   void WriteHeaderNodes(IdfxFileHandler);
+  void WriteParticles(const fs::path &);
+  template<typename T>
+  void WriteParticleData(IdfxFileHandler, const std::vector<T> &, int, int64_t, int64_t);
 
   // output directory
   fs::path outputDirectory;
@@ -6,13 +6,36 @@
 // ***********************************************************************************
 
 #include <algorithm>
+#include <fstream>
 #include <iomanip>
 #include <mutex>    // NOLINT [build/c++11]
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include "idefix.hpp"
 #include "profiler.hpp"
+#include "version.hpp"
+
+// Escape a string so that it can be safely written in a JSON file
+static std::string JsonEscape(const std::string &in) {
+  std::string out;
+  for(const char c : in) {
+    if(c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if(static_cast<unsigned char>(c) < 0x20) {
+      out += ' ';
+    } else {
+      out += c;
+    }
+  }
+  return(out);
+}
+
+static void JsonIndent(std::ostream &os, int indent) {
+  for(int i = 0 ; i < indent ; i++) os << "  ";
+}
 
 /////////////////////////////
 // Kokkos Profiler hooks (needed to track memory allocation)
@@ -108,14 +131,202 @@ void idfx::Profiler::Show() {
     idfx::cout << std::endl;
     idfx::cout << "Profiler: end of performance profiling report." << std::endl;
   }
+
+  if(reportEnabled) WriteReport();
+  if(traceEnabled) WriteTrace();
+}
+
+void idfx::Profiler::Reset() {
+  rootRegion.Reset();
+  currentRegion = &rootRegion;
+  metrics.clear();
+  traceEvents.clear();
+  traceOverflow = false;
+  if(perfEnabled) rootRegion.Start();
 }
 
 void idfx::Profiler::EnablePerformanceProfiling() {
+  // Avoid restarting the root timer if profiling was already enabled
+  if(perfEnabled) return;
   currentRegion = &rootRegion;
   rootRegion.Start();
   perfEnabled = true;
 }
 
+void idfx::Profiler::EnablePerformanceReport(std::string filename) {
+  // A report without the region tree would be of little use
+  EnablePerformanceProfiling();
+  reportEnabled = true;
+  reportFileName = filename;
+}
+
+void idfx::Profiler::AddMetric(std::string name, double value) {
+  metrics[name] = value;
+}
+
+void idfx::Profiler::EnableTrace(std::string prefix) {
+  EnablePerformanceProfiling();
+  traceEnabled = true;
+  tracePrefix = prefix;
+  traceEvents.reserve(traceMaxEvents);
+}
+
+void idfx::Profiler::SetKernelTraffic(std::string name, double bytes, double flops) {
+  kernelTraffic[name].bytes = bytes;
+  kernelTraffic[name].flops = flops;
+}
+
+// Record the last call of region in the trace timeline
+void idfx::Profiler::AddTraceEvent(Region *region) {
+  if(traceEvents.size() >= traceMaxEvents) {
+    traceOverflow = true;
+    return;
+  }
+  traceEvents.push_back({region, region->traceStart, Clock()-region->traceStart});
+}
+
+// Gather the time spent in each region over all of the MPI processes.
+// Each rank flattens its own tree as path->time, which is sent to rank 0 as plain text.
+// The returned map is only meaningful on rank 0.
+std::map<std::string, idfx::RegionStats> idfx::Profiler::GatherRegionStats() {
+  std::map<std::string, double> local;
+  rootRegion.Flatten("", local);
+
+  std::map<std::string, RegionStats> stats;
+  auto addToStats = [&](const std::string &path, double time) {
+    RegionStats &st = stats[path];
+    if(st.ranks == 0 || time < st.min) st.min = time;
+    if(st.ranks == 0 || time > st.max) st.max = time;
+    st.sum += time;
+    st.ranks++;
+  };
+
+  #ifdef WITH_MPI
+    std::ostringstream buffer;
+    buffer << std::scientific << std::setprecision(17);
+    for(auto const &it : local) {
+      buffer << it.second << " " << it.first << "\n";
+    }
+    std::string sendBuffer = buffer.str();
+    int sendSize = sendBuffer.size();
+    std::vector<int> recvSize(idfx::psize);
+    MPI_Gather(&sendSize, 1, MPI_INT, recvSize.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    std::vector<int> displacement(idfx::psize, 0);
+    for(int r = 1 ; r < idfx::psize ; r++) {
+      displacement[r] = displacement[r-1] + recvSize[r-1];
+    }
+    std::vector<char> recvBuffer(idfx::prank == 0 ?
+                                    displacement[idfx::psize-1]+recvSize[idfx::psize-1] : 1);
+    MPI_Gatherv(sendBuffer.data(), sendSize, MPI_CHAR,
+                recvBuffer.data(), recvSize.data(), displacement.data(), MPI_CHAR,
+                0, MPI_COMM_WORLD);
+    if(idfx::prank == 0) {
+      std::istringstream input(std::string(recvBuffer.begin(), recvBuffer.end()));
+      std::string line;
+      while(std::getline(input, line)) {
+        size_t pos = line.find(' ');
+        if(pos == std::string::npos) continue;
+        addToStats(line.substr(pos+1), std::stod(line.substr(0, pos)));
+      }
+    }
+  #else
+    for(auto const &it : local) {
+      addToStats(it.first, it.second);
+    }
+  #endif
+  return(stats);
+}
+
+// Write a machine-readable (JSON) performance report, containing the global metrics
+// registered with AddMetric, the memory high-water mark and the region tree.
+// This should be called by all of the MPI processes, but only rank 0 writes the file.
+void idfx::Profiler::WriteReport() {
+  // Maximum memory usage over all the processes
+  std::vector<double> memMax(numSpaces);
+  for(int i = 0 ; i < numSpaces ; i++) {
+    memMax[i] = static_cast<double>(spaceMax[i]);
+  }
+  #ifdef WITH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, memMax.data(), numSpaces, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  #endif
+
+  auto stats = GatherRegionStats();
+
+  if(idfx::prank != 0) return;
+
+  std::ofstream file(reportFileName);
+  if(!file) {
+    IDEFIX_WARNING("Cannot open performance report file "+reportFileName);
+    return;
+  }
+  file << std::scientific << std::setprecision(6);
+  file << "{" << std::endl;
+  file << "  \"idefix_version\": \"" << IDEFIX_VERSION << "\"," << std::endl;
+  file << "  \"idefix_commit\": \"" << IDEFIX_GIT_COMMIT << "\"," << std::endl;
+  file << "  \"mpi_processes\": " << idfx::psize << "," << std::endl;
+  #ifdef SINGLE_PRECISION
+    file << "  \"precision\": \"single\"," << std::endl;
+  #else
+    file << "  \"precision\": \"double\"," << std::endl;
+  #endif
+  file << "  \"metrics\": {";
+  bool first = true;
+  for(auto const &it : metrics) {
+    file << (first ? "" : ",") << std::endl;
+    file << "    \"" << JsonEscape(it.first) << "\": " << it.second;
+    first = false;
+  }
+  file << std::endl << "  }," << std::endl;
+  file << "  \"memory_high_water_mark\": {";
+  for(int i = 0 ; i < numSpaces ; i++) {
+    file << (i==0 ? "" : ",") << std::endl;
+    file << "    \"" << JsonEscape(spaceName[i]) << "\": " << memMax[i];
+  }
+  file << std::endl << "  }," << std::endl;
+  file << "  \"regions\": ";
+  rootRegion.WriteJson(file, 1, stats);
+  file << std::endl << "}" << std::endl;
+  file.close();
+
+  idfx::cout << "Profiler: performance report written in " << reportFileName << std::endl;
+}
+
+// Write the timeline of the regions of this process in the Chrome trace event format
+// (to be opened with chrome://tracing or https://ui.perfetto.dev).
+// Each process writes its own file, named prefix.rank.json
+void idfx::Profiler::WriteTrace() {
+  std::string filename = tracePrefix + "." + std::to_string(idfx::prank) + ".json";
+  std::ofstream file(filename);
+  if(!file) {
+    IDEFIX_WARNING("Cannot open trace file "+filename);
+    return;
+  }
+  file << std::fixed << std::setprecision(3);
+  file << "{\"traceEvents\": [";
+  bool first = true;
+  for(auto const &ev : traceEvents) {
+    file << (first ? "" : ",") << std::endl;
+    file << "{\"name\": \"" << JsonEscape(ev.region->name) << "\", \"ph\": \"X\""
+         << ", \"ts\": " << ev.start*1e6 << ", \"dur\": " << ev.duration*1e6
+         << ", \"pid\": " << idfx::prank << ", \"tid\": 0"
+         << ", \"cat\": \"" << (ev.region->isKernel ? "kernel" : "region") << "\"}";
+    first = false;
+  }
+  file << std::endl << "]," << std::endl;
+  file << "\"displayTimeUnit\": \"ms\"}" << std::endl;
+  file.close();
+
+  if(traceOverflow) {
+    std::stringstream msg;
+    msg << "The trace buffer is full, only the first " << traceMaxEvents
+        << " events have been written in " << filename;
+    IDEFIX_WARNING(msg);
+  }
+  idfx::cout << "Profiler: trace timeline written in " << tracePrefix << ".<rank>.json"
+             << std::endl;
+}
+
 
 ///////////////////////////////////
 // Region functions definitions //
@@ -143,6 +354,17 @@ idfx::Region::~Region() {
   }
 }
 
+void idfx::Region::Reset() {
+  for( auto &it : children) {
+    delete it.second;
+  }
+  children.clear();
+  isLeaf = true;
+  myTime = 0;
+  nCalls = 0;
+  nCells = 0;
+}
+
 void idfx::Region::Start() {
   this->nCalls++;
   this->timer.reset();
@@ -165,6 +387,19 @@ idfx::Region * idfx::Region::GetChild(std::string name) {
   return this->children[name];
 }
 
+std::string idfx::Region::GetPath() {
+  if(parent == nullptr) return(name);
+  return(parent->GetPath() + "/" + name);
+}
+
+void idfx::Region::Flatten(std::string path, std::map<std::string, double> &out) {
+  path = path.empty() ? name : path + "/" + name;
+  out[path] = myTime;
+  for( auto &it : children) {
+    it.second->Flatten(path, out);
+  }
+}
+
 bool idfx::Region::Compare(Region * r1, Region * r2) {
   return r1->GetTimer() > r2->GetTimer();
 }
@@ -201,3 +436,78 @@ void idfx::Region::Show(double totTime) {
         }
   }
 }
+
+void idfx::Region::WriteJson(std::ostream &os, int indent,
+                             const std::map<std::string, RegionStats> &stats) {
+  double childTime = 0;
+  for( auto &it : children) {
+    childTime += it.second->GetTimer();
+  }
+  os << "{" << std::endl;
+  JsonIndent(os, indent+1);
+  os << "\"name\": \"" << JsonEscape(this->name) << "\"," << std::endl;
+  JsonIndent(os, indent+1);
+  os << "\"time\": " << this->myTime << "," << std::endl;
+  JsonIndent(os, indent+1);
+  os << "\"self_time\": " << this->myTime - childTime << "," << std::endl;
+  JsonIndent(os, indent+1);
+  os << "\"calls\": " << this->nCalls << "," << std::endl;
+
+  auto st = stats.find(GetPath());
+  if(st != stats.end()) {
+    const double avg = st->second.sum/st->second.ranks;
+    JsonIndent(os, indent+1);
+    os << "\"ranks\": " << st->second.ranks << "," << std::endl;
+    JsonIndent(os, indent+1);
+    os << "\"time_min\": " << st->second.min << "," << std::endl;
+    JsonIndent(os, indent+1);
+    os << "\"time_avg\": " << avg << "," << std::endl;
+    JsonIndent(os, indent+1);
+    os << "\"time_max\": " << st->second.max << "," << std::endl;
+    JsonIndent(os, indent+1);
+    os << "\"imbalance\": " << (avg > 0 ? st->second.max/avg : 1.0) << "," << std::endl;
+  }
+
+  if(isKernel) {
+    JsonIndent(os, indent+1);
+    os << "\"cells\": " << this->nCells << "," << std::endl;
+    auto traffic = prof.kernelTraffic.find(kernelName);
+    if(traffic != prof.kernelTraffic.end()) {
+      const double bytes = traffic->second.bytes * nCells;
+      const double flops = traffic->second.flops * nCells;
+      JsonIndent(os, indent+1);
+      os << "\"bytes\": " << bytes << "," << std::endl;
+      JsonIndent(os, indent+1);
+      os << "\"flops\": " << flops << "," << std::endl;
+      JsonIndent(os, indent+1);
+      os << "\"bandwidth_GBps\": " << (myTime > 0 ? bytes/myTime/1e9 : 0) << "," << std::endl;
+      JsonIndent(os, indent+1);
+      os << "\"GFLOPS\": " << (myTime > 0 ? flops/myTime/1e9 : 0) << "," << std::endl;
+      JsonIndent(os, indent+1);
+      os << "\"arithmetic_intensity\": " << (bytes > 0 ? flops/bytes : 0) << "," << std::endl;
+    }
+  }
+  JsonIndent(os, indent+1);
+  os << "\"children\": [";
+
+  // Sort the children as in the text report
+  std::vector<Region*> sorted;
+  for( auto &it : this->children) {
+    sorted.push_back(it.second);
+  }
+  std::sort(sorted.begin(), sorted.end(), this->Compare);
+  bool first = true;
+  for( auto &it : sorted) {
+    os << (first ? "" : ",") << std::endl;
+    JsonIndent(os, indent+2);
+    it->WriteJson(os, indent+2, stats);
+    first = false;
+  }
+  if(!sorted.empty()) {
+    os << std::endl;
+    JsonIndent(os, indent+1);
+  }
+  os << "]" << std::endl;
+  JsonIndent(os, indent);
+  os << "}";
+}
@@ -10,7 +10,9 @@
 
 #include <map>
 #include <mutex>  // NOLINT [build/c++11]
+#include <ostream>
 #include <string>
+#include <vector>
 
 namespace idfx {
 
@@ -18,6 +20,20 @@ struct SpaceHandle {
   char name[64];
 };
 
+// Statistics of a region over all of the MPI processes
+struct RegionStats {
+  double min{0};
+  double max{0};
+  double sum{0};
+  int ranks{0};
+};
+
+// Estimated memory traffic and floating point operations of a kernel, per cell
+struct KernelTraffic {
+  double bytes{0};
+  double flops{0};
+};
+
 // Region is a helper class to Profiler
 // it used to generate a tree of the regions encountered while running
 // and produce a performance report.
@@ -28,27 +44,50 @@ class Region {
   ~Region();
   void Start();
   void Stop();
+  void Reset();   // forget the timers and children of this region
   void Show(double );
+  // write the region tree in JSON format, with the statistics gathered over all the ranks
+  void WriteJson(std::ostream &, int, const std::map<std::string, RegionStats> &);
+  void Flatten(std::string, std::map<std::string, double> &);  // path->time of the whole tree
   Region* GetChild(std::string name);
   double GetTimer();
+  std::string GetPath();
   static bool Compare(Region *, Region *);
   bool isLeaf{true};
   std::string name;
   std::map<std::string, Region*> children;
   Region *parent;
   int level;
+  bool isKernel{false};     // whether this region is a single idefix_for/idefix_reduce
+  std::string kernelName;   // name of the kernel (used to look up its traffic estimate)
+  int64_t nCells{0};        // number of cells processed by the kernel (all calls included)
+  double traceStart{0};     // start time of the last call on the profiler clock
  private:
   Kokkos::Timer timer;
   double myTime{0};
   int64_t nCalls{0};
 };
 
+// One entry of the Chrome trace timeline
+struct TraceEvent {
+  Region *region;
+  double start;
+  double duration;
+};
+
 
 class Profiler {
  public:
   void Init();
+  void Reset();   // restart the performance measurements (e.g. after an in-process restart)
   void Show();
   void EnablePerformanceProfiling();
+  void EnablePerformanceReport(std::string);  // Write a JSON report at the end of the run
+  void AddMetric(std::string, double);        // Add a global metric to the JSON report
+  void EnableTrace(std::string);              // Write a per-rank Chrome trace timeline
+  void SetKernelTraffic(std::string, double, double);  // bytes & flops per cell of a kernel
+  void AddTraceEvent(Region *);
+  double Clock() { return clock.seconds(); }
   int numSpaces;
   int64_t spaceSize[16];
   int64_t spaceMax[16];
@@ -56,8 +95,26 @@ class Profiler {
   std::mutex m;
 
   bool perfEnabled{false};
+  bool traceEnabled{false};
   Region rootRegion;
   Region *currentRegion;
+
+ private:
+  friend class Region;
+  void WriteReport();
+  void WriteTrace();
+  std::map<std::string, RegionStats> GatherRegionStats();
+  bool reportEnabled{false};
+  std::string reportFileName;
+  std::map<std::string, double> metrics;
+  std::map<std::string, KernelTraffic> kernelTraffic;
+
+  // Chrome trace: the event buffer is allocated once, so that recording is cheap
+  static constexpr int traceMaxEvents{1000000};
+  std::string tracePrefix;
+  std::vector<TraceEvent> traceEvents;
+  bool traceOverflow{false};
+  Kokkos::Timer clock;
 };
 
 
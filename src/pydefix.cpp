@@ -16,12 +16,29 @@
 #include "idefix.hpp"
 #include "dataBlock.hpp"
 #include "dataBlockHost.hpp"
+#include "gridHost.hpp"
 
 
 namespace py = pybind11;
 
 int Pydefix::ninstance = 0;
 
+// Python property for a field of DataBlockHost, which is synchronized from the device only when
+// Python first reads it (fields which are not used by the script are never copied).
+template<typename T>
+void DefLazyField(py::class_<DataBlockHost> &cls, const char *name, T DataBlockHost::*field) {
+  std::string fieldName(name);
+  cls.def_property(name,
+    [field, fieldName](DataBlockHost &self) -> T& {
+      self.SyncIfOutOfDate(fieldName);
+      return self.*field;
+    },
+    [field, fieldName](DataBlockHost &self, const T &value) {
+      self.*field = value;
+      self.MarkUpToDate(fieldName);
+    });
+}
+
 
 namespace PydefixTools {
 // Functions provided by Idefix in Pydefix for user convenience
@@ -172,7 +189,8 @@ py::array_t<real, py::array::c_style> GatherIdefixArray(IdefixHostArray3D<real>
  * **********************************/
 
 PYBIND11_EMBEDDED_MODULE(pydefix, m) {
-  py::class_<DataBlockHost>(m, "DataBlockHost")
+  py::class_<DataBlockHost> dataBlockHost(m, "DataBlockHost");
+  dataBlockHost
     .def(py::init<>())
     .def_readwrite("x", &DataBlockHost::x)
     .def_readwrite("xr", &DataBlockHost::xr)
@@ -180,16 +198,6 @@ PYBIND11_EMBEDDED_MODULE(pydefix, m) {
     .def_readwrite("dx", &DataBlockHost::dx)
     .def_readwrite("dV", &DataBlockHost::dV)
     .def_readwrite("A", &DataBlockHost::A)
-    .def_readwrite("Vc", &DataBlockHost::Vc)
-    .def_readwrite("dustVc", &DataBlockHost::dustVc)
-    #if MHD == YES
-      .def_readwrite("Vs", &DataBlockHost::Vs)
-      .def_readwrite("Ve", &DataBlockHost::Ve)
-      .def_readwrite("J", &DataBlockHost::J)
-      .def_readwrite("Ex1", &DataBlockHost::Ex1)
-      .def_readwrite("Ex2", &DataBlockHost::Ex2)
-      .def_readwrite("Ex3", &DataBlockHost::Ex3)
-    #endif
     .def_readwrite("xbeg", &DataBlockHost::xbeg)
     .def_readwrite("xend", &DataBlockHost::xend)
     .def_readwrite("gbeg", &DataBlockHost::gbeg)
@@ -199,10 +207,22 @@ PYBIND11_EMBEDDED_MODULE(pydefix, m) {
     .def_readwrite("np_tot", &DataBlockHost::np_tot)
     .def_readwrite("np_int", &DataBlockHost::np_int)
     .def_readwrite("nghost", &DataBlockHost::nghost)
-    .def_readwrite("InvDt", &DataBlockHost::InvDt)
     .def_readwrite("t",&DataBlockHost::t)
     .def_readwrite("dt",&DataBlockHost::dt);
 
+  // Fields evolved by the code are synchronized on demand
+  DefLazyField(dataBlockHost, "Vc", &DataBlockHost::Vc);
+  DefLazyField(dataBlockHost, "dustVc", &DataBlockHost::dustVc);
+  DefLazyField(dataBlockHost, "InvDt", &DataBlockHost::InvDt);
+  #if MHD == YES
+    DefLazyField(dataBlockHost, "Vs", &DataBlockHost::Vs);
+    DefLazyField(dataBlockHost, "Ve", &DataBlockHost::Ve);
+    DefLazyField(dataBlockHost, "J", &DataBlockHost::J);
+    DefLazyField(dataBlockHost, "Ex1", &DataBlockHost::Ex1);
+    DefLazyField(dataBlockHost, "Ex2", &DataBlockHost::Ex2);
+    DefLazyField(dataBlockHost, "Ex3", &DataBlockHost::Ex3);
+  #endif
+
   py::class_<GridHost>(m, "GridHost")
     .def(py::init<>())
     .def_readwrite("x", &GridHost::x)
@@ -246,7 +266,7 @@ PYBIND11_EMBEDDED_MODULE(pydefix, m) {
 
 
 template<typename... Ts>
-void Pydefix::CallScript(std::string scriptName, std::string funcName, Ts... args) {
+void Pydefix::CallScript(std::string scriptName, std::string funcName, Ts&... args) {
   idfx::pushRegion("Pydefix::CallScript");
   try {
     py::module_ script = py::module_::import(scriptName.c_str());
@@ -298,11 +318,16 @@ void Pydefix::Output(DataBlock &data, int n) {
     IDEFIX_ERROR("No python output function has been defined "
                   "in your input file [python]:output_function");
   }
-  DataBlockHost dataHost(data);
-  GridHost gridHost(*data.mygrid);
-  gridHost.SyncFromDevice();
-  dataHost.SyncFromDevice();
-  this->CallScript(this->scriptFilename,this->outputFunctionName,dataHost, gridHost, n);
+  // The mirrors are persistent: the grid is synchronized at each call, since it may have
+  // changed (and Python may have modified its copy), and the fields lazily
+  if(!outputDataHost) {
+    outputDataHost = std::make_unique<DataBlockHost>(data);
+    outputGridHost = std::make_unique<GridHost>(*data.mygrid);
+  }
+  outputGridHost->SyncFromDevice();
+  outputDataHost->MarkOutOfDate();
+  this->CallScript(this->scriptFilename,this->outputFunctionName,
+                   *outputDataHost, *outputGridHost, n);
   idfx::popRegion();
 }
 
@@ -13,6 +13,7 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/embed.h>
 #include <pybind11/numpy.h>
+#include <memory>
 #include <string>
 #include <vector>
 #include "idefix.hpp"
@@ -22,6 +23,7 @@ namespace py = pybind11;
 
 class DataBlock;
 class DataBlockHost;
+class GridHost;
 
 class Pydefix {
  public:
@@ -35,8 +37,12 @@ class Pydefix {
   bool haveInitflow{false};
  private:
   template<typename... Ts>
-  void CallScript(std::string, std::string, Ts...);
+  void CallScript(std::string, std::string, Ts&...);
   static int ninstance;
+  // Host mirrors used by the output function. They are allocated on the first call and reused:
+  // the grid is synchronized before each call, each field only when Python first accesses it.
+  std::unique_ptr<DataBlockHost> outputDataHost;
+  std::unique_ptr<GridHost> outputGridHost;
   std::string scriptFilename;
   std::string outputFunctionName;
   std::string initflowFunctionName;
@@ -44,6 +50,16 @@ class Pydefix {
 
 
 namespace pybind11 { namespace detail {
+// Wrap the memory of a host view in a numpy array, without any copy. The numpy array holds a
+// reference to the view, so that the memory remains valid for as long as Python uses it.
+template <typename ViewType>
+py::handle NumpyFromView(const ViewType &src, std::vector<py::ssize_t> shape) {
+  auto ref = new ViewType(src);
+  py::capsule owner(ref, [](void *p) { delete reinterpret_cast<ViewType*>(p); });
+  py::array_t<typename ViewType::value_type, py::array::c_style> a(shape, src.data(), owner);
+  return a.release();
+}
+
 // Caster for IdefixArray4D<T>
 template <typename T> struct type_caster<IdefixHostArray4D<T>> {
  public:
@@ -83,14 +99,10 @@ template <typename T> struct type_caster<IdefixHostArray4D<T>> {
   static py::handle cast(const IdefixHostArray4D<T>& src,
                          py::return_value_policy policy,
                          py::handle parent) {
-    py::none dummyDataOwner;
-    py::array_t<real, py::array::c_style> a({src.extent(0),
-                                             src.extent(1),
-                                             src.extent(2),
-                                             src.extent(3)},
-                                             src.data(), dummyDataOwner);
-
-    return a.release();
+    return NumpyFromView(src, {static_cast<py::ssize_t>(src.extent(0)),
+                               static_cast<py::ssize_t>(src.extent(1)),
+                               static_cast<py::ssize_t>(src.extent(2)),
+                               static_cast<py::ssize_t>(src.extent(3))});
   }
 };
 // Caster for IdefixArray3D<T>
@@ -100,7 +112,6 @@ template <typename T> struct type_caster<IdefixHostArray3D<T>> {
 
   // Conversion part 1 (Python -> C++)
   bool load(py::handle src, bool convert) {
-    idfx::pushRegion("Pydefix::TypeCaster3D Python->C");
     if ( !convert && !py::array_t<T>::check_(src) )
       return false;
 
@@ -122,7 +133,6 @@ template <typename T> struct type_caster<IdefixHostArray3D<T>> {
                                                                   array.shape()[1],
                                                                   array.shape()[2]);
 
-    idfx::popRegion();
     return true;
   }
 
@@ -130,16 +140,9 @@ template <typename T> struct type_caster<IdefixHostArray3D<T>> {
   static py::handle cast(const IdefixHostArray3D<T>& src,
                          py::return_value_policy policy,
                          py::handle parent) {
-    idfx::pushRegion("Pydefix::TypeCaster3D C->Python");
-    // Keep a local reference
-    auto arr = src;
-    py::none dummyDataOwner;
-    py::array_t<real, py::array::c_style> a({src.extent(0),
-                                             src.extent(1),
-                                             src.extent(2)},
-                                             src.data(),dummyDataOwner);
-    idfx::popRegion();
-    return a.release();
+    return NumpyFromView(src, {static_cast<py::ssize_t>(src.extent(0)),
+                               static_cast<py::ssize_t>(src.extent(1)),
+                               static_cast<py::ssize_t>(src.extent(2))});
   }
 };
 // Caster for IdefixArray2D<T>
@@ -169,7 +172,6 @@ template <typename T> struct type_caster<IdefixHostArray2D<T>> {
                                                                   array.shape()[0],
                                                                   array.shape()[1]);
 
-    idfx::popRegion();
     return true;
   }
 
@@ -177,9 +179,8 @@ template <typename T> struct type_caster<IdefixHostArray2D<T>> {
   static py::handle cast(const IdefixHostArray2D<T>& src,
                          py::return_value_policy policy,
                          py::handle parent) {
-    py::none dummyOwner;
-    py::array_t<real, py::array::c_style> a({src.extent(0),src.extent(1)},src.data(),dummyOwner);
-    return a.release();
+    return NumpyFromView(src, {static_cast<py::ssize_t>(src.extent(0)),
+                               static_cast<py::ssize_t>(src.extent(1))});
   }
 };
 // Caster for IdefixArray1D<T>
@@ -208,7 +209,6 @@ template <typename T> struct type_caster<IdefixHostArray1D<T>> {
                         Kokkos::MemoryTraits<Kokkos::Unmanaged>> (reinterpret_cast<T*>(buf.ptr),
                                                                   array.shape()[0]);
 
-    idfx::popRegion();
     return true;
   }
 
@@ -216,9 +216,7 @@ template <typename T> struct type_caster<IdefixHostArray1D<T>> {
   static py::handle cast(const IdefixHostArray1D<T>& src,
                          py::return_value_policy policy,
                          py::handle parent) {
-    py::none dummyDataOwner;
-    py::array_t<real, py::array::c_style> a(src.extent(0),src.data(),dummyDataOwner);
-    return a.release();
+    return NumpyFromView(src, {static_cast<py::ssize_t>(src.extent(0))});
   }
 };
 } // namespace detail
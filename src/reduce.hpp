@@ -23,15 +23,11 @@ inline void idefix_reduce(const std::string & NAME,
                 const int & IB, const int & IE,
                 Function function,
                 Reducer redFunction) {
-    #ifdef DEBUG
-    idfx::pushRegion("idefix_reduce("+NAME+")");
-    #endif
+    if(idfx::kernelProfiling)
+      idfx::pushKernelRegion("idefix_reduce", NAME, static_cast<int64_t>(IE-IB));
     Kokkos::parallel_reduce(NAME,
       Kokkos::RangePolicy<>(IB,IE), function, redFunction);
-    #ifdef DEBUG
-    Kokkos::fence();
-    idfx::popRegion();
-    #endif
+    if(idfx::kernelProfiling) idfx::popKernelRegion();
 }
 
 // 2D default loop pattern
@@ -41,9 +37,8 @@ inline void idefix_reduce(const std::string & NAME,
                 const int & IB, const int & IE,
                 Function function,
                 Reducer redFunction) {
-    #ifdef DEBUG
-    idfx::pushRegion("idefix_reduce("+NAME+")");
-    #endif
+    if(idfx::kernelProfiling)
+      idfx::pushKernelRegion("idefix_reduce", NAME, static_cast<int64_t>(JE-JB)*(IE-IB));
 
     // We only implement MDRange reductions here since the other implementations are too
     // complicated to be implemented for any reduction operator on any class
@@ -51,10 +46,7 @@ inline void idefix_reduce(const std::string & NAME,
       Kokkos::MDRangePolicy<Kokkos::Rank<2, Kokkos::Iterate::Right, Kokkos::Iterate::Right>>
         ({JB,IB},{JE,IE}), function, redFunction);
 
-    #ifdef DEBUG
-    Kokkos::fence();
-    idfx::popRegion();
-    #endif
+    if(idfx::kernelProfiling) idfx::popKernelRegion();
 }
 
 // 3D default loop pattern
@@ -67,17 +59,13 @@ inline void idefix_reduce(const std::string & NAME,
                 Reducer redFunction) {
     // We only implement MDRange reductions here since the other implementations are too
     // complicated to be implemented for any reduction operator on any class
-    #ifdef DEBUG
-    idfx::pushRegion("idefix_reduce("+NAME+")");
-    #endif
+    if(idfx::kernelProfiling)
+      idfx::pushKernelRegion("idefix_reduce", NAME, static_cast<int64_t>(KE-KB)*(JE-JB)*(IE-IB));
     Kokkos::parallel_reduce(NAME,
       Kokkos::MDRangePolicy<Kokkos::Rank<3, Kokkos::Iterate::Right, Kokkos::Iterate::Right>>
         ({KB,JB,IB},{KE,JE,IE}), function, redFunction);
 
-    #ifdef DEBUG
-    Kokkos::fence();
-    idfx::popRegion();
-    #endif
+    if(idfx::kernelProfiling) idfx::popKernelRegion();
 }
 
 // 4D default loop pattern
@@ -91,17 +79,14 @@ inline void idefix_reduce(const std::string & NAME,
                 Reducer redFunction) {
     // We only implement MDRange reductions here since the other implementations are too
     // complicated to be implemented for any reduction operator on any class
-    #ifdef DEBUG
-    idfx::pushRegion("idefix_reduce("+NAME+")");
-    #endif
+    if(idfx::kernelProfiling)
+      idfx::pushKernelRegion("idefix_reduce", NAME,
+                             static_cast<int64_t>(NE-NB)*(KE-KB)*(JE-JB)*(IE-IB));
     Kokkos::parallel_reduce(NAME,
       Kokkos::MDRangePolicy<Kokkos::Rank<4, Kokkos::Iterate::Right, Kokkos::Iterate::Right>>
         ({NB,KB,JB,IB},{NE,KE,JE,IE}), function, redFunction);
 
-    #ifdef DEBUG
-    Kokkos::fence();
-    idfx::popRegion();
-    #endif
+    if(idfx::kernelProfiling) idfx::popKernelRegion();
 }
 
 #endif // REDUCE_HPP_
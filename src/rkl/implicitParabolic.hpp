@@ -0,0 +1,487 @@
+// ***********************************************************************************
+// Idefix MHD astrophysical code
+// Copyright(C) Geoffroy R. J. Lesur <geoffroy.lesur@univ-grenoble-alpes.fr>
+// and other code contributors
+// Licensed under CeCILL 2.1 License, see COPYING for more information
+// ***********************************************************************************
+
+#ifndef RKL_IMPLICITPARABOLIC_HPP_
+#define RKL_IMPLICITPARABOLIC_HPP_
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "idefix.hpp"
+#include "input.hpp"
+#include "rkl.hpp"
+#include "bicgstab.hpp"
+
+// Implicit integration of the parabolic terms flagged "implicit". Writing L(U) for the
+// parabolic operator (evaluated with the RKL machinery), each cycle solves
+//      (I - theta dt J) dU = dt L(U0)        and sets U = U0 + dU
+// where J is the Jacobian of L around U0. The system is solved matrix-free with BICGSTAB,
+// J.v being a finite difference of L, optionally with a diagonal preconditioner built from
+// the local diffusion rates of the cell-centered variables. theta=1 is backward Euler (the
+// default, L-stable) and theta=1/2 Crank-Nicolson. When the diffusivities do not depend on
+// the solution, both are exact implicit steps: the cost depends on the conditioning of the
+// system, not on dt/dt_par.
+// Each block of unknowns (one per variable, see below) is scaled by the rms of its right hand
+// side, so that the convergence criterion of the solver weighs the cell-centered variables and
+// the field components evenly, whatever their units.
+template<typename Phys>
+class ImplicitParabolic : public RKLegendre<Phys> {
+ public:
+  ImplicitParabolic(Input &, Fluid<Phys>*);
+  void Cycle();
+  void ShowConfig();
+
+  // (Preconditioned) linear operator I - theta dt J, called by the iterative solver
+  void operator() (IdefixArray3D<real> in, IdefixArray3D<real> out);
+
+  int niter{0};               // # of solver iterations of the last cycle
+  real theta{1.0};            // Implicitness parameter
+
+ private:
+  void Pack(IdefixArray3D<real>, IdefixArray4D<real>, IdefixArray4D<real>, real, bool);
+  void Unpack(IdefixArray3D<real>, real);   // Set U = U0 + eps*in and the primitive variables
+  real Norm(IdefixArray3D<real>, bool);     // L2 norm of a packed array over all the domain
+  void ScaleBlocks(IdefixArray3D<real>);    // Normalise each block of the rhs
+
+  bool havePreconditioner{true};
+  real tolerance;
+  int maxiter;
+  real tEval;                 // Time at which the operator is evaluated
+  real normU0;                // Norm of the initial state, sets the finite difference step
+  real sqrtSize;              // Square root of the total number of unknowns
+
+  // The variables solved for are packed in a single 3D array: one block along K per
+  // cell-centered variable of varList, then one per face-centered field component.
+  int nvarCell{0};
+  int nvarFace{0};
+  int nk;                     // Extent of a block along K
+  std::array<int,3> ntot;
+  std::array<int,3> beg;
+  std::array<int,3> end;
+
+  IdefixArray3D<real> solution;
+  IdefixArray3D<real> rhs;
+  IdefixArray3D<real> work;
+  // Diagonal preconditioner of the cell-centered equations. The field equations are left
+  // unscaled, so that the field increment stays a combination of curls (divergence-free).
+  IdefixArray3D<real> precond;
+  // Scale of each block: the solver works on the unknowns and the equations divided by it
+  IdefixArray1D<real> blockScale;
+
+  std::unique_ptr<Bicgstab<ImplicitParabolic<Phys>>> solver;
+};
+
+template<typename Phys>
+ImplicitParabolic<Phys>::ImplicitParabolic(Input &input, Fluid<Phys>* hydroin):
+                                RKLegendre<Phys>(input, hydroin, true) {
+  idfx::pushRegion("ImplicitParabolic::Init");
+  DataBlock *data = this->data;
+
+  std::string scheme = input.GetOrSet<std::string>("Implicit","scheme",0,"euler");
+  if(scheme.compare("euler") == 0) {
+    theta = 1.0;
+  } else if(scheme.compare("crank-nicolson") == 0) {
+    theta = 0.5;
+  } else {
+    IDEFIX_ERROR("Unknown implicit scheme "+scheme+". Can only be euler or crank-nicolson.");
+  }
+  std::string strSolver = input.GetOrSet<std::string>("Implicit","solver",0,"PBICGSTAB");
+  if(strSolver.compare("BICGSTAB") == 0) {
+    havePreconditioner = false;
+  } else if(strSolver.compare("PBICGSTAB") == 0) {
+    havePreconditioner = true;
+  } else {
+    IDEFIX_ERROR("Unknown implicit solver "+strSolver+". Can only be BICGSTAB or PBICGSTAB.");
+  }
+  tolerance = input.GetOrSet<real>("Implicit","tolerance",0, 1e-5);
+  maxiter = input.GetOrSet<int>("Implicit","maxiter",0, 200);
+
+  #ifdef EVOLVE_VECTOR_POTENTIAL
+    if(this->haveVs) {
+      IDEFIX_ERROR("Implicit non-ideal MHD is not compatible with EVOLVE_VECTOR_POTENTIAL");
+    }
+  #endif
+
+  nvarCell = this->haveVc ? this->nvarRKL : 0;
+  nvarFace = this->haveVs ? DIMENSIONS : 0;
+  nk = data->np_tot[KDIR]+KOFFSET;
+
+  ntot[IDIR] = data->np_tot[IDIR]+IOFFSET;
+  ntot[JDIR] = data->np_tot[JDIR]+JOFFSET;
+  ntot[KDIR] = (nvarCell+nvarFace)*nk;
+  beg[IDIR] = data->beg[IDIR];
+  beg[JDIR] = data->beg[JDIR];
+  beg[KDIR] = 0;
+  end[IDIR] = data->end[IDIR]+IOFFSET;
+  end[JDIR] = data->end[JDIR]+JOFFSET;
+  end[KDIR] = ntot[KDIR];
+
+  double size = nvarCell*data->np_int[IDIR]*data->np_int[JDIR]*data->np_int[KDIR];
+  for(int n = 0 ; n < nvarFace ; n++) {
+    size += (data->np_int[IDIR]+(n==IDIR))*(data->np_int[JDIR]+(n==JDIR))
+           *(data->np_int[KDIR]+(n==KDIR));
+  }
+  #ifdef WITH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &size, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  #endif
+  sqrtSize = std::sqrt(size);
+
+  solution = IdefixArray3D<real>("Implicit_solution", ntot[KDIR], ntot[JDIR], ntot[IDIR]);
+  rhs = IdefixArray3D<real>("Implicit_rhs", ntot[KDIR], ntot[JDIR], ntot[IDIR]);
+  work = IdefixArray3D<real>("Implicit_work", ntot[KDIR], ntot[JDIR], ntot[IDIR]);
+  precond = IdefixArray3D<real>("Implicit_precond", data->np_tot[KDIR],
+                                                    data->np_tot[JDIR],
+                                                    data->np_tot[IDIR]);
+  Kokkos::deep_copy(precond, ONE_F);
+  blockScale = IdefixArray1D<real>("Implicit_blockScale", nvarCell+nvarFace);
+  Kokkos::deep_copy(blockScale, ONE_F);
+
+  solver = std::make_unique<Bicgstab<ImplicitParabolic<Phys>>>(*this, tolerance, maxiter,
+                                                                 ntot, beg, end);
+  idfx::popRegion();
+}
+
+template<typename Phys>
+void ImplicitParabolic<Phys>::ShowConfig() {
+  if(theta == 1.0) {
+    idfx::cout << "ImplicitParabolic: backward Euler scheme ENABLED." << std::endl;
+  } else {
+    idfx::cout << "ImplicitParabolic: Crank-Nicolson scheme ENABLED." << std::endl;
+  }
+  idfx::cout << "ImplicitParabolic: using " << (havePreconditioner ? "PBICGSTAB" : "BICGSTAB")
+             << " solver with tolerance " << tolerance << " and at most " << maxiter
+             << " iterations." << std::endl;
+  if(this->haveVc) {
+     idfx::cout << "ImplicitParabolic: will evolve cell-centered fields Vc." << std::endl;
+  }
+  if(this->haveVs) {
+     idfx::cout << "ImplicitParabolic: will evolve face-centered fields Vs." << std::endl;
+  }
+  if(this->checkNan) {
+    idfx::cout << "ImplicitParabolic: will check consistency of solution in the integrator "
+               << "(slow!)." << std::endl;
+  }
+}
+
+// Pack scale*(cell, face) into out, divided by the preconditioner when requested
+template<typename Phys>
+void ImplicitParabolic<Phys>::Pack(IdefixArray3D<real> out,
+                                   IdefixArray4D<real> cell, IdefixArray4D<real> face,
+                                   real scale, bool precondition) {
+  idfx::pushRegion("ImplicitParabolic::Pack");
+  IdefixArray3D<real> precond = this->precond;
+  const int nvarCell = this->nvarCell;
+  const int nk = this->nk;
+  const int kbeg = this->data->beg[KDIR];
+  const int kend = this->data->end[KDIR];
+  const int jend = this->data->end[JDIR];
+  const int iend = this->data->end[IDIR];
+  const bool usePrecond = precondition && havePreconditioner;
+
+  idefix_for("Implicit_Pack", beg[KDIR], end[KDIR], beg[JDIR], end[JDIR], beg[IDIR], end[IDIR],
+    KOKKOS_LAMBDA (int kk, int j, int i) {
+      const int b = kk / nk;
+      const int k = kk - b*nk;
+      real q = ZERO_F;
+      if(b < nvarCell) {
+        if(k >= kbeg && k < kend && j < jend && i < iend) {
+          q = scale*cell(b,k,j,i);
+          if(usePrecond) q /= precond(k,j,i);
+        }
+      } else {
+        // Only the faces of the active domain: the others are set by the boundary conditions
+        const int n = b - nvarCell;
+        if(k >= kbeg && k < kend + (n == KDIR) && j < jend + (n == JDIR)
+                                               && i < iend + (n == IDIR)) {
+          q = scale*face(n,k,j,i);
+        }
+      }
+      out(kk,j,i) = q;
+    });
+  idfx::popRegion();
+}
+
+template<typename Phys>
+void ImplicitParabolic<Phys>::Unpack(IdefixArray3D<real> in, real eps) {
+  idfx::pushRegion("ImplicitParabolic::Unpack");
+  Fluid<Phys> *hydro = this->hydro;
+  DataBlock *data = this->data;
+  IdefixArray1D<int> varList = this->varList;
+  IdefixArray4D<real> Uc = hydro->Uc;
+  IdefixArray4D<real> Vs = hydro->Vs;
+  IdefixArray4D<real> Uc0 = this->Uc0;
+  IdefixArray4D<real> Vs0 = this->Vs0;
+  IdefixArray1D<real> blockScale = this->blockScale;
+  const int nvarCell = this->nvarCell;
+  const int nk = this->nk;
+  const int kbeg = data->beg[KDIR];
+  const int kend = data->end[KDIR];
+  const int jend = data->end[JDIR];
+  const int iend = data->end[IDIR];
+
+  idefix_for("Implicit_Unpack", beg[KDIR], end[KDIR], beg[JDIR], end[JDIR], beg[IDIR], end[IDIR],
+    KOKKOS_LAMBDA (int kk, int j, int i) {
+      const int b = kk / nk;
+      const int k = kk - b*nk;
+      if(b < nvarCell) {
+        if(k >= kbeg && k < kend && j < jend && i < iend) {
+          Uc(varList(b),k,j,i) = Uc0(b,k,j,i) + eps*blockScale(b)*in(kk,j,i);
+        }
+      } else {
+        const int n = b - nvarCell;
+        if(k >= kbeg && k < kend + (n == KDIR) && j < jend + (n == JDIR)
+                                               && i < iend + (n == IDIR)) {
+          Vs(n,k,j,i) = Vs0(n,k,j,i) + eps*blockScale(b)*in(kk,j,i);
+        }
+      }
+    });
+  if constexpr(Phys::mhd) {
+    if(this->haveVs) hydro->boundary->ReconstructVcField(Uc);
+  }
+  if(data->haveGridCoarsening) {
+    data->Coarsen();
+  }
+  hydro->ConvertConsToPrim();
+  idfx::popRegion();
+}
+
+// When scaled is set, in holds scaled unknowns and the norm is that of the actual unknowns
+template<typename Phys>
+real ImplicitParabolic<Phys>::Norm(IdefixArray3D<real> in, bool scaled) {
+  IdefixArray1D<real> blockScale = this->blockScale;
+  const int nk = this->nk;
+  real norm = 0;
+  idefix_reduce("Implicit_Norm", beg[KDIR], end[KDIR], beg[JDIR], end[JDIR], beg[IDIR], end[IDIR],
+    KOKKOS_LAMBDA (int k, int j, int i, real &localSum) {
+      const real q = scaled ? blockScale(k/nk)*in(k,j,i) : in(k,j,i);
+      localSum += q*q;
+    },
+    Kokkos::Sum<real>(norm));
+  #ifdef WITH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &norm, 1, realMPI, MPI_SUM, MPI_COMM_WORLD);
+  #endif
+  return(std::sqrt(norm));
+}
+
+template<typename Phys>
+void ImplicitParabolic<Phys>::ScaleBlocks(IdefixArray3D<real> in) {
+  idfx::pushRegion("ImplicitParabolic::ScaleBlocks");
+  IdefixArray1D<real> blockScale = this->blockScale;
+  const int nk = this->nk;
+  const int nblocks = nvarCell+nvarFace;
+  std::vector<real> sum(2*nblocks, ZERO_F);
+  for(int b = 0 ; b < nblocks ; b++) {
+    idefix_reduce("Implicit_BlockNorm", b*nk, (b+1)*nk, beg[JDIR], end[JDIR],
+                                        beg[IDIR], end[IDIR],
+      KOKKOS_LAMBDA (int k, int j, int i, real &localSum) {
+        localSum += in(k,j,i)*in(k,j,i);
+      },
+      Kokkos::Sum<real>(sum[2*b]));
+    // Number of unknowns of the block (the others are zero in every packed array)
+    const int n = b - nvarCell;
+    sum[2*b+1] = (this->data->np_int[IDIR] + (n == IDIR))
+                *(this->data->np_int[JDIR] + (n == JDIR))
+                *(this->data->np_int[KDIR] + (n == KDIR));
+  }
+  #ifdef WITH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, sum.data(), sum.size(), realMPI, MPI_SUM, MPI_COMM_WORLD);
+  #endif
+  IdefixArray1D<real>::HostMirror scaleHost = Kokkos::create_mirror_view(blockScale);
+  for(int b = 0 ; b < nblocks ; b++) {
+    const real rms = std::sqrt(sum[2*b]/sum[2*b+1]);
+    scaleHost(b) = rms > ZERO_F ? rms : ONE_F;
+  }
+  Kokkos::deep_copy(blockScale, scaleHost);
+
+  idefix_for("Implicit_ScaleBlocks", beg[KDIR], end[KDIR], beg[JDIR], end[JDIR],
+                                     beg[IDIR], end[IDIR],
+    KOKKOS_LAMBDA (int k, int j, int i) {
+      in(k,j,i) /= blockScale(k/nk);
+    });
+  idfx::popRegion();
+}
+
+template<typename Phys>
+void ImplicitParabolic<Phys>::operator() (IdefixArray3D<real> in, IdefixArray3D<real> out) {
+  idfx::pushRegion("ImplicitParabolic::Operator");
+  // Finite difference step for the Jacobian-vector product, such that the perturbation of
+  // each unknown is ~sqrt(machine epsilon) times the rms of the state
+  const real normIn = Norm(in, true);
+  const real eps = std::sqrt(std::numeric_limits<real>::epsilon())*(sqrtSize+normU0)/normIn;
+  if(!std::isfinite(eps)) {
+    // in is zero (or so small that it is at round-off)
+    Kokkos::deep_copy(out, ZERO_F);
+    idfx::popRegion();
+    return;
+  }
+
+  // L(U0+eps*in)
+  Unpack(in, eps);
+  this->SetBoundaries(tEval);
+  this->EvolveStage(tEval);
+
+  // out = P^-1 (in - theta dt (L(U0+eps*S*in) - L(U0))/(eps*S)), S being the block scale
+  IdefixArray4D<real> dU = this->dU;
+  IdefixArray4D<real> dU0 = this->dU0;
+  IdefixArray4D<real> dB = this->dB;
+  IdefixArray4D<real> dB0 = this->dB0;
+  IdefixArray3D<real> precond = this->precond;
+  IdefixArray1D<real> blockScale = this->blockScale;
+  const int nvarCell = this->nvarCell;
+  const int nk = this->nk;
+  const int kbeg = this->data->beg[KDIR];
+  const int kend = this->data->end[KDIR];
+  const int jend = this->data->end[JDIR];
+  const int iend = this->data->end[IDIR];
+  const real coeff = theta*this->data->dt/eps;
+
+  idefix_for("Implicit_Operator", beg[KDIR], end[KDIR], beg[JDIR], end[JDIR], beg[IDIR], end[IDIR],
+    KOKKOS_LAMBDA (int kk, int j, int i) {
+      const int b = kk / nk;
+      const int k = kk - b*nk;
+      real q = ZERO_F;
+      if(b < nvarCell) {
+        if(k >= kbeg && k < kend && j < jend && i < iend) {
+          q = (in(kk,j,i) - coeff*(dU(b,k,j,i) - dU0(b,k,j,i))/blockScale(b))
+              / precond(k,j,i);
+        }
+      } else {
+        const int n = b - nvarCell;
+        if(k >= kbeg && k < kend + (n == KDIR) && j < jend + (n == JDIR)
+                                               && i < iend + (n == IDIR)) {
+          q = in(kk,j,i) - coeff*(dB(n,k,j,i) - dB0(n,k,j,i))/blockScale(b);
+        }
+      }
+      out(kk,j,i) = q;
+    });
+  idfx::popRegion();
+}
+
+template<typename Phys>
+void ImplicitParabolic<Phys>::Cycle() {
+  idfx::pushRegion("ImplicitParabolic::Cycle");
+  Fluid<Phys> *hydro = this->hydro;
+  DataBlock *data = this->data;
+  const real dt = data->dt;
+
+  // Tell the datablock that we're performing the implicit cycle
+  data->implicitCycle = true;
+  tEval = data->t + theta*dt;
+
+  this->stage = 1;
+  hydro->boundary->SetBoundaries(data->t);
+  hydro->ConvertPrimToCons();
+  if(data->haveGridCoarsening) {
+    data->Coarsen();
+  }
+  this->Copy(this->Uc0, hydro->Uc);
+  if(this->haveVs) Kokkos::deep_copy(this->Vs0, hydro->Vs);
+
+  // L(U0), which also fills InvDt with the local diffusion rates
+  this->SetBoundaries(tEval);
+  this->EvolveStage(tEval);
+  Kokkos::deep_copy(this->dU0, this->dU);
+  if(this->haveVs) Kokkos::deep_copy(this->dB0, this->dB);
+
+  // InvDt should not be reset by the Jacobian evaluations
+  this->stage = 2;
+
+  if(havePreconditioner) {
+    IdefixArray3D<real> precond = this->precond;
+    IdefixArray3D<real> invDt = hydro->InvDt;
+    const real coeff = theta*dt;
+    idefix_for("Implicit_Preconditioner",
+               data->beg[KDIR], data->end[KDIR],
+               data->beg[JDIR], data->end[JDIR],
+               data->beg[IDIR], data->end[IDIR],
+      KOKKOS_LAMBDA (int k, int j, int i) {
+        precond(k,j,i) = ONE_F + coeff*invDt(k,j,i);
+      });
+  }
+
+  Pack(work, this->Uc0, this->Vs0, ONE_F, false);
+  normU0 = Norm(work, false);
+  Pack(rhs, this->dU0, this->dB0, dt, true);
+  ScaleBlocks(rhs);
+  Kokkos::deep_copy(solution, ZERO_F);
+
+  niter = 0;
+  if(Norm(rhs, false) > ZERO_F) {
+    niter = solver->Solve(solution, rhs);
+    if(niter < 0) {
+      idfx::cout << "ImplicitParabolic: BICGSTAB failed, restarting" << std::endl;
+      Kokkos::deep_copy(solution, ZERO_F);
+      niter = solver->Solve(solution, rhs);
+      if(niter < 0) {
+        IDEFIX_ERROR("ImplicitParabolic: BICGSTAB failed despite restart");
+      }
+    }
+  }
+
+  // U = U0 + dt (theta L(U0+dU) + (1-theta) L(U0)). Rebuilding the increment from the fluxes
+  // and EMFs, rather than taking dU itself, keeps the update conservative and the field
+  // divergence-free to round-off, whatever the solver tolerance.
+  Unpack(solution, ONE_F);
+  this->SetBoundaries(tEval);
+  this->EvolveStage(tEval);
+  {
+    IdefixArray1D<int> varList = this->varList;
+    IdefixArray4D<real> Uc = hydro->Uc;
+    IdefixArray4D<real> Uc0 = this->Uc0;
+    IdefixArray4D<real> dU = this->dU;
+    IdefixArray4D<real> dU0 = this->dU0;
+    const real w = dt*theta;
+    const real w0 = dt*(ONE_F-theta);
+    if(this->haveVc) {
+      idefix_for("Implicit_UpdateUc",
+                 0, this->nvarRKL,
+                 data->beg[KDIR], data->end[KDIR],
+                 data->beg[JDIR], data->end[JDIR],
+                 data->beg[IDIR], data->end[IDIR],
+        KOKKOS_LAMBDA (int n, int k, int j, int i) {
+          const int nv = varList(n);
+          Uc(nv,k,j,i) = Uc0(n,k,j,i) + w*dU(n,k,j,i) + w0*dU0(n,k,j,i);
+        });
+    }
+    if constexpr(Phys::mhd) {
+      if(this->haveVs) {
+        IdefixArray4D<real> Vs = hydro->Vs;
+        IdefixArray4D<real> Vs0 = this->Vs0;
+        IdefixArray4D<real> dB = this->dB;
+        IdefixArray4D<real> dB0 = this->dB0;
+        idefix_for("Implicit_UpdateVs",
+                   0, DIMENSIONS,
+                   data->beg[KDIR], data->end[KDIR]+KOFFSET,
+                   data->beg[JDIR], data->end[JDIR]+JOFFSET,
+                   data->beg[IDIR], data->end[IDIR]+IOFFSET,
+          KOKKOS_LAMBDA (int n, int k, int j, int i) {
+            Vs(n,k,j,i) = Vs0(n,k,j,i) + w*dB(n,k,j,i) + w0*dB0(n,k,j,i);
+          });
+        hydro->boundary->ReconstructVcField(Uc);
+      }
+    }
+  }
+  if(data->haveGridCoarsening) {
+    data->Coarsen();
+  }
+  hydro->ConvertConsToPrim();
+
+  if(this->checkNan) {
+    if(data->CheckNan()>0) {
+      throw std::runtime_error(std::string("Nan found during implicit parabolic cycle"));
+    }
+  }
+
+  // Tell the datablock that we're done
+  data->implicitCycle = false;
+  idfx::popRegion();
+}
+
+#endif // RKL_IMPLICITPARABOLIC_HPP_
@@ -27,7 +27,7 @@ struct RKLegendre_ResetStageFunctor;
 template<typename Phys>
 class RKLegendre {
  public:
-  RKLegendre(Input &, Fluid<Phys>*);
+  RKLegendre(Input &, Fluid<Phys>*, bool implicit = false);
   void Cycle();
   void ResetStage();
   void ResetFlux();
@@ -37,21 +37,22 @@ class RKLegendre {
   void ShowConfig();
   void Copy(IdefixArray4D<real>&, IdefixArray4D<real>&);
 
+  // The cell-centered arrays only store the variables of varList: dU(n) refers to varList(n)
   IdefixArray4D<real> dU;      // variation of main cell-centered conservative variables
   IdefixArray4D<real> dU0;      // dU of the first stage
   IdefixArray4D<real> Uc0;      // Uc at initial stage
-  IdefixArray4D<real> Uc1;      // Uc of the previous stage, Uc1 = Uc(stage-1)
+  IdefixArray4D<real> Uc1;      // Uc of the previous stage, Uc1 = Uc(stage-1) (RKL only)
 
   IdefixArray4D<real> dB;      // Variation of cell-centered magnetic variables
   IdefixArray4D<real> dB0;     // dB of the first stage
   IdefixArray4D<real> Vs0;     // Vs of initial stage
-  IdefixArray4D<real> Vs1;     // Vs of previous stage
+  IdefixArray4D<real> Vs1;     // Vs of previous stage (RKL only)
 
   #ifdef EVOLVE_VECTOR_POTENTIAL
   IdefixArray4D<real> dA;      // Variation of edge-centered vector potential
   IdefixArray4D<real> dA0;     // dA of the first stage
   IdefixArray4D<real> Ve0;     // Ve of initial stage
-  IdefixArray4D<real> Ve1;     // Ve of previous stage
+  IdefixArray4D<real> Ve1;     // Ve of previous stage (RKL only)
   #endif
 
   IdefixArray1D<int> varList;  // List of variables which should be evolved
@@ -60,9 +61,10 @@ class RKLegendre {
   real dt, cfl_rkl, rmax_par;
   int stage{0};
 
- private:
+ protected:
   friend struct RKLegendre_ResetStageFunctor<Phys>;
   void SetBoundaries(real);        // Enforce boundary conditions on the variables solved by RKL
+  bool Handles(const ParabolicModuleStatus &) const;  // Whether a term is integrated here
 
   DataBlock *data;
   Fluid<Phys> *hydro;
@@ -76,8 +78,9 @@ class RKLegendre {
   void AddVariable(int, std::vector<int> & );
 
   bool checkNan{false};         // whether we should look for Nans when RKL is running
+  bool implicit{false};         // Whether we evaluate the terms of the implicit integrator
+  bool needCurrent{false};      // Whether the current is needed by the terms we evaluate
 
- private:
   template<int> void LoopDir(real);   // Dimensional loop
 };
 
@@ -104,7 +107,7 @@ void RKLegendre<Phys>::AddVariable(int var, std::vector<int> &varListHost ) {
   }
 }
 
-// Copy just the variables required by the RK scheme
+// Copy just the variables required by the RK scheme from a full array into a compact one
 template<typename Phys>
 void RKLegendre<Phys>::Copy(IdefixArray4D<real> &out, IdefixArray4D<real> &in) {
   IdefixArray1D<int> vars = this->varList;
@@ -115,35 +118,45 @@ void RKLegendre<Phys>::Copy(IdefixArray4D<real> &out, IdefixArray4D<real> &in) {
              0, data->np_tot[JDIR],
              0, data->np_tot[IDIR],
              KOKKOS_LAMBDA(int n, int k, int j, int i) {
-               const int var = vars(n);
-               out(var,k,j,i) = in(var,k,j,i);
+               out(n,k,j,i) = in(vars(n),k,j,i);
              });
 }
 
 template<typename Phys>
-RKLegendre<Phys>::RKLegendre(Input &input, Fluid<Phys>* hydroin) {
+bool RKLegendre<Phys>::Handles(const ParabolicModuleStatus &status) const {
+  return(implicit ? status.isImplicit : status.isRKL);
+}
+
+template<typename Phys>
+RKLegendre<Phys>::RKLegendre(Input &input, Fluid<Phys>* hydroin, bool implicit):
+                              implicit(implicit) {
   idfx::pushRegion("RKLegendre::Init");
 
   // Save the datablock to which we are attached from now on
   this->data = hydroin->data;
   this->hydro = hydroin;
 
-  cfl_rkl = input.GetOrSet<real> ("RKL","cfl",0, 0.5);
-  rmax_par = input.GetOrSet<real> ("RKL","rmax_par",0, 100.0);
+  // When used by the implicit integrator, only the parabolic operator is needed
+  const std::string block = implicit ? "Implicit" : "RKL";
+  if(!implicit) {
+    cfl_rkl = input.GetOrSet<real> ("RKL","cfl",0, 0.5);
+    rmax_par = input.GetOrSet<real> ("RKL","rmax_par",0, 100.0);
+  }
 
   // By default check nans in debug mode
   #ifdef DEBUG
   this->checkNan = true;
   #endif
 
-  this->checkNan = input.GetOrSet<bool>("RKL","check_nan",0, this->checkNan);
+  this->checkNan = input.GetOrSet<bool>(block,"check_nan",0, this->checkNan);
+  this->needCurrent = implicit ? hydro->needImplicitCurrent : hydro->needRKLCurrent;
 
   // Make a list of variables
 
   std::vector<int> varListHost;
   // Create a list of variables
   // Viscosity
-  if(hydro->viscosityStatus.isRKL) {
+  if(Handles(hydro->viscosityStatus)) {
     haveVc = true;
     EXPAND( AddVariable(MX1, varListHost);   ,
             AddVariable(MX2, varListHost);   ,
@@ -154,7 +167,7 @@ RKLegendre<Phys>::RKLegendre(Input &input, Fluid<Phys>* hydroin) {
     #endif
   }
   // BragViscosity
-  if(hydro->bragViscosityStatus.isRKL) {
+  if(Handles(hydro->bragViscosityStatus)) {
     haveVc = true;
     EXPAND( AddVariable(MX1, varListHost);   ,
             AddVariable(MX2, varListHost);   ,
@@ -166,18 +179,18 @@ RKLegendre<Phys>::RKLegendre(Input &input, Fluid<Phys>* hydroin) {
 
   // Thermal diffusion
   #if HAVE_ENERGY
-    if(hydro->thermalDiffusionStatus.isRKL) {
+    if(Handles(hydro->thermalDiffusionStatus)) {
       haveVc = true;
       AddVariable(ENG, varListHost);
     }
     // Braginskii Thermal diffusion
-    if(hydro->bragThermalDiffusionStatus.isRKL) {
+    if(Handles(hydro->bragThermalDiffusionStatus)) {
       haveVc = true;
       AddVariable(ENG, varListHost);
     }
   #endif
   // Ambipolar diffusion
-  if(hydro->ambipolarStatus.isRKL || hydro->resistivityStatus.isRKL) {
+  if(Handles(hydro->ambipolarStatus) || Handles(hydro->resistivityStatus)) {
     #if COMPONENTS == 3 && DIMENSIONS < 3
       haveVc = true;
       AddVariable(BX3, varListHost);
@@ -204,14 +217,17 @@ RKLegendre<Phys>::RKLegendre(Input &input, Fluid<Phys>* hydroin) {
 
   // Variable allocation
 
-  dU = IdefixArray4D<real>("RKL_dU", NVAR,
-                           data->np_tot[KDIR], data->np_tot[JDIR], data->np_tot[IDIR]);
-  dU0 = IdefixArray4D<real>("RKL_dU0", NVAR,
+  // Only the variables of varList are stored. The implicit integrator has no previous stage.
+  dU = IdefixArray4D<real>("RKL_dU", nvarRKL,
                            data->np_tot[KDIR], data->np_tot[JDIR], data->np_tot[IDIR]);
-  Uc0 = IdefixArray4D<real>("RKL_Uc0", NVAR,
+  dU0 = IdefixArray4D<real>("RKL_dU0", nvarRKL,
                            data->np_tot[KDIR], data->np_tot[JDIR], data->np_tot[IDIR]);
-  Uc1 = IdefixArray4D<real>("RKL_Uc1", NVAR,
+  Uc0 = IdefixArray4D<real>("RKL_Uc0", nvarRKL,
                            data->np_tot[KDIR], data->np_tot[JDIR], data->np_tot[IDIR]);
+  if(!implicit) {
+    Uc1 = IdefixArray4D<real>("RKL_Uc1", nvarRKL,
+                             data->np_tot[KDIR], data->np_tot[JDIR], data->np_tot[IDIR]);
+  }
 
   if(haveVs) {
     #ifdef EVOLVE_VECTOR_POTENTIAL
@@ -227,10 +243,12 @@ RKLegendre<Phys>::RKLegendre(Input &input, Fluid<Phys>* hydroin) {
                         data->np_tot[KDIR]+KOFFSET,
                         data->np_tot[JDIR]+JOFFSET,
                         data->np_tot[IDIR]+IOFFSET);
-      Ve1 = IdefixArray4D<real>("RKL_Ve1", AX3e+1,
-                        data->np_tot[KDIR]+KOFFSET,
-                        data->np_tot[JDIR]+JOFFSET,
-                        data->np_tot[IDIR]+IOFFSET);
+      if(!implicit) {
+        Ve1 = IdefixArray4D<real>("RKL_Ve1", AX3e+1,
+                          data->np_tot[KDIR]+KOFFSET,
+                          data->np_tot[JDIR]+JOFFSET,
+                          data->np_tot[IDIR]+IOFFSET);
+      }
     #else
       dB = IdefixArray4D<real>("RKL_dB", DIMENSIONS,
                         data->np_tot[KDIR]+KOFFSET,
@@ -244,10 +262,12 @@ RKLegendre<Phys>::RKLegendre(Input &input, Fluid<Phys>* hydroin) {
                         data->np_tot[KDIR]+KOFFSET,
                         data->np_tot[JDIR]+JOFFSET,
                         data->np_tot[IDIR]+IOFFSET);
-      Vs1 = IdefixArray4D<real>("RKL_Vs1", DIMENSIONS,
-                        data->np_tot[KDIR]+KOFFSET,
-                        data->np_tot[JDIR]+JOFFSET,
-                        data->np_tot[IDIR]+IOFFSET);
+      if(!implicit) {
+        Vs1 = IdefixArray4D<real>("RKL_Vs1", DIMENSIONS,
+                          data->np_tot[KDIR]+KOFFSET,
+                          data->np_tot[JDIR]+JOFFSET,
+                          data->np_tot[IDIR]+IOFFSET);
+      }
     #endif
   }
 
@@ -339,7 +359,7 @@ void RKLegendre<Phys>::Cycle() {
 
   ComputeDt();
 
-  Copy(dU0,dU);
+  Kokkos::deep_copy(dU0,dU);
 
   if(haveVs) {
     #ifdef EVOLVE_VECTOR_POTENTIAL
@@ -393,8 +413,8 @@ void RKLegendre<Phys>::Cycle() {
               data->beg[IDIR],data->end[IDIR],
       KOKKOS_LAMBDA (int n, int k, int j, int i) {
         int nv = varList(n);
-        Uc1(nv,k,j,i) = Uc(nv,k,j,i);
-        Uc(nv,k,j,i) = Uc1(nv,k,j,i) + mu_tilde_j*dt_hyp*dU0(nv,k,j,i);
+        Uc1(n,k,j,i) = Uc(nv,k,j,i);
+        Uc(nv,k,j,i) = Uc1(n,k,j,i) + mu_tilde_j*dt_hyp*dU0(n,k,j,i);
       }
     );
   }
@@ -472,14 +492,14 @@ void RKLegendre<Phys>::Cycle() {
               data->beg[IDIR],data->end[IDIR],
         KOKKOS_LAMBDA (int n, int k, int j, int i) {
           const int nv = varList(n);
-          real Y = mu_j*Uc(nv,k,j,i) + nu_j*Uc1(nv,k,j,i);
-          Uc1(nv,k,j,i) = Uc(nv,k,j,i);
+          real Y = mu_j*Uc(nv,k,j,i) + nu_j*Uc1(n,k,j,i);
+          Uc1(n,k,j,i) = Uc(nv,k,j,i);
   #if RKL_ORDER == 1
-          Uc(nv,k,j,i) = Y + dt_hyp*mu_tilde_j*dU(nv,k,j,i);
+          Uc(nv,k,j,i) = Y + dt_hyp*mu_tilde_j*dU(n,k,j,i);
   #elif RKL_ORDER == 2
-          Uc(nv,k,j,i) = Y + (1.0 - mu_j - nu_j)*Uc0(nv,k,j,i)
-                                  + dt_hyp*mu_tilde_j*dU(nv,k,j,i)
-                                  + gamma_j*dt_hyp*dU0(nv,k,j,i);
+          Uc(nv,k,j,i) = Y + (1.0 - mu_j - nu_j)*Uc0(n,k,j,i)
+                                  + dt_hyp*mu_tilde_j*dU(n,k,j,i)
+                                  + gamma_j*dt_hyp*dU0(n,k,j,i);
   #endif
           });
     }
@@ -577,7 +597,6 @@ struct RKLegendre_ResetStageFunctor {
   explicit RKLegendre_ResetStageFunctor(RKLegendre<Phys> *rkl) {
     dU = rkl->dU;
     Flux = rkl->hydro->FluxRiemann;
-    vars = rkl->varList;
     stage = rkl->stage;
     nvar = rkl->nvarRKL;
     haveVc = rkl->haveVc || (rkl->stage ==1 );
@@ -597,7 +616,6 @@ struct RKLegendre_ResetStageFunctor {
 
   IdefixArray4D<real> dU;
   IdefixArray4D<real> Flux;
-  IdefixArray1D<int> vars;
   IdefixArray4D<real> dA, dB;
   IdefixArray3D<real> ex,ey,ez;
   IdefixArray3D<real> invDt;
@@ -607,8 +625,7 @@ struct RKLegendre_ResetStageFunctor {
   KOKKOS_INLINE_FUNCTION void operator() (const int k, const int j,  const int i) const {
     if(haveVc) {
       for(int n = 0 ; n < nvar ; n++) {
-        const int nv = vars(n);
-        dU(nv,k,j,i) = ZERO_F;
+        dU(n,k,j,i) = ZERO_F;
       }
     }
     if(stage == 1)   invDt(k,j,i) = ZERO_F;
@@ -701,20 +718,22 @@ void RKLegendre<Phys>::EvolveStage(real t) {
 
   ResetStage();
 
-  if(haveVs && hydro->needRKLCurrent) hydro->CalcCurrent();
+  if(haveVs && needCurrent) hydro->CalcCurrent();
 
   // Loop on dimensions for the parabolic fluxes and RHS, starting from IDIR
   if(haveVc || stage == 1) LoopDir<IDIR>(t);
 
-  if(haveVs) {
-    hydro->emf->CalcNonidealEMF(t);
-    hydro->emf->EnforceEMFBoundary();
-    real dt=1.0;
-    #ifdef EVOLVE_VECTOR_POTENTIAL
-      hydro->emf->EvolveVectorPotential(dt, this->dA);
-    #else
-      hydro->emf->EvolveMagField(t, dt, this->dB);
-    #endif
+  if constexpr(Phys::mhd) {
+    if(haveVs) {
+      hydro->emf->CalcNonidealEMF(t);
+      hydro->emf->EnforceEMFBoundary();
+      real dt=1.0;
+      #ifdef EVOLVE_VECTOR_POTENTIAL
+        hydro->emf->EvolveVectorPotential(dt, this->dA);
+      #else
+        hydro->emf->EvolveMagField(t, dt, this->dB);
+      #endif
+    }
   }
   idfx::popRegion();
 }
@@ -741,10 +760,10 @@ void RKLegendre<Phys>::CalcParabolicRHS(real t) {
   IdefixArray4D<real> dU = this->dU;
   IdefixArray1D<int> varList = this->varList;
 
-  bool haveViscosity = hydro->viscosityStatus.isRKL;
+  bool haveViscosity = Handles(hydro->viscosityStatus);
   if(haveViscosity) viscSrc = hydro->viscosity->viscSrc;
   IdefixArray4D<real> bragViscSrc;
-  bool haveBragViscosity = hydro->bragViscosityStatus.isRKL;
+  bool haveBragViscosity = Handles(hydro->bragViscosityStatus);
   if(haveBragViscosity) bragViscSrc = hydro->bragViscosity->bragViscSrc;
 
   int ioffset,joffset,koffset;
@@ -802,7 +821,7 @@ void RKLegendre<Phys>::CalcParabolicRHS(real t) {
   );
 
 
-  idefix_for("CalcRightHandSide",
+  idefix_for("RKL_CalcRightHandSide",
              0, this->nvarRKL,
              data->beg[KDIR],data->end[KDIR],
              data->beg[JDIR],data->end[JDIR],
@@ -867,7 +886,7 @@ void RKLegendre<Phys>::CalcParabolicRHS(real t) {
 #endif // GEOMETRY != CARTESIAN
 
       // store the field components
-      dU(nv,k,j,i) += rhs;
+      dU(n,k,j,i) += rhs;
     });
 
   // Compute hyperbolic timestep only if we're in the first stage of the RKL loop
@@ -19,6 +19,7 @@
 #include "gridHost.hpp"
 #include "dataBlockHost.hpp"
 #include "boundary.hpp"
+#include "particles.hpp"
 
 class Setup {
  public:
@@ -18,6 +18,7 @@
 #include "stateContainer.hpp"
 #include "fluid.hpp"
 #include "planetarySystem.hpp"
+#include "particles.hpp"
 
 
 TimeIntegrator::TimeIntegrator(Input & input, DataBlock & data) {
@@ -74,6 +75,14 @@ TimeIntegrator::TimeIntegrator(Input & input, DataBlock & data) {
   if(data.hydro->haveRKLParabolicTerms) {
     haveRKL = true;
   }
+  // and the implicit parabolic integrator
+  if(data.hydro->haveImplicitParabolicTerms) {
+    haveImplicit = true;
+  }
+  // and the Hall subcycles
+  if(data.hydro->hallStatus.isSubcycled) {
+    haveHallSubcycle = true;
+  }
 
   // If multi-stage, create a new state in the datablock called "begin"
   if(nstages>1) {
@@ -125,6 +134,12 @@ void TimeIntegrator::ShowLog(DataBlock &data) {
     if(haveRKL) {
       idfx::cout << " | " << std::setw(col_width) << "RKL stages";
     }
+    if(haveImplicit) {
+      idfx::cout << " | " << std::setw(col_width) << "Implicit iter.";
+    }
+    if(haveHallSubcycle) {
+      idfx::cout << " | " << std::setw(col_width) << "Hall substeps";
+    }
     if(data.haveGravity && data.gravity->haveSelfGravityPotential) {
       idfx::cout << " | " << std::setw(col_width) << "SG iterations";
       idfx::cout << " | " << std::setw(col_width) << "SG error";
@@ -135,7 +150,7 @@ void TimeIntegrator::ShowLog(DataBlock &data) {
 
   #ifdef WITH_MPI
     double imbalance = 0;
-    if(ncycles>=cyclePeriod) imbalance = ComputeBalance();
+    if(ncycles>=cyclePeriod) imbalance = ComputeBalance(data);
   #endif
   idfx::cout << "TimeIntegrator: ";
   idfx::cout << std::scientific;
@@ -177,6 +192,12 @@ void TimeIntegrator::ShowLog(DataBlock &data) {
   if(haveRKL) {
     idfx::cout << " | " << std::setw(col_width) << data.hydro->rkl->stage;
   }
+  if(haveImplicit) {
+    idfx::cout << " | " << std::setw(col_width) << data.hydro->implicit->niter;
+  }
+  if(haveHallSubcycle) {
+    idfx::cout << " | " << std::setw(col_width) << data.hydro->hallSubcycle->nsubsteps;
+  }
   if(data.haveGravity && data.gravity->haveSelfGravityPotential) {
     if(ncycles>=cyclePeriod) {
       idfx::cout << " | " << std::setw(col_width) << data.gravity->selfGravity.nsteps;
@@ -193,7 +214,7 @@ void TimeIntegrator::ShowLog(DataBlock &data) {
   idfx::cout << std::endl;
 }
 
-double TimeIntegrator::ComputeBalance() {
+double TimeIntegrator::ComputeBalance(DataBlock &data) {
   // Check MPI imbalance
     double imbalance = 0;
     #ifdef WITH_MPI
@@ -238,6 +259,8 @@ double TimeIntegrator::ComputeBalance() {
           idfx::cout << "-------------------------------------------------------------"<< std::endl;
         }
       }
+      // Adapt the domain decomposition to the measured load
+      if(data.mygrid->haveLoadBalance) data.mygrid->BalanceLoad(computeLogPerCore, imbalance);
     #endif
     return(imbalance);
 }
@@ -252,10 +275,13 @@ void TimeIntegrator::Cycle(DataBlock &data) {
 
   if(ncycles%cyclePeriod==0) ShowLog(data);
 
+  data.cycle = ncycles;
+
   // Launch user step before everything
   data.LaunchUserStepFirst();
 
-  if(haveRKL && (ncycles%2)==1) {    // Runge-Kutta-Legendre cycle
+  // RKL, implicit parabolic and Hall cycles
+  if((haveRKL || haveImplicit || haveHallSubcycle) && (ncycles%2)==1) {
     data.EvolveRKLStage();
   }
 
@@ -273,8 +299,12 @@ void TimeIntegrator::Cycle(DataBlock &data) {
   // BEGIN STAGES LOOP                           //
   /////////////////////////////////////////////////
   for(int stage=0; stage < nstages ; stage++) {
-    // Apply Boundary conditions
-    data.SetBoundaries();
+    // Apply Boundary conditions (deep halos are only exchanged at the beginning of the cycle)
+    data.SetBoundaries(stage == 0 || !data.haveDeepHalo);
+
+    // The particles are evolved after the gas with the velocity of the last stage, whose
+    // boundaries (and MPI halos) are set
+    if(data.haveParticles && stage == nstages-1) data.particles->StoreGasVelocity();
 
     // Remove Fargo velocity so that the integrator works on the residual
     if(data.haveFargo) data.fargo->SubstractVelocity(data.t);
@@ -293,8 +323,10 @@ void TimeIntegrator::Cycle(DataBlock &data) {
 
     Kokkos::fence();
     computeLastLog -= timer.seconds();
-    // Update Uc & Vs
+    // Update Uc & Vs (also in the part of the deep halos needed by the next stages)
+    data.ExtendActiveDomain(nstages-1-stage);
     data.EvolveStage();
+    data.ResetActiveDomain();
     Kokkos::fence();
     computeLastLog += timer.seconds();
 
@@ -359,7 +391,8 @@ void TimeIntegrator::Cycle(DataBlock &data) {
   }
 #endif
 
-  if(haveRKL && (ncycles%2)==0) {    // Runge-Kutta-Legendre cycle
+  // RKL, implicit parabolic and Hall cycles
+  if((haveRKL || haveImplicit || haveHallSubcycle) && (ncycles%2)==0) {
     data.EvolveRKLStage();
   }
 
@@ -368,6 +401,11 @@ void TimeIntegrator::Cycle(DataBlock &data) {
     data.planetarySystem->EvolveSystem(data, data.dt);
   }
 
+  // Update the dust particles, and their feedback on the gas
+  if(data.haveParticles) {
+    data.particles->Evolve(data.dt);
+  }
+
   // Coarsen the grid
   if(data.haveGridCoarsening) {
     data.Coarsen();
@@ -384,6 +422,11 @@ void TimeIntegrator::Cycle(DataBlock &data) {
     real tt = newdt/data.hydro->rkl->dt;
     newdt *= std::fmin(ONE_F, data.hydro->rkl->rmax_par/(tt));
   }
+  if(haveHallSubcycle) {
+    // limit the number of Hall substeps
+    real tt = newdt/data.hydro->hallSubcycle->dt;
+    newdt *= std::fmin(ONE_F, data.hydro->hallSubcycle->rmax/(tt));
+  }
 
   // Next time step
   if(!haveFixedDt) {
@@ -407,6 +450,8 @@ void TimeIntegrator::Cycle(DataBlock &data) {
     data.dt = fixedDt;
   }
 
+  // Agree on the loop strategies timed during this cycle
+  idfx::tuner.Synchronize();
 
   ncycles++;
 
@@ -33,10 +33,13 @@ class TimeIntegrator {
   bool isSilent{false};   // Whether the integration should proceed silently
 
  private:
-  double ComputeBalance(); // Compute the compute balance between MPI processes
+  double ComputeBalance(DataBlock &); // Compute the compute balance between MPI processes
 
   // Whether we have RKL
   bool haveRKL{false};
+  // Whether we have implicit parabolic terms
+  bool haveImplicit{false};
+  bool haveHallSubcycle{false};
 
   int nstages;
   // Weights of time integrator
@@ -0,0 +1,4 @@
+#define     COMPONENTS      3
+#define     DIMENSIONS      3
+#define     ISOTHERMAL
+#define     GEOMETRY        CARTESIAN
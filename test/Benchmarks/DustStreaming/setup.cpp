@@ -0,0 +1,91 @@
+#include "idefix.hpp"
+#include "setup.hpp"
+
+// Streaming instability in a shearing box with several dust species
+
+static real omega;
+static real shear;
+real epsilon;
+real chi;
+
+void PressureGradient(Hydro *hydro, const real t, const real dt) {
+  auto Uc = hydro->Uc;
+  auto Vc = hydro->Vc;
+  DataBlock *data = hydro->data;
+  real eps = epsilon;
+  idefix_for("MySourceTerm",0,data->np_tot[KDIR],0,data->np_tot[JDIR],0,data->np_tot[IDIR],
+              KOKKOS_LAMBDA (int k, int j, int i) {
+                // Radial pressure gradient
+                  Uc(MX1,k,j,i) += eps*Vc(RHO,k,j,i)*dt;
+              });
+}
+
+void BodyForce(DataBlock &data, const real t, IdefixArray4D<real> &force) {
+  idfx::pushRegion("BodyForce");
+  IdefixArray1D<real> x = data.x[IDIR];
+
+  // GPUS cannot capture static variables
+  real omegaLocal=omega;
+  real shearLocal =shear;
+
+  idefix_for("BodyForce",
+              data.beg[KDIR] , data.end[KDIR],
+              data.beg[JDIR] , data.end[JDIR],
+              data.beg[IDIR] , data.end[IDIR],
+              KOKKOS_LAMBDA (int k, int j, int i) {
+                force(IDIR,k,j,i) = -2.0*omegaLocal*shearLocal*x(i);
+                force(JDIR,k,j,i) = ZERO_F;
+                force(KDIR,k,j,i) = ZERO_F;
+      });
+
+  idfx::popRegion();
+}
+
+// Initialisation routine. Can be used to allocate
+// Arrays or variables which are used later on
+Setup::Setup(Input &input, Grid &grid, DataBlock &data, Output &output) {
+  // Get rotation rate along vertical axis
+  omega=input.Get<real>("Hydro","rotation",0);
+  shear=input.Get<real>("Hydro","shearingBox",0);
+
+  epsilon = input.Get<real>("Setup","epsilon",0);
+  chi = input.Get<real>("Setup","chi",0);
+  data.hydro->EnrollUserSourceTerm(&PressureGradient);
+  data.gravity->EnrollBodyForce(BodyForce);
+}
+
+// This routine initialize the flow
+// Note that data is on the device.
+// One can therefore define locally
+// a datahost and sync it, if needed
+void Setup::InitFlow(DataBlock &data) {
+    // Create a host copy
+    DataBlockHost d(data);
+
+    // The total dust-to-gas ratio chi is shared equally between the species
+    const int nSpecies = data.dust.size();
+    const real chiSpecie = chi/nSpecies;
+
+    for(int k = 0; k < d.np_tot[KDIR] ; k++) {
+        for(int j = 0; j < d.np_tot[JDIR] ; j++) {
+            for(int i = 0; i < d.np_tot[IDIR] ; i++) {
+                real x=d.x[IDIR](i);
+
+                d.Vc(RHO,k,j,i) = 1.0;
+                d.Vc(VX1,k,j,i) = 1e-2*(idfx::randm()-0.5);
+                d.Vc(VX2,k,j,i) = shear*x - epsilon/(2*(1+chi)*omega);
+                d.Vc(VX3,k,j,i) = 1e-2*(idfx::randm()-0.5);
+
+                for(int n = 0 ; n < nSpecies ; n++) {
+                  d.dustVc[n](RHO,k,j,i) = chiSpecie;
+                  d.dustVc[n](VX1,k,j,i) = 0.0;
+                  d.dustVc[n](VX2,k,j,i) = shear*x - epsilon/(2*(1+chi)*omega);
+                  d.dustVc[n](VX3,k,j,i) = 0.0;
+                }
+            }
+        }
+    }
+
+    // Send it all, if needed
+    d.SyncToDevice();
+}
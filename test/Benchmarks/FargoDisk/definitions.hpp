@@ -0,0 +1,6 @@
+#define     COMPONENTS      3
+#define     DIMENSIONS      2
+
+#define     ISOTHERMAL
+
+#define     GEOMETRY        POLAR
@@ -0,0 +1,36 @@
+#include "idefix.hpp"
+#include "setup.hpp"
+
+// Hydrodynamical version of the 3D Orszag-Tang vortex, used as a pure hydro benchmark
+
+Setup::Setup(Input &input, Grid &grid, DataBlock &data, Output &output) {
+}
+
+// This routine initialize the flow
+// Note that data is on the device.
+// One can therefore define locally
+// a datahost and sync it, if needed
+void Setup::InitFlow(DataBlock &data) {
+    // Create a host copy
+    DataBlockHost d(data);
+    real x,y,z;
+
+    for(int k = 0; k < d.np_tot[KDIR] ; k++) {
+        for(int j = 0; j < d.np_tot[JDIR] ; j++) {
+            for(int i = 0; i < d.np_tot[IDIR] ; i++) {
+                x=d.x[IDIR](i);
+                y=d.x[JDIR](j);
+                z=d.x[KDIR](k);
+
+                d.Vc(RHO,k,j,i) = 25.0/(36.0*M_PI);
+                d.Vc(PRS,k,j,i) = 5.0/(12.0*M_PI);
+                d.Vc(VX1,k,j,i) = -sin(2.0*M_PI*y);
+                d.Vc(VX2,k,j,i) = sin(2.0*M_PI*x)+cos(2.0*M_PI*z);
+                d.Vc(VX3,k,j,i) = cos(2.0*M_PI*x);
+            }
+        }
+    }
+
+    // Send it all, if needed
+    d.SyncToDevice();
+}
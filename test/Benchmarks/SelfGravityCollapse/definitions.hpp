@@ -0,0 +1,5 @@
+#define     COMPONENTS     3
+#define     DIMENSIONS     3
+
+#define     GEOMETRY       CARTESIAN
+#define     ISOTHERMAL
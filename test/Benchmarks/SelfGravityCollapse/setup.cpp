@@ -0,0 +1,43 @@
+#include <cmath>
+
+#include "idefix.hpp"
+#include "setup.hpp"
+
+// Collapse of an overdense sphere embedded in a uniform background, with periodic self-gravity
+
+real rho0Glob, rhoBgGlob, r0Glob;
+
+// Initialisation routine. Can be used to allocate
+// Arrays or variables which are used later on
+Setup::Setup(Input &input, Grid &grid, DataBlock &data, Output &output) {
+  rho0Glob = input.Get<real>("Setup","rho0",0);
+  rhoBgGlob = input.Get<real>("Setup","rhoBackground",0);
+  r0Glob = input.Get<real>("Setup","r0",0);
+}
+
+// This routine initialize the flow
+// Note that data is on the device.
+// One can therefore define locally
+// a datahost and sync it, if needed
+void Setup::InitFlow(DataBlock &data) {
+    // Create a host copy
+    DataBlockHost d(data);
+
+    for(int k = 0; k < d.np_tot[KDIR] ; k++) {
+        for(int j = 0; j < d.np_tot[JDIR] ; j++) {
+            for(int i = 0; i < d.np_tot[IDIR] ; i++) {
+              real dx = d.x[IDIR](i);
+              real dy = d.x[JDIR](j);
+              real dz = d.x[KDIR](k);
+              real dr = sqrt(dx*dx+dy*dy+dz*dz);
+              d.Vc(RHO,k,j,i) = (dr<=r0Glob) ? rho0Glob : rhoBgGlob;
+              d.Vc(VX1,k,j,i) = 0.0;
+              d.Vc(VX2,k,j,i) = 0.0;
+              d.Vc(VX3,k,j,i) = 0.0;
+            }
+        }
+    }
+
+    // Send it all, if needed
+    d.SyncToDevice();
+}
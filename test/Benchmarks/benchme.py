@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Run the Idefix benchmark suite and gather the performance reports in a single JSON file
+
+Usage: ./benchme.py [-bench name1 name2...] [-cycles n] [-output file.json] [-label text]
+Any option of the test suite (e.g. -mpi -dec 2 2 2 -cuda -single) can be added.
+"""
+import argparse
+import datetime
+import json
+import os
+import socket
+import subprocess
+import sys
+
+sys.path.append(os.getenv("IDEFIX_DIR"))
+
+import pytools.idfx_test as tst
+
+benchDir = os.path.dirname(os.path.abspath(__file__))
+
+# Standard workloads, in the order they are run
+benchList = ["OrszagTang3D-HD",
+             "OrszagTang3D-MHD",
+             "FargoDisk",
+             "SelfGravityCollapse",
+             "DustStreaming"]
+
+parser = argparse.ArgumentParser()
+
+parser.add_argument("-bench",
+                    default=benchList,
+                    help="List of benchmarks to run (default: all)",
+                    nargs='+')
+
+parser.add_argument("-cycles",
+                    type=int,
+                    default=100,
+                    help="Number of integration cycles for each benchmark")
+
+parser.add_argument("-output",
+                    default="benchmarks.json",
+                    help="Name of the JSON file gathering all of the reports")
+
+parser.add_argument("-label",
+                    default="",
+                    help="Label identifying this build in the report")
+
+args, unknown = parser.parse_known_args()
+
+outputFile = os.path.abspath(args.output)
+
+def getCommit():
+  try:
+    git = subprocess.run(["git", "-C", os.getenv("IDEFIX_DIR"), "rev-parse", "HEAD"],
+                         capture_output=True, text=True)
+    return git.stdout.strip()
+  except OSError:
+    return "unknown"
+
+report = {"date": datetime.datetime.now().strftime("%Y-%m-%d_%H:%M:%S"),
+          "label": args.label,
+          "hostname": socket.gethostname(),
+          "idefix_commit": getCommit(),
+          "cycles": args.cycles,
+          "benchmarks": {}}
+
+def packBandwidth(region, total):
+  # Sum the bytes and time of the MPI pack and unpack kernels of each direction
+  name = region["name"]
+  if name.startswith("idefix_for(") and "BufferX" in name and "bytes" in region:
+    kernel = name[len("idefix_for("):-1]
+    nbytes, time = total.get(kernel, (0.0, 0.0))
+    total[kernel] = (nbytes + region["bytes"], time + region["time"])
+  for child in region["children"]:
+    packBandwidth(child, total)
+  return total
+
+for bench in args.bench:
+  if bench not in benchList:
+    raise ValueError("Unknown benchmark "+bench+". Valid names are: "+" ".join(benchList))
+
+  print(tst.bcolors.HEADER+"Running benchmark "+bench+tst.bcolors.ENDC)
+  os.chdir(os.path.join(benchDir, bench))
+  test = tst.idfxTest()
+  test.configure()
+  test.compile()
+  if os.path.exists("perf.json"):
+    os.remove("perf.json")
+  test.run(options=["-maxcycles", str(args.cycles), "-perfreport", "perf.json"])
+
+  with open("perf.json", "r") as f:
+    report["benchmarks"][bench] = json.load(f)
+
+  perf = report["benchmarks"][bench]["metrics"]["cell_updates_per_second"]
+  print(tst.bcolors.OKGREEN+"%s: %e cell updates/s"%(bench, perf)+tst.bcolors.ENDC)
+
+  # MPI pack/unpack bandwidth in each direction, in every MPI run (these kernels do not exist
+  # without MPI). Kernel regions require -profile_kernels, which fences every kernel, so they
+  # are measured in a separate short run that does not pollute the timings above.
+  pack = {}
+  if test.mpi:
+    if os.path.exists("perf-kernels.json"):
+      os.remove("perf-kernels.json")
+    test.run(options=["-maxcycles", str(min(args.cycles, 20)), "-profile_kernels",
+                      "-perfreport", "perf-kernels.json"])
+    with open("perf-kernels.json", "r") as f:
+      pack = packBandwidth(json.load(f)["regions"], {})
+  report["benchmarks"][bench]["pack_bandwidth_GBps"] = {}
+  for kernel in sorted(pack):
+    nbytes, time = pack[kernel]
+    bandwidth = nbytes/time/1e9 if time > 0 else 0
+    report["benchmarks"][bench]["pack_bandwidth_GBps"][kernel] = bandwidth
+    print("  %s: %.2f GB/s"%(kernel, bandwidth))
+
+with open(outputFile, "w") as f:
+  json.dump(report, f, indent=2)
+
+print(tst.bcolors.OKGREEN+"Benchmark report written in "+outputFile+tst.bcolors.ENDC)
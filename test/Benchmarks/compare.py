@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+Compare two benchmark reports produced by benchme.py and flag performance regressions
+
+Usage: ./compare.py reference.json new.json [-threshold 5] [-minshare 1]
+The script exits with a non-zero code when a regression is found.
+"""
+import argparse
+import json
+import sys
+
+parser = argparse.ArgumentParser()
+
+parser.add_argument("reference",
+                    help="Reference benchmark report")
+
+parser.add_argument("new",
+                    help="Benchmark report to be compared to the reference")
+
+parser.add_argument("-threshold",
+                    type=float,
+                    default=5.0,
+                    help="Relative variation (in %%) above which a regression is flagged")
+
+parser.add_argument("-minshare",
+                    type=float,
+                    default=1.0,
+                    help="Only compare regions representing more than this %% of the run time")
+
+args = parser.parse_args()
+
+class bcolors:
+  FAIL = '\033[91m'
+  OKGREEN = '\033[92m'
+  WARNING = '\033[93m'
+  ENDC = '\033[0m'
+
+def flattenRegions(region, path="", out=None):
+  # Flatten the region tree into a dictionnary indexed by the full region path
+  if out is None:
+    out = {}
+  name = path+"/"+region["name"] if path else region["name"]
+  out[name] = region
+  for child in region["children"]:
+    flattenRegions(child, name, out)
+  return out
+
+def variation(ref, new):
+  return 100.0*(new-ref)/ref if ref > 0 else 0.0
+
+with open(args.reference, "r") as f:
+  ref = json.load(f)
+with open(args.new, "r") as f:
+  new = json.load(f)
+
+regressions = 0
+
+for bench, refBench in ref["benchmarks"].items():
+  if bench not in new["benchmarks"]:
+    print(bcolors.WARNING+bench+": missing from "+args.new+bcolors.ENDC)
+    continue
+  newBench = new["benchmarks"][bench]
+
+  # Global throughput
+  refPerf = refBench["metrics"]["cell_updates_per_second"]
+  newPerf = newBench["metrics"]["cell_updates_per_second"]
+  var = variation(refPerf, newPerf)
+  flag = var < -args.threshold
+  color = bcolors.FAIL if flag else bcolors.OKGREEN
+  print(color+"%-24s %e -> %e cell updates/s (%+.1f%%)"%(bench, refPerf, newPerf, var)+bcolors.ENDC)
+  regressions += flag
+
+  # Memory high-water mark
+  for space, refMem in refBench["memory_high_water_mark"].items():
+    newMem = newBench["memory_high_water_mark"].get(space, 0)
+    var = variation(refMem, newMem)
+    if var > args.threshold:
+      print(bcolors.FAIL+"    memory (%s): %+.1f%%"%(space, var)+bcolors.ENDC)
+      regressions += 1
+
+  # Per-region time per cycle
+  refRegions = flattenRegions(refBench["regions"])
+  newRegions = flattenRegions(newBench["regions"])
+  refTotal = refBench["regions"]["time"]
+  refCycles = refBench["metrics"]["cycles"]
+  newCycles = newBench["metrics"]["cycles"]
+  for name, region in refRegions.items():
+    if name not in newRegions or refTotal <= 0:
+      continue
+    if 100.0*region["time"]/refTotal < args.minshare:
+      continue
+    var = variation(region["time"]/refCycles, newRegions[name]["time"]/newCycles)
+    if var > args.threshold:
+      print(bcolors.FAIL+"    %s: %+.1f%% time per cycle"%(name, var)+bcolors.ENDC)
+      regressions += 1
+
+if regressions > 0:
+  print(bcolors.FAIL+"%d performance regression(s) found."%regressions+bcolors.ENDC)
+  sys.exit(1)
+
+print(bcolors.OKGREEN+"No performance regression found."+bcolors.ENDC)
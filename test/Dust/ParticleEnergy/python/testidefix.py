@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Check that the drag between the gas and the Lagrangian particles conserves
+the total energy and the total momentum
+"""
+import sys
+import numpy as np
+import argparse
+import matplotlib.pyplot as plt
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-noplot",
+                    default=False,
+                    help="disable plotting",
+                    action="store_true")
+
+
+args, unknown=parser.parse_known_args()
+
+# load the dat file produced by the setup
+raw=np.loadtxt('../timevol.dat',skiprows=1)
+t=raw[:,0]
+Ekg=raw[:,1]
+Ekp=raw[:,2]
+Eth=raw[:,3]
+Pg=raw[:,4]
+Pp=raw[:,5]
+
+etot=Ekg+Ekp+Eth
+ptot=Pg+Pp
+
+if not(args.noplot):
+  plt.figure()
+  plt.plot(t,Ekg,label="Ek_g")
+  plt.plot(t,Ekp,label="Ek_p")
+  plt.plot(t,Eth,label="Eth")
+  plt.plot(t,etot,'--',label="Etot")
+  plt.legend()
+  plt.xlabel("t")
+  plt.ylabel("Flow energy")
+  plt.show()
+
+# Relative evolution of the total energy, and of the total momentum
+# (compared to the momentum of the gas)
+errorE=abs((etot[-1]-etot[0])/etot[0])
+errorP=abs((ptot[-1]-ptot[0])/Pg[0])
+
+print("error on energy=%e, error on momentum=%e"%(errorE,errorP))
+if(errorE<1e-4 and errorP<1e-6):
+  print("Success!")
+else:
+  print("Failure!")
+  sys.exit(1)
@@ -0,0 +1,129 @@
+#include "idefix.hpp"
+#include "setup.hpp"
+
+#define  FILENAME    "timevol.dat"
+
+
+// Analyse data to produce an output
+void Analysis(DataBlock & data) {
+  auto Vc = data.hydro->Vc;
+  auto dV = data.dV;
+  auto state = data.particles->state;
+  real gamma = data.hydro->eos->GetGamma();
+  // Kinetic energy, momentum and thermal energy
+  real Ekg, Ekp, Etherm, Pg, Pp;
+
+  idefix_reduce("Ek",data.beg[KDIR],data.end[KDIR],data.beg[JDIR],data.end[JDIR],data.beg[IDIR],data.end[IDIR],
+              KOKKOS_LAMBDA (int k, int j, int i, real &e) {
+                for(int n = 0 ; n < COMPONENTS ; n++) {
+                  e += 0.5*Vc(RHO,k,j,i)*Vc(VX1+n,k,j,i) * Vc(VX1+n,k,j,i)*dV(k,j,i);
+                }
+              }, Kokkos::Sum<real>(Ekg) );
+
+  idefix_reduce("Eth",data.beg[KDIR],data.end[KDIR],data.beg[JDIR],data.end[JDIR],data.beg[IDIR],data.end[IDIR],
+              KOKKOS_LAMBDA (int k, int j, int i, real &e) {
+                e += Vc(PRS,k,j,i)/(gamma-1)*dV(k,j,i);
+              }, Kokkos::Sum<real>(Etherm) );
+
+  idefix_reduce("Pg",data.beg[KDIR],data.end[KDIR],data.beg[JDIR],data.end[JDIR],data.beg[IDIR],data.end[IDIR],
+              KOKKOS_LAMBDA (int k, int j, int i, real &p) {
+                p += Vc(RHO,k,j,i)*Vc(VX1,k,j,i)*dV(k,j,i);
+              }, Kokkos::Sum<real>(Pg) );
+
+  idefix_reduce("Ekp", 0, data.particles->count,
+              KOKKOS_LAMBDA (int n, real &e) {
+                for(int c = 0 ; c < COMPONENTS ; c++) {
+                  e += 0.5*state(Particles::PMASS,n)*state(Particles::PV1+c,n)
+                          *state(Particles::PV1+c,n);
+                }
+              }, Kokkos::Sum<real>(Ekp) );
+
+  idefix_reduce("Pp", 0, data.particles->count,
+              KOKKOS_LAMBDA (int n, real &p) {
+                p += state(Particles::PMASS,n)*state(Particles::PV1,n);
+              }, Kokkos::Sum<real>(Pp) );
+
+  #ifdef WITH_MPI
+    real sums[5] = {Ekg, Ekp, Etherm, Pg, Pp};
+    MPI_Allreduce(MPI_IN_PLACE, sums, 5, realMPI, MPI_SUM, MPI_COMM_WORLD);
+    Ekg = sums[0];
+    Ekp = sums[1];
+    Etherm = sums[2];
+    Pg = sums[3];
+    Pp = sums[4];
+  #endif
+
+  if(idfx::prank == 0) {
+    std::ofstream f;
+    f.open(FILENAME,std::ios::app);
+    f.precision(10);
+    f << std::scientific << data.t << "\t" << Ekg << "\t" << Ekp << "\t" << Etherm
+      << "\t" << Pg << "\t" << Pp << std::endl;
+    f.close();
+  }
+}
+
+// Initialisation routine. Can be used to allocate
+// Arrays or variables which are used later on
+Setup::Setup(Input &input, Grid &grid, DataBlock &data, Output &output) {
+  output.EnrollAnalysis(&Analysis);
+  if(!input.restartRequested) {
+      // Initialise the output file
+      std::ofstream f;
+      f.open(FILENAME,std::ios::trunc);
+      f << "t\t\t Ekg \t\t Ekp \t\t Etherm \t\t Pg \t\t Pp" << std::endl;
+      f.close();
+    }
+}
+
+// This routine initialize the flow
+// Note that data is on the device.
+// One can therefore define locally
+// a datahost and sync it, if needed
+void Setup::InitFlow(DataBlock &data) {
+    // Create a host copy
+    DataBlockHost d(data);
+
+    for(int k = 0; k < d.np_tot[KDIR] ; k++) {
+        for(int j = 0; j < d.np_tot[JDIR] ; j++) {
+            for(int i = 0; i < d.np_tot[IDIR] ; i++) {
+                d.Vc(RHO,k,j,i) = 1.0;
+                d.Vc(VX1,k,j,i) = 2.0;
+                #if COMPONENTS >= 2
+                  d.Vc(VX2,k,j,i) = 1.0;
+                #endif
+                d.Vc(PRS,k,j,i) = 1.0;
+            }
+        }
+    }
+
+    // Send it all, if needed
+    d.SyncToDevice();
+
+    // 4 particles per cell, moving against the gas
+    const int nPerCell = 4;
+    const int n = nPerCell*d.np_int[IDIR]*d.np_int[JDIR];
+    IdefixHostArray2D<real> particles("particles", Particles::nfield, n);
+    for(int p = 0 ; p < n ; p++) {
+      const int q = p%nPerCell;
+      const int i = d.beg[IDIR] + (p/nPerCell)%d.np_int[IDIR];
+      const int j = d.beg[JDIR] + (p/nPerCell)/d.np_int[IDIR];
+      particles(Particles::PX1,p) = d.xl[IDIR](i) + (q + 0.5)*d.dx[IDIR](i)/nPerCell;
+      particles(Particles::PX2,p) = d.x[JDIR](j);
+      #if DIMENSIONS >= 2
+        particles(Particles::PX2,p) = d.xl[JDIR](j) + ((3*q)%nPerCell + 0.5)*d.dx[JDIR](j)/nPerCell;
+      #endif
+      particles(Particles::PX3,p) = d.x[KDIR](d.beg[KDIR]);
+      particles(Particles::PV1,p) = -2.0;
+      particles(Particles::PV2,p) = COMPONENTS >= 2 ? -1.0 : 0.0;
+      particles(Particles::PV3,p) = 0.0;
+      particles(Particles::PMASS,p) = 0.5*d.dV(d.beg[KDIR],j,i)/nPerCell;
+      particles(Particles::PSPECIES,p) = 0;
+    }
+    data.particles->Add(particles);
+}
+
+// Analyse data to produce an output
+void MakeAnalysis(DataBlock & data) {
+
+}
@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+
+"""
+
+Lagrangian particles coupled to the gas: conservation of energy and momentum
+"""
+import os
+import sys
+sys.path.append(os.getenv("IDEFIX_DIR"))
+
+import pytools.idfx_test as tst
+
+def testMe(test):
+  test.configure()
+  test.compile()
+  test.run()
+  test.standardTest()
+
+  # 2D, with the deposits of the particles near the subdomain edges exchanged in both directions
+  dec = test.dec
+  test.dec = ['2','2']
+  test.configure(definitionFile="definitions-2D.hpp")
+  test.compile()
+  test.run(inputFile="idefix-2D.ini")
+  test.standardTest()
+  test.dec = dec
+
+
+test=tst.idfxTest()
+
+# if no decomposition is specified, use that one
+if not test.dec:
+  test.dec=['2']
+
+if not test.all:
+  if(test.check):
+    test.standardTest()
+  else:
+    testMe(test)
+else:
+  test.noplot = True
+  test.single=False
+  test.reconstruction=2
+  test.mpi=False
+  testMe(test)
+  test.mpi=True
+  testMe(test)
@@ -0,0 +1,68 @@
+#include "idefix.hpp"
+#include "setup.hpp"
+
+// Advection of a density bump, with some extra work in the left half of the domain, so that
+// the processes sharing this half are slower and the domain decomposition gets rebalanced.
+
+static int nWork;
+static IdefixArray3D<real> work;
+
+// Busy loop which does not change the flow (its result is stored in a scratch array)
+void ExtraWork(Hydro *hydro, const real t, const real dt) {
+  DataBlock *data = hydro->data;
+  IdefixArray4D<real> Vc = hydro->Vc;
+  IdefixArray1D<real> x = data->x[IDIR];
+  IdefixArray3D<real> w = work;
+  const int n = nWork;
+  idefix_for("ExtraWork",
+              data->beg[KDIR], data->end[KDIR],
+              data->beg[JDIR], data->end[JDIR],
+              data->beg[IDIR], data->end[IDIR],
+              KOKKOS_LAMBDA (int k, int j, int i) {
+                real s = Vc(RHO,k,j,i);
+                if(x(i) < ZERO_F) {
+                  for(int m = 0 ; m < n ; m++) {
+                    s = std::sqrt(s*s + 1.0e-3);
+                  }
+                }
+                w(k,j,i) = s;
+              });
+}
+
+// Initialisation routine. Can be used to allocate
+// Arrays or variables which are used later on
+Setup::Setup(Input &input, Grid &grid, DataBlock &data, Output &output) {
+  nWork = input.Get<int>("Setup","work",0);
+  work = IdefixArray3D<real>("work", data.np_tot[KDIR], data.np_tot[JDIR], data.np_tot[IDIR]);
+  data.hydro->EnrollUserSourceTerm(&ExtraWork);
+}
+
+// This routine initialize the flow
+// Note that data is on the device.
+// One can therefore define locally
+// a datahost and sync it, if needed
+void Setup::InitFlow(DataBlock &data) {
+    // Create a host copy
+    DataBlockHost d(data);
+
+    for(int k = 0; k < d.np_tot[KDIR] ; k++) {
+        for(int j = 0; j < d.np_tot[JDIR] ; j++) {
+            for(int i = 0; i < d.np_tot[IDIR] ; i++) {
+                real x = d.x[IDIR](i);
+                real y = d.x[JDIR](j);
+
+                d.Vc(RHO,k,j,i) = 1.0 + 0.5*exp(-(x*x+y*y)/0.01);
+                d.Vc(VX1,k,j,i) = 1.0;
+                d.Vc(VX2,k,j,i) = 0.5;
+                d.Vc(PRS,k,j,i) = 1.0;
+            }
+        }
+    }
+
+    // Send it all, if needed
+    d.SyncToDevice();
+}
+
+// Analyse data to produce an output
+void MakeAnalysis(DataBlock & data) {
+}
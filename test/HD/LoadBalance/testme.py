@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+
+"""
+Rebalancing the domain decomposition restarts the code from a dump, with slabs of different
+widths. The result should be the one of a run keeping the initial decomposition.
+"""
+import os
+import sys
+import glob
+import shutil
+sys.path.append(os.getenv("IDEFIX_DIR"))
+
+import pytools.idfx_test as tst
+
+tolerance=1e-13
+
+def lastDump():
+  return(sorted(glob.glob("dump.[0-9]*.dmp"))[-1])
+
+def testMe(test):
+  test.configure()
+  test.compile()
+  for dump in glob.glob("dump.*.dmp"):
+    os.remove(dump)
+
+  # Reference run, with the initial decomposition (dumps at t=0 and t=tstop)
+  test.run(inputFile="idefix.ini")
+  shutil.move(lastDump(), "dump.nobalance.dmp")
+  for dump in glob.glob("dump.[0-9]*.dmp"):
+    os.remove(dump)
+
+  # Each rebalancing writes an additional dump before restarting
+  test.run(inputFile="idefix-balance.ini")
+  dumps = sorted(glob.glob("dump.[0-9]*.dmp"))
+  assert len(dumps) > 2, tst.bcolors.FAIL+"The domain decomposition was not rebalanced"+tst.bcolors.ENDC
+  print(tst.bcolors.OKGREEN+"Domain decomposition rebalanced %d time(s)"%(len(dumps)-2)+tst.bcolors.ENDC)
+  test.compareDump("dump.nobalance.dmp", dumps[-1], tolerance=tolerance)
+
+
+test=tst.idfxTest()
+
+# Load balancing only exists with MPI, with several slabs along X1
+test.mpi=True
+if not test.dec:
+  test.dec=['4','1']
+
+test.noplot = True
+testMe(test)
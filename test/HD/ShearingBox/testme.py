@@ -38,3 +38,7 @@ else:
   test.reconstruction=2
   test.mpi=False
   testMe(test)
+  # Domain decomposed along X2: the shearing-box remap then exchanges data across processes
+  test.mpi=True
+  test.dec=['1','2','1']
+  testMe(test)
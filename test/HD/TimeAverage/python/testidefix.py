@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Compare the time averages of a static flow, and their averages along X2, with the analytical
+values.
+"""
+
+import os
+import sys
+sys.path.append(os.getenv("IDEFIX_DIR"))
+from pytools.vtk_io import readVTK
+import argparse
+import numpy as np
+import matplotlib.pyplot as plt
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-noplot",
+                    default=False,
+                    help="disable plotting",
+                    action="store_true")
+
+
+args, unknown=parser.parse_known_args()
+
+# rho = 1 + a(x)*(1 + cos(2 pi y)/2) with a(x) = sin(2 pi x)/2, so that along X2
+# <rho> = 1 + a and <rho^2> = (1+a)^2 + a^2/8
+Vline=readVTK('../avg1.0001.vtk', geometry='cartesian')
+a=0.5*np.sin(2.0*np.pi*Vline.x)
+rhoLine=1.0+a
+rho2Line=(1.0+a)**2+a**2/8.0
+
+# Time averages only
+Vtime=readVTK('../avg2.0001.vtk', geometry='cartesian')
+x,y=np.meshgrid(Vtime.x,Vtime.y,indexing='ij')
+rho=1.0+0.5*np.sin(2.0*np.pi*x)*(1.0+0.5*np.cos(2.0*np.pi*y))
+
+if(not args.noplot):
+    plt.figure(1)
+    plt.plot(Vline.x,Vline.data['RHO'][:,0,0],'+',label='<RHO>')
+    plt.plot(Vline.x,rhoLine,label='<RHO> theory')
+    plt.plot(Vline.x,Vline.data['RHO*RHO'][:,0,0],'+',label='<RHO*RHO>')
+    plt.plot(Vline.x,rho2Line,label='<RHO*RHO> theory')
+    plt.legend()
+    plt.ioff()
+    plt.show()
+
+error=max(np.max(np.abs(Vline.data['RHO'][:,0,0]-rhoLine)),
+          np.max(np.abs(Vline.data['RHO*RHO'][:,0,0]-rho2Line)),
+          np.max(np.abs(Vline.data['PRS'][:,0,0]-1.0)),
+          np.max(np.abs(Vtime.data['RHO'][:,:,0]-rho)),
+          np.max(np.abs(Vtime.data['RHO*RHO'][:,:,0]-rho**2)))
+print("Error=%e"%error)
+# vtk files are written in single precision
+assert(error<1e-5)
+
+print("SUCCESS!")
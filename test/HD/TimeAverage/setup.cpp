@@ -0,0 +1,40 @@
+#include "idefix.hpp"
+#include "setup.hpp"
+
+// Static density pattern in pressure equilibrium. The flow does not evolve, so that its time
+// averages and its averages along X2 are known analytically.
+
+// Initialisation routine. Can be used to allocate
+// Arrays or variables which are used later on
+Setup::Setup(Input &input, Grid &grid, DataBlock &data, Output &output) {
+}
+
+// This routine initialize the flow
+// Note that data is on the device.
+// One can therefore define locally
+// a datahost and sync it, if needed
+void Setup::InitFlow(DataBlock &data) {
+    // Create a host copy
+    DataBlockHost d(data);
+
+    for(int k = 0; k < d.np_tot[KDIR] ; k++) {
+        for(int j = 0; j < d.np_tot[JDIR] ; j++) {
+            for(int i = 0; i < d.np_tot[IDIR] ; i++) {
+                real x = d.x[IDIR](i);
+                real y = d.x[JDIR](j);
+
+                d.Vc(RHO,k,j,i) = 1.0 + 0.5*sin(2.0*M_PI*x)*(1.0 + 0.5*cos(2.0*M_PI*y));
+                d.Vc(VX1,k,j,i) = 0.0;
+                d.Vc(VX2,k,j,i) = 0.0;
+                d.Vc(PRS,k,j,i) = 1.0;
+            }
+        }
+    }
+
+    // Send it all, if needed
+    d.SyncToDevice();
+}
+
+// Analyse data to produce an output
+void MakeAnalysis(DataBlock & data) {
+}
@@ -0,0 +1,34 @@
+#!/usr/bin/env python3
+
+"""
+
+@author: glesur
+"""
+import os
+import sys
+sys.path.append(os.getenv("IDEFIX_DIR"))
+
+import pytools.idfx_test as tst
+
+def testMe(test):
+  test.configure()
+  test.compile()
+  test.run()
+  test.standardTest()
+
+
+test=tst.idfxTest()
+
+if not test.all:
+  testMe(test)
+else:
+  test.noplot = True
+  test.mpi=False
+  testMe(test)
+
+  # Decomposed along the averaging direction (X2), then along both directions
+  test.mpi=True
+  test.dec=['1','2']
+  testMe(test)
+  test.dec=['2','2']
+  testMe(test)
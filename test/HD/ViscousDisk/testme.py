@@ -5,11 +5,15 @@
 @author: glesur
 """
 import os
+import shutil
 import sys
 sys.path.append(os.getenv("IDEFIX_DIR"))
 
 import pytools.idfx_test as tst
 tolerance=3e-15
+# Differences allowed with respect to a refresh of the viscosity at each stage
+cycleTolerance=1e-6
+thresholdTolerance=1e-5
 def testMe(test):
   test.configure()
   test.compile()
@@ -23,6 +27,14 @@ def testMe(test):
     test.standardTest()
     test.nonRegressionTest(filename="dump.0001.dmp",tolerance=mytol)
 
+  # Refreshing the viscosity once per cycle, or once the density changed enough, should stay
+  # close to the default refresh at each stage (the last run above)
+  shutil.move("dump.0001.dmp","dump.stage.dmp")
+  for ini,tol in [("idefix-rkl-cycle.ini",cycleTolerance),
+                  ("idefix-rkl-threshold.ini",thresholdTolerance)]:
+    test.run(inputFile=ini)
+    test.compareDump("dump.stage.dmp","dump.0001.dmp",tolerance=tol)
+
 
 test=tst.idfxTest()
 if not test.dec:
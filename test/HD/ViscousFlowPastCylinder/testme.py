@@ -26,6 +26,14 @@ def testMe(test):
     test.standardTest()
     test.nonRegressionTest(filename="dump.0001.dmp",tolerance=mytol)
 
+  # Deep halos with explicit viscosity, which widens the stencil of each stage, should give
+  # the same result
+  if test.mpi:
+    test.run(inputFile="idefix-deephalo.ini")
+    #force override the inputfile since the result should be identical
+    test.inifile="idefix.ini"
+    test.nonRegressionTest(filename="dump.0001.dmp",tolerance=tolerance)
+
 
 test=tst.idfxTest()
 if not test.dec:
@@ -26,6 +26,12 @@ def testMe(test):
       test.makeReference(filename=name)
     test.nonRegressionTest(filename=name,tolerance=tolerance)
 
+  # coarsening levels computed by the built-in criteria, statically and dynamically
+  inifiles=["idefix-coarsening-aspect.ini","idefix-coarsening-cfl.ini"]
+  for ini in inifiles:
+    test.run(inputFile=ini)
+    test.standardTest()
+
 
 test=tst.idfxTest()
 
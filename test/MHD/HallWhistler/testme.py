@@ -25,6 +25,10 @@ def testMe(test):
       test.makeReference(filename=name)
     test.nonRegressionTest(filename=name,tolerance=tolerance)
 
+  # Hall term integrated in SSP-RK3 substeps: the whistler frequency should be recovered
+  test.run(inputFile="idefix-subcycle.ini")
+  test.standardTest()
+
 
 test=tst.idfxTest()
 
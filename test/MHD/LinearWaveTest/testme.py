@@ -23,6 +23,14 @@ def testMe(test):
     test.standardTest()
     test.nonRegressionTest(filename="dump.0001.dmp",tolerance=mytol)
 
+  # Deep halos with a 3-stage integrator in 3D should give the same result
+  if test.mpi:
+    test.run(inputFile="idefix-alfven-deephalo.ini")
+    test.standardTest()
+    #force override the inputfile since the result should be identical
+    test.inifile="idefix-alfven.ini"
+    test.nonRegressionTest(filename="dump.0001.dmp",tolerance=tolerance)
+
 
 test=tst.idfxTest()
 if not test.dec:
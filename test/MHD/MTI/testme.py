@@ -26,6 +26,13 @@ def testMe(test):
       test.makeReference(filename=name)
     test.nonRegressionTest(filename=name)
 
+  # The user potential does not depend on time: caching it should give the same result
+  test.run(inputFile="idefix-static.ini")
+  test.standardTest()
+  #force override the inputfile since the result should be identical
+  test.inifile="idefix.ini"
+  test.nonRegressionTest(filename=name)
+
 
 test=tst.idfxTest()
 
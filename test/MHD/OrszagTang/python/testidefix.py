@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Check a restart on a finer grid: the mass should be the one of the initial
+conditions, and the remapped magnetic field should stay divergence-free.
+"""
+import os
+import sys
+import glob
+import numpy as np
+sys.path.append(os.getenv("IDEFIX_DIR"))
+from pytools.dump_io import readDump
+import argparse
+
+parser = argparse.ArgumentParser()
+parser.add_argument("-noplot",
+                    default=False,
+                    help="disable plotting",
+                    action="store_true")
+
+args, unknown=parser.parse_known_args()
+
+# last dump written by the restarted run
+filename=max(glob.glob('../dump.*.dmp'), key=os.path.getmtime)
+D=readDump(filename)
+
+dx=D.x1r-D.x1l
+dy=D.x2r-D.x2l
+dV=dx[:,np.newaxis]*dy[np.newaxis,:]
+if D.data['Vc-RHO'].ndim==3:
+  rho=D.data['Vc-RHO'][:,:,0]
+  bx=D.data['Vs-BX1s'][:,:,0]
+  by=D.data['Vs-BX2s'][:,:,0]
+else:
+  rho=D.data['Vc-RHO']
+  bx=D.data['Vs-BX1s']
+  by=D.data['Vs-BX2s']
+
+# The domain is periodic: the mass is the one of the initial conditions
+massRef=25.0/(36.0*np.pi)
+errMass=np.abs(np.sum(rho*dV)-massRef)/massRef
+
+divB=(bx[1:,:]-bx[:-1,:])/dx[:,np.newaxis] + (by[:,1:]-by[:,:-1])/dy[np.newaxis,:]
+errDivB=np.max(np.abs(divB))*np.min(dx)/np.max(np.abs(bx))
+
+print("File=%s, nx=%d, ny=%d"%(filename,rho.shape[0],rho.shape[1]))
+print("Relative mass error=%e"%errMass)
+print("Normalised max|divB|=%e"%errDivB)
+
+if errMass<1e-10 and errDivB<1e-10:
+  print("SUCCESS!")
+  sys.exit(0)
+else:
+  print("FAILURE!")
+  sys.exit(1)
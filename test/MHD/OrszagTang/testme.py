@@ -5,6 +5,7 @@
 @author: glesur
 """
 import os
+import shutil
 import sys
 sys.path.append(os.getenv("IDEFIX_DIR"))
 
@@ -32,6 +33,32 @@ def testMe(test):
 
     test.nonRegressionTest(filename="dump.0001.dmp",tolerance=mytol)
 
+  # Deep halos (one MPI exchange per cycle) should give the same result
+  if test.mpi:
+    test.run(inputFile="idefix-hlld-deephalo.ini")
+    #force override the inputfile since the result should be identical
+    test.inifile="idefix-hlld-hlld.ini"
+    test.nonRegressionTest(filename="dump.0001.dmp",tolerance=mytol)
+
+  # Dumps staged in a node-local directory: the drained dump should be the one of idefix.ini,
+  # and so should a restart from the node-local copy of the dump at t=0.25
+  shutil.rmtree("local-dumps", ignore_errors=True)
+  test.run(inputFile="idefix-local.ini")
+  test.inifile="idefix.ini"
+  test.nonRegressionTest(filename="dump.0002.dmp",tolerance=mytol)
+  os.remove("dump.0001.dmp")
+  os.remove("dump.0002.dmp")
+  test.run(inputFile="idefix-local.ini", restart=1)
+  test.inifile="idefix.ini"
+  test.nonRegressionTest(filename="dump.0002.dmp",tolerance=mytol)
+  shutil.rmtree("local-dumps", ignore_errors=True)
+
+  # Restart the dump of idefix.ini on a grid twice finer
+  if not test.single:
+    test.run(inputFile="idefix.ini")
+    test.run(inputFile="idefix-remap.ini", restart=1)
+    test.standardTest()
+
 
 test=tst.idfxTest()
 if not test.dec:
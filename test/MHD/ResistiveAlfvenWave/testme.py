@@ -25,6 +25,11 @@ def testMe(test):
       mytol=1e-10
     test.nonRegressionTest(filename="dump.0001.dmp",tolerance=mytol)
 
+  # Implicit integration of the resistive term (field and energy unknowns): the decay
+  # should follow the analytic rate
+  test.run(inputFile="idefix-implicit.ini")
+  test.standardTest()
+
 
 test=tst.idfxTest()
 
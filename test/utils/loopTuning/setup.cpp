@@ -0,0 +1,40 @@
+#include "idefix.hpp"
+#include "setup.hpp"
+
+// Advection of a density bump, used to check that the loop strategies chosen by the loop
+// autotuner are saved and read back by the next run.
+
+// Initialisation routine. Can be used to allocate
+// Arrays or variables which are used later on
+Setup::Setup(Input &input, Grid &grid, DataBlock &data, Output &output) {
+}
+
+// This routine initialize the flow
+// Note that data is on the device.
+// One can therefore define locally
+// a datahost and sync it, if needed
+void Setup::InitFlow(DataBlock &data) {
+    // Create a host copy
+    DataBlockHost d(data);
+
+    for(int k = 0; k < d.np_tot[KDIR] ; k++) {
+        for(int j = 0; j < d.np_tot[JDIR] ; j++) {
+            for(int i = 0; i < d.np_tot[IDIR] ; i++) {
+                real x = d.x[IDIR](i);
+                real y = d.x[JDIR](j);
+
+                d.Vc(RHO,k,j,i) = 1.0 + 0.5*exp(-(x*x+y*y)/0.01);
+                d.Vc(VX1,k,j,i) = 1.0;
+                d.Vc(VX2,k,j,i) = 0.5;
+                d.Vc(PRS,k,j,i) = 1.0;
+            }
+        }
+    }
+
+    // Send it all, if needed
+    d.SyncToDevice();
+}
+
+// Analyse data to produce an output
+void MakeAnalysis(DataBlock & data) {
+}
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+
+"""
+With the loop autotuner, the first run times the loop strategies of each kernel and saves the
+winners in the tuning cache. The second run should read them back instead of tuning again, and
+give the same result.
+"""
+import os
+import re
+import sys
+import glob
+import shutil
+sys.path.append(os.getenv("IDEFIX_DIR"))
+
+import pytools.idfx_test as tst
+
+tolerance=1e-14
+cacheFile="idefix.tuning"
+
+def cachedKernels():
+  with open(cacheFile,'r') as file:
+    return(len([line for line in file if line.strip() and not line.startswith('#')]))
+
+def testMe(test):
+  test.configure()
+  test.compile()
+  for dump in glob.glob("dump.*.dmp"):
+    os.remove(dump)
+  if os.path.exists(cacheFile):
+    os.remove(cacheFile)
+
+  # First run: the kernels are tuned and the cache is written
+  test.run(inputFile="idefix.ini")
+  assert os.path.exists(cacheFile), tst.bcolors.FAIL+"The tuning cache was not written"+tst.bcolors.ENDC
+  nCached = cachedKernels()
+  assert nCached > 0, tst.bcolors.FAIL+"The tuning cache is empty"+tst.bcolors.ENDC
+  shutil.move("dump.0001.dmp", "dump.tuning.dmp")
+
+  # Second run: the strategies are read from the cache
+  test.run(inputFile="idefix.ini")
+  with open('./idefix.0.log','r') as file:
+    log = file.read()
+  line = re.search(r'LoopTuner: read the loop strategies of (\d+) kernels', log)
+  assert line is not None and int(line.group(1)) == nCached, \
+         tst.bcolors.FAIL+"The tuning cache was not read by the second run"+tst.bcolors.ENDC
+  print(tst.bcolors.OKGREEN+"%d loop strategies read from the cache"%nCached+tst.bcolors.ENDC)
+  test.compareDump("dump.tuning.dmp", "dump.0001.dmp", tolerance=tolerance)
+
+
+test=tst.idfxTest()
+
+# The test only makes sense with the loop autotuner
+test.cmake.append("Idefix_LOOP_AUTOTUNE=ON")
+test.noplot = True
+
+if not test.all:
+  testMe(test)
+else:
+  test.mpi=False
+  testMe(test)
+
+  # The ranks should agree on the strategies they write
+  test.mpi=True
+  test.dec=['2','2']
+  testMe(test)